@@ -19,6 +19,7 @@
 #include <iomanip>
 #include <iostream>
 #include <limits>
+#include <mutex>
 #include <numeric>
 #include <sstream>
 #include <stdexcept>
@@ -451,6 +452,41 @@ end
     addMetric(report, "lua_to_cpp_ns_per_call", "ns/call", "lower", std::move(costs));
 }
 
+void benchmarkPcallError(Report& report) {
+    std::cerr << "[bench] pcall of a Lua function raising error()\n";
+    constexpr std::string_view source = R"lua(
+local pcall, error = pcall, error
+local function reject(i) error(i, 0) end
+return function(count)
+  local total = 0
+  for i = 1, count do
+    local ok, value = pcall(reject, i)
+    if not ok then total = total + value end
+  end
+  return total
+end
+)lua";
+
+    LuaStateOwner owner(lua_open());
+    lua_State* state = owner.get();
+    luaL_openlibs(state);
+    const int functionReference = loadReturnedFunction(state, source, "=runtime_bench_pcall_error");
+
+    std::vector<double> costs;
+    costs.reserve(report.config.samples);
+    for (std::size_t sample = 0; sample < report.config.samples; ++sample) {
+        const double count = static_cast<double>(report.config.luaToCppCalls);
+        const auto start = Clock::now();
+        const double result = invokeNumberFunction(state, functionReference, count, "Lua pcall error loop");
+        const auto end = Clock::now();
+        require(result == count * (count + 1.0) / 2.0, "Lua pcall error checksum mismatch");
+        costs.push_back(elapsedSeconds(start, end) * 1.0e9 / count);
+    }
+
+    luaL_unref(state, LUA_REGISTRYINDEX, functionReference);
+    addMetric(report, "pcall_error_ns_per_call", "ns/call", "lower", std::move(costs));
+}
+
 void benchmarkCoroutine(Report& report) {
     std::cerr << "[bench] coroutine resume/yield cost\n";
     LuaStateOwner owner(lua_open());
@@ -492,6 +528,79 @@ void benchmarkCoroutine(Report& report) {
     addMetric(report, "coroutine_resume_yield_ns", "ns/round-trip", "lower", std::move(costs));
 }
 
+void benchmarkCoroutineSwitch(Report& report) {
+    std::cerr << "[bench] Lua-driven coroutine resume/yield cost\n";
+    constexpr std::string_view source = R"lua(
+local create, resume, yield = coroutine.create, coroutine.resume, coroutine.yield
+return function(count)
+  local actor = create(function()
+    local i = 0
+    while true do i = i + 1; yield(i) end
+  end)
+  local total = 0
+  for _ = 1, count do
+    local _, value = resume(actor)
+    total = total + value
+  end
+  return total
+end
+)lua";
+
+    LuaStateOwner owner(lua_open());
+    lua_State* state = owner.get();
+    luaL_openlibs(state);
+    const int functionReference = loadReturnedFunction(state, source, "=runtime_bench_coroutine_switch");
+
+    std::vector<double> costs;
+    costs.reserve(report.config.samples);
+    for (std::size_t sample = 0; sample < report.config.samples; ++sample) {
+        const double count = static_cast<double>(report.config.coroutineYields);
+        const auto start = Clock::now();
+        const double result = invokeNumberFunction(state, functionReference, count, "Lua coroutine switch loop");
+        const auto end = Clock::now();
+        require(result == count * (count + 1.0) / 2.0, "Lua coroutine switch checksum mismatch");
+        costs.push_back(elapsedSeconds(start, end) * 1.0e9 / count);
+    }
+
+    luaL_unref(state, LUA_REGISTRYINDEX, functionReference);
+    addMetric(report, "coroutine_switch_ns", "ns/round-trip", "lower", std::move(costs));
+}
+
+void benchmarkCoroutineSpawn(Report& report) {
+    std::cerr << "[bench] short-lived coroutine spawn cost\n";
+    constexpr std::string_view source = R"lua(
+local create, resume = coroutine.create, coroutine.resume
+local function body(x) return x end
+return function(count)
+  local total = 0
+  for i = 1, count do
+    local _, value = resume(create(body), i)
+    total = total + value
+  end
+  return total
+end
+)lua";
+
+    LuaStateOwner owner(lua_open());
+    lua_State* state = owner.get();
+    luaL_openlibs(state);
+    const int functionReference = loadReturnedFunction(state, source, "=runtime_bench_coroutine_spawn");
+
+    std::vector<double> costs;
+    costs.reserve(report.config.samples);
+    for (std::size_t sample = 0; sample < report.config.samples; ++sample) {
+        const double count = static_cast<double>(report.config.coroutineYields);
+        const auto start = Clock::now();
+        const double result = invokeNumberFunction(state, functionReference, count, "Lua coroutine spawn loop");
+        const auto end = Clock::now();
+        require(result == count * (count + 1.0) / 2.0, "Lua coroutine spawn checksum mismatch");
+        costs.push_back(elapsedSeconds(start, end) * 1.0e9 / count);
+    }
+
+    luaL_unref(state, LUA_REGISTRYINDEX, functionReference);
+    addMetric(report, "coroutine_spawn_ns", "ns/coroutine", "lower", std::move(costs));
+}
+
 double expectedTableChecksum(std::size_t iterations) {
     std::vector<double> array(257, 0.0);
     std::vector<double> hash(65, 0.0);
@@ -639,6 +748,17 @@ end
     addMetric(report, "allocation_mib_per_second", "MiB/s", "higher", std::move(allocationRates));
 }
 
+struct LockedCountingAllocator {
+    std::mutex mutex;
+    CountingAllocator counts;
+};
+
+void* lockedCountingAllocator(void* userData, void* pointer, std::size_t oldSize, std::size_t newSize) {
+    auto* probe = static_cast<LockedCountingAllocator*>(userData);
+    std::scoped_lock lock(probe->mutex);
+    return countingAllocator(&probe->counts, pointer, oldSize, newSize);
+}
+
 int loadTransientFrameFunction(lua_State* state, std::string_view name) {
     constexpr std::string_view source = R"lua(
 return function(frame)
@@ -657,36 +777,42 @@ double expectedTransientChecksum(std::size_t frame) {
     return static_cast<double>(frame * 4 + 10);
 }
 
-void benchmarkGcPause(Report& report) {
-    std::cerr << "[bench] fixed-budget per-frame GC pause distribution\n";
-    CountingAllocator allocator;
-    LuaStateOwner owner(lua_newstate(countingAllocator, &allocator));
-    lua_State* state = owner.get();
-    const int functionReference = loadTransientFrameFunction(state, "=runtime_bench_gc_pause");
+std::size_t runGcPauseFrames(lua_State* state, int functionReference, const Config& config,
+                             std::vector<double>& samplesUs) {
     Lua::LuaState* internal = internalState(state);
     Lua::GarbageCollector& gc = internal->getGlobalState().getGC();
-    gc.stopAutomatic();
-
-    report.gcPauseSamplesUs.reserve(report.config.gcPauseFrames);
+    samplesUs.reserve(config.gcPauseFrames);
     std::size_t completedCycles = 0;
-    for (std::size_t frame = 1; frame <= report.config.gcPauseFrames; ++frame) {
+    for (std::size_t frame = 1; frame <= config.gcPauseFrames; ++frame) {
         const double result =
             invokeNumberFunction(state, functionReference, static_cast<double>(frame), "GC frame allocation fixture");
         require(result == expectedTransientChecksum(frame), "GC frame checksum mismatch");
 
         const auto start = Clock::now();
-        const bool completed = gc.step(internal, report.config.gcStepSize);
+        const bool completed = gc.step(internal, config.gcStepSize);
         const auto end = Clock::now();
-        report.gcPauseSamplesUs.push_back(elapsedSeconds(start, end) * 1.0e6);
+        samplesUs.push_back(elapsedSeconds(start, end) * 1.0e6);
         if (completed) {
             ++completedCycles;
         }
     }
 
-    require(report.gcPauseSamplesUs.size() >= kRequiredCiGcPauseSamples,
-            "GC pause distribution has fewer than 10000 frame samples");
+    require(samplesUs.size() >= kRequiredCiGcPauseSamples, "GC pause distribution has fewer than 10000 frame samples");
     require(completedCycles > 0, "fixed-budget GC did not complete a collection cycle");
-    report.gcCycles = completedCycles;
+    return completedCycles;
+}
+
+void benchmarkGcPause(Report& report) {
+    std::cerr << "[bench] fixed-budget per-frame GC pause distribution\n";
+    CountingAllocator allocator;
+    LuaStateOwner owner(lua_newstate(countingAllocator, &allocator));
+    lua_State* state = owner.get();
+    const int functionReference = loadTransientFrameFunction(state, "=runtime_bench_gc_pause");
+    Lua::LuaState* internal = internalState(state);
+    Lua::GarbageCollector& gc = internal->getGlobalState().getGC();
+    gc.stopAutomatic();
+
+    report.gcCycles = runGcPauseFrames(state, functionReference, report.config, report.gcPauseSamplesUs);
 
     const double p50 = nearestRankPercentile(report.gcPauseSamplesUs, 0.50);
     const double p95 = nearestRankPercentile(report.gcPauseSamplesUs, 0.95);
@@ -706,6 +832,35 @@ void benchmarkGcPause(Report& report) {
     require(allocator.liveBytes == 0, "GC pause allocator retained bytes after lua_close");
 }
 
+void benchmarkGcPauseBackgroundFree(Report& report) {
+    std::cerr << "[bench] fixed-budget per-frame GC pause distribution with background free\n";
+    LockedCountingAllocator allocator;
+    LuaStateOwner owner(lua_newstate(lockedCountingAllocator, &allocator));
+    lua_State* state = owner.get();
+    const int functionReference = loadTransientFrameFunction(state, "=runtime_bench_gc_pause_background_free");
+    Lua::LuaState* internal = internalState(state);
+    Lua::GarbageCollector& gc = internal->getGlobalState().getGC();
+    gc.stopAutomatic();
+    gc.setBackgroundFreeEnabled(true);
+
+    std::vector<double> samplesUs;
+    (void)runGcPauseFrames(state, functionReference, report.config, samplesUs);
+
+    const double p99 = nearestRankPercentile(samplesUs, 0.99);
+    const double maximum = *std::max_element(samplesUs.begin(), samplesUs.end());
+    require(p99 <= maximum, "background-free GC pause percentiles are not monotonic");
+    require(gc.getBackgroundFreedBlocks() > 0, "background-free GC pause run freed nothing on the helper thread");
+
+    addMetric(report, "gc_pause_background_free_p99_us", "us", "lower", {p99});
+    addMetric(report, "gc_pause_background_free_max_us", "us", "lower", {maximum});
+
+    luaL_unref(state, LUA_REGISTRYINDEX, functionReference);
+    (void)gc.collect(internal);
+    owner.close();
+    require(!allocator.counts.accountingError, "allocator accounting failed during background-free GC pause benchmark");
+    require(allocator.counts.liveBytes == 0, "background-free GC pause allocator retained bytes after lua_close");
+}
+
 int loadHeapStabilityFunction(lua_State* state) {
     constexpr std::string_view source = R"lua(
 local retained = {}
@@ -1080,10 +1235,14 @@ void runBenchmarks(Report& report) {
     benchmarkVmDispatch(report);
     benchmarkCppToLua(report);
     benchmarkLuaToCpp(report);
+    benchmarkPcallError(report);
     benchmarkCoroutine(report);
+    benchmarkCoroutineSwitch(report);
+    benchmarkCoroutineSpawn(report);
     benchmarkTableHotReadWrite(report);
     benchmarkClosureLifecycle(report);
     benchmarkGcPause(report);
+    benchmarkGcPauseBackgroundFree(report);
     benchmarkHeapStability(report);
 }
 
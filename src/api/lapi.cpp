@@ -17,6 +17,7 @@
 #include "core/upvalue.hpp"
 #include "core/userdata.hpp"
 #include "core/value.hpp"
+#include "gc/gc_strategy.hpp"
 #include "lib/lib_manager.hpp"
 #include "lib/baselib.hpp"
 #include "lib/stringlib.hpp"
@@ -756,6 +757,31 @@ int lua_runtime_get_metrics(lua_State* L, lua_RuntimeMetrics* metrics) LUA_CXX_N
     return LUA_RUNTIME_OK;
 }
 
+int lua_runtime_scheduler_run(lua_State* L, uint64_t budget) LUA_CXX_NOEXCEPT {
+    Lua::LuaState* state = fromCUnchecked(L);
+    if (state == nullptr) {
+        return -LUA_RUNTIME_ERR_ARGUMENT;
+    }
+    Lua::GlobalState& globalState = state->getGlobalState();
+    if (!globalState.isOwnerThread()) {
+        return -LUA_RUNTIME_ERR_THREAD;
+    }
+    Lua::LuaState* host = globalState.getMainThread();
+    Lua::CoroutineScheduler& scheduler = globalState.getScheduler();
+    if (host == nullptr || scheduler.isRunning() || globalState.getRunningThread() != nullptr ||
+        host->getCurrentCI() != 0) {
+        return -LUA_RUNTIME_ERR_BUSY;
+    }
+
+    /** @brief 任务错误由各自的恢复吸收并留给 join；这里只会遇到宿主栈中转时的分配失败。 */
+    try {
+        const Lua::usize pending = scheduler.run(host, budget);
+        return static_cast<int>(std::min<Lua::usize>(pending, std::numeric_limits<int>::max()));
+    } catch (...) {
+        return -LUA_RUNTIME_ERR_MEMORY;
+    }
+}
+
 lua_CancellationHandle* lua_runtime_get_cancellation_handle(lua_State* L, int* runtimeStatus) LUA_CXX_NOEXCEPT {
     setRuntimeStatus(runtimeStatus, LUA_RUNTIME_OK);
     Lua::LuaState* state = fromCUnchecked(L);
@@ -804,8 +830,11 @@ lua_Alloc lua_getallocf(lua_State* L, void** userData) LUA_CXX_MAY_THROW {
 }
 
 void lua_setallocf(lua_State* L, lua_Alloc allocatorFunction, void* userData) LUA_CXX_MAY_THROW {
-    Lua::LuaAllocator* allocator = fromC(L)->getGlobalState().getAllocator();
+    Lua::GlobalState& globalState = fromC(L)->getGlobalState();
+    Lua::LuaAllocator* allocator = globalState.getAllocator();
     if (allocator != nullptr && allocatorFunction != nullptr) {
+        // 新分配器不一定可并发释放；先让在途批次经旧函数归还，再关闭后台释放
+        globalState.getGC().setBackgroundFreeEnabled(false);
         allocator->set(allocatorFunction, userData);
     }
 }
@@ -1239,7 +1268,7 @@ const char* lua_pushfstring(lua_State* L, const char* format, ...) LUA_CXX_MAY_T
 
 void lua_pushcclosure(lua_State* L, lua_CFunction fn, int n) LUA_CXX_MAY_THROW {
     Lua::LuaState* state = fromC(L);
-    if (fn == nullptr || n < 0 || n > apiTop(state)) {
+    if (fn == nullptr || n < 0 || n > apiTop(state) || static_cast<Lua::usize>(n) > Lua::Function::MaxUpvalues) {
         state->error("invalid C closure");
     }
 
@@ -1249,7 +1278,7 @@ void lua_pushcclosure(lua_State* L, lua_CFunction fn, int n) LUA_CXX_MAY_THROW {
         upvalues.push_back(state->at(-i));
     }
 
-    Lua::Function* closure = state->getGlobalState().getGC().create<Lua::Function>(fn);
+    Lua::Function* closure = state->getGlobalState().getGC().create<Lua::Function>(fn, static_cast<Lua::usize>(n));
     closure->setEnv(state->getGlobalTable());
     for (const Lua::Value& value : upvalues) {
         closure->addUpvalue(state->getGlobalState().getGC().create<Lua::Upvalue>(value));
@@ -1528,6 +1557,27 @@ void lua_call(lua_State* L, int nargs, int nresults) LUA_CXX_MAY_THROW {
     Lua::VM::call(services, state, nargs, nresults);
 }
 
+void lua_callk(lua_State* L, int nargs, int nresults, lua_KContext ctx, lua_KFunction k) LUA_CXX_MAY_THROW {
+    Lua::LuaState* state = fromC(L);
+    Lua::RuntimeServices services(state->getGlobalState());
+    if (k == nullptr || state->getCurrentCI() == 0 || !state->canYield()) {
+        Lua::VM::call(services, state, nargs, nresults);
+        return;
+    }
+
+    /**
+     * @brief 被调函数挂起时当前 C 帧保留在调用栈上，恢复后以续延代替本函数剩余部分；
+     * 正常返回时续延不会执行，登记随即清除。
+     */
+    Lua::CallInfo& ci = state->getCurrentCallInfo();
+    ci.continuation = k;
+    ci.continuationContext = ctx;
+    Lua::VM::callk(services, state, nargs, nresults);
+    Lua::CallInfo& current = state->getCurrentCallInfo();
+    current.continuation = nullptr;
+    current.continuationContext = 0;
+}
+
 int lua_pcall(lua_State* L, int nargs, int nresults, int errfunc) LUA_CXX_NOEXCEPT {
     Lua::LuaState* state = fromCNoexcept(L);
     if (state == nullptr) {
@@ -1684,7 +1734,10 @@ int lua_resume(lua_State* L, int nargs) LUA_CXX_NOEXCEPT {
             restoreAbsoluteTopClearingSlots(bridge, bridgeTop);
 
             if (thread->isSuspended()) {
-                setApiTop(state, 0);
+                // 挂起于 lua_yieldk 续延帧时保留该帧的栈内容供续延使用，挂起值压在其上
+                if (state->getCurrentCallInfo().continuation == nullptr) {
+                    setApiTop(state, 0);
+                }
                 for (const Lua::Value& value : outputValues) {
                     state->pushValue(value);
                 }
@@ -1756,6 +1809,10 @@ void lua_concat(lua_State* L, int n) LUA_CXX_MAY_THROW {
 }
 
 int lua_yield(lua_State* L, int nresults) LUA_CXX_MAY_THROW {
+    return lua_yieldk(L, nresults, 0, nullptr);
+}
+
+int lua_yieldk(lua_State* L, int nresults, lua_KContext ctx, lua_KFunction k) LUA_CXX_MAY_THROW {
     Lua::LuaState* state = fromC(L);
     if (nresults < 0 || nresults > apiTop(state)) {
         state->error("invalid yield result count");
@@ -1764,6 +1821,14 @@ int lua_yield(lua_State* L, int nresults) LUA_CXX_MAY_THROW {
         state->error("cannot yield across non-resumable call boundaries");
     }
 
+    /** @brief 带续延挂起时恢复直接进入续延，恢复参数留在本帧栈顶。 */
+    Lua::CallInfo& ci = state->getCurrentCallInfo();
+    ci.continuation = k;
+    ci.continuationContext = ctx;
+    if (k != nullptr) {
+        state->setContinuationFrames(true);
+    }
+
     state->setStatus(Lua::ThreadStatus::Yield);
     state->setYieldResults(nresults);
     return 0;
@@ -1793,10 +1858,45 @@ int lua_gc(lua_State* L, int what, int data) LUA_CXX_MAY_THROW {
         return static_cast<int>(gc.getTotalMemory() & 0x3ffU);
     case LUA_GCSTEP:
         return gc.step(state, data) ? 1 : 0;
+    case LUA_GCSTEPUS:
+        return gc.stepFor(state, std::chrono::microseconds(data)) ? 1 : 0;
+    case LUA_GCDEBT: {
+        // 以 KB 报告尚未偿还的债务；处于信用状态时为 0
+        const Lua::isize debt = gc.getDebtBytes();
+        if (debt <= 0) {
+            return 0;
+        }
+        return static_cast<int>(std::min<Lua::isize>(debt >> 10U, std::numeric_limits<int>::max()));
+    }
     case LUA_GCSETPAUSE:
         return gc.setPause(data);
     case LUA_GCSETSTEPMUL:
         return gc.setStepMultiplier(data);
+    case LUA_GCGEN:
+    case LUA_GCINC: {
+        // data 为 0 时保持原参数；分代模式下 data 是次要收集倍数
+        int previous = LUA_GCINC;
+        if (gc.isGenerational()) {
+            previous = LUA_GCGEN;
+        } else if (&gc.getStrategy() == &Lua::markSweepGCStrategy()) {
+            previous = LUA_GCMARKSWEEP;
+        }
+        if (what == LUA_GCGEN) {
+            if (data != 0) {
+                (void)gc.setMinorMultiplier(data);
+            }
+            (void)gc.useStrategy("generational");
+        } else {
+            if (data != 0) {
+                (void)gc.setPause(data);
+            }
+            // 离开分代模式时恢复进入前的策略，否则切换到增量策略
+            if (!gc.leaveGenerationalMode()) {
+                (void)gc.useStrategy("incremental");
+            }
+        }
+        return previous;
+    }
     default:
         return -1;
     }
@@ -0,0 +1,179 @@
+#pragma once
+
+/**
+ * @file hash.hpp
+ * @brief 字符串与标量哈希函数
+ *
+ * 设计说明：
+ * 字节哈希沿用 wyhash 的 64 位乘法折叠（mum）结构：短字符串只需一到两次
+ * 乘法即可完成，质量远好于逐字节移位异或。
+ *
+ * 种子：
+ * 字符串哈希接受种子参数，StringPool 为每个运行时状态生成随机种子，
+ * 使不可信脚本无法离线构造大量同桶字符串。带种子的哈希总是读取全部字节：
+ * 若只采样固定位置，只在未采样字节上不同的字符串对任何种子都会碰撞，种子形同虚设。
+ *
+ * 长字符串采样：
+ * 只有不带种子（seed 为 0，未经 StringPool 驻留）的哈希对超过 kHashFullBytes 的
+ * 字符串采样：读取首尾各 16 字节与均匀分布的 kHashSampleChunks 个 16 字节块，
+ * 并混入长度，使代价与长度无关。
+ */
+
+#include "common/types.hpp"
+
+#include <bit>
+#include <cstring>
+
+#if defined(_MSC_VER) && !defined(__clang__) && defined(_M_X64)
+#include <intrin.h>
+#endif
+
+namespace Lua {
+
+/** @brief 不带种子时，不超过此长度的字符串完整参与哈希。 */
+inline constexpr usize kHashFullBytes = 256;
+/** @brief 长字符串中段的采样块数量（每块 16 字节）。 */
+inline constexpr usize kHashSampleChunks = 16;
+
+namespace hash_detail {
+
+inline constexpr u64 kSecret0 = 0xa0761d6478bd642full;
+inline constexpr u64 kSecret1 = 0xe7037ed1a0b428dbull;
+inline constexpr u64 kSecret2 = 0x8ebc6af09c88c6e3ull;
+inline constexpr u64 kSecret3 = 0x589965cc75374cc3ull;
+
+/** @brief 64×64→128 位乘法，低位写回 a、高位写回 b。 */
+inline void multiplyFold(u64& a, u64& b) noexcept {
+#if defined(__SIZEOF_INT128__)
+    __extension__ using U128 = unsigned __int128;
+    const U128 product = static_cast<U128>(a) * b;
+    a = static_cast<u64>(product);
+    b = static_cast<u64>(product >> 64);
+#elif defined(_MSC_VER) && !defined(__clang__) && defined(_M_X64)
+    a = _umul128(a, b, &b);
+#else
+    const u64 ha = a >> 32, hb = b >> 32, la = static_cast<u32>(a), lb = static_cast<u32>(b);
+    const u64 rh = ha * hb, rm0 = ha * lb, rm1 = hb * la, rl = la * lb;
+    const u64 t = rl + (rm0 << 32);
+    u64 carry = t < rl ? 1 : 0;
+    const u64 lo = t + (rm1 << 32);
+    carry += lo < t ? 1 : 0;
+    a = lo;
+    b = rh + (rm0 >> 32) + (rm1 >> 32) + carry;
+#endif
+}
+
+[[nodiscard]] inline u64 mix(u64 a, u64 b) noexcept {
+    multiplyFold(a, b);
+    return a ^ b;
+}
+
+[[nodiscard]] inline u64 read64(const char* p) noexcept {
+    u64 value = 0;
+    std::memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+[[nodiscard]] inline u64 read32(const char* p) noexcept {
+    u32 value = 0;
+    std::memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+[[nodiscard]] inline u64 read3(const char* p, usize len) noexcept {
+    return (static_cast<u64>(static_cast<unsigned char>(p[0])) << 16) |
+           (static_cast<u64>(static_cast<unsigned char>(p[len >> 1])) << 8) |
+           static_cast<u64>(static_cast<unsigned char>(p[len - 1]));
+}
+
+} // namespace hash_detail
+
+/**
+ * @brief 计算字节序列的带种子哈希
+ * @param data 字节起始地址
+ * @param len 字节数
+ * @param seed 哈希种子；非 0 时读取全部字节
+ * @return 64 位哈希值；seed 为 0 且超过 kHashFullBytes 的输入按固定块数采样
+ */
+[[nodiscard]] inline u64 luaHashBytes(const char* data, usize len, u64 seed) noexcept {
+    using namespace hash_detail;
+
+    const bool sampled = seed == 0 && len > kHashFullBytes;
+    seed ^= mix(seed ^ kSecret0, kSecret1);
+    u64 a = 0;
+    u64 b = 0;
+    if (len <= 16) {
+        if (len >= 4) {
+            const usize shift = (len >> 3) << 2;
+            a = (read32(data) << 32) | read32(data + shift);
+            b = (read32(data + len - 4) << 32) | read32(data + len - 4 - shift);
+        } else if (len > 0) {
+            a = read3(data, len);
+        }
+    } else if (!sampled) {
+        const char* p = data;
+        usize remaining = len;
+        if (remaining > 48) {
+            u64 lane1 = seed;
+            u64 lane2 = seed;
+            do {
+                seed = mix(read64(p) ^ kSecret1, read64(p + 8) ^ seed);
+                lane1 = mix(read64(p + 16) ^ kSecret2, read64(p + 24) ^ lane1);
+                lane2 = mix(read64(p + 32) ^ kSecret3, read64(p + 40) ^ lane2);
+                p += 48;
+                remaining -= 48;
+            } while (remaining > 48);
+            seed ^= lane1 ^ lane2;
+        }
+        while (remaining > 16) {
+            seed = mix(read64(p) ^ kSecret1, read64(p + 8) ^ seed);
+            p += 16;
+            remaining -= 16;
+        }
+        a = read64(p + remaining - 16);
+        b = read64(p + remaining - 8);
+    } else {
+        // 采样首块与均匀分布的中段块；末尾 16 字节作为收尾输入
+        const usize step = (len - 16) / kHashSampleChunks;
+        for (usize i = 0; i < kHashSampleChunks; ++i) {
+            const char* p = data + i * step;
+            seed = mix(read64(p) ^ kSecret1, read64(p + 8) ^ seed);
+        }
+        a = read64(data + len - 16);
+        b = read64(data + len - 8);
+    }
+
+    a ^= kSecret1;
+    b ^= seed;
+    multiplyFold(a, b);
+    return mix(a ^ kSecret0 ^ static_cast<u64>(len), b ^ kSecret1);
+}
+
+/**
+ * @brief 计算单个 64 位字的哈希（数值键与指针键）
+ * @param value 待哈希的位模式
+ * @return 低位同样充分混合的哈希值，可直接按掩码取桶
+ */
+[[nodiscard]] inline u64 luaHashWord(u64 value) noexcept {
+    using namespace hash_detail;
+    u64 a = value ^ kSecret0;
+    u64 b = kSecret1;
+    multiplyFold(a, b);
+    return mix(a ^ kSecret0, b ^ kSecret1);
+}
+
+/**
+ * @brief 计算 Lua 数值键的哈希
+ *
+ * +0 与 -0 在 Lua 中是同一个键，因此先归一化再取位模式。
+ */
+[[nodiscard]] inline u64 luaHashNumber(f64 value) noexcept {
+    return luaHashWord(std::bit_cast<u64>(value == 0.0 ? 0.0 : value));
+}
+
+/** @brief 计算指针身份的哈希。 */
+[[nodiscard]] inline u64 luaHashPointer(const void* ptr) noexcept {
+    return luaHashWord(static_cast<u64>(reinterpret_cast<uintptr_t>(ptr)));
+}
+
+} // namespace Lua
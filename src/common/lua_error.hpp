@@ -80,6 +80,42 @@ public:
     using LuaError::LuaError;
 };
 
+/** @brief 需要按出错操作数改写消息的运行时错误类型。 */
+enum class RuntimeErrorKind : u8 {
+    IndexNonTable,      // 索引非表值且没有 __index/__newindex
+    ArithmeticNonNumber // 算术操作数不能转换为数字且没有算术元方法
+};
+
+/**
+ * @brief 由 VM 基本操作抛出、尚未附带变量名的类型错误
+ *
+ * 操作码处理器按错误类型与操作数序号定位出错的寄存器，再交给诊断层生成
+ * "attempt to index local 'x' (a nil value)" 形式的消息，不再匹配消息文本。
+ * frame 记录抛出时的调用帧序号：只有同一帧的处理器才改写，元方法或 C 函数内部
+ * 抛出的同类错误原样传播。
+ */
+class OperandError : public RuntimeError {
+public:
+    OperandError(RuntimeErrorKind kind, u8 operand, usize frame, const char* message)
+        : RuntimeError(message), kind_(kind), operand_(operand), frame_(frame) {}
+
+    RuntimeErrorKind getKind() const noexcept {
+        return kind_;
+    }
+    /** @brief 出错的操作数：0 为被索引对象或左操作数，1 为右操作数 */
+    u8 getOperand() const noexcept {
+        return operand_;
+    }
+    usize getFrame() const noexcept {
+        return frame_;
+    }
+
+private:
+    RuntimeErrorKind kind_;
+    u8 operand_;
+    usize frame_;
+};
+
 /**
  * @brief 内存与资源耗尽错误
  */
@@ -229,6 +229,15 @@ template <typename... Args> constexpr void luaUnused(const Args&...) noexcept {}
 #define LUA_UNLIKELY(x) (x)
 #endif
 
+/**
+ * @brief 预取提示：提前把即将访问的缓存行载入缓存，不影响语义
+ */
+#if defined(__GNUC__) || defined(__clang__)
+#define LUA_PREFETCH(addr) __builtin_prefetch(addr)
+#else
+#define LUA_PREFETCH(addr) ((void)(addr))
+#endif
+
 /** @} */
 
 // =====================================================================
@@ -14,8 +14,10 @@
 #include <charconv>
 #include <cstdlib>
 #include <cmath>
+#include <cstring>
 #include <expected>
 #include <limits>
+#include <stdexcept>
 #include <system_error>
 
 namespace Lua {
@@ -62,14 +64,78 @@ checkedLuaInteger(LuaNumber value, IntegerConversion mode = IntegerConversion::T
     return static_cast<i32>(truncated);
 }
 
+namespace detail {
+
+/**
+ * @brief 与 strtod 一致的空白判定，避免依赖当前区域设置。
+ */
+[[nodiscard]] constexpr bool isLuaNumberSpace(char c) noexcept {
+    return c == ' ' || c == '\t' || c == '\n' || c == '\v' || c == '\f' || c == '\r';
+}
+
+} // namespace detail
+
+/**
+ * @brief 十进制快速路径：只接受 from_chars 与 strtod 结果必然一致的输入。
+ *
+ * @param text 待解析的文本，无需以 NUL 结尾。
+ * @param out 成功时接收解析结果。
+ * @return 命中快速路径时返回 true。
+ *
+ * 十六进制、溢出、嵌入 NUL 等其余形式返回 false，由调用方退回 strtod 慢路径裁决，
+ * 因此快速路径从不改变可接受输入的集合。
+ */
+[[nodiscard]] inline bool luaTryParseDecimalNumber(StrView text, LuaNumber& out) noexcept {
+    const char* first = text.data();
+    const char* last = first + text.size();
+    while (first != last && detail::isLuaNumberSpace(*first)) {
+        ++first;
+    }
+
+    bool negative = false;
+    if (first != last && (*first == '+' || *first == '-')) {
+        negative = *first == '-';
+        ++first;
+        /** @brief from_chars 本身接受 '-'；符号已消费后再出现符号必须交给 strtod 拒绝。 */
+        if (first == last || *first == '+' || *first == '-') {
+            return false;
+        }
+    }
+
+    LuaNumber value = 0.0;
+    const auto result = std::from_chars(first, last, value, std::chars_format::general);
+    /** @brief strtod 对次正规结果可能报告 ERANGE，交给慢路径保持原有判定。 */
+    if (result.ec != std::errc{} || std::fpclassify(value) == FP_SUBNORMAL) {
+        return false;
+    }
+
+    const char* end = result.ptr;
+    while (end != last && detail::isLuaNumberSpace(*end)) {
+        ++end;
+    }
+    if (end != last) {
+        return false;
+    }
+
+    out = negative ? -value : value;
+    return true;
+}
+
 /**
  * @brief 按 Lua 数字语法解析字符串。
  * @param text 待解析的文本。
  * @param out 用于接收解析结果。
  * @param allocator 可选的内存分配器。
  * @return 解析成功时返回 true，否则返回 false。
+ *
+ * 常见十进制文本直接由 from_chars 在原视图上解析，无需复制出以 NUL 结尾的副本；
+ * 其余形式保持原有 strtod 语义。
  */
 inline bool luaStringToNumber(StrView text, LuaNumber& out, LuaAllocator* allocator = nullptr) {
+    if (luaTryParseDecimalNumber(text, out)) {
+        return true;
+    }
+
     LuaString copy(text.begin(), text.end(), LuaStdAllocator<char>(allocator));
     const char* start = copy.c_str();
     char* end = nullptr;
@@ -92,15 +158,140 @@ inline bool luaStringToNumber(StrView text, LuaNumber& out, LuaAllocator* alloca
     return true;
 }
 
+/** @brief 小整数字符串缓存覆盖的最小值。 */
+inline constexpr i64 kSmallIntegerStringMin = -256;
+/** @brief 小整数字符串缓存覆盖的最大值。 */
+inline constexpr i64 kSmallIntegerStringMax = 65535;
+
+/**
+ * @brief 判断数值是否为小整数字符串缓存可覆盖的整数。
+ * @param value 待检查的数值。
+ * @param out 命中时接收整数值。
+ * @return 数值为区间内整数且不是 -0 时返回 true。
+ */
+[[nodiscard]] inline bool luaNumberToSmallInteger(LuaNumber value, i64& out) noexcept {
+    if (!(value >= static_cast<LuaNumber>(kSmallIntegerStringMin) &&
+          value <= static_cast<LuaNumber>(kSmallIntegerStringMax))) {
+        return false;
+    }
+    const i64 integer = static_cast<i64>(value);
+    if (static_cast<LuaNumber>(integer) != value || (integer == 0 && std::signbit(value))) {
+        return false;
+    }
+    out = integer;
+    return true;
+}
+
+namespace detail {
+
+/** @brief Lua 5.1 LUAI_NUMFMT（"%.14g"）的有效数字位数。 */
+inline constexpr i32 kLuaNumberPrecision = 14;
+
+/**
+ * @brief 将最短往返科学计数法改写为 "%.14g" 的定点形式。
+ *
+ * 最短表示的有效数字不超过 14 位时，按 14 位舍入必然得到相同数字再补零，
+ * 而 %g 会删除这些尾随零；因此只需按指数决定小数点位置。
+ */
+[[nodiscard]] inline StrView formatShortestAsGeneral(LuaNumber value, std::array<char, 64>& buffer) {
+    std::array<char, 32> scientific{};
+    const auto shortest = std::to_chars(scientific.data(), scientific.data() + scientific.size(), value,
+                                        std::chars_format::scientific);
+    if (shortest.ec != std::errc{}) {
+        return {};
+    }
+
+    const char* cursor = scientific.data();
+    const bool negative = *cursor == '-';
+    if (negative) {
+        ++cursor;
+    }
+
+    std::array<char, 20> digits{};
+    usize digitCount = 0;
+    while (cursor != shortest.ptr && *cursor != 'e') {
+        if (*cursor != '.') {
+            if (digitCount == digits.size()) {
+                return {};
+            }
+            digits[digitCount++] = *cursor;
+        }
+        ++cursor;
+    }
+    if (digitCount > static_cast<usize>(kLuaNumberPrecision) || cursor == shortest.ptr) {
+        return {};
+    }
+
+    i32 exponent = 0;
+    const auto parsedExponent = std::from_chars(cursor + (cursor[1] == '+' ? 2 : 1), shortest.ptr, exponent);
+    if (parsedExponent.ec != std::errc{}) {
+        return {};
+    }
+
+    if (exponent < -4 || exponent >= kLuaNumberPrecision) {
+        /** @brief %g 的科学计数法分支与 to_chars 一样去除尾随零并至少输出两位指数。 */
+        const usize length = static_cast<usize>(shortest.ptr - scientific.data());
+        std::memcpy(buffer.data(), scientific.data(), length);
+        return StrView(buffer.data(), length);
+    }
+
+    char* out = buffer.data();
+    if (negative) {
+        *out++ = '-';
+    }
+    if (exponent < 0) {
+        *out++ = '0';
+        *out++ = '.';
+        for (i32 i = -1; i > exponent; --i) {
+            *out++ = '0';
+        }
+        std::memcpy(out, digits.data(), digitCount);
+        out += digitCount;
+    } else {
+        const usize integerDigits = static_cast<usize>(exponent) + 1;
+        for (usize i = 0; i < integerDigits; ++i) {
+            *out++ = i < digitCount ? digits[i] : '0';
+        }
+        if (digitCount > integerDigits) {
+            *out++ = '.';
+            std::memcpy(out, digits.data() + integerDigits, digitCount - integerDigits);
+            out += digitCount - integerDigits;
+        }
+    }
+    return StrView(buffer.data(), static_cast<usize>(out - buffer.data()));
+}
+
+} // namespace detail
+
 /**
  * @brief 将 Lua 数值格式化到调用方提供的缓冲区中。
  * @param value 待格式化的数值。
  * @param buffer 输出缓冲区。
  * @return 指向格式化结果的字符串视图。
+ *
+ * 输出与 Lua 5.1 的 "%.14g" 逐字节一致。小于 1e14 的整数直接按整数格式化；其余正规数先取
+ * 最短往返表示，仅在其超过 14 位有效数字时才退回带精度的通用格式化。
  */
 inline StrView luaNumberToView(LuaNumber value, std::array<char, 64>& buffer) {
-    const auto result =
-        std::to_chars(buffer.data(), buffer.data() + buffer.size(), value, std::chars_format::general, 14);
+    constexpr LuaNumber kIntegerFormatLimit = 1e14;
+    if (value > -kIntegerFormatLimit && value < kIntegerFormatLimit) {
+        const i64 integer = static_cast<i64>(value);
+        if (static_cast<LuaNumber>(integer) == value && (integer != 0 || !std::signbit(value))) {
+            const auto result = std::to_chars(buffer.data(), buffer.data() + buffer.size(), integer);
+            return StrView(buffer.data(), static_cast<usize>(result.ptr - buffer.data()));
+        }
+    }
+
+    /** @brief 次正规数的最短表示可能远短于其精确值的 14 位舍入，因此只对正规数走最短路径。 */
+    if (std::isnormal(value)) {
+        const StrView shortest = detail::formatShortestAsGeneral(value, buffer);
+        if (!shortest.empty()) {
+            return shortest;
+        }
+    }
+
+    const auto result = std::to_chars(buffer.data(), buffer.data() + buffer.size(), value,
+                                      std::chars_format::general, detail::kLuaNumberPrecision);
 
     if (result.ec != std::errc{}) {
         throw std::runtime_error("failed to format Lua number");
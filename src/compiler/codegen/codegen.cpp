@@ -5,6 +5,7 @@
 
 #include "compiler/codegen/codegen.hpp"
 #include "compiler/codegen/gc_allocation_guard.hpp"
+#include "compiler/codegen/stack_map_builder.hpp"
 #include "core/gc_string.hpp"
 #include "core/string_pool.hpp"
 #include "core/value.hpp"
@@ -89,6 +90,7 @@ Proto* CodeGenerator::generateUnchecked(const Chunk& chunk, StrView sourceName)
     }
 
     attachDebugMetadata();
+    buildStackMap(*state_.proto);
 
     return protoGuard.commit();
 }
@@ -7,6 +7,7 @@
 #include "compiler/codegen/codegen.hpp"
 #include "compiler/codegen/codegen_types.hpp"
 #include "compiler/codegen/gc_allocation_guard.hpp"
+#include "compiler/codegen/stack_map_builder.hpp"
 
 namespace Lua {
 
@@ -108,6 +109,99 @@ bool stmtUsesDirectVararg(const Stmt& stmt) {
         stmt.variant);
 }
 
+/**
+ * @brief 函数体（含嵌套函数体）是否以名字 name 读写变量
+ *
+ * 只看名字，不解析作用域：被同名局部变量遮蔽的引用也算，结果偏保守。
+ */
+bool exprReferencesName(const Expr& expr, StrView name);
+bool stmtListReferencesName(const Vec<StmtPtr>& stmts, StrView name);
+
+bool exprListReferencesName(const Vec<ExprPtr>& exprs, StrView name) {
+    for (const auto& expr : exprs) {
+        if (expr && exprReferencesName(*expr, name)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool exprReferencesName(const Expr& expr, StrView name) {
+    auto refs = [name](const ExprPtr& e) { return e && exprReferencesName(*e, name); };
+    return std::visit(
+        ValueResultVisitor{
+            [](const VarargExpr&) { return false; },
+            [](const NilExpr&) { return false; },
+            [](const BoolExpr&) { return false; },
+            [](const NumberExpr&) { return false; },
+            [](const StringExpr&) { return false; },
+            [name](const NameExpr& e) { return e.name == name; },
+            [name](const FunctionExpr& e) { return stmtListReferencesName(e.body, name); },
+            [&](const BinaryExpr& e) { return refs(e.left) || refs(e.right); },
+            [&](const UnaryExpr& e) { return refs(e.operand); },
+            [&](const TableExpr& e) {
+                for (const TableField& field : e.fields) {
+                    if (refs(field.key) || refs(field.value)) {
+                        return true;
+                    }
+                }
+                return false;
+            },
+            [&](const CallExpr& e) { return refs(e.func) || exprListReferencesName(e.args, name); },
+            [&](const IndexExpr& e) { return refs(e.table) || refs(e.index); },
+            [&](const MemberExpr& e) { return refs(e.table); },
+            [&](const ParenExpr& e) { return refs(e.expression); },
+        },
+        expr.variant);
+}
+
+bool stmtReferencesName(const Stmt& stmt, StrView name) {
+    auto refs = [name](const ExprPtr& e) { return e && exprReferencesName(*e, name); };
+    return std::visit(
+        ValueResultVisitor{
+            [](const EmptyStmt&) { return false; },
+            [](const BreakStmt&) { return false; },
+            [name](const FunctionStmt& s) {
+                const StrView root = s.tablePath.empty() ? StrView(s.name) : StrView(s.tablePath.front());
+                const bool assignsName = !s.isLocal && root == name;
+                return assignsName || stmtListReferencesName(s.body, name);
+            },
+            [name](const AssignStmt& s) {
+                return exprListReferencesName(s.targets, name) || exprListReferencesName(s.values, name);
+            },
+            [name](const LocalStmt& s) { return exprListReferencesName(s.values, name); },
+            [&](const CallStmt& s) { return refs(s.call); },
+            [&](const IfStmt& s) {
+                for (const IfStmt::Branch& branch : s.branches) {
+                    if (refs(branch.condition) || stmtListReferencesName(branch.body, name)) {
+                        return true;
+                    }
+                }
+                return stmtListReferencesName(s.elseBranch, name);
+            },
+            [&](const WhileStmt& s) { return refs(s.condition) || stmtListReferencesName(s.body, name); },
+            [&](const RepeatStmt& s) { return stmtListReferencesName(s.body, name) || refs(s.condition); },
+            [&](const ForNumStmt& s) {
+                return refs(s.init) || refs(s.limit) || refs(s.step) || stmtListReferencesName(s.body, name);
+            },
+            [&](const ForInStmt& s) {
+                return exprListReferencesName(s.iterators, name) || stmtListReferencesName(s.body, name);
+            },
+            [name](const ReturnStmt& s) { return exprListReferencesName(s.values, name); },
+            [name](const DoStmt& s) { return stmtListReferencesName(s.body, name); },
+        },
+        stmt.variant);
+}
+
+bool stmtListReferencesName(const Vec<StmtPtr>& stmts, StrView name) {
+    for (const auto& stmt : stmts) {
+        if (stmt && stmtReferencesName(*stmt, name)) {
+            return true;
+        }
+    }
+    return false;
+}
+
 } // namespace
 
 CompiledFunction FunctionCompiler::compile(const Vec<Str>& params, bool isVararg, const Vec<StmtPtr>& body,
@@ -121,7 +215,11 @@ CompiledFunction FunctionCompiler::compile(const Vec<Str>& params, bool isVararg
     if (isVararg) {
         varargFlags = VARARG_ISVARARG;
         if (needsCompatArg) {
-            varargFlags |= VARARG_HASARG | VARARG_NEEDSARG;
+            // 局部变量 arg 照旧声明；兼容表只在函数体确实引用 arg 时于调用时建立，否则该寄存器保持 nil
+            varargFlags |= VARARG_HASARG;
+            if (stmtListReferencesName(body, "arg")) {
+                varargFlags |= VARARG_NEEDSARG;
+            }
         }
     }
 
@@ -169,6 +267,7 @@ CompiledFunction FunctionCompiler::compile(const Vec<Str>& params, bool isVararg
     if (static_cast<i32>(newProto->getMaxStackSize()) < child.state_.registers.current()) {
         newProto->setMaxStackSize(static_cast<u8>(child.state_.registers.current()));
     }
+    buildStackMap(*newProto);
 
     CompiledFunction compiled;
     compiled.upvalues = child.scopes_.upvalues();
@@ -0,0 +1,317 @@
+/**
+ * @file stack_map_builder.cpp
+ * @brief 安全点寄存器存活分析的实现
+ */
+
+#include "compiler/codegen/stack_map_builder.hpp"
+
+#include "compiler/opcode.hpp"
+#include "core/function.hpp"
+
+#include <bitset>
+#include <vector>
+
+namespace Lua {
+
+namespace {
+
+constexpr usize kRegisterCount = static_cast<usize>(MAXARG_A) + 1;
+using RegisterSet = std::bitset<kRegisterCount>;
+
+/** @brief 单条指令对寄存器的读写与控制流后继。 */
+struct InstructionEffect {
+    RegisterSet uses;
+    /** @brief 执行后必定不再持有旧值的寄存器，存活区间在此终止 */
+    RegisterSet kills;
+    /** @brief 本指令可能写入的寄存器；安全点处它们已经或即将持有新值 */
+    RegisterSet writes;
+    i32 successors[2] = {-1, -1};
+    /** @brief 伪指令与扩展参数字不是可执行指令 */
+    bool executable = false;
+    bool safepoint = false;
+};
+
+void addRegister(RegisterSet& set, i32 reg) {
+    if (reg >= 0 && static_cast<usize>(reg) < kRegisterCount) {
+        set.set(static_cast<usize>(reg));
+    }
+}
+
+void addRK(RegisterSet& set, i32 operand) {
+    if (!ISK(operand)) {
+        addRegister(set, operand);
+    }
+}
+
+RegisterSet registerRange(i32 first, i32 count) {
+    RegisterSet set;
+    for (i32 reg = first; reg < first + count; ++reg) {
+        addRegister(set, reg);
+    }
+    return set;
+}
+
+RegisterSet registersFrom(i32 first) {
+    if (first <= 0) {
+        return ~RegisterSet{};
+    }
+    if (static_cast<usize>(first) >= kRegisterCount) {
+        return {};
+    }
+    return ~RegisterSet{} << static_cast<usize>(first);
+}
+
+/**
+ * @brief 解码 pc 处的指令，返回它占用的指令字数
+ */
+usize describeInstruction(const Proto& proto, std::span<const Instruction> code, usize pc,
+                          InstructionEffect& effect) {
+    const Instruction inst = code[pc];
+    const i32 a = GETARG_A(inst);
+    const i32 b = GETARG_B(inst);
+    const i32 c = GETARG_C(inst);
+    const i32 next = static_cast<i32>(pc) + 1;
+    usize width = 1;
+
+    auto define = [&effect](const RegisterSet& registers) {
+        effect.kills |= registers;
+        effect.writes |= registers;
+    };
+
+    effect.executable = true;
+    effect.successors[0] = next;
+
+    switch (GET_OPCODE(inst)) {
+    case OpCode::MOVE:
+        addRegister(effect.uses, b);
+        define(registerRange(a, 1));
+        break;
+    case OpCode::LOADK:
+    case OpCode::GETUPVAL:
+        define(registerRange(a, 1));
+        break;
+    case OpCode::LOADBOOL:
+        define(registerRange(a, 1));
+        if (c != 0) {
+            effect.successors[0] = next + 1;
+        }
+        break;
+    case OpCode::LOADNIL:
+        define(registerRange(a, b - a + 1));
+        break;
+    case OpCode::GETGLOBAL:
+    case OpCode::NEWTABLE:
+        define(registerRange(a, 1));
+        effect.safepoint = true;
+        break;
+    case OpCode::GETTABLE:
+        addRegister(effect.uses, b);
+        addRK(effect.uses, c);
+        define(registerRange(a, 1));
+        effect.safepoint = true;
+        break;
+    case OpCode::SETGLOBAL:
+        addRegister(effect.uses, a);
+        effect.safepoint = true;
+        break;
+    case OpCode::SETUPVAL:
+        addRegister(effect.uses, a);
+        break;
+    case OpCode::SETTABLE:
+        addRegister(effect.uses, a);
+        addRK(effect.uses, b);
+        addRK(effect.uses, c);
+        effect.safepoint = true;
+        break;
+    case OpCode::SELF:
+        addRegister(effect.uses, b);
+        addRK(effect.uses, c);
+        define(registerRange(a, 2));
+        effect.safepoint = true;
+        break;
+    case OpCode::ADD:
+    case OpCode::SUB:
+    case OpCode::MUL:
+    case OpCode::DIV:
+    case OpCode::MOD:
+    case OpCode::POW:
+        addRK(effect.uses, b);
+        addRK(effect.uses, c);
+        define(registerRange(a, 1));
+        effect.safepoint = true;
+        break;
+    case OpCode::UNM:
+    case OpCode::LEN:
+        addRegister(effect.uses, b);
+        define(registerRange(a, 1));
+        effect.safepoint = true;
+        break;
+    case OpCode::NOT:
+        addRegister(effect.uses, b);
+        define(registerRange(a, 1));
+        break;
+    case OpCode::CONCAT:
+        effect.uses |= registerRange(b, c - b + 1);
+        define(registerRange(a, 1));
+        effect.safepoint = true;
+        break;
+    case OpCode::JMP:
+        effect.successors[0] = next + GETARG_sBx(inst);
+        break;
+    case OpCode::EQ:
+    case OpCode::LT:
+    case OpCode::LE:
+        addRK(effect.uses, b);
+        addRK(effect.uses, c);
+        effect.successors[1] = next + 1;
+        effect.safepoint = true;
+        break;
+    case OpCode::TEST:
+        addRegister(effect.uses, a);
+        effect.successors[1] = next + 1;
+        break;
+    case OpCode::TESTSET:
+        addRegister(effect.uses, b);
+        addRegister(effect.writes, a);
+        effect.successors[1] = next + 1;
+        break;
+    case OpCode::CALL:
+        // 被调用者占用 R(A) 以上的寄存器，返回后结果以外的部分都是废弃值
+        effect.uses |= b != 0 ? registerRange(a, b) : registersFrom(a);
+        effect.kills |= registersFrom(a);
+        effect.writes |= c != 0 ? registerRange(a, c - 1) : registersFrom(a);
+        effect.safepoint = true;
+        break;
+    case OpCode::TAILCALL:
+        effect.uses |= b != 0 ? registerRange(a, b) : registersFrom(a);
+        effect.kills |= registersFrom(a);
+        effect.writes |= registersFrom(a);
+        effect.safepoint = true;
+        break;
+    case OpCode::RETURN:
+        effect.uses |= b != 0 ? registerRange(a, b - 1) : registersFrom(a);
+        effect.successors[0] = -1;
+        break;
+    case OpCode::FORLOOP:
+        effect.uses |= registerRange(a, 3);
+        addRegister(effect.writes, a);
+        addRegister(effect.writes, a + 3);
+        effect.successors[1] = next + GETARG_sBx(inst);
+        break;
+    case OpCode::FORPREP:
+        effect.uses |= registerRange(a, 3);
+        addRegister(effect.writes, a);
+        effect.successors[0] = next + GETARG_sBx(inst);
+        break;
+    case OpCode::TFORLOOP:
+        effect.uses |= registerRange(a, 3);
+        effect.kills |= registersFrom(a + 3);
+        effect.writes |= registersFrom(a + 3);
+        addRegister(effect.writes, a + 2);
+        effect.successors[1] = next + 1;
+        effect.safepoint = true;
+        break;
+    case OpCode::SETLIST:
+        effect.uses |= b != 0 ? registerRange(a, b + 1) : registersFrom(a);
+        if (c == 0) {
+            width = 2;
+            effect.successors[0] = next + 1;
+        }
+        effect.safepoint = true;
+        break;
+    case OpCode::CLOSE:
+        break;
+    case OpCode::CLOSURE: {
+        const i32 bx = GETARG_Bx(inst);
+        usize upvalues = 0;
+        if (bx >= 0 && static_cast<usize>(bx) < proto.getSubProtoCount()) {
+            upvalues = proto.getSubProto(static_cast<usize>(bx))->getNumUpvalues();
+        }
+        for (usize j = 1; j <= upvalues && pc + j < code.size(); ++j) {
+            if (GET_OPCODE(code[pc + j]) == OpCode::MOVE) {
+                addRegister(effect.uses, GETARG_B(code[pc + j]));
+            }
+        }
+        width += upvalues;
+        effect.successors[0] = static_cast<i32>(pc + width);
+        define(registerRange(a, 1));
+        effect.safepoint = true;
+        break;
+    }
+    case OpCode::VARARG:
+        define(b != 0 ? registerRange(a, b - 1) : registersFrom(a));
+        break;
+    }
+
+    return width;
+}
+
+} // namespace
+
+void buildStackMap(Proto& proto) {
+    const auto code = proto.getInstructionSpan();
+    const usize count = code.size();
+
+    std::vector<InstructionEffect> effects(count);
+    for (usize pc = 0; pc < count;) {
+        pc += describeInstruction(proto, code, pc, effects[pc]);
+    }
+
+    /** @brief 后向迭代到不动点；循环体通常两三轮即稳定。 */
+    std::vector<RegisterSet> liveIn(count);
+    bool changed = true;
+    while (changed) {
+        changed = false;
+        for (usize pc = count; pc-- > 0;) {
+            const InstructionEffect& effect = effects[pc];
+            if (!effect.executable) {
+                continue;
+            }
+
+            RegisterSet liveOut;
+            for (i32 successor : effect.successors) {
+                if (successor >= 0 && static_cast<usize>(successor) < count) {
+                    liveOut |= liveIn[static_cast<usize>(successor)];
+                }
+            }
+
+            const RegisterSet in = effect.uses | (liveOut & ~effect.kills);
+            if (in != liveIn[pc]) {
+                liveIn[pc] = in;
+                changed = true;
+            }
+        }
+    }
+
+    const usize registers = proto.getMaxStackSize();
+    const usize stride = registers == 0 ? 1 : (registers + 63) / 64;
+    const RegisterSet window = ~registersFrom(static_cast<i32>(registers));
+    const RegisterSet lowWord(~0ULL);
+
+    std::vector<u32> pcs;
+    std::vector<u64> bits;
+    for (usize pc = 0; pc < count; ++pc) {
+        const InstructionEffect& effect = effects[pc];
+        if (!effect.executable || !effect.safepoint) {
+            continue;
+        }
+
+        RegisterSet scanned = liveIn[pc] | effect.writes;
+        for (usize i = 0; i < proto.getLocVarCount(); ++i) {
+            const LocVar& local = proto.getLocVar(i);
+            if (local.startpc <= static_cast<i32>(pc) && static_cast<i32>(pc) < local.endpc) {
+                addRegister(scanned, local.reg);
+            }
+        }
+        scanned &= window;
+
+        pcs.push_back(static_cast<u32>(pc));
+        for (usize word = 0; word < stride; ++word) {
+            bits.push_back(((scanned >> (word * 64)) & lowWord).to_ullong());
+        }
+    }
+
+    proto.setStackMap(pcs, bits, static_cast<u8>(stride));
+}
+
+} // namespace Lua
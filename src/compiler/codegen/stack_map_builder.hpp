@@ -0,0 +1,29 @@
+#pragma once
+
+/**
+ * @file stack_map_builder.hpp
+ * @brief 为函数原型生成垃圾回收安全点的寄存器存活映射
+ *
+ * 设计说明：
+ * 在字节码与局部变量调试信息全部生成后，对指令做一次后向存活分析。每个可能调用函数或分配
+ * 对象的指令（调用、元方法可达的表与算术操作、NEWTABLE、CLOSURE、CONCAT、SETLIST）都是安全点，
+ * 其位图为：进入该指令时存活的寄存器、该指令会写入的寄存器，以及作用域内的具名局部变量。
+ * 具名局部变量即使此后不再读取也保留，使 debug.getlocal 观察到的值不受回收影响。
+ *
+ * 多返回值的生产者（CALL C=0、VARARG B=0）视为覆盖 R(A) 以上全部寄存器，
+ * 消费者（CALL/TAILCALL/RETURN/SETLIST 的 B=0）视为读取 R(A) 以上全部寄存器。
+ * CLOSURE 之后的上值伪指令与 SETLIST 的扩展 C 字不是可执行指令，只计入所属指令的读取。
+ */
+
+namespace Lua {
+
+class Proto;
+
+/**
+ * @brief 计算原型的栈映射并写入 Proto::setStackMap
+ *
+ * 子原型须已生成完毕：CLOSURE 的上值伪指令数量取自子原型。
+ */
+void buildStackMap(Proto& proto);
+
+} // namespace Lua
@@ -8,6 +8,7 @@
 #include "core/table.hpp"
 #include "core/upvalue.hpp"
 #include "gc/garbage_collector.hpp"
+#include <algorithm>
 #include <stdexcept>
 #include <iostream>
 
@@ -22,10 +23,11 @@ Proto::Proto() : Proto(nullptr) {}
 Proto::Proto(LuaAllocator* allocator)
     : GCObject(GCObjectType::Proto), constants_(allocator),
       constantMap_(0, ConstantKeyHash{}, std::equal_to<ConstantKey>{}, ConstantMapAllocator(allocator)),
-      code_(allocator), subProtos_(allocator), lineInfo_(allocator), locvars_(allocator), upvalueNames_(allocator),
+      code_(allocator), subProtos_(allocator), lineInfo_(allocator), locvars_(allocator), stackMapPcs_(allocator),
+      stackMapBits_(allocator), upvalueNames_(allocator),
       source_(nullptr), debugName_(nullptr), linedefined_(0), lastlinedefined_(0), gclist_(nullptr), nups_(0),
       numParams_(0), isVararg_(0),
-      maxStackSize_(0) {}
+      maxStackSize_(0), stackMapStride_(0) {}
 
 Proto::~Proto() {
     // 常量表中的GC对象由GC系统管理，这里不需要手动删除
@@ -246,6 +248,41 @@ CharPtr Proto::getLocalName(i32 localNumber, i32 pc) const {
     return locvar->varname ? locvar->varname->c_str() : nullptr;
 }
 
+// =====================================================================
+// 栈映射
+// =====================================================================
+
+void Proto::setStackMap(std::span<const u32> pcs, std::span<const u64> bits, u8 stride) {
+    if (stride == 0 || bits.size() != pcs.size() * stride) {
+        throw std::invalid_argument("stack map bitmap size mismatch");
+    }
+
+    stackMapPcs_.clear();
+    stackMapBits_.clear();
+    stackMapPcs_.reserve(pcs.size());
+    stackMapBits_.reserve(bits.size());
+    for (u32 pc : pcs) {
+        stackMapPcs_.push_back(pc);
+    }
+    for (u64 word : bits) {
+        stackMapBits_.push_back(word);
+    }
+    stackMapStride_ = stride;
+    if (GarbageCollector* gc = getOwnerCollector()) {
+        gc->accountObjectSizeChange(this);
+    }
+}
+
+const u64* Proto::findStackMap(usize pc) const noexcept {
+    const u32* begin = stackMapPcs_.data();
+    const u32* end = begin + stackMapPcs_.size();
+    const u32* found = std::lower_bound(begin, end, pc, [](u32 entry, usize target) { return entry < target; });
+    if (found == end || *found != pc) {
+        return nullptr;
+    }
+    return stackMapBits_.data() + static_cast<usize>(found - begin) * stackMapStride_;
+}
+
 // =====================================================================
 // 上值名称管理
 // =====================================================================
@@ -298,55 +335,58 @@ usize Proto::getSize() const {
     // 基础大小 + 所有动态数组的容量
     return sizeof(Proto) + constants_.capacity() * sizeof(Value) + code_.capacity() * sizeof(Instruction) +
            lineInfo_.capacity() * sizeof(i32) + subProtos_.capacity() * sizeof(Proto*) +
-           locvars_.capacity() * sizeof(LocVar) + upvalueNames_.capacity() * sizeof(GCString*);
+           locvars_.capacity() * sizeof(LocVar) + stackMapPcs_.capacity() * sizeof(u32) +
+           stackMapBits_.capacity() * sizeof(u64) + upvalueNames_.capacity() * sizeof(GCString*);
 }
 
 // =====================================================================
 // Function类实现
 // =====================================================================
 
-Function::Function(CFunction func) : Function(nullptr, func) {}
+Function::Function(bool isC, CFunction cFunction, ApiCFunction apiCFunction, Proto* proto,
+                   usize inlineCapacity) noexcept
+    : GCObject(GCObjectType::Function), isC_(isC), nupvalues_(0), upvalueCapacity_(static_cast<u8>(inlineCapacity)),
+      inlineUpvalueCapacity_(static_cast<u8>(inlineCapacity)), gclist_(nullptr), env_(nullptr), cFunction_(cFunction),
+      apiCFunction_(apiCFunction), proto_(proto), upvalues_(inlineUpvalues()) {
+    std::fill_n(upvalues_, inlineCapacity, nullptr);
+}
+
+Function::Function(CFunction func) : Function(GCInlineStorage{}, func) {}
 
-Function::Function(LuaAllocator* allocator, CFunction func)
-    : GCObject(GCObjectType::Function), isC_(true), nupvalues_(0) // 初始化上值数量为0
-      ,
-      gclist_(nullptr) // 初始化GC链表指针为nullptr
-      ,
-      env_(nullptr) // 初始化环境表为nullptr
-      ,
-      cFunction_(func), apiCFunction_(nullptr), proto_(nullptr), upvalues_(LuaStdAllocator<Upvalue*>(allocator)) {
+Function::Function(GCInlineStorage, CFunction func, usize nupvalues)
+    : Function(true, func, nullptr, nullptr, checkedUpvalueCapacity(nupvalues)) {
     if (func == nullptr) {
         throw std::invalid_argument("C function pointer cannot be null");
     }
 }
 
-Function::Function(ApiCFunction func) : Function(nullptr, func) {}
+Function::Function(ApiCFunction func) : Function(GCInlineStorage{}, func) {}
 
-Function::Function(LuaAllocator* allocator, ApiCFunction func)
-    : GCObject(GCObjectType::Function), isC_(true), nupvalues_(0), gclist_(nullptr), env_(nullptr), cFunction_(nullptr),
-      apiCFunction_(func), proto_(nullptr), upvalues_(LuaStdAllocator<Upvalue*>(allocator)) {
+Function::Function(GCInlineStorage, ApiCFunction func, usize nupvalues)
+    : Function(true, nullptr, func, nullptr, checkedUpvalueCapacity(nupvalues)) {
     if (func == nullptr) {
         throw std::invalid_argument("Lua C API function pointer cannot be null");
     }
 }
 
-Function::Function(Proto* proto) : Function(nullptr, proto) {}
+Function::Function(Proto* proto) : Function(false, nullptr, nullptr, proto, 0) {
+    if (proto == nullptr) {
+        throw std::invalid_argument("Proto pointer cannot be null");
+    }
+}
 
-Function::Function(LuaAllocator* allocator, Proto* proto)
-    : GCObject(GCObjectType::Function), isC_(false), nupvalues_(0) // 初始化上值数量为0
-      ,
-      gclist_(nullptr) // 初始化GC链表指针为nullptr
-      ,
-      env_(nullptr) // 初始化环境表为nullptr
-      ,
-      cFunction_(nullptr), apiCFunction_(nullptr), proto_(proto), upvalues_(LuaStdAllocator<Upvalue*>(allocator)) {
+Function::Function(GCInlineStorage, Proto* proto)
+    : Function(false, nullptr, nullptr, proto, proto ? proto->getNumUpvalues() : 0) {
     if (proto == nullptr) {
         throw std::invalid_argument("Proto pointer cannot be null");
     }
 }
 
 Function::~Function() {
-    // Proto和Upvalue由GC系统管理，这里不需要手动删除
+    // Proto和Upvalue由GC系统管理，这里只释放溢出的上值数组
+    if (ownsUpvalueBlock()) {
+        releaseUpvalueBlock();
+    }
 }
 
 i32 Function::callCFunction(LuaState* state) const {
@@ -364,14 +404,14 @@ i32 Function::callCFunction(LuaState* state) const {
 // =====================================================================
 
 Upvalue* Function::getUpvalue(usize index) const {
-    if (index >= upvalues_.size()) {
+    if (index >= nupvalues_) {
         return nullptr;
     }
     return upvalues_[index];
 }
 
 void Function::setUpvalue(usize index, Upvalue* upvalue) {
-    if (index >= upvalues_.size()) {
+    if (index >= nupvalues_) {
         throw std::out_of_range("Upvalue index out of range");
     }
     if (GarbageCollector* gc = getOwnerCollector()) {
@@ -381,15 +421,35 @@ void Function::setUpvalue(usize index, Upvalue* upvalue) {
 }
 
 void Function::addUpvalue(Upvalue* upvalue) {
+    if (nupvalues_ == upvalueCapacity_) {
+        growUpvalues();
+    }
     if (GarbageCollector* gc = getOwnerCollector()) {
         gc->writeBarrier(this, upvalue);
     }
-    upvalues_.push_back(upvalue);
+    upvalues_[nupvalues_++] = upvalue;
+}
+
+void Function::releaseUpvalueBlock() noexcept {
+    LuaStdAllocator<Upvalue*>(getBlockAllocator()).deallocate(upvalues_, upvalueCapacity_);
+}
+
+void Function::growUpvalues() {
+    if (upvalueCapacity_ == MaxUpvalues) {
+        throw std::length_error("too many closure upvalues");
+    }
+    const usize capacity = std::min<usize>(MaxUpvalues, std::max<usize>(4, usize{upvalueCapacity_} * 2));
+    Upvalue** block = LuaStdAllocator<Upvalue*>(getBlockAllocator()).allocate(capacity);
+    std::copy_n(upvalues_, nupvalues_, block);
+    std::fill(block + nupvalues_, block + capacity, nullptr);
+    if (ownsUpvalueBlock()) {
+        releaseUpvalueBlock();
+    }
+    upvalues_ = block;
+    upvalueCapacity_ = static_cast<u8>(capacity);
     if (GarbageCollector* gc = getOwnerCollector()) {
         gc->accountObjectSizeChange(this);
     }
-    // 同步nupvalues_字段（ClosureHeader字段）
-    nupvalues_ = static_cast<u8>(upvalues_.size());
 }
 
 void Function::setEnv(Table* env) {
@@ -411,7 +471,7 @@ void Function::mark(GarbageCollector& gc) {
     }
 
     // 标记所有upvalue
-    for (Upvalue* uv : upvalues_) {
+    for (Upvalue* uv : std::span(upvalues_, nupvalues_)) {
         gc.markObject(uv);
     }
 
@@ -420,8 +480,12 @@ void Function::mark(GarbageCollector& gc) {
 }
 
 usize Function::getSize() const {
-    // 基础大小 + upvalue数组大小
-    return sizeof(Function) + upvalues_.capacity() * sizeof(Upvalue*);
+    // 基础大小 + 内联上值槽 + 溢出的上值数组
+    usize size = sizeof(Function) + inlineUpvalueCapacity_ * sizeof(Upvalue*);
+    if (ownsUpvalueBlock()) {
+        size += upvalueCapacity_ * sizeof(Upvalue*);
+    }
+    return size;
 }
 
 } // namespace Lua
@@ -22,6 +22,7 @@
 #ifndef LUA_CORE_FUNCTION_HPP
 #define LUA_CORE_FUNCTION_HPP
 
+#include "common/hash.hpp"
 #include "common/types.hpp"
 #include "core/gc_object.hpp"
 #include "core/gc_string.hpp"
@@ -32,6 +33,7 @@
 #include <variant>
 #include <functional>
 #include <span>
+#include <stdexcept>
 
 struct lua_State;
 
@@ -101,7 +103,7 @@ struct ConstantKeyHash {
                 } else if constexpr (std::is_same_v<T, bool>) {
                     return std::hash<bool>{}(val);
                 } else if constexpr (std::is_same_v<T, f64>) {
-                    return std::hash<f64>{}(val);
+                    return static_cast<usize>(luaHashNumber(val));
                 } else if constexpr (std::is_same_v<T, GCString*>) {
                     // 字符串使用GCString的预计算哈希值
                     return val ? val->getHash() : 0;
@@ -241,7 +243,7 @@ public:
     /**
      * @brief 析构函数
      */
-    ~Proto() override;
+    ~Proto();
 
     // =====================================================================
     // 基本属性访问
@@ -534,6 +536,32 @@ public:
      */
     const LocVar* getLocalVarInfo(i32 localNumber, i32 pc) const;
 
+    // =====================================================================
+    // 栈映射（垃圾回收安全点）
+    // =====================================================================
+
+    /**
+     * @brief 设置安全点寄存器存活映射
+     * @param pcs 升序排列的安全点指令索引
+     * @param bits 每个安全点 stride 个字的寄存器位图，位 r 表示 R(r) 需要扫描
+     * @param stride 每个位图的字数
+     */
+    void setStackMap(std::span<const u32> pcs, std::span<const u64> bits, u8 stride);
+
+    /**
+     * @brief 查找安全点的寄存器位图
+     * @param pc 当前指令索引
+     * @return 位图首字；pc 不是安全点或原型没有栈映射时返回 nullptr
+     */
+    const u64* findStackMap(usize pc) const noexcept;
+
+    /**
+     * @brief 获取栈映射中的安全点数量
+     */
+    usize getStackMapSize() const noexcept {
+        return stackMapPcs_.size();
+    }
+
     // =====================================================================
     // 上值名称管理（调试支持）
     // =====================================================================
@@ -640,8 +668,8 @@ public:
     // GCObject接口实现
     // =====================================================================
 
-    void mark(GarbageCollector& gc) override;
-    usize getSize() const override;
+    void mark(GarbageCollector& gc);
+    usize getSize() const;
 
 private:
     // =====================================================================
@@ -683,6 +711,16 @@ private:
      */
     LuaReallocVector<LocVar> locvars_;
 
+    /**
+     * @brief 栈映射安全点：升序指令索引
+     */
+    LuaReallocVector<u32> stackMapPcs_;
+
+    /**
+     * @brief 栈映射位图：每个安全点 stackMapStride_ 个字
+     */
+    LuaReallocVector<u64> stackMapBits_;
+
     /**
      * @brief 上值名称数组：闭包变量的名称（用于调试）
      */
@@ -739,6 +777,11 @@ private:
      * @brief 最大栈大小：函数执行时需要的最大栈空间
      */
     u8 maxStackSize_;
+
+    /**
+     * @brief 栈映射中每个位图的字数
+     */
+    u8 stackMapStride_;
 };
 
 /**
@@ -769,23 +812,48 @@ public:
      * @param func C函数指针
      */
     explicit Function(CFunction func);
-    Function(LuaAllocator* allocator, CFunction func);
 
     /** @brief 公开 C API 回调保留其精确的 lua_State* 签名。 */
     explicit Function(ApiCFunction func);
-    Function(LuaAllocator* allocator, ApiCFunction func);
 
     /**
      * @brief 创建Lua函数闭包
      * @param proto 函数原型
      */
     explicit Function(Proto* proto);
-    Function(LuaAllocator* allocator, Proto* proto);
+
+    /**
+     * @brief 构造函数 - 上值数组存放在紧随对象头的尾随载荷中
+     *
+     * 调用方必须提供至少 getInlineAllocationSize(...) 字节的内存块；
+     * 由 GarbageCollector::create<Function>() 自动选择。Lua 闭包按原型的上值数量预留槽位，
+     * C 闭包按 nupvalues 预留；超出预留数量的 addUpvalue 溢出到单独堆块。
+     */
+    Function(GCInlineStorage, CFunction func, usize nupvalues = 0);
+    Function(GCInlineStorage, ApiCFunction func, usize nupvalues = 0);
+    Function(GCInlineStorage, Proto* proto);
+
+    /**
+     * @brief 计算单次分配所需的总字节数（对象头 + 上值指针数组）
+     * @return 内存块字节数
+     */
+    [[nodiscard]] static usize getInlineAllocationSize(CFunction /*func*/, usize nupvalues = 0) {
+        return sizeof(Function) + checkedUpvalueCapacity(nupvalues) * sizeof(Upvalue*);
+    }
+    [[nodiscard]] static usize getInlineAllocationSize(ApiCFunction /*func*/, usize nupvalues = 0) {
+        return sizeof(Function) + checkedUpvalueCapacity(nupvalues) * sizeof(Upvalue*);
+    }
+    [[nodiscard]] static usize getInlineAllocationSize(const Proto* proto) noexcept {
+        return sizeof(Function) + (proto ? proto->getNumUpvalues() : 0) * sizeof(Upvalue*);
+    }
 
     /**
      * @brief 析构函数
      */
-    ~Function() override;
+    ~Function();
+
+    /** @brief 单个闭包最多持有的上值数量（与 nupvalues 字段宽度一致） */
+    static constexpr usize MaxUpvalues = 255;
 
     // =====================================================================
     // 类型检查
@@ -865,7 +933,7 @@ public:
      * 注意：C函数也可以有upvalue，但当前实现仅支持Lua函数
      */
     usize getUpvalueCount() const noexcept {
-        return upvalues_.size();
+        return nupvalues_;
     }
 
     /**
@@ -875,6 +943,16 @@ public:
      */
     Upvalue* getUpvalue(usize index) const;
 
+    /**
+     * @brief 不检查下标的上值访问，供 GETUPVAL/SETUPVAL 使用
+     *
+     * 调用方保证 index < getUpvalueCount()：编译器按原型上值数量生成下标，
+     * 二进制块由字节码校验器检查。
+     */
+    Upvalue* getUpvalueUnchecked(usize index) const noexcept {
+        return upvalues_[index];
+    }
+
     /**
      * @brief 设置指定索引的上值
      * @param index 上值索引（从 0 开始）
@@ -965,11 +1043,40 @@ public:
     // =====================================================================
 
     /** @brief 标记闭包引用的垃圾回收对象。 */
-    void mark(GarbageCollector& gc) override;
+    void mark(GarbageCollector& gc);
     /** @brief 获取闭包对象占用的字节数。 */
-    usize getSize() const override;
+    usize getSize() const;
+
+    /** @brief 对象头之后内联预留的上值槽数；决定托管内存块大小。 */
+    usize getInlineUpvalueCapacity() const noexcept {
+        return inlineUpvalueCapacity_;
+    }
 
 private:
+    /** @brief 公共初始化：上值数组指向内联槽位并清零。 */
+    Function(bool isC, CFunction cFunction, ApiCFunction apiCFunction, Proto* proto, usize inlineCapacity) noexcept;
+
+    static usize checkedUpvalueCapacity(usize nupvalues) {
+        if (nupvalues > MaxUpvalues) {
+            throw std::length_error("too many closure upvalues");
+        }
+        return nupvalues;
+    }
+
+    [[nodiscard]] Upvalue** inlineUpvalues() noexcept {
+        return reinterpret_cast<Upvalue**>(this + 1);
+    }
+
+    /** @brief 上值数组已溢出到单独堆块（含非托管构造的闭包）。 */
+    bool ownsUpvalueBlock() const noexcept {
+        return upvalueCapacity_ > inlineUpvalueCapacity_;
+    }
+
+    void growUpvalues();
+
+    /** @brief 把溢出的上值数组交回分配它的分配器（见 getBlockAllocator()）。 */
+    void releaseUpvalueBlock() noexcept;
+
     // =====================================================================
     // ClosureHeader 字段
     // =====================================================================
@@ -985,6 +1092,16 @@ private:
      */
     u8 nupvalues_;
 
+    /**
+     * @brief 上值数组容量：内联槽数，溢出到单独堆块后为该堆块的槽数
+     */
+    u8 upvalueCapacity_;
+
+    /**
+     * @brief 对象头之后内联预留的上值槽数
+     */
+    u8 inlineUpvalueCapacity_;
+
     /**
      * @brief GC链表指针
      * 用于增量GC和分代GC的灰色对象链表遍历
@@ -1022,12 +1139,11 @@ private:
     /**
      * @brief 上值数组（闭包捕获的外部变量）
      * 注意：
-     * - 对于C函数（CClosure），应该直接存储Value（对应TValue upvalue[1]）
-     * - 对于Lua函数（LClosure），存储Upvalue*指针（对应UpVal *upvals[1]）
-     * - 当前实现统一使用Upvalue*，这与C实现略有不同
+     * - 对应 LClosure 的 UpVal *upvals[1] 与 CClosure 的 upvalue[1]，由收集器创建时尾随在对象头之后
+     * - C 闭包同样存储 Upvalue*（已关闭上值），这与C实现略有不同
      * - 上值由垃圾回收器管理，这里只持有指针
      */
-    LuaVector<Upvalue*> upvalues_;
+    Upvalue** upvalues_;
 };
 
 } // namespace Lua
@@ -1,24 +1,93 @@
 ﻿/**
  * @file gc_object.cpp
  * @brief GCObject类的实现文件
- * 
- * 当前阶段：基础实现
- * 大部分功能已在头文件中通过内联实现，此文件预留用于后续添加：
- * - 复杂的GC算法实现
- * - 调试和统计功能
- * - 对象遍历和验证
+ *
+ * 对象头不含虚表，标记、大小计算、块大小推导与析构均在此按 GCObjectType
+ * 转换到具体类型后直接调用；新增可回收类型时须同步扩展这里的分派。
  */
 
 #include "core/gc_object.hpp"
+#include "core/function.hpp"
+#include "core/gc_string.hpp"
+#include "core/table.hpp"
+#include "core/thread.hpp"
+#include "core/upvalue.hpp"
+#include "core/userdata.hpp"
 #include "gc/garbage_collector.hpp"
 
+#include <memory>
+#include <type_traits>
+#include <utility>
+
 namespace Lua {
 
+namespace {
+
+/**
+ * @brief 将对象头转换为具体类型并调用访问器
+ *
+ * 类型集合封闭，未知标签只可能来自内存损坏，按不可达处理。
+ */
+template <typename Visitor> decltype(auto) visitGCObject(GCObject* obj, Visitor&& visitor) {
+    switch (obj->getType()) {
+    case GCObjectType::String:
+        return visitor(static_cast<GCString*>(obj));
+    case GCObjectType::Table:
+        return visitor(static_cast<Table*>(obj));
+    case GCObjectType::Function:
+        return visitor(static_cast<Function*>(obj));
+    case GCObjectType::Userdata:
+        return visitor(static_cast<Userdata*>(obj));
+    case GCObjectType::Thread:
+        return visitor(static_cast<Thread*>(obj));
+    case GCObjectType::Proto:
+        return visitor(static_cast<Proto*>(obj));
+    case GCObjectType::Upval:
+        return visitor(static_cast<Upvalue*>(obj));
+    }
+    std::unreachable();
+}
+
+} // namespace
+
 GCObject::~GCObject() {
     if (GarbageCollector* owner = getOwnerCollector()) {
         owner->unregisterObject(this);
     }
 }
 
-} // namespace Lua
+void GCObject::mark(GarbageCollector& gc) {
+    visitGCObject(this, [&gc](auto* object) { object->mark(gc); });
+}
 
+usize GCObject::getSize() const {
+    return visitGCObject(const_cast<GCObject*>(this), [](const auto* object) -> usize { return object->getSize(); });
+}
+
+usize GCObject::getAllocationSize() const noexcept {
+    return visitGCObject(const_cast<GCObject*>(this), []<typename T>([[maybe_unused]] const T* object) -> usize {
+        if constexpr (std::is_same_v<T, GCString>) {
+            // 收集器创建的字符串总是把内容尾随存放，块大小即对象头加内容与终止符
+            return sizeof(GCString) + object->getLength() + 1;
+        } else if constexpr (std::is_same_v<T, Function>) {
+            // 闭包的内联上值槽尾随在对象头之后
+            return sizeof(Function) + object->getInlineUpvalueCapacity() * sizeof(Upvalue*);
+        } else {
+            return sizeof(T);
+        }
+    });
+}
+
+LuaAllocator* GCObject::getBlockAllocator() const noexcept {
+    LuaAllocator* allocator = getAllocationAllocator();
+    if (GCSlabAllocator* slab = getAllocationSlab()) {
+        allocator = slab->getBackingAllocator();
+    }
+    return allocator != nullptr && allocator->isConfigured() ? allocator : nullptr;
+}
+
+void GCObject::destroy() noexcept {
+    visitGCObject(this, [](auto* object) { std::destroy_at(object); });
+}
+
+} // namespace Lua
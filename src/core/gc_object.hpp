@@ -5,38 +5,56 @@
  * @brief 垃圾回收对象基类——垃圾回收系统的基础
  *
  * 设计说明：
- * 垃圾回收对象是所有需要垃圾回收的对象的抽象基类。
- * 使用 C++ 的虚函数机制实现多态，提供统一的垃圾回收接口。
+ * 垃圾回收对象是所有需要垃圾回收的对象的公共对象头。
+ * 对象头不含虚表指针；标记、大小计算与销毁按 type_ 分派到具体类型。
  *
  * 核心特性：
  * - 三色标记：支持白色、灰色、黑色三种颜色标记
  * - 链表管理：通过 next 指针形成垃圾回收对象链表
  * - 类型识别：每个对象都有明确的类型标识
- * - 虚函数接口：支持子类自定义标记和大小计算
+ * - 类型分派：按 GCObjectType 调用具体类型的标记、大小计算与析构
  *
  * 相关文档：lua/docs/architecture/overview.md
  */
 
 #include "common/types.hpp"
 
+#include <atomic>
+
 namespace Lua {
 
 class GarbageCollector;
+class GCSlabAllocator;
 class LuaAllocator;
 
 /**
- * @brief 垃圾回收对象抽象基类——所有可回收对象的基类
+ * @brief 垃圾回收对象内存块的来源
+ *
+ * - Delete：普通 new 创建，由 delete 释放
+ * - OperatorNew：::operator new 分配的变长块（含尾随载荷）
+ * - Allocator：经 LuaAllocator（lua_Alloc）分配
+ * - Slab：来自收集器的小对象块池
+ */
+enum class GCAllocationKind : u8 { Delete, OperatorNew, Allocator, Slab };
+
+/** @brief 构造标签：对象载荷紧随对象头存放在同一内存块中。 */
+struct GCInlineStorage {};
+
+/**
+ * @brief 垃圾回收对象头——所有可回收对象的基类
  *
  * 详细说明：
  * 垃圾回收对象实现了 Lua 垃圾回收系统的核心数据结构。每个需要垃圾回收器管理的对象
  * （字符串、表、函数、用户数据、线程等）都继承自这个基类。
  *
- * 内存布局：
- * - next_: 8字节（64位指针）
- * - type_：1 字节（垃圾回收对象类型枚举）
- * - marked_：1 字节（垃圾回收标记位）
- * - 填充：6 字节（对齐到 8 字节边界）
- * 总计：16字节（基类部分）
+ * 具体类型集合是封闭的（GCObjectType 的七个取值），因此 mark()、getSize() 与销毁
+ * 不走虚函数，而是在 gc_object.cpp 中按 type_ 转换到具体类型后直接调用。
+ * 对象块大小同样由类型推导（字符串为对象头加内容，其余为 sizeof），无需逐对象保存。
+ *
+ * 内存布局（64 位平台）：
+ * - next_、ownerCollector_、allocationSource_、accountedSize_：各 8 字节
+ * - type_、marked_、allocationKind_：各 1 字节，填充到 8 字节边界
+ * 总计：40字节（基类部分）
  *
  * 三色标记算法：
  * - 白色：未访问的对象，有两种白色标记
@@ -55,11 +73,6 @@ public:
     // 构造函数和析构函数
     // =====================================================================
 
-    /**
-     * @brief 虚析构函数 - 确保正确的多态销毁
-     */
-    virtual ~GCObject();
-
     // 禁止拷贝和移动（GC对象由GC系统管理生命周期）
     GCObject(const GCObject&) = delete;
     GCObject(GCObject&&) = delete;
@@ -99,7 +112,7 @@ public:
      * @return 标记位的原始值
      */
     u8 getMarked() const noexcept {
-        return marked_;
+        return loadMarked();
     }
 
     /**
@@ -110,6 +123,24 @@ public:
         marked_ = mark;
     }
 
+    /**
+     * @brief 并行标记：原子地把白色对象改为灰色或黑色
+     * @return true 表示由当前线程完成着色，之后只有该线程会改写此对象的标记位
+     */
+    bool tryShadeConcurrent(GCColor color) noexcept;
+
+    /**
+     * @brief 并行标记：以比较交换改写颜色
+     *
+     * 已着色对象仍可能被其他标记线程同时读取或着色，改写标记位不能覆盖它们的结果。
+     */
+    void setColorConcurrent(GCColor color) noexcept;
+
+    /**
+     * @brief 并行标记：以比较交换循环清除 clearBits 并置上 setBits
+     */
+    void updateMarkedConcurrent(u8 clearBits, u8 setBits) noexcept;
+
     /**
      * @brief 检查对象是否为白色
      * @return true 如果对象是白色
@@ -164,14 +195,14 @@ public:
     }
 
     // =====================================================================
-    // 虚函数接口（子类必须实现）
+    // 按类型分派的对象接口
     // =====================================================================
 
     /**
      * @brief 标记对象引用的其他对象
      *
-     * 这是GC标记阶段的核心方法。每个子类需要实现这个方法，
-     * 标记它所引用的所有其他GC对象。
+     * 这是GC标记阶段的核心方法。每个具体类型提供同名的非虚实现，
+     * 此处按 type_ 转换后调用，标记它所引用的所有其他GC对象。
      *
      * 例如：
      * - Table需要标记其元表、数组和哈希表中的所有值
@@ -180,7 +211,7 @@ public:
      *
      * @note 这个方法在GC标记阶段被调用
      */
-    virtual void mark(GarbageCollector& gc) = 0;
+    void mark(GarbageCollector& gc);
 
     /**
      * @brief 获取对象占用的内存大小
@@ -189,7 +220,7 @@ public:
      *
      * @return 对象占用的字节数
      */
-    virtual usize getSize() const = 0;
+    usize getSize() const;
 
 protected:
     /**
@@ -197,8 +228,23 @@ protected:
      * @param type 对象类型
      */
     explicit GCObject(GCObjectType type) noexcept
-        : next_(nullptr), ownerCollector_(nullptr), allocationAllocator_(nullptr), allocationSize_(0),
-          allocationDestructor_(nullptr), accountedSize_(0), type_(type), marked_(0) {}
+        : next_(nullptr), ownerCollector_(nullptr), allocationSource_{nullptr}, accountedSize_(0), type_(type),
+          marked_(0), allocationKind_(GCAllocationKind::Delete) {}
+
+    /**
+     * @brief 非虚析构函数
+     *
+     * 受保护以禁止通过基类指针 delete；收集器经 destroy() 调用具体类型的析构函数。
+     */
+    ~GCObject();
+
+    /**
+     * @brief 对象内存块来源的 lua_Alloc 分配器，供对象为自身附属存储分配内存
+     *
+     * 块池分配的对象返回块池的后备分配器。取自分配来源而非当前所属收集器，
+     * 对象迁移后释放仍交回分配时的分配器；非托管构造或未配置分配器时返回 nullptr。
+     */
+    [[nodiscard]] LuaAllocator* getBlockAllocator() const noexcept;
 
 private:
     friend class GarbageCollector;
@@ -207,24 +253,47 @@ private:
         ownerCollector_ = collector;
     }
 
-    using AllocationDestructor = void (*)(GCObject*) noexcept;
+    /**
+     * @brief 记录对象内存块的来源
+     *
+     * 块大小可由类型推导，头部只保存释放路径与所属分配器或块池；
+     * 块池须逐对象保存，因为对象可迁移到其他收集器而块仍属原块池。
+     */
+    void setAllocation(GCAllocationKind kind, LuaAllocator* allocator) noexcept {
+        allocationKind_ = kind;
+        allocationSource_.allocator = allocator;
+    }
 
-    void setAllocatorAllocation(LuaAllocator* allocator, usize size, AllocationDestructor destructor) noexcept {
-        allocationAllocator_ = allocator;
-        allocationSize_ = size;
-        allocationDestructor_ = destructor;
+    void setSlabAllocation(GCSlabAllocator* slab) noexcept {
+        allocationKind_ = GCAllocationKind::Slab;
+        allocationSource_.slab = slab;
+    }
+
+    GCAllocationKind getAllocationKind() const noexcept {
+        return allocationKind_;
     }
 
     LuaAllocator* getAllocationAllocator() const noexcept {
-        return allocationAllocator_;
+        return allocationKind_ == GCAllocationKind::Allocator ? allocationSource_.allocator : nullptr;
     }
 
-    usize getAllocationSize() const noexcept {
-        return allocationSize_;
+    GCSlabAllocator* getAllocationSlab() const noexcept {
+        return allocationKind_ == GCAllocationKind::Slab ? allocationSource_.slab : nullptr;
     }
 
-    AllocationDestructor getAllocationDestructor() const noexcept {
-        return allocationDestructor_;
+    /** @brief 按类型推导传给 lua_Alloc 或块池的精确对象内存块大小。 */
+    usize getAllocationSize() const noexcept;
+
+    /** @brief 按类型调用具体析构函数，不释放对象内存块。 */
+    void destroy() noexcept;
+
+    /**
+     * @brief 以原子加载读取标记位
+     *
+     * 并行标记期间其他工作者会比较交换同一字节，所有读取都须是原子的；宽松的单字节加载与普通读取代价相同。
+     */
+    u8 loadMarked() const noexcept {
+        return std::atomic_ref<u8>(const_cast<u8&>(marked_)).load(std::memory_order_relaxed);
     }
 
     void setAccountedSize(usize size) noexcept {
@@ -235,22 +304,26 @@ private:
         return accountedSize_;
     }
 
+    /** @brief 对象内存块所属的分配器或块池，按 allocationKind_ 解释。 */
+    union AllocationSource {
+        LuaAllocator* allocator;
+        GCSlabAllocator* slab;
+    };
+
     /** @brief GC链表指针 */
     GCObject* next_;
     /** @brief 当前管理此对象的GC实例 */
     GarbageCollector* ownerCollector_;
-    /** @brief 拥有当前对象内存块的分配器 */
-    LuaAllocator* allocationAllocator_;
-    /** @brief 传给 lua_Alloc 的精确对象内存块大小 */
-    usize allocationSize_;
-    /** @brief 具体的定位析构函数 */
-    AllocationDestructor allocationDestructor_;
+    /** @brief 拥有当前对象内存块的分配器或块池 */
+    AllocationSource allocationSource_;
     /** @brief 最近一次计入垃圾回收器快速路径总量的大小 */
     usize accountedSize_;
     /** @brief 对象类型 */
     GCObjectType type_;
     /** @brief GC标记位 */
     u8 marked_;
+    /** @brief 释放路径，与 type_、marked_ 共用同一个对齐字 */
+    GCAllocationKind allocationKind_;
 };
 
 // =====================================================================
@@ -278,6 +351,8 @@ constexpr u8 WEAKKEYBIT = 4;
 constexpr u8 FIXEDBIT = 5;
 /** @brief 弱值表标记位索引 */
 constexpr u8 WEAKVALUEBIT = 6;
+/** @brief 老年代位索引（分代模式中已晋升的对象） */
+constexpr u8 OLDBIT = 7;
 
 /** @brief 白色类型0掩码 */
 constexpr u8 WHITE0 = (1 << WHITE0BIT);
@@ -297,6 +372,8 @@ constexpr u8 FIXED = (1 << FIXEDBIT);
 constexpr u8 WEAKVALUE = (1 << WEAKVALUEBIT);
 /** @brief 弱表模式掩码 */
 constexpr u8 WEAKBITS = (WEAKKEY | WEAKVALUE);
+/** @brief 老年代掩码 */
+constexpr u8 OLD = (1 << OLDBIT);
 } // namespace GCBits
 
 // =====================================================================
@@ -307,9 +384,10 @@ constexpr u8 WEAKBITS = (WEAKKEY | WEAKVALUE);
  * @brief 获取GC颜色
  */
 inline GCColor GCObject::getColor() const noexcept {
-    if (marked_ & GCBits::BLACK) {
+    const u8 marked = loadMarked();
+    if (marked & GCBits::BLACK) {
         return GCColor::Black;
-    } else if (marked_ & GCBits::WHITEBITS) {
+    } else if (marked & GCBits::WHITEBITS) {
         return GCColor::White;
     } else {
         return GCColor::Gray;
@@ -337,18 +415,62 @@ inline void GCObject::setColor(GCColor color) noexcept {
     }
 }
 
+/**
+ * @brief 并行标记着色
+ *
+ * 只在仍为白色时比较交换，因此同一对象至多被一个线程压入灰栈。
+ */
+inline bool GCObject::tryShadeConcurrent(GCColor color) noexcept {
+    std::atomic_ref<u8> marked(marked_);
+    u8 current = marked.load(std::memory_order_relaxed);
+    while ((current & GCBits::WHITEBITS) != 0) {
+        u8 desired = static_cast<u8>(current & ~(GCBits::WHITEBITS | GCBits::BLACK));
+        if (color == GCColor::Black) {
+            desired |= GCBits::BLACK;
+        }
+        if (marked.compare_exchange_weak(current, desired, std::memory_order_relaxed)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief 并行标记改色
+ */
+inline void GCObject::setColorConcurrent(GCColor color) noexcept {
+    u8 colorBits = 0;
+    if (color == GCColor::White) {
+        colorBits = GCBits::WHITE0;
+    } else if (color == GCColor::Black) {
+        colorBits = GCBits::BLACK;
+    }
+    updateMarkedConcurrent(GCBits::WHITEBITS | GCBits::BLACK, colorBits);
+}
+
+/**
+ * @brief 并行标记改写标记位
+ */
+inline void GCObject::updateMarkedConcurrent(u8 clearBits, u8 setBits) noexcept {
+    std::atomic_ref<u8> marked(marked_);
+    u8 current = marked.load(std::memory_order_relaxed);
+    while (!marked.compare_exchange_weak(current, static_cast<u8>((current & ~clearBits) | setBits),
+                                         std::memory_order_relaxed)) {
+    }
+}
+
 /**
  * @brief 检查对象是否为白色
  */
 inline bool GCObject::isWhite() const noexcept {
-    return (marked_ & GCBits::WHITEBITS) != 0;
+    return (loadMarked() & GCBits::WHITEBITS) != 0;
 }
 
 /**
  * @brief 检查对象是否为黑色
  */
 inline bool GCObject::isBlack() const noexcept {
-    return (marked_ & GCBits::BLACK) != 0;
+    return (loadMarked() & GCBits::BLACK) != 0;
 }
 
 /**
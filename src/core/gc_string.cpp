@@ -4,6 +4,7 @@
  */
 
 #include "core/gc_string.hpp"
+#include "common/hash.hpp"
 
 #include <cstring>
 #include <limits>
@@ -13,80 +14,59 @@ namespace Lua {
 
 /**
  * @brief 构造函数 - 从字符串视图创建GCString
+ *
+ * 旧接口路径：对象由普通 new 创建，没有尾随载荷，内容放在单独的堆块中。
  */
-GCString::GCString(StrView str) : GCString(nullptr, str) {}
-
-GCString::GCString(LuaAllocator* allocator, StrView str)
-    : GCObject(GCObjectType::String), hash_(computeHash(str)), length_(str.length()), allocator_(allocator) {
+GCString::GCString(StrView str)
+    : GCObject(GCObjectType::String), hash_(computeHash(str)), length_(str.length()), data_(nullptr) {
     if (length_ == std::numeric_limits<usize>::max()) {
         throw std::bad_array_new_length();
     }
-    const usize storageBytes = length_ + 1;
-    char* destination = inlineData_.data();
-    if (storageBytes > inlineData_.size()) {
-        if (allocator_ != nullptr && allocator_->isConfigured()) {
-            externalData_ = static_cast<char*>(allocator_->allocate(storageBytes));
-            callbackOwned_ = true;
-        } else {
-            externalData_ = static_cast<char*>(::operator new(storageBytes));
-        }
-        if (externalData_ == nullptr) {
-            throw std::bad_alloc();
-        }
-        destination = externalData_;
+    data_ = static_cast<char*>(::operator new(length_ + 1));
+    if (length_ != 0) {
+        std::memcpy(data_, str.data(), length_);
     }
+    data_[length_] = '\0';
+}
 
+GCString::GCString(GCInlineStorage tag, StrView str) noexcept : GCString(tag, str, computeHash(str)) {}
+
+GCString::GCString(GCInlineStorage, StrView str, usize hash) noexcept
+    : GCObject(GCObjectType::String), hash_(hash), length_(str.length()), data_(inlineStorage()) {
     if (length_ != 0) {
-        std::memcpy(destination, str.data(), length_);
+        std::memcpy(data_, str.data(), length_);
     }
-    destination[length_] = '\0';
+    data_[length_] = '\0';
 }
 
 GCString::~GCString() {
-    if (externalData_ == nullptr) {
-        return;
+    if (data_ != inlineStorage()) {
+        ::operator delete(data_);
     }
-    if (callbackOwned_) {
-        allocator_->deallocate(externalData_, length_ + 1);
-    } else {
-        ::operator delete(externalData_);
+}
+
+usize GCString::getInlineAllocationSize(StrView str) {
+    if (str.length() > std::numeric_limits<usize>::max() - sizeof(GCString) - 1) {
+        throw std::bad_array_new_length();
     }
+    return sizeof(GCString) + str.length() + 1;
 }
 
 /**
  * @brief 获取对象占用的内存大小
  */
 usize GCString::getSize() const {
-    return sizeof(GCString) + (externalData_ != nullptr ? length_ + 1 : 0);
+    return sizeof(GCString) + length_ + 1;
 }
 
 /**
  * @brief 计算字符串的哈希值
  *
- * 实现说明：
- * 使用与Lua 5.1.5相似的哈希算法。对于长字符串，采用采样策略：
- * 不是扫描整个字符串，而是以固定步长采样，以提高性能。
- *
- * 算法特点：
- * - 短字符串：扫描所有字符
- * - 长字符串：采样计算（每隔一定步长取一个字符）
- * - 包含字符串长度，避免不同长度字符串的哈希冲突
+ * 实现见 common/hash.hpp：带种子时全部字节参与 wyhash 式乘法折叠；
+ * 不带种子的长字符串只读取首尾与均匀分布的固定数量块，并混入长度。
  */
-usize GCString::computeHash(StrView str) noexcept {
-    usize len = str.length();
-    usize hash = len; // 初始哈希值为字符串长度
-
-    // 采样步长：对于长字符串，不扫描所有字符
-    // Lua 5.1使用 (len >> 5) + 1 作为步长
-    usize step = (len >> 5) + 1;
-
-    // 采样计算哈希值
-    for (usize i = 0; i < len; i += step) {
-        // 使用简单但有效的哈希组合公式
-        hash = hash ^ ((hash << 5) + (hash >> 2) + static_cast<unsigned char>(str[i]));
-    }
-
-    return hash;
+usize GCString::computeHash(StrView str, u64 seed) noexcept {
+    return static_cast<usize>(luaHashBytes(str.data(), str.length(), seed));
 }
 
 } // namespace Lua
@@ -21,7 +21,6 @@
 #include "common/types.hpp"
 #include "core/gc_object.hpp"
 #include "runtime/lua_allocator.hpp"
-#include <array>
 #include <string_view>
 
 namespace Lua {
@@ -35,20 +34,23 @@ namespace Lua {
  * 每个字符串对象包含预计算的哈希值、长度信息和实际的字符串数据。
  *
  * 内存布局：
- * - GCObject基类：24字节（next, type, marked, vtable）
+ * - GCObject基类：56字节（vtable, next, owner, 分配来源与计量, type, marked）
  * - hash_: 8字节（usize）
  * - length_: 8字节（usize）
- * - inlineData_: 最多23字节内容及终止符
- * - externalData_: 更长内容的精确 length + 1 字节 lua_Alloc 块
- * 总大小由平台布局决定；getSize() 计入对象和实际外部载荷
+ * - data_: 8字节，指向字符内容
+ * - 尾随载荷：length + 1 字节内容及终止符，与对象头处于同一内存块
+ * 经垃圾回收器创建的字符串只占一次分配；总块不超过 128 字节的短字符串
+ * 由收集器的小对象块池（GCSlabAllocator）按尺寸分级承载。
+ * 直接 new 创建的字符串（仅测试与旧接口使用）把内容放在单独的堆块中。
  *
  * 字符串驻留：
  * 所有GCString对象通过StringPool创建和管理，确保相同内容的字符串
  * 只有一个实例。这使得字符串比较可以简化为指针比较。
  *
  * 哈希算法：
- * 使用与Lua 5.1.5相同的哈希算法，在字符串创建时计算并缓存。
- * 哈希值用于快速查找和表键比较。
+ * 使用 luaHashBytes（wyhash 结构），在字符串创建时计算并缓存。经 StringPool
+ * 驻留的字符串使用该池的随机种子并完整读取全部字节，哈希值用于驻留查找和
+ * 表键定位；未驻留的长字符串按固定块数采样。
  *
  * 不可变性：
  * 字符串一旦创建，内容不可修改。这是字符串驻留的前提条件。
@@ -68,12 +70,41 @@ public:
      * 注意：此构造函数应该只被StringPool调用，不应直接使用。
      */
     explicit GCString(StrView str);
-    GCString(LuaAllocator* allocator, StrView str);
+
+    /**
+     * @brief 构造函数 - 内容存放在紧随对象头的尾随载荷中
+     * @param str 字符串内容
+     *
+     * 调用方必须提供至少 getInlineAllocationSize(str) 字节的内存块；
+     * 由 GarbageCollector::create<GCString>() 自动选择此构造函数。
+     */
+    GCString(GCInlineStorage, StrView str) noexcept;
+
+    /**
+     * @brief 构造函数 - 尾随载荷，并采用调用方已算好的哈希值
+     * @param str 字符串内容
+     * @param hash computeHash(str, seed) 的结果
+     *
+     * StringPool 查找时已按自身种子计算过哈希，创建时直接复用。
+     */
+    GCString(GCInlineStorage, StrView str, usize hash) noexcept;
+
+    /**
+     * @brief 计算单次分配所需的总字节数（对象头 + 内容 + 终止符）
+     * @param str 字符串内容
+     * @return 内存块字节数
+     */
+    [[nodiscard]] static usize getInlineAllocationSize(StrView str);
+
+    /** @brief 同上，对应带预计算哈希的构造函数。 */
+    [[nodiscard]] static usize getInlineAllocationSize(StrView str, usize /*hash*/) {
+        return getInlineAllocationSize(str);
+    }
 
     /**
      * @brief 析构函数
      */
-    ~GCString() override;
+    ~GCString();
 
     // 禁止拷贝和移动（字符串由StringPool管理）
     GCString(const GCString&) = delete;
@@ -134,7 +165,7 @@ public:
      *
      * 字符串对象不引用其他GC对象，所以这个方法为空实现。
      */
-    void mark(GarbageCollector& /*gc*/) override {
+    void mark(GarbageCollector& /*gc*/) {
         // 字符串对象不引用其他GC对象
     }
 
@@ -142,7 +173,7 @@ public:
      * @brief 获取对象占用的内存大小
      * @return 对象占用的字节数
      */
-    usize getSize() const override;
+    usize getSize() const;
 
     // =====================================================================
     // 固定字符串（防止GC回收）
@@ -199,28 +230,29 @@ public:
     /**
      * @brief 计算字符串的哈希值
      *
-     * 使用与Lua 5.1.5相同的哈希算法。
-     * 对于长字符串，采用采样策略以提高性能。
+     * 带种子时读取全部字节；种子为 0 时超过 kHashFullBytes 的字符串只采样固定数量的块。
      *
      * @param str 字符串视图
+     * @param seed 哈希种子；未经 StringPool 创建的字符串使用 0
      * @return 哈希值
      */
-    static usize computeHash(StrView str) noexcept;
+    static usize computeHash(StrView str, u64 seed = 0) noexcept;
 
 private:
     [[nodiscard]] CharPtr storageData() const noexcept {
-        return externalData_ != nullptr ? externalData_ : inlineData_.data();
+        return data_;
+    }
+
+    [[nodiscard]] char* inlineStorage() noexcept {
+        return reinterpret_cast<char*>(this + 1);
     }
 
-    static constexpr usize kInlineStorageBytes = 24;
     /** @brief 预计算的哈希值 */
     usize hash_;
     /** @brief 字符串长度（字节数） */
     usize length_;
-    LuaAllocator* allocator_ = nullptr;
-    char* externalData_ = nullptr;
-    bool callbackOwned_ = false;
-    std::array<char, kInlineStorageBytes> inlineData_{};
+    /** @brief 内容指针：尾随载荷或旧接口的单独堆块 */
+    char* data_;
 };
 
 } // namespace Lua
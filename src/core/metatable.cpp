@@ -18,6 +18,11 @@
 #include "vm/state/global_state.hpp"
 #include "vm/vm.hpp"
 #include "runtime/runtime_services.hpp"
+#include "vm/state/stack.hpp"
+
+#include <algorithm>
+#include <array>
+#include <span>
 #include <stdexcept>
 
 namespace Lua {
@@ -133,40 +138,50 @@ Value fastMetamethod(GlobalState& globalState, Table* metatable, TMS event) {
 // 元方法调用函数实现
 // =====================================================================
 
+namespace {
+
 /**
- * @brief 调用元方法并获取返回值
+ * @brief 在当前栈顶原地建立元方法调用帧并调用
+ * @param frame 元方法及其参数；调用方先复制到 C++ 栈上，扩容不会使其失效
+ * @param result 非空时接收第一个返回值
+ *
+ * 一次检查栈空间后直接写入各槽位，不逐个压栈，也不分配临时数组。与 pushValue 相同，
+ * 帧之上保留一个已分配的应急栈槽。返回或抛出时清空帧用过的槽位并恢复栈顶。
  */
-void callTMWithResult(LuaState* L, Value& result, const Value& metamethod, const Value& arg1, const Value& arg2) {
-    // 检查元方法是否是函数
-    if (!metamethod.isFunction()) {
+void invokeMetamethod(LuaState* L, std::span<const Value> frame, Value* result) {
+    if (!frame.front().isFunction()) {
         throw std::runtime_error("Metamethod is not a function");
     }
 
     Stack& stack = L->getStack();
-    usize savedTop = L->getAbsoluteTop();
-    usize savedStackSize = stack.size();
+    const usize savedTop = L->getAbsoluteTop();
+    const usize savedStackSize = stack.size();
+    const usize frameTop = savedTop + frame.size();
     auto restoreStack = [&]() {
         for (usize i = savedTop; i < savedStackSize && i < stack.size(); i++) {
-            stack.at(i) = Value();
+            stack[i] = Value();
         }
         stack.setTop(savedStackSize);
         L->setAbsoluteTop(savedTop);
     };
 
-    try {
-        L->pushValue(metamethod);
-        L->pushValue(arg1);
-        L->pushValue(arg2);
+    stack.checkLimit(frameTop);
+    if (stack.capacity() <= frameTop) {
+        stack.ensureSpace(frameTop + 1 - stack.size());
+    }
+    if (stack.size() < frameTop) {
+        stack.setTop(frameTop);
+    }
+    std::copy(frame.begin(), frame.end(), &stack[savedTop]);
+    L->setAbsoluteTop(frameTop);
 
+    try {
         RuntimeServices services(L->getGlobalState());
-        VM::call(services, L, 2, 1);
+        VM::call(services, L, static_cast<i32>(frame.size() - 1), result != nullptr ? 1 : 0);
 
-        if (L->getAbsoluteTop() > savedTop) {
-            result = stack.at(savedTop);
-        } else {
-            result = Value();
+        if (result != nullptr) {
+            *result = L->getAbsoluteTop() > savedTop ? stack[savedTop] : Value();
         }
-
         restoreStack();
     } catch (...) {
         restoreStack();
@@ -174,40 +189,22 @@ void callTMWithResult(LuaState* L, Value& result, const Value& metamethod, const
     }
 }
 
+} // namespace
+
+/**
+ * @brief 调用元方法并获取返回值
+ */
+void callTMWithResult(LuaState* L, Value& result, const Value& metamethod, const Value& arg1, const Value& arg2) {
+    const std::array<Value, 3> frame{metamethod, arg1, arg2};
+    invokeMetamethod(L, frame, &result);
+}
+
 /**
  * @brief 调用元方法（无返回值）
  */
 void callTM(LuaState* L, const Value& metamethod, const Value& arg1, const Value& arg2, const Value& arg3) {
-    // 检查元方法是否是函数
-    if (!metamethod.isFunction()) {
-        throw std::runtime_error("Metamethod is not a function");
-    }
-
-    Stack& stack = L->getStack();
-    usize savedTop = L->getAbsoluteTop();
-    usize savedStackSize = stack.size();
-    auto restoreStack = [&]() {
-        for (usize i = savedTop; i < savedStackSize && i < stack.size(); i++) {
-            stack.at(i) = Value();
-        }
-        stack.setTop(savedStackSize);
-        L->setAbsoluteTop(savedTop);
-    };
-
-    try {
-        L->pushValue(metamethod);
-        L->pushValue(arg1);
-        L->pushValue(arg2);
-        L->pushValue(arg3);
-
-        RuntimeServices services(L->getGlobalState());
-        VM::call(services, L, 3, 0);
-
-        restoreStack();
-    } catch (...) {
-        restoreStack();
-        throw;
-    }
+    const std::array<Value, 4> frame{metamethod, arg1, arg2, arg3};
+    invokeMetamethod(L, frame, nullptr);
 }
 
 /**
@@ -4,12 +4,47 @@
  */
 
 #include "core/string_pool.hpp"
+#include "common/hash.hpp"
+#include "common/number_conversion.hpp"
 #include "gc/garbage_collector.hpp"
 
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <chrono>
+#include <new>
+
 namespace Lua {
 
+namespace {
+
+/** @brief 缓存覆盖区间的槽位总数。 */
+constexpr usize kSmallIntegerSlotCount = static_cast<usize>(kSmallIntegerStringMax - kSmallIntegerStringMin) + 1;
+/** @brief 缓存按此粒度增长，避免顺序整数逐个扩容。 */
+constexpr usize kSmallIntegerSlotChunk = 256;
+/** @brief 缓存区间内整数的最长十进制文本（"-256" 与 "65535"）。 */
+constexpr usize kSmallIntegerMaxDigits = 5;
+
+/**
+ * @brief 生成字符串哈希种子
+ *
+ * 与参考实现 luai_makeseed 相同的思路：混合堆地址、栈地址、函数地址与时钟，
+ * 开启 ASLR 时不同进程与不同状态得到不同种子，且无需阻塞式熵源。
+ */
+u64 makeHashSeed(const void* owner) noexcept {
+    const int stackProbe = 0;
+    u64 seed = luaHashPointer(owner);
+    seed = luaHashWord(seed ^ luaHashPointer(&stackProbe));
+    seed = luaHashWord(seed ^ luaHashPointer(reinterpret_cast<const void*>(&makeHashSeed)));
+    seed = luaHashWord(seed ^ static_cast<u64>(std::chrono::steady_clock::now().time_since_epoch().count()));
+    return seed;
+}
+
+} // namespace
+
 StringPool::StringPool(LuaAllocator* allocator)
-    : pool_(0, std::hash<StrView>{}, std::equal_to<StrView>{}, PoolAllocator(allocator)) {}
+    : hashSeed_(makeHashSeed(this)), pool_(0, PoolKeyHash{}, PoolKeyEqual{}, PoolAllocator(allocator)),
+      smallIntegerStrings_(LuaStdAllocator<GCString*>(allocator)) {}
 
 void StringPool::setGarbageCollector(GarbageCollector* collector) {
     collector_ = collector;
@@ -33,7 +68,8 @@ GCString* StringPool::intern(StrView str) {
     }
 
     // 在池中查找是否已存在
-    auto it = pool_.find(str);
+    const PoolKey key = makeKey(str);
+    auto it = pool_.find(key);
     if (it != pool_.end()) {
         // 已存在，返回已有的字符串对象
         return it->second;
@@ -42,7 +78,7 @@ GCString* StringPool::intern(StrView str) {
     // 不存在，创建新的字符串对象
     GarbageCollector& gc = collector_ != nullptr ? *collector_ : GarbageCollector::legacyInstance();
     gc.setStringPool(this);
-    GCString* newString = gc.create<GCString>(str);
+    GCString* newString = gc.create<GCString>(str, key.hash);
 
     try {
         /**
@@ -51,7 +87,7 @@ GCString* StringPool::intern(StrView str) {
          * 此时对象已注册到垃圾回收器，因此插入失败必须回滚，不能在对象链表中留下未驻留的
          * GCString。
          */
-        auto [entry, inserted] = pool_.emplace(newString->view(), newString);
+        auto [entry, inserted] = pool_.emplace(PoolKey{newString->view(), key.hash}, newString);
         if (!inserted) {
             gc.destroyManagedObject(newString);
             return entry->second;
@@ -64,11 +100,60 @@ GCString* StringPool::intern(StrView str) {
     return newString;
 }
 
+/**
+ * @brief 驻留数值的 Lua 字符串形式
+ */
+GCString* StringPool::internNumber(LuaNumber value) {
+    i64 integer = 0;
+    std::array<char, 64> buffer{};
+    if (!luaNumberToSmallInteger(value, integer)) {
+        return intern(luaNumberToView(value, buffer));
+    }
+
+    const usize slot = static_cast<usize>(integer - kSmallIntegerStringMin);
+    if (slot < smallIntegerStrings_.size() && smallIntegerStrings_[slot] != nullptr) {
+        return smallIntegerStrings_[slot];
+    }
+
+    GCString* str = intern(luaNumberToView(value, buffer));
+    if (slot >= smallIntegerStrings_.size()) {
+        const usize required = (slot / kSmallIntegerSlotChunk + 1) * kSmallIntegerSlotChunk;
+        const usize grown = std::max(required, smallIntegerStrings_.size() * 2);
+        try {
+            smallIntegerStrings_.resize(std::min(grown, kSmallIntegerSlotCount), nullptr);
+        } catch (const std::bad_alloc&) {
+            /** @brief 缓存只是加速路径；扩容失败时仍返回已驻留的字符串。 */
+            return str;
+        }
+    }
+    smallIntegerStrings_[slot] = str;
+    return str;
+}
+
+void StringPool::forgetSmallInteger(const GCString* str) noexcept {
+    const StrView text = str->view();
+    if (text.empty() || text.size() > kSmallIntegerMaxDigits) {
+        return;
+    }
+
+    i64 integer = 0;
+    const auto result = std::from_chars(text.data(), text.data() + text.size(), integer);
+    if (result.ec != std::errc{} || result.ptr != text.data() + text.size() || integer < kSmallIntegerStringMin ||
+        integer > kSmallIntegerStringMax) {
+        return;
+    }
+
+    const usize slot = static_cast<usize>(integer - kSmallIntegerStringMin);
+    if (slot < smallIntegerStrings_.size() && smallIntegerStrings_[slot] == str) {
+        smallIntegerStrings_[slot] = nullptr;
+    }
+}
+
 /**
  * @brief 查找字符串 - 不创建新对象
  */
 GCString* StringPool::find(StrView str) const {
-    auto it = pool_.find(str);
+    auto it = pool_.find(makeKey(str));
     if (it != pool_.end()) {
         return it->second;
     }
@@ -84,12 +169,16 @@ void StringPool::remove(GCString* str) {
         return;
     }
 
+    if (!smallIntegerStrings_.empty()) {
+        forgetSmallInteger(str);
+    }
+
     /**
      * @brief 仅当条目仍指向正在销毁的确切对象时才将其移除。
      *
      * 垃圾回收器可能短暂拥有内容相同的另一 GCString，例如回滚失败的插入期间。
      */
-    auto it = pool_.find(str->view());
+    auto it = pool_.find(PoolKey{str->view(), str->getHash()});
     if (it != pool_.end() && it->second == str) {
         pool_.erase(it);
     }
@@ -100,6 +189,7 @@ void StringPool::remove(GCString* str) {
  */
 void StringPool::clear() {
     pool_.clear();
+    smallIntegerStrings_.clear();
 }
 
 /**
@@ -38,7 +38,7 @@ class GarbageCollector;
  *
  * 字符串驻留流程：
  * 1. 调用intern()方法请求创建字符串
- * 2. 计算字符串的哈希值
+ * 2. 用本池的种子计算字符串的哈希值（新建对象直接复用）
  * 3. 在哈希表中查找是否已存在
  * 4. 如果存在，返回已有的GCString指针
  * 5. 如果不存在，创建新的GCString并加入哈希表
@@ -126,6 +126,17 @@ public:
         return intern(StrView(str, len));
     }
 
+    /**
+     * @brief 驻留数值的 Lua 字符串形式
+     *
+     * -256..65535 内的整数经由小整数字符串缓存直接返回已驻留对象，
+     * 不再重复格式化与查找驻留表；其余数值按 "%.14g" 格式化后驻留。
+     *
+     * @param value 数值
+     * @return GCString指针
+     */
+    GCString* internNumber(LuaNumber value);
+
     /**
      * @brief 设置新字符串默认注册到的GC实例
      */
@@ -219,6 +230,15 @@ public:
      */
     void resize(usize newSize);
 
+    /**
+     * @brief 获取本池的字符串哈希种子
+     *
+     * 种子在构造时由地址与时钟随机化生成，驻留字符串的 getHash() 均基于它。
+     */
+    u64 getHashSeed() const noexcept {
+        return hashSeed_;
+    }
+
 private:
     // =====================================================================
     // 内部数据结构
@@ -228,12 +248,46 @@ private:
      * @brief 字符串驻留池的键是指向不可变垃圾回收字符串存储的视图。
      *
      * remove() 会在垃圾回收器释放所有者之前移除条目，从而避免悬空键和重复内容存储。
+     * 键同时携带已算好的带种子哈希，查找、插入与移除都不再重复扫描内容。
      */
-    using PoolValue = std::pair<const StrView, GCString*>;
+    struct PoolKey {
+        StrView text;
+        usize hash;
+    };
+
+    struct PoolKeyHash {
+        usize operator()(const PoolKey& key) const noexcept {
+            return key.hash;
+        }
+    };
+
+    struct PoolKeyEqual {
+        bool operator()(const PoolKey& lhs, const PoolKey& rhs) const noexcept {
+            return lhs.hash == rhs.hash && lhs.text == rhs.text;
+        }
+    };
+
+    using PoolValue = std::pair<const PoolKey, GCString*>;
     using PoolAllocator = LuaStdAllocator<PoolValue>;
-    using PoolMap = std::unordered_map<StrView, GCString*, std::hash<StrView>, std::equal_to<StrView>, PoolAllocator>;
+    using PoolMap = std::unordered_map<PoolKey, GCString*, PoolKeyHash, PoolKeyEqual, PoolAllocator>;
 
+    PoolKey makeKey(StrView str) const noexcept {
+        return PoolKey{str, GCString::computeHash(str, hashSeed_)};
+    }
+
+    /**
+     * @brief 小整数缓存条目失效：仅在被回收字符串正是缓存槽位对象时清空槽位。
+     */
+    void forgetSmallInteger(const GCString* str) noexcept;
+
+    u64 hashSeed_;
     PoolMap pool_;
+    /**
+     * @brief 小整数字符串缓存，按 value - kSmallIntegerStringMin 索引并按需增长。
+     *
+     * 缓存是弱引用：条目不延长字符串生命周期，remove() 在对象被回收前清空对应槽位。
+     */
+    LuaVector<GCString*> smallIntegerStrings_;
     GarbageCollector* collector_ = nullptr;
     const ResourcePolicy* resourcePolicy_ = nullptr;
 };
@@ -4,7 +4,9 @@
  */
 
 #include "core/table.hpp"
+#include "common/hash.hpp"
 #include "common/lua_error.hpp"
+#include "common/macros.hpp"
 #include "core/gc_string.hpp"
 #include "core/function.hpp"
 #include "gc/garbage_collector.hpp"
@@ -27,20 +29,18 @@ usize ValueHash::operator()(const Value& val) const noexcept {
         return val.asBoolean() ? 1 : 0;
 
     case ValueType::Number: {
-        f64 num = val.asNumber();
-        // 使用std::hash<f64>计算浮点数的哈希值
-        return std::hash<f64>{}(num);
+        // 乘法折叠使整数键的低位也充分混合，线性探测不会聚集
+        return static_cast<usize>(luaHashNumber(val.asNumber()));
     }
 
     case ValueType::LightUserdata: {
-        void* ptr = val.asLightUserdata();
-        // 使用指针值的哈希
-        return std::hash<void*>{}(ptr);
+        // 指针低位因对齐恒为零，必须混合后再按掩码取桶
+        return static_cast<usize>(luaHashPointer(val.asLightUserdata()));
     }
 
     case ValueType::String: {
         GCString* str = val.asString();
-        // 使用字符串对象的预计算哈希值
+        // 使用字符串对象的预计算（带驻留池种子的）哈希值
         return str->getHash();
     }
 
@@ -59,7 +59,7 @@ usize ValueHash::operator()(const Value& val) const noexcept {
         } else if (val.getType() == ValueType::Thread) {
             ptr = val.asThread();
         }
-        return std::hash<void*>{}(ptr);
+        return static_cast<usize>(luaHashPointer(ptr));
     }
 
     default:
@@ -324,33 +324,84 @@ usize Table::length() const {
 // GCObject接口实现
 // =====================================================================
 
+namespace {
+
+/** @brief 标记循环向前预取的槽位数，约覆盖一次缓存未命中的延迟。 */
+constexpr usize kMarkPrefetchDistance = 8;
+
+/**
+ * @brief 预取值所引用对象的对象头
+ *
+ * 标记该值时要读写对象头的颜色位；提前若干槽发出预取，可把对象头未命中与当前槽的处理重叠。
+ * 只取地址不解引用，因此无需具体类型定义。
+ */
+void prefetchValueObject(const Value& value) noexcept {
+    switch (value.getType()) {
+    case ValueType::String:
+        LUA_PREFETCH(value.asString());
+        break;
+    case ValueType::Table:
+        LUA_PREFETCH(value.asTable());
+        break;
+    case ValueType::Function:
+        LUA_PREFETCH(value.asFunction());
+        break;
+    case ValueType::Userdata:
+        LUA_PREFETCH(value.asUserdata());
+        break;
+    case ValueType::Thread:
+        LUA_PREFETCH(value.asThread());
+        break;
+    default:
+        break;
+    }
+}
+
+} // namespace
+
 void Table::mark(GarbageCollector& gc) {
     gc.markTable(this);
 }
 
+void Table::prefetchContents() const noexcept {
+    LUA_PREFETCH(array_.data());
+    LUA_PREFETCH(hashNodes_.data());
+}
+
 void Table::markContents(GarbageCollector& gc, bool weakKeys, bool weakValues) {
-    // 标记数组部分中的GC对象
-    if (!weakValues) {
-        for (const Value& val : array_) {
-            gc.markValue(val);
-        }
-    } else {
-        for (const Value& val : array_) {
-            if (val.isString()) {
-                gc.markValue(val);
-            }
+    // 标记数组部分中的GC对象；非可回收槽位只需一次类型范围比较即跳过
+    const Value* slots = array_.data();
+    const usize slotCount = array_.size();
+    for (usize i = 0; i < slotCount; ++i) {
+        if (i + kMarkPrefetchDistance < slotCount) {
+            prefetchValueObject(slots[i + kMarkPrefetchDistance]);
+        }
+        const Value& val = slots[i];
+        if (!val.isCollectable() || (weakValues && !val.isString())) {
+            continue;
         }
+        gc.markValue(val);
     }
 
     // 标记哈希部分中的GC对象
-    for (const HashNode& node : hashNodes_) {
+    const HashNode* nodes = hashNodes_.data();
+    const usize nodeCount = hashNodes_.size();
+    for (usize i = 0; i < nodeCount; ++i) {
+        if (i + kMarkPrefetchDistance < nodeCount) {
+            const HashNode& ahead = nodes[i + kMarkPrefetchDistance];
+            if (ahead.state == HashNodeState::Live) {
+                prefetchValueObject(ahead.key);
+                prefetchValueObject(ahead.value);
+            }
+        }
+        const HashNode& node = nodes[i];
         if (node.state != HashNodeState::Live) {
             continue;
         }
-        if (!weakKeys || node.key.isString()) {
+        if (node.key.isCollectable() && (!weakKeys || node.key.isString())) {
             gc.markValue(node.key);
         }
-        if (!weakValues || node.value.isString()) {
+        if (node.value.isCollectable() && (!weakValues || node.value.isString())) {
             gc.markValue(node.value);
         }
     }
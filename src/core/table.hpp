@@ -44,9 +44,10 @@ class Table;
  * 不同类型的Value使用不同的哈希策略：
  * - Nil: 固定哈希值0
  * - Boolean: true为1，false为0
- * - Number: 使用std::hash<f64>
- * - LightUserdata: 使用指针值的哈希
- * - String/Table/Function/Userdata/Thread: 使用GC对象指针的哈希
+ * - Number: luaHashNumber（+0/-0 归一化后乘法折叠）
+ * - LightUserdata: luaHashPointer
+ * - String: GCString 预计算的带种子哈希
+ * - Table/Function/Userdata/Thread: 对象指针的 luaHashPointer
  */
 struct ValueHash {
     usize operator()(const Value& val) const noexcept;
@@ -107,7 +108,7 @@ public:
      * 释放表占用的内存。注意：表中引用的GC对象由GC系统管理，
      * 这里不需要手动释放。
      */
-    ~Table() override;
+    ~Table();
 
     // =====================================================================
     // 基本操作
@@ -291,7 +292,7 @@ public:
      * - 线程对象
      * - 元表
      */
-    void mark(GarbageCollector& gc) override;
+    void mark(GarbageCollector& gc);
 
     /**
      * @brief 按弱表模式标记表内容
@@ -301,6 +302,13 @@ public:
      */
     void markContents(GarbageCollector& gc, bool weakKeys, bool weakValues);
 
+    /**
+     * @brief 预取数组与哈希节点存储的首个缓存行
+     *
+     * 表入灰栈时调用；遍历通常紧随其后，预取可隐藏槽数组的首次未命中。
+     */
+    void prefetchContents() const noexcept;
+
     /**
      * @brief 清理弱表中指向死亡对象的条目
      *
@@ -318,7 +326,7 @@ public:
      *
      * @return 表占用的字节数
      */
-    usize getSize() const override;
+    usize getSize() const;
 
     // =====================================================================
     // 调试和统计
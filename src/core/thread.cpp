@@ -17,16 +17,21 @@
 #include "runtime/runtime_services.hpp"
 #include "gc/garbage_collector.hpp"
 #include "common/lua_error.hpp"
+#include "vm/state/call_info.hpp"
 #if LUA_CPP_ENABLE_DEBUGGER
 #include "debugger/debug_runtime.hpp"
 #endif
 #include <algorithm>
+#include <exception>
+#include <limits>
 #include <utility>
 
 namespace Lua {
 
+static_assert(MAX_STACK_SIZE <= std::numeric_limits<u32>::max(), "ResumeContext stores stack slots as u32");
+
 void LuaStateOwnerDeleter::operator()(LuaState* state) const noexcept {
-    if (ownsState) {
+    if (state != nullptr && state->isChildThread()) {
         LuaState::destroyState(state);
     }
 }
@@ -41,14 +46,30 @@ Thread::Thread(LuaStateOwner state)
 }
 
 Thread::Thread(LuaState* mainState)
-    : GCObject(GCObjectType::Thread), state_(mainState, LuaStateOwnerDeleter{false}),
-      coStatus_(CoroutineStatus::Running) {
+    : GCObject(GCObjectType::Thread), state_(mainState), coStatus_(CoroutineStatus::Running) {
     if (mainState == nullptr) {
         throw std::invalid_argument("main thread facade requires a state");
     }
 }
 
-Thread::~Thread() = default;
+/**
+ * @brief 恢复过的协程把状态交回全局状态的复用池
+ *
+ * 从未恢复过的协程（包括创建事务回滚的协程）直接释放状态，使内存不足时的回滚真正归还内存。
+ */
+Thread::~Thread() {
+    if (ownsLuaState() && !firstResume_ && state_->getGlobalState().recycleThreadState(state_.get())) {
+        (void)state_.release();
+    }
+}
+
+bool Thread::ownsLuaState() const noexcept {
+    return state_ != nullptr && state_->isChildThread();
+}
+
+Thread* Thread::getCaller() const noexcept {
+    return callerState_ != nullptr ? callerState_->getThread() : nullptr;
+}
 
 // =====================================================================
 // 工厂方法
@@ -86,320 +107,396 @@ Thread* Thread::create(LuaState* parentL) {
 /** @brief 协程恢复的核心逻辑。 */
 // =====================================================================
 
-bool Thread::resume(LuaState* callerL, i32 nargs) {
-    if (callerL == nullptr) {
-        return false;
+void Thread::clearCallerSlots(usize begin, usize end) noexcept {
+    Stack& callerStack = resume_.callerL->getStack();
+    const usize clearEnd = std::min(end, callerStack.size());
+    for (usize slot = begin; slot < clearEnd; ++slot) {
+        callerStack[slot] = Value();
     }
+}
 
-    const usize callerTop = callerL->getAbsoluteTop();
-    const bool validArgumentCount = nargs >= 0 && static_cast<usize>(nargs) <= callerTop;
-    const usize callerResultBase = validArgumentCount ? callerTop - static_cast<usize>(nargs) : callerTop;
-    GlobalState& globalState = callerL->getGlobalState();
-    Thread* callerThread = callerL->getThread();
-    Thread* previousRunningThread = globalState.getRunningThread();
-    const CoroutineStatus previousCallerStatus =
-        callerThread != nullptr ? callerThread->coStatus_ : CoroutineStatus::Dead;
-    bool callerStatusChanged = false;
-    bool callerLinksChanged = false;
-    bool yieldPermissionAdded = false;
+/**
+ * @brief 在配置的 Lua 分配器拒绝全部请求时仍能发布失败响应。
+ *
+ * 正常情况下，调用者的调用帧已拥有这些栈槽，因此无需调用分配器即可写入。
+ */
+bool Thread::publishPairNoThrow(bool success, const Value& value) noexcept {
+    LuaState* callerL = resume_.callerL;
     Stack& callerStack = callerL->getStack();
+    const usize callerResultBase = resume_.callerResultBase;
+    callerL->setAbsoluteTop(callerResultBase);
+    if (callerResultBase <= callerStack.size() && callerStack.size() - callerResultBase >= 2) {
+        callerStack[callerResultBase] = Value(success);
+        callerStack[callerResultBase + 1] = value;
+        const usize publishedTop = callerResultBase + 2;
+        clearCallerSlots(publishedTop, resume_.callerTop);
+        callerL->setAbsoluteTop(publishedTop);
+        return true;
+    }
 
-    auto clearCallerSlots = [&](usize begin, usize end) noexcept {
-        const usize clearEnd = std::min(end, callerStack.size());
-        for (usize slot = begin; slot < clearEnd; ++slot) {
-            callerStack[slot] = Value();
-        }
-    };
-
-    /**
-     * @brief 在配置的 Lua 分配器拒绝全部请求时仍能发布失败响应。
-     *
-     * 正常情况下，调用者的调用帧已拥有这些栈槽，因此无需调用分配器即可写入。
-     */
-    auto publishPairNoThrow = [&](bool success, const Value& value) noexcept {
-        callerL->setAbsoluteTop(callerResultBase);
-        if (callerResultBase <= callerStack.size() && callerStack.size() - callerResultBase >= 2) {
-            callerStack[callerResultBase] = Value(success);
-            callerStack[callerResultBase + 1] = value;
-            const usize publishedTop = callerResultBase + 2;
-            clearCallerSlots(publishedTop, callerTop);
-            callerL->setAbsoluteTop(publishedTop);
-            return true;
-        }
-
-        const usize previousStackTop = callerStack.size();
+    const usize previousStackTop = callerStack.size();
+    try {
+        callerL->pushBoolean(success);
+        callerL->pushValue(value);
+    } catch (...) {
         try {
-            callerL->pushBoolean(success);
-            callerL->pushValue(value);
+            callerStack.setTop(previousStackTop);
         } catch (...) {
-            try {
-                callerStack.setTop(previousStackTop);
-            } catch (...) {
-                /** @brief 缩小到已保存的物理栈顶无需分配内存。 */
-            }
-            clearCallerSlots(callerResultBase, std::max(callerTop, callerResultBase + 2));
-            callerL->setAbsoluteTop(callerResultBase);
-            return false;
+            /** @brief 缩小到已保存的物理栈顶无需分配内存。 */
         }
+        clearCallerSlots(callerResultBase, std::max<usize>(resume_.callerTop, callerResultBase + 2));
+        callerL->setAbsoluteTop(callerResultBase);
+        return false;
+    }
 
-        const usize publishedTop = callerResultBase + 2;
-        clearCallerSlots(publishedTop, callerTop);
-        callerL->setAbsoluteTop(publishedTop);
-        return true;
-    };
+    const usize publishedTop = callerResultBase + 2;
+    clearCallerSlots(publishedTop, resume_.callerTop);
+    callerL->setAbsoluteTop(publishedTop);
+    return true;
+}
 
-    auto restoreCallerContext = [&]() noexcept {
-        if (yieldPermissionAdded) {
-            state_->decAllowYield();
-            yieldPermissionAdded = false;
-        }
-        if (callerStatusChanged && callerThread != nullptr) {
-            callerThread->coStatus_ = previousCallerStatus;
-            callerStatusChanged = false;
-        }
-        globalState.setRunningThread(previousRunningThread);
-        if (callerLinksChanged) {
-            caller_ = nullptr;
-            callerState_ = nullptr;
-            callerLinksChanged = false;
-        }
-    };
+void Thread::restoreCallerContext() noexcept {
+    Thread* callerThread = resume_.callerL->getThread();
+    if (resume_.yieldPermissionAdded) {
+        state_->decAllowYield();
+        resume_.yieldPermissionAdded = false;
+    }
+    if (resume_.callerStatusChanged && callerThread != nullptr) {
+        callerThread->coStatus_ = resume_.previousCallerStatus;
+        resume_.callerStatusChanged = false;
+    }
+    resume_.callerL->getGlobalState().setRunningThread(resume_.previousRunningThread);
+    if (resume_.callerLinksChanged) {
+        callerState_ = nullptr;
+        resume_.callerLinksChanged = false;
+    }
+}
 
-    auto failResume = [&](const Value& errorValue, ThreadStatus status, bool canonicalizeCoroutine) noexcept {
-        restoreCallerContext();
-        if (canonicalizeCoroutine) {
-            abortResume(status);
-        } else {
-            state_->setStatus(status);
-        }
+bool Thread::failWith(const Value& errorValue, ThreadStatus status, bool canonicalizeCoroutine) noexcept {
+    restoreCallerContext();
+    if (canonicalizeCoroutine) {
+        abortResume(status);
+    } else {
+        state_->setStatus(status);
+    }
 
-        if (!publishPairNoThrow(false, errorValue)) {
-            /**
-             * @brief 调用者的两个预留结果槽均不可用时，无法表示 Lua 结果。
-             *
-             * 即便如此，也要保持每项运行时状态规范，并在边界内消化 C++ 分配失败。
-             */
-            callerL->setAbsoluteTop(callerResultBase);
-        }
-        return false;
-    };
+    if (!publishPairNoThrow(false, errorValue)) {
+        /**
+         * @brief 调用者的两个预留结果槽均不可用时，无法表示 Lua 结果。
+         *
+         * 即便如此，也要保持每项运行时状态规范，并在边界内消化 C++ 分配失败。
+         */
+        resume_.callerL->setAbsoluteTop(resume_.callerResultBase);
+    }
+    return false;
+}
+
+bool Thread::failMemory() noexcept {
+    return failWith(Value(resume_.callerL->getGlobalState().getMemoryErrorMessage()), ThreadStatus::ErrMem, true);
+}
 
-    auto failMemory = [&]() noexcept {
-        return failResume(Value(globalState.getMemoryErrorMessage()), ThreadStatus::ErrMem, true);
-    };
+bool Thread::failRuntimeValue(const Value& errorValue, bool canonicalizeCoroutine) noexcept {
+    if (canonicalizeCoroutine) {
+        return failWith(errorValue, ThreadStatus::ErrRun, true);
+    }
 
-    auto failRuntimeValue = [&](const Value& errorValue, bool canonicalizeCoroutine) noexcept {
-        if (canonicalizeCoroutine) {
-            return failResume(errorValue, ThreadStatus::ErrRun, true);
-        }
+    restoreCallerContext();
+    state_->setStatus(ThreadStatus::ErrRun);
+    coStatus_ = CoroutineStatus::Dead;
+    if (!publishPairNoThrow(false, errorValue)) {
+        resume_.callerL->setAbsoluteTop(resume_.callerResultBase);
+    }
+    return false;
+}
 
-        restoreCallerContext();
-        state_->setStatus(ThreadStatus::ErrRun);
-        coStatus_ = CoroutineStatus::Dead;
-        if (!publishPairNoThrow(false, errorValue)) {
-            callerL->setAbsoluteTop(callerResultBase);
-        }
+bool Thread::failRuntimeMessage(CharPtr message, bool canonicalizeCoroutine) noexcept {
+    GlobalState& globalState = resume_.callerL->getGlobalState();
+    try {
+        return failRuntimeValue(Value(globalState.getStringPool().intern(message)), canonicalizeCoroutine);
+    } catch (...) {
+        return failRuntimeValue(Value(globalState.getApiExceptionMessage()), canonicalizeCoroutine);
+    }
+}
+
+bool Thread::failMessage(CharPtr message, bool canonicalizeCoroutine) noexcept {
+    GlobalState& globalState = resume_.callerL->getGlobalState();
+    try {
+        Value errorValue(globalState.getStringPool().intern(message));
+        return failWith(errorValue, ThreadStatus::ErrRun, canonicalizeCoroutine);
+    } catch (...) {
+        return failWith(Value(globalState.getApiExceptionMessage()), ThreadStatus::ErrRun, canonicalizeCoroutine);
+    }
+}
+
+bool Thread::canSwitchResume(const LuaState* callerL) const noexcept {
+    if (coStatus_ != CoroutineStatus::Suspended || !ownsLuaState() || callerL == nullptr) {
+        return false;
+    }
+    if (callerL->getDebugHookMask() != 0 || state_->getDebugHookMask() != 0) {
+        return false;
+    }
+    /** @brief 续延 C 帧需要由原生恢复逐层重入，调度循环无法直接接管。 */
+    if (state_->hasContinuationFrames()) {
+        return false;
+    }
+#if LUA_CPP_ENABLE_DEBUGGER
+    if (state_->getGlobalState().getDebugController() != nullptr) {
         return false;
-    };
+    }
+#endif
 
-    auto failRuntimeMessage = [&](CharPtr message, bool canonicalizeCoroutine) noexcept {
-        try {
-            return failRuntimeValue(Value(globalState.getStringPool().intern(message)), canonicalizeCoroutine);
-        } catch (...) {
-            return failRuntimeValue(Value(globalState.getApiExceptionMessage()), canonicalizeCoroutine);
-        }
-    };
+    Stack& stack = state_->getStack();
+    if (firstResume_) {
+        return state_->getAbsoluteTop() > 1 && stack.at(1).isFunction() && stack.at(1).asFunction()->isLuaFunction();
+    }
 
-    auto failMessage = [&](CharPtr message, bool canonicalizeCoroutine) noexcept {
-        try {
-            Value errorValue(globalState.getStringPool().intern(message));
-            return failResume(errorValue, ThreadStatus::ErrRun, canonicalizeCoroutine);
-        } catch (...) {
-            return failResume(Value(globalState.getApiExceptionMessage()), ThreadStatus::ErrRun, canonicalizeCoroutine);
-        }
-    };
+    /** @brief 挂起现场是 yield 的 C 帧，其下必须是 Lua 帧。 */
+    const usize current = state_->getCurrentCI();
+    if (current < 2 || state_->getStatus() != ThreadStatus::Yield) {
+        return false;
+    }
+    const CallInfo& suspended = state_->getCallStack()[current - 1];
+    return suspended.func < stack.size() && stack[suspended.func].isFunction() &&
+           stack[suspended.func].asFunction()->isLuaFunction();
+}
+
+bool Thread::beginResume(LuaState* callerL, i32 nargs) noexcept {
+    if (callerL == nullptr) {
+        return false;
+    }
+
+    const usize callerTop = callerL->getAbsoluteTop();
+    const bool validArgumentCount = nargs >= 0 && static_cast<usize>(nargs) <= callerTop;
+    Thread* callerThread = callerL->getThread();
+    ResumeContext request;
+    request.callerL = callerL;
+    request.callerTop = static_cast<u32>(callerTop);
+    request.callerResultBase = static_cast<u32>(validArgumentCount ? callerTop - static_cast<usize>(nargs) : callerTop);
+    request.previousRunningThread = callerL->getGlobalState().getRunningThread();
+    request.previousCallerStatus = callerThread != nullptr ? callerThread->coStatus_ : CoroutineStatus::Dead;
+
+    if (coStatus_ == CoroutineStatus::Running || coStatus_ == CoroutineStatus::Normal) {
+        /** @brief 正在进行的恢复仍需要自己的调用者现场，失败响应只借用它。 */
+        const ResumeContext active = std::exchange(resume_, request);
+        failMessage(coStatus_ == CoroutineStatus::Running ? "cannot resume running coroutine"
+                                                          : "cannot resume non-suspended coroutine",
+                    false);
+        resume_ = active;
+        return false;
+    }
+    resume_ = request;
 
     if (!validArgumentCount) {
-        return failMessage("invalid resume argument count", false);
+        failMessage("invalid resume argument count", false);
+        return false;
     }
     if (coStatus_ == CoroutineStatus::Dead) {
-        return failMessage("cannot resume dead coroutine", false);
+        failMessage("cannot resume dead coroutine", false);
+        return false;
     }
-    if (coStatus_ == CoroutineStatus::Running) {
-        return failMessage("cannot resume running coroutine", false);
+    /** @brief 调度器挂起的任务只能由调度器恢复，否则它会在休眠或等待中被耗尽或结束。 */
+    if (callerL->getGlobalState().getScheduler().isSuspendedTask(this)) {
+        failMessage("cannot resume a coroutine suspended by the scheduler", false);
+        return false;
     }
     if (firstResume_) {
         Stack& stack = state_->getStack();
         if (state_->getAbsoluteTop() <= 1 || !stack.at(1).isFunction()) {
-            return failMessage("cannot resume coroutine without an entry function", true);
+            failMessage("cannot resume coroutine without an entry function", true);
+            return false;
         }
         Function* entry = stack.at(1).asFunction();
         if (entry == nullptr || entry->isCFunction()) {
-            return failMessage("cannot resume a C function as coroutine entry", true);
+            failMessage("cannot resume a C function as coroutine entry", true);
+            return false;
         }
     }
 
     try {
-        /**
-         * @brief 将参数从 callerL 复制到协程。
-         *
-         * 所有复制均成功前不要消费调用者参数，以便失败路径拥有稳定的基准位置。
-         */
-        if (nargs > 0) {
-            Stack& sourceStack = callerL->getStack();
-            for (usize i = callerResultBase; i < callerTop; ++i) {
-                state_->pushValue(sourceStack.at(i));
-            }
-        }
-        clearCallerSlots(callerResultBase, callerTop);
-        callerL->setAbsoluteTop(callerResultBase);
+        prepareResume();
+        return true;
+    } catch (...) {
+        failResume(std::current_exception());
+        return false;
+    }
+}
 
-        Proto* proto = nullptr;
-        if (firstResume_) {
-            Stack& stack = state_->getStack();
-            constexpr usize functionPosition = 1;
-            Function* function = stack.at(functionPosition).asFunction();
-            proto = function->getProto();
-            if (proto == nullptr) {
-                throw RuntimeError("coroutine entry has no prototype");
-            }
-            const i32 parameterCount = proto->getNumParams();
-
-            usize base = functionPosition + 1;
-            if (proto->isVararg()) {
-                i32 actualArguments = nargs;
-                const usize oldBase = functionPosition + 1;
-                while (actualArguments < parameterCount) {
-                    stack.push(Value());
-                    ++actualArguments;
-                }
-                base = oldBase + static_cast<usize>(actualArguments);
-                stack.checkSpace(static_cast<usize>(parameterCount) + 1);
-                for (i32 i = 0; i < parameterCount; ++i) {
-                    stack.push(stack[oldBase + static_cast<usize>(i)]);
-                    stack[oldBase + static_cast<usize>(i)] = Value();
-                }
-            } else {
-                i32 actualArguments = nargs;
-                while (actualArguments < parameterCount) {
-                    stack.push(Value());
-                    ++actualArguments;
-                }
-            }
+void Thread::prepareResume() {
+    LuaState* callerL = resume_.callerL;
+    const usize callerResultBase = resume_.callerResultBase;
+    const usize callerTop = resume_.callerTop;
+    const i32 nargs = static_cast<i32>(callerTop - callerResultBase);
+    GlobalState& globalState = callerL->getGlobalState();
+    Thread* callerThread = callerL->getThread();
+
+    /**
+     * @brief 将参数从 callerL 复制到协程。
+     *
+     * 所有复制均成功前不要消费调用者参数，以便失败路径拥有稳定的基准位置。
+     */
+    if (nargs > 0) {
+        Stack& sourceStack = callerL->getStack();
+        for (usize i = callerResultBase; i < callerTop; ++i) {
+            state_->pushValue(sourceStack.at(i));
+        }
+    }
+    clearCallerSlots(callerResultBase, callerTop);
+    callerL->setAbsoluteTop(callerResultBase);
 
-            CallInfo& callInfo = state_->pushCallInfo();
-            callInfo.func = functionPosition;
-            callInfo.base = base;
-            callInfo.top = base + proto->getMaxStackSize();
-            callInfo.nresults = MULTRET;
-            callInfo.savedpc = nullptr;
-            callInfo.tailcalls = 0;
+    if (firstResume_) {
+        Stack& stack = state_->getStack();
+        constexpr usize functionPosition = 1;
+        Function* function = stack.at(functionPosition).asFunction();
+        Proto* proto = function->getProto();
+        if (proto == nullptr) {
+            throw RuntimeError("coroutine entry has no prototype");
+        }
+        const i32 parameterCount = proto->getNumParams();
 
-            while (stack.size() < callInfo.top) {
+        usize base = functionPosition + 1;
+        if (proto->isVararg()) {
+            i32 actualArguments = nargs;
+            const usize oldBase = functionPosition + 1;
+            while (actualArguments < parameterCount) {
                 stack.push(Value());
+                ++actualArguments;
             }
-            const usize registerClearEnd =
-                proto->isVararg() ? callInfo.top : std::max(callInfo.top, base + static_cast<usize>(nargs));
-            for (usize slot = base + static_cast<usize>(parameterCount); slot < registerClearEnd; ++slot) {
-                stack[slot] = Value();
+            base = oldBase + static_cast<usize>(actualArguments);
+            stack.checkSpace(static_cast<usize>(parameterCount) + 1);
+            for (i32 i = 0; i < parameterCount; ++i) {
+                stack.push(stack[oldBase + static_cast<usize>(i)]);
+                stack[oldBase + static_cast<usize>(i)] = Value();
             }
-            if (stack.size() > callInfo.top) {
-                stack.setTop(callInfo.top);
+        } else {
+            i32 actualArguments = nargs;
+            while (actualArguments < parameterCount) {
+                stack.push(Value());
+                ++actualArguments;
             }
-            state_->setAbsoluteTop(callInfo.top);
+        }
 
-            VM::detail::dispatchCallHook(state_.get());
+        CallInfo& callInfo = state_->pushCallInfo();
+        callInfo.func = functionPosition;
+        callInfo.base = base;
+        callInfo.top = base + proto->getMaxStackSize();
+        callInfo.nresults = MULTRET;
+        callInfo.savedpc = nullptr;
+        callInfo.tailcalls = 0;
 
-            firstResume_ = false;
-            savedNexeccalls_ = 1;
-        } else {
-            /** @brief 恢复参数替换暂停的挂起调用结果。 */
-            CallInfo& yieldCallInfo = state_->getCurrentCallInfo();
-            const usize functionPosition = yieldCallInfo.func;
-            const i32 wantedResults = yieldCallInfo.nresults;
-            state_->popCallInfo();
+        while (stack.size() < callInfo.top) {
+            stack.push(Value());
+        }
+        const usize registerClearEnd =
+            proto->isVararg() ? callInfo.top : std::max(callInfo.top, base + static_cast<usize>(nargs));
+        for (usize slot = base + static_cast<usize>(parameterCount); slot < registerClearEnd; ++slot) {
+            stack[slot] = Value();
+        }
+        if (stack.size() > callInfo.top) {
+            stack.setTop(callInfo.top);
+        }
+        state_->setAbsoluteTop(callInfo.top);
+
+        VM::detail::dispatchCallHook(state_.get());
+
+        firstResume_ = false;
+        savedNexeccalls_ = 1;
+    } else if (state_->getCurrentCallInfo().continuation != nullptr) {
+        /** @brief lua_yieldk 挂起的 C 帧保留在栈上，恢复参数留在其栈顶交给续延。 */
+    } else {
+        /** @brief 恢复参数替换暂停的挂起调用结果。 */
+        CallInfo& yieldCallInfo = state_->getCurrentCallInfo();
+        const usize functionPosition = yieldCallInfo.func;
+        const i32 wantedResults = yieldCallInfo.nresults;
+        state_->popCallInfo();
 
-            Stack& stack = state_->getStack();
-            const usize sourceTop = state_->getAbsoluteTop();
-            const usize argumentStart = sourceTop - static_cast<usize>(nargs);
-            const usize argumentCount = static_cast<usize>(nargs);
-            if (functionPosition > argumentStart && functionPosition < sourceTop) {
-                for (usize i = argumentCount; i > 0; --i) {
-                    stack.at(functionPosition + i - 1) = stack.at(argumentStart + i - 1);
-                }
-            } else {
-                for (usize i = 0; i < argumentCount; ++i) {
-                    stack.at(functionPosition + i) = stack.at(argumentStart + i);
-                }
+        Stack& stack = state_->getStack();
+        const usize sourceTop = state_->getAbsoluteTop();
+        const usize argumentStart = sourceTop - static_cast<usize>(nargs);
+        const usize argumentCount = static_cast<usize>(nargs);
+        if (functionPosition > argumentStart && functionPosition < sourceTop) {
+            for (usize i = argumentCount; i > 0; --i) {
+                stack.at(functionPosition + i - 1) = stack.at(argumentStart + i - 1);
+            }
+        } else {
+            for (usize i = 0; i < argumentCount; ++i) {
+                stack.at(functionPosition + i) = stack.at(argumentStart + i);
             }
+        }
 
-            const bool fixedResults = wantedResults >= 0;
-            if (fixedResults) {
-                for (usize i = argumentCount; i < static_cast<usize>(wantedResults); ++i) {
-                    stack.at(functionPosition + i) = Value();
-                }
+        const bool fixedResults = wantedResults >= 0;
+        if (fixedResults) {
+            for (usize i = argumentCount; i < static_cast<usize>(wantedResults); ++i) {
+                stack.at(functionPosition + i) = Value();
             }
+        }
 
-            const usize logicalResultTop =
-                functionPosition + (fixedResults ? static_cast<usize>(wantedResults) : argumentCount);
-            const usize copiedResultTop = functionPosition + argumentCount;
-            for (usize slot = logicalResultTop; slot < copiedResultTop; ++slot) {
+        const usize logicalResultTop =
+            functionPosition + (fixedResults ? static_cast<usize>(wantedResults) : argumentCount);
+        const usize copiedResultTop = functionPosition + argumentCount;
+        for (usize slot = logicalResultTop; slot < copiedResultTop; ++slot) {
+            stack[slot] = Value();
+        }
+        for (usize slot = argumentStart; slot < sourceTop; ++slot) {
+            if (slot < functionPosition || slot >= logicalResultTop) {
                 stack[slot] = Value();
             }
-            for (usize slot = argumentStart; slot < sourceTop; ++slot) {
-                if (slot < functionPosition || slot >= logicalResultTop) {
-                    stack[slot] = Value();
-                }
-            }
-            state_->setAbsoluteTop(logicalResultTop);
+        }
+        state_->setAbsoluteTop(logicalResultTop);
 
-            CallInfo& callInfo = state_->getCurrentCallInfo();
-            const usize physicalTop = std::max(callInfo.top, logicalResultTop);
-            if (stack.size() > physicalTop) {
-                stack.setTop(physicalTop);
-            }
+        CallInfo& callInfo = state_->getCurrentCallInfo();
+        const usize physicalTop = std::max(callInfo.top, logicalResultTop);
+        if (stack.size() > physicalTop) {
+            stack.setTop(physicalTop);
+        }
+        /**
+         * @brief 挂起的函数由 lua_callk 直接调用时，结果按 C API 约定留在调用方 C 帧栈顶，
+         * 由其续延接收；否则回到 Lua 帧，固定结果数时栈顶还原为帧顶。
+         */
+        if (callInfo.continuation == nullptr) {
             if (fixedResults) {
                 state_->setAbsoluteTop(callInfo.top);
             }
             Function* function = state_->getStack().at(callInfo.func).asFunction();
-            proto = function != nullptr ? function->getProto() : nullptr;
-            if (proto == nullptr) {
+            if (function == nullptr || function->getProto() == nullptr) {
                 throw RuntimeError("suspended coroutine has no Lua frame");
             }
         }
+    }
 
-        if (callerThread != nullptr) {
-            callerThread->coStatus_ = CoroutineStatus::Normal;
-            callerStatusChanged = true;
-        }
-        caller_ = callerThread;
-        callerState_ = callerL;
-        callerLinksChanged = true;
-        coStatus_ = CoroutineStatus::Running;
-        state_->setStatus(ThreadStatus::OK);
-        state_->incAllowYield();
-        yieldPermissionAdded = true;
-        globalState.setRunningThread(this);
+    if (callerThread != nullptr) {
+        callerThread->coStatus_ = CoroutineStatus::Normal;
+        resume_.callerStatusChanged = true;
+    }
+    callerState_ = callerL;
+    resume_.callerLinksChanged = true;
+    coStatus_ = CoroutineStatus::Running;
+    state_->setStatus(ThreadStatus::OK);
+    state_->incAllowYield();
+    state_->setYieldableHostDepth(state_->getHostCallDepth());
+    resume_.yieldPermissionAdded = true;
+    globalState.setRunningThread(this);
 
 #if LUA_CPP_ENABLE_DEBUGGER
-        if (Debugger::DebugController* debugger = globalState.getDebugController();
-            debugger != nullptr &&
-            debugger->semanticSafepoint(*state_, Debugger::DebugSemanticEvent::CoroutineResume) ==
-                Debugger::DebugSafepointResult::TerminateExecution) [[unlikely]] {
-            throw RuntimeError("debugger requested execution termination");
-        }
+    if (Debugger::DebugController* debugger = globalState.getDebugController();
+        debugger != nullptr &&
+        debugger->semanticSafepoint(*state_, Debugger::DebugSemanticEvent::CoroutineResume) ==
+            Debugger::DebugSafepointResult::TerminateExecution) [[unlikely]] {
+        throw RuntimeError("debugger requested execution termination");
+    }
 #endif
+}
 
-        RuntimeServices services(state_->getGlobalState());
-        const ExecResult result = VM::executeProto(services, state_.get(), proto, savedNexeccalls_);
-        restoreCallerContext();
+bool Thread::finishResume(ExecResult result) noexcept {
+    restoreCallerContext();
 
+    LuaState* callerL = resume_.callerL;
+    try {
         Stack& coroutineStack = state_->getStack();
         usize resultStart = 0;
         usize resultCount = 0;
         if (result == ExecResult::Yielded) {
 #if LUA_CPP_ENABLE_DEBUGGER
-            if (Debugger::DebugController* debugger = globalState.getDebugController();
+            if (Debugger::DebugController* debugger = callerL->getGlobalState().getDebugController();
                 debugger != nullptr &&
                 debugger->semanticSafepoint(*state_, Debugger::DebugSemanticEvent::CoroutineYield) ==
                     Debugger::DebugSafepointResult::TerminateExecution) [[unlikely]] {
@@ -426,17 +523,29 @@ bool Thread::resume(LuaState* callerL, i32 nargs) {
             resultCount = resultTop - resultStart;
         }
 
-        callerL->setAbsoluteTop(callerResultBase);
+        callerL->setAbsoluteTop(resume_.callerResultBase);
         callerL->pushBoolean(true);
         for (usize i = 0; i < resultCount; ++i) {
             callerL->pushValue(coroutineStack.at(resultStart + i));
         }
         const usize publishedTop = callerL->getAbsoluteTop();
-        clearCallerSlots(publishedTop, callerTop);
+        clearCallerSlots(publishedTop, resume_.callerTop);
         for (usize i = 0; i < resultCount; ++i) {
             coroutineStack[resultStart + i] = Value();
         }
+        /** @brief lua_yieldk 的 C 帧留在栈上等待续延，挂起值已交给调用者，从其栈顶移除。 */
+        if (result == ExecResult::Yielded && state_->getCurrentCallInfo().continuation != nullptr) {
+            state_->setAbsoluteTop(resultStart);
+        }
         return true;
+    } catch (...) {
+        return failResume(std::current_exception());
+    }
+}
+
+bool Thread::failResume(std::exception_ptr error) noexcept {
+    try {
+        std::rethrow_exception(error);
     } catch (const MemoryError&) {
         return failMemory();
     } catch (const std::bad_alloc&) {
@@ -455,8 +564,29 @@ bool Thread::resume(LuaState* callerL, i32 nargs) {
          */
         return failRuntimeMessage(error.what(), true);
     } catch (...) {
-        return failRuntimeValue(Value(globalState.getApiExceptionMessage()), true);
+        return failRuntimeValue(Value(resume_.callerL->getGlobalState().getApiExceptionMessage()), true);
+    }
+}
+
+bool Thread::resume(LuaState* callerL, i32 nargs) {
+    if (!beginResume(callerL, nargs)) {
+        return false;
+    }
+
+    ExecResult result = ExecResult::Returned;
+    try {
+        RuntimeServices services(state_->getGlobalState());
+        if (state_->hasContinuationFrames()) {
+            result = VM::detail::resumeContinuations(services, state_.get());
+        } else {
+            const CallInfo& callInfo = state_->getCurrentCallInfo();
+            Proto* proto = state_->getStack().at(callInfo.func).asFunction()->getProto();
+            result = VM::executeProto(services, state_.get(), proto, savedNexeccalls_);
+        }
+    } catch (...) {
+        return failResume(std::current_exception());
     }
+    return finishResume(result);
 }
 
 void Thread::abortResume(ThreadStatus status) noexcept {
@@ -490,13 +620,13 @@ void Thread::abortResume(ThreadStatus status) noexcept {
     firstResume_ = false;
     savedNexeccalls_ = 1;
 
+    Thread* caller = getCaller();
     if (state_->getGlobalState().getRunningThread() == this) {
-        state_->getGlobalState().setRunningThread(caller_);
+        state_->getGlobalState().setRunningThread(caller);
     }
-    if (caller_ != nullptr && caller_->coStatus_ == CoroutineStatus::Normal) {
-        caller_->coStatus_ = CoroutineStatus::Running;
+    if (caller != nullptr && caller->coStatus_ == CoroutineStatus::Normal) {
+        caller->coStatus_ = CoroutineStatus::Running;
     }
-    caller_ = nullptr;
     callerState_ = nullptr;
 }
 
@@ -507,7 +637,7 @@ void Thread::abortResume(ThreadStatus status) noexcept {
 void Thread::mark(GarbageCollector& gc) {
     gc.markState(state_.get());
     gc.markState(callerState_);
-    gc.markObject(caller_);
+    gc.markObject(getCaller());
 }
 
 usize Thread::getSize() const {
@@ -518,4 +648,81 @@ usize Thread::getSize() const {
            state_->getCallStack().capacity() * sizeof(CallInfo);
 }
 
+// =====================================================================
+// 协程库的 resume / yield 入口
+// =====================================================================
+
+i32 coroutineResume(LuaState* L) {
+    i32 totalArgs = L->getTop();
+    if (totalArgs < 1 || !L->at(1).isThread()) {
+        L->error("bad argument #1 to 'resume' (coroutine expected)");
+    }
+
+    // Thread::resume 从 L 的栈顶传递恢复参数，再将 true/false 与结果压回 L
+    L->at(1).asThread()->resume(L, totalArgs - 1);
+    return collectResumeResults(L, false);
+}
+
+i32 coroutineYield(LuaState* L) {
+    if (!L->canYield()) {
+        L->error("cannot yield across non-resumable call boundaries");
+    }
+
+    i32 nresults = L->getTop(); // 所有参数即 yield 值
+    L->setStatus(ThreadStatus::Yield);
+    L->setYieldResults(nresults);
+    return 0; // C 函数返回 0 — vmPrecall 会检测 Yield 状态
+}
+
+i32 coroutineWrapResume(LuaState* L) {
+    const CallInfo& ci = L->getCurrentCallInfo();
+    Thread* thread = wrappedCoroutine(L, L->getStack()[ci.func].asFunction());
+    if (thread == nullptr) {
+        L->error("cannot resume dead coroutine");
+    }
+
+    // 参数已经在 base .. 栈顶，全部作为恢复参数
+    thread->resume(L, L->getTop());
+    return collectResumeResults(L, true);
+}
+
+i32 collectResumeResults(LuaState* L, bool wrapped) {
+    // resume 的结果紧跟在位置 1 的线程参数之后；wrap 迭代器的参数全部被消费，结果从帧基址开始
+    const usize resultBase = L->getCurrentCallInfo().base + (wrapped ? 0 : 1);
+    const usize resultTop = L->getAbsoluteTop();
+    if (!wrapped) {
+        return static_cast<i32>(resultTop - resultBase);
+    }
+
+    Stack& stack = L->getStack();
+    const Value& okValue = stack.at(resultBase);
+    if (!okValue.isBoolean() || !okValue.asBoolean()) {
+        // 错误：第二个值是错误消息，直接在调用者中抛出
+        L->pushValue(resultTop - resultBase >= 2 ? stack.at(resultBase + 1) : Value());
+        return L->error();
+    }
+
+    // 成功：把 bool 之后的结果值搬到栈帧起点
+    const i32 nresults = static_cast<i32>(resultTop - resultBase) - 1;
+    L->consumeNativeWork(nresults == 0 ? 1 : static_cast<u64>(nresults));
+    for (i32 i = 0; i < nresults; i++) {
+        stack[resultBase + static_cast<usize>(i)] = stack[resultBase + 1 + static_cast<usize>(i)];
+    }
+    stack[resultTop - 1] = Value();
+    L->setAbsoluteTop(resultTop - 1);
+    return nresults;
+}
+
+Thread* wrappedCoroutine(LuaState* L, const Function* iterator) {
+    if (iterator == nullptr || iterator->getCFunction() != coroutineWrapResume) {
+        return nullptr;
+    }
+    Upvalue* upvalue = iterator->getUpvalue(0);
+    if (upvalue == nullptr) {
+        return nullptr;
+    }
+    const Value& value = upvalue->getValue(L->getStack());
+    return value.isThread() ? value.asThread() : nullptr;
+}
+
 } // namespace Lua
@@ -9,12 +9,20 @@
  *   - 所有执行现场保存在 Lua 状态和调用信息中（不依赖 C++ 栈帧）
  *   - 虚拟机通过已挂起执行结果退出执行循环
  *   - 恢复和挂起通过显式值搬运及虚拟机重入实现
+ *
+ * 两种恢复路径：
+ *   - 原生恢复（resume）：从 C 边界（lua_resume、pcall 等宿主调用）进入，嵌套一次 executeProto
+ *   - 切换恢复：Lua 代码以 CALL 调用 coroutine.resume 或 wrap 迭代器时，调度循环用 beginResume
+ *     建立协程调用帧后直接把当前状态换成协程；协程挂起、返回或出错时再用 finishResume /
+ *     failResume 把结果发布给调用者并换回，不占用 C++ 栈
+ *   两者共享同一套调用帧布局，同一协程可交替经两种路径恢复。
  */
 
 #pragma once
 
 #include "core/gc_object.hpp"
 #include "common/types.hpp"
+#include <exception>
 #include <memory>
 
 namespace Lua {
@@ -22,11 +30,13 @@ namespace Lua {
 class LuaState;
 class Function;
 class GarbageCollector;
+class Proto;
+class Value;
 enum class ThreadStatus : u8;
+enum class ExecResult : u8;
 
-/** @brief 按所有权标志销毁 Lua 状态的删除器。 */
+/** @brief 销毁协程状态的删除器；主状态不归线程外观所有，删除器跳过它。 */
 struct LuaStateOwnerDeleter {
-    bool ownsState = true;
     void operator()(LuaState* state) const noexcept;
 };
 
@@ -79,6 +89,45 @@ public:
      */
     bool resume(LuaState* callerL, i32 nargs);
 
+    /**
+     * @brief 切换恢复的前半段：校验状态、搬运参数并建立协程调用帧
+     * @return 成功时为 true；失败时返回 false，此时失败标志与错误已压入 callerL
+     */
+    bool beginResume(LuaState* callerL, i32 nargs) noexcept;
+
+    /**
+     * @brief 协程执行返回或挂起后，恢复调用者现场并向其压入成功标志与结果
+     */
+    bool finishResume(ExecResult result) noexcept;
+
+    /**
+     * @brief 协程执行抛出异常后，恢复调用者现场并向其压入失败标志与错误
+     */
+    bool failResume(std::exception_ptr error) noexcept;
+
+    /**
+     * @brief 能否由调度循环直接切换执行：协程挂起于 Lua 帧、没有待执行的 C 续延，且两侧都没有调试钩子
+     */
+    bool canSwitchResume(const LuaState* callerL) const noexcept;
+
+    /** @brief 协程执行循环应使用的 Lua 调用深度（nexeccalls） */
+    i32 getResumeNexeccalls() const noexcept {
+        return savedNexeccalls_;
+    }
+
+    /** @brief 最近一次恢复的调用者状态；恢复结束后仍保留，供切换恢复换回 */
+    LuaState* getResumeCaller() const noexcept {
+        return resume_.callerL;
+    }
+
+    /** @brief 切换恢复时调用者执行循环的调用深度，换回时还原 */
+    void setResumeCallerNexeccalls(i32 n) noexcept {
+        resume_.callerNexeccalls = n;
+    }
+    i32 getResumeCallerNexeccalls() const noexcept {
+        return resume_.callerNexeccalls;
+    }
+
     /**
      * @brief 宿主或 API 失败后将协程置于规范的死亡状态
      *
@@ -95,9 +144,8 @@ public:
     LuaState* getLuaState() const noexcept {
         return state_.get();
     }
-    bool ownsLuaState() const noexcept {
-        return state_.get_deleter().ownsState;
-    }
+    /** @brief 是否拥有独立的协程状态；主线程外观返回 false */
+    bool ownsLuaState() const noexcept;
     bool isDead() const noexcept {
         return coStatus_ == CoroutineStatus::Dead;
     }
@@ -105,27 +153,79 @@ public:
         return coStatus_ == CoroutineStatus::Suspended;
     }
 
-    // === 恢复链管理 ===
-
-    Thread* getCaller() const noexcept {
-        return caller_;
+    /** @brief 作为调度任务结束；成功标志与结果留在协程栈上供 join 读取 */
+    bool isTaskFinished() const noexcept {
+        return taskFinished_;
     }
-    void setCaller(Thread* t) noexcept {
-        caller_ = t;
+    void setTaskFinished() noexcept {
+        taskFinished_ = true;
     }
 
+    // === 恢复链管理 ===
+
+    /** @brief 正在恢复本协程的协程；由主状态恢复或未在运行时为空指针 */
+    Thread* getCaller() const noexcept;
+
     // === GCObject 接口 ===
 
-    void mark(GarbageCollector& gc) override;
-    usize getSize() const override;
+    void mark(GarbageCollector& gc);
+    usize getSize() const;
 
 private:
+    /**
+     * @brief 一次恢复在调用者一侧需要回滚或发布结果的现场。
+     *
+     * 栈槽索引受 MAX_STACK_SIZE 限制，以 32 位保存，使协程对象留在 96 字节的块池尺寸级别。
+     */
+    struct ResumeContext {
+        LuaState* callerL = nullptr;
+        Thread* previousRunningThread = nullptr;
+        u32 callerTop = 0;
+        u32 callerResultBase = 0;
+        i32 callerNexeccalls = 0;
+        CoroutineStatus previousCallerStatus = CoroutineStatus::Dead;
+        bool callerStatusChanged = false;
+        bool callerLinksChanged = false;
+        bool yieldPermissionAdded = false;
+    };
+
+    void prepareResume();
+    void clearCallerSlots(usize begin, usize end) noexcept;
+    bool publishPairNoThrow(bool success, const Value& value) noexcept;
+    void restoreCallerContext() noexcept;
+    bool failWith(const Value& errorValue, ThreadStatus status, bool canonicalizeCoroutine) noexcept;
+    bool failMemory() noexcept;
+    bool failRuntimeValue(const Value& errorValue, bool canonicalizeCoroutine) noexcept;
+    bool failRuntimeMessage(CharPtr message, bool canonicalizeCoroutine) noexcept;
+    bool failMessage(CharPtr message, bool canonicalizeCoroutine) noexcept;
+
     LuaStateOwner state_;
-    CoroutineStatus coStatus_;
-    Thread* caller_ = nullptr;
+    /** @brief 恢复期间的调用者状态；其协程对象即 getCaller() */
     LuaState* callerState_ = nullptr;
+    CoroutineStatus coStatus_;
     bool firstResume_ = true;
+    bool taskFinished_ = false;
     i32 savedNexeccalls_ = 1;
+    ResumeContext resume_;
 };
 
+/**
+ * @brief coroutine.resume、coroutine.yield 与 wrap 迭代器的 C 入口
+ *
+ * 由协程库注册。VM 在 CALL 中按函数指针识别 coroutineResume 与 coroutineWrapResume，
+ * 满足 Thread::canSwitchResume 时不调用它们，而是在调度循环内切换。
+ */
+i32 coroutineResume(LuaState* L);
+i32 coroutineYield(LuaState* L);
+i32 coroutineWrapResume(LuaState* L);
+
+/**
+ * @brief 恢复结果已压在当前 C 帧的栈顶后，整理出 resume / wrap 迭代器的返回值
+ * @return C 函数返回值数量；wrap 迭代器在协程失败时抛出其错误
+ */
+i32 collectResumeResults(LuaState* L, bool wrapped);
+
+/** @brief wrap 迭代器闭包持有的协程；不是 wrap 迭代器时返回空指针 */
+Thread* wrappedCoroutine(LuaState* L, const Function* iterator);
+
 } // namespace Lua
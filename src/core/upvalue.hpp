@@ -87,7 +87,7 @@ public:
      *
      * @note 上值由垃圾回收器管理，不要手动释放。
      */
-    ~Upvalue() override = default;
+    ~Upvalue() = default;
 
     // ========== 状态查询 ==========
 
@@ -186,13 +186,13 @@ public:
      * - 开放状态：标记自身即可（栈上的值由栈管理）
      * - 关闭状态：标记自身和 closedValue_ 中的垃圾回收对象
      */
-    void mark(GarbageCollector& gc) override;
+    void mark(GarbageCollector& gc);
 
     /**
      * @brief 获取上值对象的大小
      * @return 对象占用的字节数
      */
-    usize getSize() const override;
+    usize getSize() const;
 
     /**
      * @brief 垃圾回收工厂构造函数（开放状态）
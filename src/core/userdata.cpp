@@ -117,6 +117,16 @@ void Userdata::setMetatable(Table* mt) {
     metatable_ = mt;
 }
 
+void Userdata::setExternalSize(usize bytes) noexcept {
+    if (bytes == externalSize_) {
+        return;
+    }
+    externalSize_ = bytes;
+    if (GarbageCollector* gc = getOwnerCollector()) {
+        gc->accountObjectSizeChange(this);
+    }
+}
+
 void Userdata::setEnvironment(Table* environment) {
     if (GarbageCollector* gc = getOwnerCollector()) {
         gc->writeBarrier(this, environment);
@@ -139,8 +149,8 @@ void Userdata::mark(GarbageCollector& gc) {
 }
 
 usize Userdata::getSize() const {
-    // 返回对象本身的大小 + 用户数据大小
-    return getGCAllocationSize(size_);
+    // 返回对象本身的大小 + 用户数据大小 + 载荷外部存储大小
+    return getGCAllocationSize(size_) + externalSize_;
 }
 
 } // namespace Lua
@@ -151,6 +151,19 @@ public:
         return size_;
     }
 
+    /**
+     * @brief 设置载荷在用户数据块之外持有的分配器字节数
+     * @param bytes 当前外部存储的容量（字节）
+     *
+     * 外部字节计入 getSize()，并立即与所属收集器的内存总量与债务对账，
+     * 使可增长的载荷（如 string.buffer）与字符串一样参与回收节奏。
+     */
+    void setExternalSize(usize bytes) noexcept;
+
+    usize getExternalSize() const noexcept {
+        return externalSize_;
+    }
+
     // =====================================================================
     // 元表操作
     // =====================================================================
@@ -192,14 +205,14 @@ public:
      *
      * 标记元表（如果存在）
      */
-    void mark(GarbageCollector& gc) override;
+    void mark(GarbageCollector& gc);
 
     /**
      * @brief 获取用户数据占用的内存大小
      *
-     * @return 对象大小 + 用户数据大小
+     * @return 对象大小 + 用户数据大小 + 外部存储大小
      */
-    usize getSize() const override;
+    usize getSize() const;
 
 public:
     // =====================================================================
@@ -229,6 +242,8 @@ private:
 
     /** @brief 用户数据大小（字节）。 */
     usize size_;
+    /** @brief 载荷在用户数据块之外持有的字节数。 */
+    usize externalSize_ = 0;
     /** @brief 用户数据指针。 */
     BufferPtr data_;
     /** @brief 元表指针。 */
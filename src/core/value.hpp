@@ -216,9 +216,13 @@ public:
 
     /**
      * @brief 检查是否为GC对象（需要垃圾回收的对象）
+     *
+     * 可回收类型在 ValueType 中连续排列（String 至 Thread，见文件末尾的静态断言），
+     * 因此只需一次范围比较；标记循环依赖它快速跳过数字、布尔等槽位。
      */
     bool isCollectable() const {
-        return isString() || isTable() || isFunction() || isUserdata() || isThread();
+        const usize index = value_.index();
+        return index >= static_cast<usize>(ValueType::String) && index <= static_cast<usize>(ValueType::Thread);
     }
 
     // =====================================================================
@@ -4,6 +4,9 @@
  */
 
 #include "gc/garbage_collector.hpp"
+#include "gc/gc_background_free.hpp"
+#include "gc/gc_parallel_mark.hpp"
+#include "gc/gc_slab.hpp"
 #include "core/gc_string.hpp"
 #include "core/string_pool.hpp"
 #include "core/table.hpp"
@@ -57,6 +60,17 @@ usize pausedThreshold(usize liveBytes, i32 pause) noexcept {
     return std::max(kMinimumThreshold, (liveBytes * pausePercent) / 100);
 }
 
+/** @brief 分代步调的下限：小堆上的次要收集间隔与主要收集基线都不低于此值。 */
+constexpr usize kMinimumGenerationalBytes = usize{64} * 1024;
+
+/** @brief 按时间步进时每片的工作单位数，也是两次检查截止时间之间的最大对象数。 */
+constexpr usize kTimedStepSliceUnits = 64;
+
+/** @brief 并行标记的默认堆规模下限：对象更少时线程启动与窃取同步的开销超过收益。 */
+constexpr usize kDefaultParallelMarkThreshold = usize{64} * 1024;
+/** @brief 并行标记线程数上限，防止误传的巨大数值耗尽线程资源。 */
+constexpr usize kMaximumParallelMarkThreads = 256;
+
 usize saturatedStepBytes(u64 scaledKilobytePercent) noexcept {
     constexpr u64 kPercent = 100;
     constexpr usize kBytesPerKilobyte = 1024;
@@ -91,13 +105,18 @@ GarbageCollector::GarbageCollector(LuaAllocator* allocator)
     : allObjects_(nullptr), roots_(LuaStdAllocator<GCObject*>(allocator)),
       grayList_(LuaStdAllocator<GCObject*>(allocator)), weakTables_(LuaStdAllocator<Table*>(allocator)),
       pendingFinalizers_(LuaStdAllocator<Userdata*>(allocator)), externalMarked_(LuaStdAllocator<GCObject*>(allocator)),
-      finalizersRunning_(false), globalState_(nullptr), stringPool_(nullptr), allocator_(allocator),
-      strategy_(&markSweepGCStrategy()), automaticStopped_(false), automaticCollectionRunning_(false),
-      preciseStackRoots_(true), automaticThresholdBytes_(usize{64} * 1024),
+      finalizersRunning_(false), globalState_(nullptr), stringPool_(nullptr), allocator_(allocator), slab_(nullptr),
+      slabAllocationEnabled_(true), parallelMark_(nullptr), parallelMarkThreads_(1),
+      parallelMarkThreshold_(kDefaultParallelMarkThreshold), parallelMarkCycles_(0), heapWalker_(nullptr),
+      allocationSampleCountdown_(std::numeric_limits<isize>::max()), allocationSampleInterval_(0),
+      strategy_(&markSweepGCStrategy()), automaticStopped_(false),
+      automaticCollectionRunning_(false), collectionPending_(false), automaticThresholdBytes_(usize{64} * 1024),
       managedMemoryBudgetBytes_(std::numeric_limits<usize>::max()), gcDebtBytes_(-static_cast<isize>(64 * 1024)),
       stepCountdown_(0), pause_(200), stepMultiplier_(200), incrementalPhase_(IncrementalPhase::Pause),
       incrementalSweepCurrent_(nullptr), incrementalSweepPrevious_(nullptr), incrementalCollected_(0),
-      lastCompletedCollected_(0), objectCount_(0), totalMemory_(0) {}
+      lastCompletedCollected_(0), rememberedSet_(LuaStdAllocator<GCObject*>(allocator)), oldBoundary_(nullptr),
+      generational_(false), generationalMajorPending_(false), minorMultiplier_(20), majorMultiplier_(100),
+      majorBaseBytes_(0), minorCollections_(0), majorCollections_(0), objectCount_(0), totalMemory_(0) {}
 
 GarbageCollector::~GarbageCollector() {
     clearAll();
@@ -115,6 +134,16 @@ GarbageCollector::~GarbageCollector() {
         object->setNext(nullptr);
         destroyObject(object, stringPool);
     }
+
+    /** @brief 迁移到其他收集器的对象仍持有块池中的块，块池在最后一块归还时自行释放。 */
+    if (slab_ != nullptr) {
+        slab_->releaseOwner();
+        slab_ = nullptr;
+    }
+
+    // 在途批次引用宿主分配器的用户数据，必须在收集器返回前全部归还
+    backgroundFree_.reset();
+    parallelMarkPool_.reset();
 }
 
 // =====================================================================
@@ -132,6 +161,7 @@ void GarbageCollector::registerObject(GCObject* obj) {
         owner->unregisterObject(obj);
     }
 
+    obj->setMarked(obj->getMarked() & ~GCBits::OLD);
     obj->setColor(incrementalPhase_ == IncrementalPhase::Pause ? GCColor::White : GCColor::Black);
     obj->setOwnerCollector(this);
 
@@ -156,6 +186,7 @@ void GarbageCollector::registerObject(GCObject* obj) {
     ++objectCount_;
     addLiveBytes(totalMemory_, objectSize);
     addDebt(gcDebtBytes_, objectSize);
+    noteAllocation();
 
     if (incrementalPhase_ != IncrementalPhase::Pause) {
         try {
@@ -203,6 +234,9 @@ void GarbageCollector::unregisterObject(GCObject* obj) noexcept {
     while (current != nullptr) {
         GCObject* next = current->getNext();
         if (current == obj) {
+            if (oldBoundary_ == obj) {
+                oldBoundary_ = next;
+            }
             if (prev == nullptr) {
                 allObjects_ = next;
             } else {
@@ -225,6 +259,7 @@ void GarbageCollector::unregisterObject(GCObject* obj) noexcept {
     }
 
     if (removed || obj->getOwnerCollector() == this) {
+        forgetRememberedObject(obj);
         roots_.erase(std::remove(roots_.begin(), roots_.end(), obj), roots_.end());
         grayList_.erase(std::remove(grayList_.begin(), grayList_.end(), obj), grayList_.end());
         if (obj->getType() == GCObjectType::Table) {
@@ -249,6 +284,7 @@ void GarbageCollector::accountObjectSizeChange(GCObject* obj) noexcept {
         const usize growth = currentSize - previousSize;
         addLiveBytes(totalMemory_, growth);
         addDebt(gcDebtBytes_, growth);
+        noteAllocation();
     } else if (currentSize < previousSize) {
         const usize shrinkage = previousSize - currentSize;
         subtractLiveBytes(totalMemory_, shrinkage);
@@ -257,6 +293,31 @@ void GarbageCollector::accountObjectSizeChange(GCObject* obj) noexcept {
     obj->setAccountedSize(currentSize);
 }
 
+void GarbageCollector::accountRetainedBytes(usize bytes) noexcept {
+    retainedBytes_ += bytes;
+    addLiveBytes(totalMemory_, bytes);
+    addDebt(gcDebtBytes_, bytes);
+    noteAllocation();
+}
+
+void GarbageCollector::releaseRetainedBytes(usize bytes) noexcept {
+    retainedBytes_ -= std::min(retainedBytes_, bytes);
+    subtractLiveBytes(totalMemory_, bytes);
+    subtractDebt(gcDebtBytes_, bytes);
+}
+
+void GarbageCollector::noteAllocation() noexcept {
+    /**
+     * @brief 与 maybeCollectAutomatic 的提前返回条件一一对应。
+     *
+     * 有限的托管预算需要在每个检查点对账，因此即使自动回收已停止也保持置位；
+     * 已开始的周期在每次分配后继续推进，保证清扫游标不会被搁置。
+     */
+    collectionPending_ = managedMemoryBudgetBytes_ != std::numeric_limits<usize>::max() ||
+                         (!automaticStopped_ && (incrementalPhase_ != IncrementalPhase::Pause || gcDebtBytes_ > 0 ||
+                                                 totalMemory_ >= automaticThresholdBytes_));
+}
+
 void GarbageCollector::addRoot(GCObject* obj) {
     if (obj == nullptr) {
         return;
@@ -321,7 +382,10 @@ usize GarbageCollector::collect(LuaState* currentState) {
 
 usize GarbageCollector::collect(StringPool& stringPool, LuaState* currentState) {
     GCContext context{*this, stringPool, currentState};
-    return strategy_->collect(context);
+    const usize collected = strategy_->collect(context);
+    // 显式完整收集返回时，宿主分配器应已收回本轮释放的全部内存与闲置缓存
+    (void)releaseCachedMemory();
+    return collected;
 }
 
 usize GarbageCollector::collectAutomatic(LuaState* currentState) {
@@ -334,19 +398,19 @@ usize GarbageCollector::collectAutomatic(StringPool& stringPool, LuaState* curre
     }
 
     automaticCollectionRunning_ = true;
-    bool previousPreciseStackRoots = preciseStackRoots_;
-    preciseStackRoots_ = false;
     usize collected = 0;
     try {
-        collected = collectMarkSweep(stringPool, currentState, false);
+        collected = generational_ ? collectGenerationalStep(stringPool, currentState, false)
+                                  : collectMarkSweep(stringPool, currentState, false);
     } catch (...) {
         resetIncrementalCycle();
-        preciseStackRoots_ = previousPreciseStackRoots;
         automaticCollectionRunning_ = false;
         throw;
     }
-    preciseStackRoots_ = previousPreciseStackRoots;
     automaticCollectionRunning_ = false;
+    if (generational_) {
+        return collected;
+    }
     const usize liveBytes = refreshMemoryAccounting();
     automaticThresholdBytes_ = pausedThreshold(liveBytes, pause_);
     gcDebtBytes_ = static_cast<isize>(liveBytes) - static_cast<isize>(automaticThresholdBytes_);
@@ -368,9 +432,18 @@ void GarbageCollector::destroyManagedObject(GCObject* obj) noexcept {
 }
 
 usize GarbageCollector::maybeCollectAutomatic(LuaState* currentState) {
+    if (managedMemoryBudgetBytes_ != std::numeric_limits<usize>::max()) {
+        // 判断是否超出预算前先让宿主分配器追平在途释放，内存错误处理看到的存活字节与收集器一致
+        drainBackgroundFree();
+    }
     if (!canAccountManagedBytes()) {
-        throw MemoryError("not enough memory");
+        // 报告内存错误前先交还闲置缓存，仅剩缓存超出预算时不应失败
+        if (!releaseCachedMemory() || !canAccountManagedBytes()) {
+            throw MemoryError("not enough memory");
+        }
     }
+    // 超出预算时保持置位，使后续检查点继续报告内存错误
+    collectionPending_ = false;
     if (automaticStopped_ || automaticCollectionRunning_) {
         return 0;
     }
@@ -378,7 +451,7 @@ usize GarbageCollector::maybeCollectAutomatic(LuaState* currentState) {
     /**
      * @brief 避免在 VM 热路径中遍历整个对象链表，并保证已开始的周期能够完成。
      *
-     * 此处是 SETTABLE、SETLIST 与全局写入的 VM 热路径。垃圾回收对象进出收集器时会增量维护
+     * 此处经 checkAutomatic 由分配型指令进入。垃圾回收对象进出收集器时会增量维护
      * totalMemory_ 与 gcDebtBytes_；在此遍历整个对象链表会使不断增长的字符串或闭包表退化为
      * 二次时间。阈值仅决定何时开始周期，而不决定是否完成周期。清扫可能让内存与债务同时
      * 降到阈值以下；若此时暂停，游标会永久搁置，且局部清扫期间分配的对象会一直保持黑色，
@@ -414,12 +487,52 @@ void GarbageCollector::stopAutomatic() noexcept {
 void GarbageCollector::restartAutomatic() noexcept {
     automaticStopped_ = false;
     stepCountdown_ = 0;
+    noteAllocation();
 }
 
 bool GarbageCollector::isAutomaticStopped() const noexcept {
     return automaticStopped_;
 }
 
+template <typename IncrementalWork>
+bool GarbageCollector::runExplicitStep(LuaState* currentState, IncrementalWork&& work) {
+    bool wasStopped = automaticStopped_;
+    automaticStopped_ = false;
+    StringPool& stringPool = stringPoolForCollection(currentState);
+
+    if (generational_) {
+        /** @brief 分代模式的一步即一次次要（或到期的主要）收集，步长与时间预算只影响增量模式。 */
+        usize collected = 0;
+        try {
+            collected = collectGenerationalStep(stringPool, currentState, true);
+        } catch (...) {
+            automaticStopped_ = wasStopped;
+            throw;
+        }
+        lastCompletedCollected_ = collected;
+        automaticStopped_ = wasStopped;
+        return true;
+    }
+
+    bool finished = false;
+    usize paidBytes = 0;
+    try {
+        finished = work(stringPool, paidBytes);
+    } catch (...) {
+        resetIncrementalCycle();
+        automaticStopped_ = wasStopped;
+        throw;
+    }
+
+    subtractDebt(gcDebtBytes_, paidBytes);
+    if (finished) {
+        updateAutomaticThresholdAfterCycle();
+    }
+
+    automaticStopped_ = wasStopped;
+    return finished;
+}
+
 bool GarbageCollector::step(LuaState* currentState, i32 size) {
     const i32 normalizedSize = std::max(0, size);
     const u64 requestedKilobytes = static_cast<u64>(normalizedSize) + 1;
@@ -436,33 +549,39 @@ bool GarbageCollector::step(LuaState* currentState, i32 size) {
     const usize budget = static_cast<usize>(
         std::min<u64>(std::max<u64>(1, scaledKilobytes), static_cast<u64>(std::numeric_limits<i32>::max())));
 
-    bool wasStopped = automaticStopped_;
-    automaticStopped_ = false;
-    StringPool& stringPool = stringPoolForCollection(currentState);
-
-    bool finished = false;
-    try {
+    return runExplicitStep(currentState, [&](StringPool& stringPool, usize& paidBytes) {
+        paidBytes = scaledBytes;
         if (normalizedSize >= 10000) {
             usize largeBudget = std::max<usize>(getObjectCount() + grayList_.size() + 16, 1024);
+            bool finished = false;
             do {
                 finished = incrementalStep(stringPool, currentState, largeBudget);
             } while (!finished);
-        } else {
-            finished = incrementalStep(stringPool, currentState, budget);
+            return true;
         }
-    } catch (...) {
-        resetIncrementalCycle();
-        automaticStopped_ = wasStopped;
-        throw;
-    }
+        return incrementalStep(stringPool, currentState, budget);
+    });
+}
 
-    subtractDebt(gcDebtBytes_, scaledBytes);
-    if (finished) {
-        updateAutomaticThresholdAfterCycle();
+bool GarbageCollector::stepFor(LuaState* currentState, std::chrono::microseconds timeBudget) {
+    if (timeBudget <= std::chrono::microseconds::zero()) {
+        return false;
     }
 
-    automaticStopped_ = wasStopped;
-    return finished;
+    using Clock = std::chrono::steady_clock;
+    const Clock::time_point deadline = Clock::now() + timeBudget;
+
+    return runExplicitStep(currentState, [&](StringPool& stringPool, usize& paidBytes) {
+        constexpr u64 kPercent = 100;
+        bool finished = false;
+        u64 grantedUnits = 0;
+        do {
+            finished = incrementalStep(stringPool, currentState, kTimedStepSliceUnits);
+            grantedUnits += kTimedStepSliceUnits;
+            paidBytes = saturatedStepBytes(grantedUnits * kPercent);
+        } while (!finished && Clock::now() < deadline);
+        return finished;
+    });
 }
 
 i32 GarbageCollector::getPause() const noexcept {
@@ -501,6 +620,7 @@ usize GarbageCollector::getManagedMemoryBudgetBytes() const noexcept {
 usize GarbageCollector::setManagedMemoryBudgetBytes(usize limit) noexcept {
     const usize previous = managedMemoryBudgetBytes_;
     managedMemoryBudgetBytes_ = limit;
+    noteAllocation();
     return previous;
 }
 
@@ -518,6 +638,81 @@ bool GarbageCollector::canAccountManagedBytes(usize additionalBytes) const noexc
     return liveBytes <= managedMemoryBudgetBytes_ && additionalBytes <= managedMemoryBudgetBytes_ - liveBytes;
 }
 
+void GarbageCollector::setSlabAllocationEnabled(bool enabled) noexcept {
+    slabAllocationEnabled_ = enabled;
+}
+
+bool GarbageCollector::isSlabAllocationEnabled() const noexcept {
+    return slabAllocationEnabled_;
+}
+
+usize GarbageCollector::getSlabReservedBytes() const noexcept {
+    return slab_ != nullptr ? slab_->getReservedBytes() : 0;
+}
+
+void GarbageCollector::setBackgroundFreeEnabled(bool enabled) noexcept {
+    if (!enabled) {
+        backgroundFree_.reset();
+        return;
+    }
+    if (backgroundFree_ == nullptr) {
+        // 创建失败时保持同步释放，语义不变
+        backgroundFree_.reset(new (std::nothrow) GCBackgroundFree());
+    }
+}
+
+bool GarbageCollector::isBackgroundFreeEnabled() const noexcept {
+    return backgroundFree_ != nullptr;
+}
+
+void GarbageCollector::drainBackgroundFree() noexcept {
+    if (backgroundFree_ != nullptr) {
+        backgroundFree_->drain();
+    }
+}
+
+bool GarbageCollector::releaseCachedMemory() noexcept {
+    bool released = false;
+    if (backgroundFree_ != nullptr) {
+        backgroundFree_->drain();
+        released = true;
+    }
+    if (globalState_ != nullptr && globalState_->getThreadStatePoolSize() != 0) {
+        globalState_->clearThreadStatePool();
+        released = true;
+    }
+    return released;
+}
+
+usize GarbageCollector::getBackgroundFreedBlocks() const noexcept {
+    return backgroundFree_ != nullptr ? backgroundFree_->getReleasedBlocks() : 0;
+}
+
+void GarbageCollector::setParallelMarkThreads(usize threads) noexcept {
+    const usize clamped = std::clamp<usize>(threads, 1, kMaximumParallelMarkThreads);
+    if (clamped != parallelMarkThreads_) {
+        // 常驻工作线程按旧线程数启动，下次并行传播时按新值重建
+        parallelMarkPool_.reset();
+    }
+    parallelMarkThreads_ = clamped;
+}
+
+usize GarbageCollector::getParallelMarkThreads() const noexcept {
+    return parallelMarkThreads_;
+}
+
+void GarbageCollector::setParallelMarkThreshold(usize objects) noexcept {
+    parallelMarkThreshold_ = objects;
+}
+
+usize GarbageCollector::getParallelMarkThreshold() const noexcept {
+    return parallelMarkThreshold_;
+}
+
+usize GarbageCollector::getParallelMarkCycles() const noexcept {
+    return parallelMarkCycles_;
+}
+
 const GCStrategy& GarbageCollector::getStrategy() const noexcept {
     return *strategy_;
 }
@@ -532,10 +727,68 @@ bool GarbageCollector::useStrategy(StrView name) noexcept {
         return false;
     }
 
+    const bool generational = &strategy->get() == &generationalGCStrategy();
+    if (generational && !generational_) {
+        preGenerationalStrategy_ = strategy_;
+    }
     strategy_ = &strategy->get();
+    if (generational != generational_) {
+        /**
+         * @brief 进入或离开分代模式时放弃未完成周期并清除代际信息。
+         *
+         * 全部对象回到新生代白色，首次分代收集因此总是主要收集。
+         */
+        resetIncrementalCycle();
+        generational_ = generational;
+        resetGenerations();
+    }
     return true;
 }
 
+bool GarbageCollector::leaveGenerationalMode() noexcept {
+    if (!generational_) {
+        return false;
+    }
+    const GCStrategy* restored = preGenerationalStrategy_ != nullptr ? preGenerationalStrategy_ : &markSweepGCStrategy();
+    return useStrategy(restored->name());
+}
+
+bool GarbageCollector::isGenerational() const noexcept {
+    return generational_;
+}
+
+i32 GarbageCollector::getMinorMultiplier() const noexcept {
+    return minorMultiplier_;
+}
+
+i32 GarbageCollector::setMinorMultiplier(i32 minorMultiplier) noexcept {
+    const i32 previous = minorMultiplier_;
+    minorMultiplier_ = std::max(1, minorMultiplier);
+    return previous;
+}
+
+i32 GarbageCollector::getMajorMultiplier() const noexcept {
+    return majorMultiplier_;
+}
+
+i32 GarbageCollector::setMajorMultiplier(i32 majorMultiplier) noexcept {
+    const i32 previous = majorMultiplier_;
+    majorMultiplier_ = std::max(0, majorMultiplier);
+    return previous;
+}
+
+usize GarbageCollector::getMinorCollectionCount() const noexcept {
+    return minorCollections_;
+}
+
+usize GarbageCollector::getMajorCollectionCount() const noexcept {
+    return majorCollections_;
+}
+
+usize GarbageCollector::getRememberedSetSize() const noexcept {
+    return rememberedSet_.size();
+}
+
 usize GarbageCollector::collectMarkSweep(StringPool& stringPool, LuaState* currentState) {
     return collectMarkSweep(stringPool, currentState, true);
 }
@@ -544,21 +797,7 @@ usize GarbageCollector::collectMarkSweep(StringPool& stringPool, LuaState* curre
     resetIncrementalCycle();
 
     // 1. 标记阶段
-    /**
-     * @brief 在 VM 尚无完整栈映射时扫描全部活动寄存器窗口。
-     *
-     * LocVar 区间不是完整的存活映射：匿名表达式临时值可跨越对 collectgarbage() 的 C 调用存活。
-     * 让一个已死亡弱值多保留一周期，比清扫仍存活的临时值并随后由 SETLIST/RETURN 解引用更安全。
-     */
-    const bool previousPreciseStackRoots = preciseStackRoots_;
-    preciseStackRoots_ = false;
-    try {
-        mark(currentState);
-    } catch (...) {
-        preciseStackRoots_ = previousPreciseStackRoots;
-        throw;
-    }
-    preciseStackRoots_ = previousPreciseStackRoots;
+    mark(currentState);
 
     // 2. 带 __gc 的不可达 userdata 需要先复活一轮，并保留其引用图。
     if (currentState != nullptr) {
@@ -597,6 +836,177 @@ usize GarbageCollector::collectIncrementalCycle(StringPool& stringPool, LuaState
     return collected;
 }
 
+usize GarbageCollector::collectGenerationalStep(StringPool& stringPool, LuaState* currentState,
+                                                bool runFinalizersNow) {
+    const usize majorBase = std::max(majorBaseBytes_, kMinimumGenerationalBytes);
+    const usize majorGrowth = majorBase / 100 * static_cast<usize>(majorMultiplier_);
+    const usize majorLimit = majorGrowth > std::numeric_limits<usize>::max() - majorBase
+                                 ? std::numeric_limits<usize>::max()
+                                 : majorBase + majorGrowth;
+    if (generationalMajorPending_ || majorBaseBytes_ == 0 || totalMemory_ > majorLimit) {
+        return collectGenerationalMajor(stringPool, currentState, runFinalizersNow);
+    }
+    return collectGenerationalMinor(stringPool, currentState, runFinalizersNow);
+}
+
+usize GarbageCollector::collectGenerationalMajor(StringPool& stringPool, LuaState* currentState,
+                                                 bool runFinalizersNow) {
+    /** @brief 完整标记会重新着色所有对象，记忆集与代际边界随之失效。 */
+    rememberedSet_.clear();
+    oldBoundary_ = nullptr;
+
+    usize collected = 0;
+    try {
+        collected = collectMarkSweep(stringPool, currentState, runFinalizersNow);
+    } catch (...) {
+        generationalMajorPending_ = true;
+        throw;
+    }
+    generationalMajorPending_ = false;
+    ++majorCollections_;
+
+    // 终结器可能已切换策略
+    if (generational_) {
+        enterGenerationalState();
+        majorBaseBytes_ = std::max<usize>(totalMemory_, 1);
+        updateGenerationalThreshold();
+    }
+    return collected;
+}
+
+usize GarbageCollector::collectGenerationalMinor(StringPool& stringPool, LuaState* currentState,
+                                                 bool runFinalizersNow) {
+    resetIncrementalCycle();
+    grayList_.reserve(objectCount_);
+    weakTables_.reserve(objectCount_);
+
+    /**
+     * @brief 新生代在两次收集之间应保持白色；此处仍按 mark() 的规则重置，
+     * 使任何在收集外被着色的新对象都会被重新扫描。
+     */
+    for (GCObject* obj = allObjects_; obj != oldBoundary_; obj = obj->getNext()) {
+        obj->setMarked(obj->getMarked() & (GCBits::FIXED | GCBits::FINALIZED));
+        obj->setColor(GCColor::White);
+    }
+
+    try {
+        for (GCObject* root : roots_) {
+            markObject(root);
+        }
+        if (currentState != nullptr) {
+            currentState->getGlobalState().markRoots(*this, currentState);
+        } else if (globalState_ != nullptr) {
+            globalState_->markRoots(*this, nullptr);
+        }
+        for (Userdata* userdata : pendingFinalizers_) {
+            markObject(userdata);
+        }
+
+        /** @brief 老年代对象不再遍历；只有记忆集中的所有者可能指向新生代。 */
+        for (GCObject* owner : rememberedSet_) {
+            owner->setColor(GCColor::Black);
+            owner->mark(*this);
+        }
+        propagateMarks();
+
+        if (currentState != nullptr) {
+            prepareFinalizers(oldBoundary_);
+            propagateMarks();
+        }
+    } catch (...) {
+        /** @brief 部分着色的新生代无法继续清扫，交由下一次主要收集重新标记整个堆。 */
+        resetIncrementalCycle();
+        generationalMajorPending_ = true;
+        throw;
+    }
+
+    clearWeakTableEntries();
+
+    // 老年代线程保留在记忆集中，其余所有者已被扫描，恢复为普通黑色老年代对象
+    usize retained = 0;
+    for (GCObject* owner : rememberedSet_) {
+        if (owner->getType() == GCObjectType::Thread) {
+            owner->setColor(GCColor::Gray);
+            rememberedSet_[retained++] = owner;
+        }
+    }
+    rememberedSet_.resize(retained);
+
+    const usize collected = sweepYoung(stringPool);
+    weakTables_.clear();
+    oldBoundary_ = allObjects_;
+    ++minorCollections_;
+
+    if (currentState != nullptr && runFinalizersNow) {
+        runFinalizers(currentState);
+    }
+
+    resetIncrementalCycle();
+    if (generational_) {
+        updateGenerationalThreshold();
+    }
+    return collected;
+}
+
+void GarbageCollector::promoteObject(GCObject* obj) noexcept {
+    obj->setMarked(obj->getMarked() | GCBits::OLD);
+    obj->setColor(GCColor::Black);
+    if (obj->getType() == GCObjectType::Thread) {
+        rememberObject(obj);
+    }
+}
+
+void GarbageCollector::enterGenerationalState() noexcept {
+    rememberedSet_.clear();
+    for (GCObject* obj = allObjects_; obj != nullptr; obj = obj->getNext()) {
+        promoteObject(obj);
+    }
+    oldBoundary_ = allObjects_;
+}
+
+void GarbageCollector::resetGenerations() noexcept {
+    for (GCObject* obj = allObjects_; obj != nullptr; obj = obj->getNext()) {
+        obj->setMarked(obj->getMarked() & ~GCBits::OLD);
+        obj->setColor(GCColor::White);
+    }
+    rememberedSet_.clear();
+    oldBoundary_ = nullptr;
+    majorBaseBytes_ = 0;
+    generationalMajorPending_ = false;
+}
+
+void GarbageCollector::rememberObject(GCObject* owner) noexcept {
+    if (rememberedSet_.size() >= rememberedSet_.capacity()) {
+        try {
+            rememberedSet_.reserve(std::max<usize>(16, rememberedSet_.capacity() * 2));
+        } catch (...) {
+            /** @brief 无法记录时保持所有者为黑色，改由下一次主要收集重新标记整个堆。 */
+            generationalMajorPending_ = true;
+            return;
+        }
+    }
+    rememberedSet_.push_back(owner);
+    owner->setColor(GCColor::Gray);
+}
+
+void GarbageCollector::forgetRememberedObject(GCObject* obj) noexcept {
+    // 记忆集条目总是灰色老年代对象；清扫中的白色对象无需查找
+    if ((obj->getMarked() & GCBits::OLD) == 0 || obj->getColor() != GCColor::Gray) {
+        return;
+    }
+    rememberedSet_.erase(std::remove(rememberedSet_.begin(), rememberedSet_.end(), obj), rememberedSet_.end());
+}
+
+void GarbageCollector::updateGenerationalThreshold() noexcept {
+    const usize liveBytes = totalMemory_;
+    const usize minorBytes =
+        std::max(kMinimumGenerationalBytes, liveBytes / 100 * static_cast<usize>(std::max(1, minorMultiplier_)));
+    automaticThresholdBytes_ =
+        minorBytes > std::numeric_limits<usize>::max() - liveBytes ? std::numeric_limits<usize>::max()
+                                                                     : liveBytes + minorBytes;
+    gcDebtBytes_ = static_cast<isize>(liveBytes) - static_cast<isize>(automaticThresholdBytes_);
+}
+
 void GarbageCollector::resetIncrementalCycle() noexcept {
     incrementalPhase_ = IncrementalPhase::Pause;
     incrementalSweepCurrent_ = nullptr;
@@ -610,7 +1020,7 @@ void GarbageCollector::resetIncrementalCycle() noexcept {
 
 usize GarbageCollector::refreshMemoryAccounting() noexcept {
     const usize previousTotal = totalMemory_;
-    usize currentTotal = 0;
+    usize currentTotal = retainedBytes_;
     for (GCObject* obj = allObjects_; obj != nullptr; obj = obj->getNext()) {
         const usize objectSize = obj->getSize();
         obj->setAccountedSize(objectSize);
@@ -660,25 +1070,11 @@ void GarbageCollector::beginIncrementalMark(LuaState* currentState) {
         markObject(root);
     }
 
-    /**
-     * @brief 增量根快照使用完整活动寄存器窗口。
-     *
-     * 自动步进可在任意两条 VM 指令间运行，包括表构造器执行到一半且临时寄存器尚无 LocVar
-     * 区间时。精确根仍用于实现弱表可观察性测试的显式收集。
-     */
-    const bool previousPreciseStackRoots = preciseStackRoots_;
-    preciseStackRoots_ = false;
-    try {
-        if (currentState != nullptr) {
-            currentState->getGlobalState().markRoots(*this, currentState);
-        } else if (globalState_ != nullptr) {
-            globalState_->markRoots(*this, nullptr);
-        }
-    } catch (...) {
-        preciseStackRoots_ = previousPreciseStackRoots;
-        throw;
+    if (currentState != nullptr) {
+        currentState->getGlobalState().markRoots(*this, currentState);
+    } else if (globalState_ != nullptr) {
+        globalState_->markRoots(*this, nullptr);
     }
-    preciseStackRoots_ = previousPreciseStackRoots;
 
     for (Userdata* userdata : pendingFinalizers_) {
         markObject(userdata);
@@ -693,26 +1089,18 @@ void GarbageCollector::performIncrementalAtomic(LuaState* currentState) {
      *
      * 这样可防止 beginIncrementalMark 后安装的值在清扫开始时仍保持白色。
      */
-    const bool previousPreciseStackRoots = preciseStackRoots_;
-    preciseStackRoots_ = false;
-    try {
-        for (GCObject* root : roots_) {
-            markObject(root);
-        }
-        if (currentState != nullptr) {
-            currentState->getGlobalState().markRoots(*this, currentState);
-        } else if (globalState_ != nullptr) {
-            globalState_->markRoots(*this, nullptr);
-        }
-        for (Userdata* userdata : pendingFinalizers_) {
-            markObject(userdata);
-        }
-        propagateMarks();
-    } catch (...) {
-        preciseStackRoots_ = previousPreciseStackRoots;
-        throw;
+    for (GCObject* root : roots_) {
+        markObject(root);
+    }
+    if (currentState != nullptr) {
+        currentState->getGlobalState().markRoots(*this, currentState);
+    } else if (globalState_ != nullptr) {
+        globalState_->markRoots(*this, nullptr);
+    }
+    for (Userdata* userdata : pendingFinalizers_) {
+        markObject(userdata);
     }
-    preciseStackRoots_ = previousPreciseStackRoots;
+    propagateMarks();
 
     /**
      * @brief 清理条目前重新评估弱表元表的 __mode。
@@ -739,6 +1127,7 @@ void GarbageCollector::performIncrementalAtomic(LuaState* currentState) {
 }
 
 usize GarbageCollector::sweepStep(StringPool& stringPool, usize budget) {
+    BackgroundFreeScope backgroundFree(*this);
     usize collected = 0;
     usize processed = 0;
 
@@ -783,6 +1172,9 @@ usize GarbageCollector::sweepStep(StringPool& stringPool, usize budget) {
     incrementalCollected_ += collected;
     if (incrementalSweepCurrent_ == nullptr) {
         weakTables_.clear();
+        if (slab_ != nullptr) {
+            (void)slab_->releaseEmptyPages();
+        }
         incrementalPhase_ = IncrementalPhase::Finalize;
     }
 
@@ -854,6 +1246,7 @@ void GarbageCollector::destroyObject(GCObject* obj, StringPool& stringPool) {
         return;
     }
 
+    forgetRememberedObject(obj);
     roots_.erase(std::remove(roots_.begin(), roots_.end(), obj), roots_.end());
     grayList_.erase(std::remove(grayList_.begin(), grayList_.end(), obj), grayList_.end());
     externalMarked_.erase(std::remove(externalMarked_.begin(), externalMarked_.end(), obj), externalMarked_.end());
@@ -884,15 +1277,71 @@ void GarbageCollector::destroyObject(GCObject* obj, StringPool& stringPool) {
     releaseObjectMemory(obj);
 }
 
+GarbageCollector::ObjectStorage GarbageCollector::allocateObjectStorage(usize size, bool allowSlab) {
+    const bool slabStorage = allowSlab && GCSlabAllocator::handles(size);
+    if (!slabStorage && (allocator_ == nullptr || !allocator_->isConfigured())) {
+        return ObjectStorage{::operator new(size), GCAllocationKind::OperatorNew};
+    }
+
+    auto tryAllocate = [&]() noexcept -> void* {
+        if (!slabStorage) {
+            return allocator_->allocate(size);
+        }
+        if (slab_ == nullptr) {
+            slab_ = GCSlabAllocator::create(allocator_);
+        }
+        return slab_ != nullptr ? slab_->allocate(size) : nullptr;
+    };
+
+    void* memory = tryAllocate();
+    if (memory == nullptr && releaseCachedMemory()) {
+        // 在途批次与闲置缓存仍计在宿主分配器名下，等它们归还后再判断是否超出宿主的内存上限
+        memory = tryAllocate();
+    }
+    if (memory == nullptr) {
+        // 页申请失败即 lua_Alloc 拒绝，按内存不足处理而不是绕过分配器重试
+        throw std::bad_alloc();
+    }
+    return ObjectStorage{memory, slabStorage ? GCAllocationKind::Slab : GCAllocationKind::Allocator};
+}
+
+void GarbageCollector::releaseObjectStorage(const ObjectStorage& storage, usize size) noexcept {
+    switch (storage.kind) {
+    case GCAllocationKind::Slab:
+        slab_->deallocate(storage.memory, size);
+        break;
+    case GCAllocationKind::Allocator:
+        allocator_->deallocate(storage.memory, size);
+        break;
+    case GCAllocationKind::OperatorNew:
+    case GCAllocationKind::Delete:
+        ::operator delete(storage.memory);
+        break;
+    }
+}
+
 void GarbageCollector::releaseObjectMemory(GCObject* obj) noexcept {
-    LuaAllocator* allocationAllocator = obj->getAllocationAllocator();
+    // 块大小由类型推导，必须在析构前读取
     const usize allocationSize = obj->getAllocationSize();
-    GCObject::AllocationDestructor allocationDestructor = obj->getAllocationDestructor();
-    if (allocationAllocator != nullptr && allocationDestructor != nullptr) {
-        allocationDestructor(obj);
-        allocationAllocator->deallocate(obj, allocationSize);
-    } else {
-        delete obj;
+    switch (obj->getAllocationKind()) {
+    case GCAllocationKind::Delete:
+    case GCAllocationKind::OperatorNew:
+        // 对象头位于具体对象偏移 0 处，new T 与 ::operator new 的块都交回 ::operator delete
+        obj->destroy();
+        ::operator delete(obj);
+        break;
+    case GCAllocationKind::Allocator: {
+        LuaAllocator* allocator = obj->getAllocationAllocator();
+        obj->destroy();
+        allocator->deallocate(obj, allocationSize);
+        break;
+    }
+    case GCAllocationKind::Slab: {
+        GCSlabAllocator* slab = obj->getAllocationSlab();
+        obj->destroy();
+        slab->deallocate(obj, allocationSize);
+        break;
+    }
     }
 }
 
@@ -909,7 +1358,7 @@ usize GarbageCollector::getRootCount() const noexcept {
 }
 
 usize GarbageCollector::getTotalMemory() const noexcept {
-    usize total = 0;
+    usize total = retainedBytes_;
     for (GCObject* obj = allObjects_; obj != nullptr; obj = obj->getNext()) {
         addLiveBytes(total, obj->getSize());
     }
@@ -939,6 +1388,8 @@ void GarbageCollector::clearAll(StringPool& stringPool) {
 
     // 清空根对象列表
     roots_.clear();
+    rememberedSet_.clear();
+    oldBoundary_ = nullptr;
     grayList_.clear();
     weakTables_.clear();
     pendingFinalizers_.clear();
@@ -984,6 +1435,7 @@ void GarbageCollector::clearAll(StringPool& stringPool) {
     grayList_.clear();
     weakTables_.clear();
     pendingFinalizers_.clear();
+    resetGenerations();
     updateAutomaticThresholdAfterCycle();
 }
 
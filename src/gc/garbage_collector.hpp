@@ -24,7 +24,10 @@
 
 #include "common/types.hpp"
 #include "core/gc_object.hpp"
+#include "gc/gc_heap_profile.hpp"
+#include "gc/gc_slab.hpp"
 #include "runtime/lua_allocator.hpp"
+#include <chrono>
 #include <memory>
 #include <type_traits>
 #include <utility>
@@ -41,8 +44,12 @@ class Userdata;
 class Value;
 class GlobalState;
 class GCStrategy;
+class GCBackgroundFree;
+class GCParallelMark;
+class GCHeapWalker;
 class MarkSweepGC;
 class IncrementalGC;
+class GenerationalGC;
 
 /**
  * @brief 垃圾回收器类
@@ -131,6 +138,14 @@ public:
      */
     void accountObjectSizeChange(GCObject* obj) noexcept;
 
+    /**
+     * @brief 计入不属于任何垃圾回收对象、由运行时缓存闲置持有的字节（如协程状态池）
+     *
+     * 与对象字节一样计入内存总量与债务；缓存交还内存时以 releaseRetainedBytes() 扣除。
+     */
+    void accountRetainedBytes(usize bytes) noexcept;
+    void releaseRetainedBytes(usize bytes) noexcept;
+
     /**
      * @brief 通过原始分配路径销毁已注册对象
      *
@@ -236,17 +251,123 @@ public:
      */
     [[nodiscard]] usize maybeCollectAutomatic(LuaState* currentState);
 
+    /**
+     * @brief VM 指令边界的自动回收检查点，对应 Lua 的 luaC_checkGC
+     *
+     * 分配是唯一的触发点：对象登记或尺寸增长使债务到期时置位待处理标志，此处只读该标志，
+     * 置位时才进入 maybeCollectAutomatic。不分配的写入循环因此不会调用收集器。
+     */
+    [[nodiscard]] usize checkAutomatic(LuaState* currentState) {
+        return collectionPending_ ? maybeCollectAutomatic(currentState) : 0;
+    }
+
+    /** @brief 自上次检查点以来是否有分配使自动回收到期 */
+    [[nodiscard]] bool isCollectionPending() const noexcept {
+        return collectionPending_;
+    }
+
     void stopAutomatic() noexcept;
     void restartAutomatic() noexcept;
     [[nodiscard]] bool isAutomaticStopped() const noexcept;
     [[nodiscard]] bool step(LuaState* currentState, i32 size);
 
+    /**
+     * @brief 按时间预算推进垃圾回收
+     *
+     * 以固定大小的工作片推进增量标记与清扫，每片之后检查截止时间，因此超时不超过一片；
+     * 原子阶段与终结器不可分割。每个工作单位与 step() 一样按 1 KiB 偿还债务，剩余债务见
+     * getDebtBytes()。
+     *
+     * 分代模式不遵守截止时间：与 step() 相同，一次调用执行一次完整的次要（或到期的主要）
+     * 收集，该收集是停顿式的，耗时只取决于年轻代（或整个堆）的大小。
+     *
+     * @param timeBudget 可用时间；不大于 0 时不做任何工作
+     * @return true 表示本次完成了一轮收集
+     */
+    [[nodiscard]] bool stepFor(LuaState* currentState, std::chrono::microseconds timeBudget);
+
     [[nodiscard]] i32 getPause() const noexcept;
     [[nodiscard]] i32 setPause(i32 pause) noexcept;
     [[nodiscard]] i32 getStepMultiplier() const noexcept;
     [[nodiscard]] i32 setStepMultiplier(i32 stepMultiplier) noexcept;
     [[nodiscard]] isize getDebtBytes() const noexcept;
     [[nodiscard]] usize getAutomaticThresholdBytes() const noexcept;
+    /**
+     * @brief 是否把小型托管对象放入尺寸分级块池
+     *
+     * 默认开启。关闭后每个对象单独经 LuaAllocator 分配，便于逐对象核对分配器记账；
+     * 已位于块池中的对象不受影响。
+     */
+    void setSlabAllocationEnabled(bool enabled) noexcept;
+    [[nodiscard]] bool isSlabAllocationEnabled() const noexcept;
+
+    /**
+     * @brief 块池向后备分配器申请的字节数（页粒度），尚未创建块池时为 0
+     */
+    [[nodiscard]] usize getSlabReservedBytes() const noexcept;
+
+    /**
+     * @brief 是否把清扫释放的内存块交给后台线程批量归还分配器
+     *
+     * 默认关闭：仅当分配器函数的释放路径可与修改器线程并发调用时才可开启。
+     * 托管字节数仍在摘链时扣减；关闭时先等待在途批次全部归还。不得在清扫期间切换。
+     * 显式 collect() 返回前、对象分配被宿主分配器拒绝后重试前，以及有托管预算时的
+     * 超限判断前，都会等待在途批次归还。
+     */
+    void setBackgroundFreeEnabled(bool enabled) noexcept;
+    [[nodiscard]] bool isBackgroundFreeEnabled() const noexcept;
+
+    /** @brief 等待后台线程归还所有已交付的块，使分配器侧存活字节数与收集器一致。 */
+    void drainBackgroundFree() noexcept;
+
+    /** @brief 后台线程累计归还的块数量。 */
+    [[nodiscard]] usize getBackgroundFreedBlocks() const noexcept;
+
+    /**
+     * @brief 停顿式完整收集的标记线程数（含修改器线程）
+     *
+     * 默认 1，即串行标记。大于 1 时，托管对象数达到阈值的完整收集在根集标记后把灰色对象
+     * 交给工作线程并行传播；线程栈扫描、弱表清理与终结器安排仍在修改器线程上执行。
+     * 工作线程在首次并行传播时启动并常驻，线程数改变时重建。增量步进与分代次要收集不受影响。
+     */
+    void setParallelMarkThreads(usize threads) noexcept;
+    [[nodiscard]] usize getParallelMarkThreads() const noexcept;
+
+    /** @brief 启用并行标记所需的最少托管对象数；小堆上启动线程的开销高于收益。 */
+    void setParallelMarkThreshold(usize objects) noexcept;
+    [[nodiscard]] usize getParallelMarkThreshold() const noexcept;
+
+    /** @brief 实际以多个工作者执行的并行标记阶段次数。 */
+    [[nodiscard]] usize getParallelMarkCycles() const noexcept;
+
+    // =====================================================================
+    // 堆诊断
+    // =====================================================================
+
+    /**
+     * @brief 按类型、尺寸级别与支配树保留大小统计当前堆
+     *
+     * 从与完整收集相同的根集遍历对象图，但不改变颜色、灰栈或回收阶段，可在增量周期中途调用。
+     * 耗时与内存与对象数成正比，仅用于诊断。
+     *
+     * @param retainerLimit 返回的保留大小最大的对象数
+     */
+    [[nodiscard]] GCHeapCensus takeHeapCensus(LuaState* currentState, usize retainerLimit = 16);
+
+    /**
+     * @brief 分配采样间隔（字节）
+     *
+     * 每分配约该字节数记录一次调用栈样本；0 表示关闭（默认）。修改间隔不清空已有样本。
+     */
+    void setAllocationSampleInterval(usize bytes) noexcept;
+    [[nodiscard]] usize getAllocationSampleInterval() const noexcept;
+
+    [[nodiscard]] const GCAllocationProfile& getAllocationProfile() const noexcept {
+        return allocationProfile_;
+    }
+
+    void resetAllocationProfile() noexcept;
+
     /**
      * @brief TestC 托管大小预算；并非分配器存活字节数或宿主硬限制
      */
@@ -269,6 +390,36 @@ public:
      */
     bool useStrategy(StrView name) noexcept;
 
+    /**
+     * @brief 离开分代模式，恢复进入前使用的标记-清扫或增量策略
+     * @return 当前不是分代模式时不做修改并返回 false
+     */
+    bool leaveGenerationalMode() noexcept;
+
+    /**
+     * @brief 当前策略是否为分代模式
+     */
+    [[nodiscard]] bool isGenerational() const noexcept;
+
+    /**
+     * @brief 分代模式的次要收集间隔：上次收集后新分配达到存活字节的该百分比时触发
+     */
+    [[nodiscard]] i32 getMinorMultiplier() const noexcept;
+    [[nodiscard]] i32 setMinorMultiplier(i32 minorMultiplier) noexcept;
+
+    /**
+     * @brief 分代模式的主要收集阈值：存活字节超过上次主要收集后基线的 (100 + 该值)% 时触发
+     */
+    [[nodiscard]] i32 getMajorMultiplier() const noexcept;
+    [[nodiscard]] i32 setMajorMultiplier(i32 majorMultiplier) noexcept;
+
+    /** @brief 已完成的次要收集次数。 */
+    [[nodiscard]] usize getMinorCollectionCount() const noexcept;
+    /** @brief 已完成的主要收集次数。 */
+    [[nodiscard]] usize getMajorCollectionCount() const noexcept;
+    /** @brief 记忆集中等待下次次要收集重扫的老年代对象数量。 */
+    [[nodiscard]] usize getRememberedSetSize() const noexcept;
+
     /**
      * @brief 标记阶段
      *
@@ -463,11 +614,24 @@ private:
     friend class StringPool;
     friend class MarkSweepGC;
     friend class IncrementalGC;
+    friend class GenerationalGC;
+    friend class GCParallelMark;
+    friend class GCHeapWalker;
 
     template <typename T, typename... Args> [[nodiscard]] T* createManaged(bool root, bool fixed, Args&&... args) {
         static_assert(std::is_base_of_v<GCObject, T>, "GarbageCollector::create<T> requires a GCObject type");
 
-        usize requestedSize = sizeof(T);
+        /**
+         * @brief 提供 getInlineAllocationSize() 的类型把载荷放在对象头之后的同一内存块中，
+         * 并以 GCInlineStorage 标签构造。
+         */
+        constexpr bool inlineStorage = requires { T::getInlineAllocationSize(args...); };
+        usize allocationSize = sizeof(T);
+        if constexpr (inlineStorage) {
+            allocationSize = static_cast<usize>(T::getInlineAllocationSize(args...));
+        }
+
+        usize requestedSize = allocationSize;
         if constexpr (requires { T::getGCAllocationSize(args...); }) {
             requestedSize = static_cast<usize>(T::getGCAllocationSize(args...));
         }
@@ -476,26 +640,30 @@ private:
             throw std::bad_alloc();
         }
 
-        if (allocator_ != nullptr && allocator_->isConfigured()) {
-            void* memory = allocator_->allocate(sizeof(T));
-            if (memory == nullptr) {
-                throw std::bad_alloc();
-            }
+        const bool slabStorage = slabAllocationEnabled_ && GCSlabAllocator::handles(allocationSize);
+        if (inlineStorage || slabStorage || (allocator_ != nullptr && allocator_->isConfigured())) {
+            const ObjectStorage storage = allocateObjectStorage(allocationSize, slabStorage);
 
             T* raw = nullptr;
             try {
-                if constexpr (std::is_constructible_v<T, LuaAllocator*, Args...>) {
-                    raw = std::construct_at(static_cast<T*>(memory), allocator_, std::forward<Args>(args)...);
+                if constexpr (inlineStorage) {
+                    raw = std::construct_at(static_cast<T*>(storage.memory), GCInlineStorage{},
+                                            std::forward<Args>(args)...);
+                } else if constexpr (std::is_constructible_v<T, LuaAllocator*, Args...>) {
+                    raw = std::construct_at(static_cast<T*>(storage.memory), allocator_, std::forward<Args>(args)...);
                 } else {
-                    raw = std::construct_at(static_cast<T*>(memory), std::forward<Args>(args)...);
+                    raw = std::construct_at(static_cast<T*>(storage.memory), std::forward<Args>(args)...);
                 }
             } catch (...) {
-                allocator_->deallocate(memory, sizeof(T));
+                releaseObjectStorage(storage, allocationSize);
                 throw;
             }
 
-            raw->setAllocatorAllocation(allocator_, sizeof(T),
-                                        [](GCObject* object) noexcept { std::destroy_at(static_cast<T*>(object)); });
+            if (storage.kind == GCAllocationKind::Slab) {
+                raw->setSlabAllocation(slab_);
+            } else {
+                raw->setAllocation(storage.kind, allocator_);
+            }
 
             try {
                 registerObject(raw);
@@ -507,34 +675,55 @@ private:
                 }
             } catch (...) {
                 unregisterObject(raw);
-                std::destroy_at(raw);
-                allocator_->deallocate(raw, sizeof(T));
+                releaseObjectMemory(raw);
                 throw;
             }
 
+            sampleAllocation(raw);
             return raw;
         }
 
-        auto object = std::make_unique<T>(std::forward<Args>(args)...);
-        T* raw = object.get();
-        registerObject(raw);
+        // 尾随载荷类型总在上面的分支中返回；旧路径只为普通类型实例化
+        if constexpr (inlineStorage) {
+            std::unreachable();
+        } else {
+            auto object = std::make_unique<T>(std::forward<Args>(args)...);
+            T* raw = object.get();
+            registerObject(raw);
 
-        try {
-            if (fixed) {
-                raw->setMarked(raw->getMarked() | GCBits::FIXED);
-            }
-            if (root) {
-                addRoot(raw);
+            try {
+                if (fixed) {
+                    raw->setMarked(raw->getMarked() | GCBits::FIXED);
+                }
+                if (root) {
+                    addRoot(raw);
+                }
+            } catch (...) {
+                unregisterObject(raw);
+                throw;
             }
-        } catch (...) {
-            unregisterObject(raw);
-            throw;
-        }
 
-        object.release();
-        return raw;
+            object.release();
+            sampleAllocation(raw);
+            return raw;
+        }
     }
 
+    /** @brief 托管对象原始内存块及其释放路径。 */
+    struct ObjectStorage {
+        void* memory;
+        GCAllocationKind kind;
+    };
+
+    /**
+     * @brief 为托管对象分配原始内存块
+     * @param size 块字节数
+     * @param allowSlab 是否允许由小对象块池承接
+     * @return 内存块与释放路径；失败时抛出 std::bad_alloc
+     */
+    [[nodiscard]] ObjectStorage allocateObjectStorage(usize size, bool allowSlab);
+    void releaseObjectStorage(const ObjectStorage& storage, usize size) noexcept;
+
     enum class IncrementalPhase : u8 { Pause, Propagate, Atomic, Sweep, Finalize };
 
     // =====================================================================
@@ -543,6 +732,13 @@ private:
 
     static bool valueContainsObject(const Value& value);
     static GCObject* objectFromValue(const Value& value);
+    /** @brief 按对象类型扫描灰色对象的子引用（标记循环的非虚分派）。 */
+    void traverseObject(GCObject* obj);
+
+    /**
+     * @brief 完整标记的传播入口：满足线程数与堆大小条件时并行传播，否则串行
+     */
+    void propagateMarksInParallel();
     static GarbageCollector& legacyInstance();
 
     StringPool& stringPoolForCollection(LuaState* currentState) const;
@@ -553,14 +749,95 @@ private:
     [[nodiscard]] usize collectIncrementalCycle(StringPool& stringPool, LuaState* currentState);
     void resetIncrementalCycle() noexcept;
     usize refreshMemoryAccounting() noexcept;
+
+    /**
+     * @brief 等待后台释放并清空协程状态池，把运行时闲置持有的内存交还分配器
+     *
+     * 用于显式完整收集之后，以及分配失败或超出托管预算后重试之前。
+     * @return 是否有可能交还了内存；为 false 时重试没有意义
+     */
+    bool releaseCachedMemory() noexcept;
     void updateAutomaticThresholdAfterCycle() noexcept;
     void beginIncrementalMark(LuaState* currentState);
     [[nodiscard]] usize propagateMarks(usize budget);
     void performIncrementalAtomic(LuaState* currentState);
     void reconcileWeakTableModes();
     [[nodiscard]] usize sweepStep(StringPool& stringPool, usize budget);
+
+    /**
+     * @brief 清扫作用域：开启后台释放时，期间经分配器释放的块转交后台线程
+     *
+     * 析构可能重入收集，作用域可以嵌套；只有挂接回调的最外层作用域负责解除与交付。
+     */
+    class BackgroundFreeScope {
+    public:
+        explicit BackgroundFreeScope(GarbageCollector& collector) noexcept;
+        ~BackgroundFreeScope();
+
+        BackgroundFreeScope(const BackgroundFreeScope&) = delete;
+        BackgroundFreeScope& operator=(const BackgroundFreeScope&) = delete;
+
+    private:
+        GarbageCollector& collector_;
+        bool armed_;
+    };
+
     [[nodiscard]] bool incrementalStep(StringPool& stringPool, LuaState* currentState, usize budget);
 
+    /**
+     * @brief 分代模式的主要收集：完整标记清除后把全部存活对象晋升为老年代
+     */
+    [[nodiscard]] usize collectGenerationalMajor(StringPool& stringPool, LuaState* currentState,
+                                                 bool runFinalizersNow);
+
+    /**
+     * @brief 分代模式的次要收集：从根与记忆集出发只标记并清扫新生代
+     */
+    [[nodiscard]] usize collectGenerationalMinor(StringPool& stringPool, LuaState* currentState,
+                                                 bool runFinalizersNow);
+
+    /**
+     * @brief 按主要收集阈值与待处理标志选择一次次要或主要收集
+     */
+    [[nodiscard]] usize collectGenerationalStep(StringPool& stringPool, LuaState* currentState,
+                                                bool runFinalizersNow);
+
+    /**
+     * @brief step() 与 stepFor() 共用的模式分派、自动回收状态恢复与债务偿还
+     *
+     * 分代模式下执行一次 collectGenerationalStep()；增量模式下调用
+     * work(stringPool, paidBytes) 推进周期，work 返回周期是否完成并写出应偿还的债务字节数。
+     */
+    template <typename IncrementalWork> bool runExplicitStep(LuaState* currentState, IncrementalWork&& work);
+
+    /**
+     * @brief 清扫新生代区间，并把存活者晋升为老年代
+     */
+    [[nodiscard]] usize sweepYoung(StringPool& stringPool);
+
+    void promoteObject(GCObject* obj) noexcept;
+    void enterGenerationalState() noexcept;
+    void resetGenerations() noexcept;
+    void rememberObject(GCObject* owner) noexcept;
+    void forgetRememberedObject(GCObject* obj) noexcept;
+    void updateGenerationalThreshold() noexcept;
+
+    /** @brief 分配记账后重新计算检查点标志 */
+    void noteAllocation() noexcept;
+
+    /** @brief 采样计数器：按对象大小递减，耗尽时才进入记录路径 */
+    void sampleAllocation(GCObject* obj) noexcept {
+        allocationSampleCountdown_ -= static_cast<isize>(obj->getAccountedSize());
+        if (allocationSampleCountdown_ <= 0) [[unlikely]] {
+            recordAllocationSample(obj);
+        }
+    }
+
+    void recordAllocationSample(GCObject* obj) noexcept;
+
+    /** @brief 堆普查期间的 markObject：只记录边，不着色 */
+    void recordHeapEdge(GCObject* obj);
+
     /**
      * @brief 传播标记
      *
@@ -576,8 +853,9 @@ private:
 
     /**
      * @brief 将带 __gc 的不可达 userdata 复活并加入待终结队列
+     * @param stop 扫描在此对象处停止；次要收集传入老年代边界，只检查新生代
      */
-    void prepareFinalizers();
+    void prepareFinalizers(GCObject* stop = nullptr);
 
     /**
      * @brief 解析当前上下文的单轮终结器回调上限
@@ -651,14 +929,43 @@ private:
     /** @brief 所属 EngineContext 共享的可变 Lua 分配器。 */
     LuaAllocator* allocator_;
 
+    /** @brief 小型托管对象的尺寸分级块池；首次使用时创建。 */
+    GCSlabAllocator* slab_;
+    bool slabAllocationEnabled_;
+
+    /** @brief 后台释放队列；开启后台释放时创建，关闭时等待归还并销毁。 */
+    std::unique_ptr<GCBackgroundFree> backgroundFree_;
+
+    /** @brief 并行标记工作者集合；首次并行传播时创建，线程常驻到收集器销毁或线程数改变。 */
+    std::unique_ptr<GCParallelMark> parallelMarkPool_;
+    /** @brief 并行传播期间指向 parallelMarkPool_，markObject 据此转交原子着色；其余时间为空。 */
+    GCParallelMark* parallelMark_;
+    usize parallelMarkThreads_;
+    usize parallelMarkThreshold_;
+    usize parallelMarkCycles_;
+
+    /** @brief 堆普查期间接收 markObject 的边；其余时间为空。 */
+    GCHeapWalker* heapWalker_;
+
+    /** @brief 距下一个分配样本的剩余字节；关闭采样时为 isize 最大值 */
+    isize allocationSampleCountdown_;
+    usize allocationSampleInterval_;
+    GCAllocationProfile allocationProfile_;
+
     /**
      * @brief 当前垃圾回收策略；默认采用标记-清扫，策略对象本身为静态共享实例
      */
     const GCStrategy* strategy_;
 
+    /**
+     * @brief 进入分代模式前的非分代策略，离开分代模式时据此恢复
+     */
+    const GCStrategy* preGenerationalStrategy_ = nullptr;
+
     bool automaticStopped_;
     bool automaticCollectionRunning_;
-    bool preciseStackRoots_;
+    /** @brief 分配时计算的检查点标志；避免每条写入指令重复比较债务、阈值与预算 */
+    bool collectionPending_;
     usize automaticThresholdBytes_;
     /** @brief TestC 与诊断用托管大小故障注入预算；绝非硬限制。 */
     usize managedMemoryBudgetBytes_;
@@ -672,6 +979,31 @@ private:
     usize incrementalCollected_;
     usize lastCompletedCollected_;
 
+    /**
+     * @brief 分代模式的记忆集
+     *
+     * 记录自上次收集以来被写入白色引用的老年代对象，以及所有老年代线程：
+     * 栈写入没有写屏障，线程必须在每次次要收集中重扫。记忆集中的对象保持灰色。
+     */
+    LuaVector<GCObject*> rememberedSet_;
+
+    /**
+     * @brief 第一个老年代对象
+     *
+     * 新对象插入链表头，因此 allObjects_ 到此边界之前的对象均为新生代；nullptr 表示全部为新生代。
+     */
+    GCObject* oldBoundary_;
+
+    bool generational_;
+    /** @brief 记忆集无法增长或次要收集中断时置位，强制下一次收集为主要收集。 */
+    bool generationalMajorPending_;
+    i32 minorMultiplier_;
+    i32 majorMultiplier_;
+    /** @brief 上次主要收集后的存活字节；0 表示尚未建立老年代。 */
+    usize majorBaseBytes_;
+    usize minorCollections_;
+    usize majorCollections_;
+
     /**
      * @brief 统计信息：对象总数
      */
@@ -681,6 +1013,11 @@ private:
      * @brief 统计信息：总内存使用量
      */
     usize totalMemory_;
+
+    /**
+     * @brief totalMemory_ 中由运行时缓存闲置持有、不对应任何对象的部分
+     */
+    usize retainedBytes_ = 0;
 };
 
 } // namespace Lua
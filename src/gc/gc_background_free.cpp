@@ -0,0 +1,110 @@
+/**
+ * @file gc_background_free.cpp
+ * @brief 垃圾回收后台释放实现
+ */
+
+#include "gc/gc_background_free.hpp"
+
+#include <utility>
+
+namespace Lua {
+
+GCBackgroundFree::~GCBackgroundFree() {
+    {
+        std::scoped_lock lock(mutex_);
+        stopping_ = true;
+    }
+    wake_.notify_all();
+    if (worker_.joinable()) {
+        worker_.join();
+    }
+}
+
+bool GCBackgroundFree::deferRelease(void* context, void* pointer, std::size_t size) noexcept {
+    auto* self = static_cast<GCBackgroundFree*>(context);
+    try {
+        self->collecting_.push_back(Block{pointer, size});
+    } catch (...) {
+        return false;
+    }
+    return true;
+}
+
+void GCBackgroundFree::flush(LuaAllocatorFunction function, void* userData) noexcept {
+    if (collecting_.empty()) {
+        return;
+    }
+
+    Batch batch{function, userData, std::move(collecting_)};
+    collecting_.clear();
+
+    if (worker_.joinable() || startWorker()) {
+        try {
+            {
+                std::scoped_lock lock(mutex_);
+                queue_.push_back(std::move(batch));
+            }
+            wake_.notify_one();
+            return;
+        } catch (...) {
+            // 入队失败时 batch 未被移动，退回下面的同步释放
+        }
+    }
+    releaseBatch(batch);
+}
+
+void GCBackgroundFree::drain() noexcept {
+    std::unique_lock lock(mutex_);
+    idle_.wait(lock, [this] { return queue_.empty() && !busy_; });
+}
+
+void GCBackgroundFree::releaseBatch(const Batch& batch) noexcept {
+    for (const Block& block : batch.blocks) {
+        try {
+            (void)batch.function(batch.userData, block.pointer, block.size, 0);
+        } catch (...) {
+            /** @brief 与 LuaAllocator::deallocate 一致，释放路径禁止异常逸出。 */
+        }
+    }
+}
+
+bool GCBackgroundFree::startWorker() noexcept {
+    try {
+        worker_ = std::thread([this] { run(); });
+    } catch (...) {
+        return false;
+    }
+    return true;
+}
+
+void GCBackgroundFree::run() noexcept {
+    std::unique_lock lock(mutex_);
+    while (true) {
+        wake_.wait(lock, [this] { return stopping_ || !queue_.empty(); });
+        if (queue_.empty()) {
+            // 只有在队列清空后才响应停止，保证析构前交付的块全部归还
+            return;
+        }
+
+        std::vector<Batch> batches = std::move(queue_);
+        queue_.clear();
+        busy_ = true;
+        lock.unlock();
+
+        usize released = 0;
+        for (const Batch& batch : batches) {
+            releaseBatch(batch);
+            released += batch.blocks.size();
+        }
+        releasedBlocks_.fetch_add(released, std::memory_order_relaxed);
+        batches.clear();
+
+        lock.lock();
+        busy_ = false;
+        if (queue_.empty()) {
+            idle_.notify_all();
+        }
+    }
+}
+
+} // namespace Lua
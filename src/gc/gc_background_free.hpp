@@ -0,0 +1,101 @@
+#pragma once
+
+/**
+ * @file gc_background_free.hpp
+ * @brief 垃圾回收后台释放——清扫产生的内存块由辅助线程批量归还分配器
+ *
+ * 设计说明：
+ * 清扫在修改器线程上摘链并运行析构函数，析构与字符串池、上值、线程状态交互，
+ * 必须留在修改器线程。真正耗时的是随后成百上千次 lua_Alloc(ptr, n, 0) 调用：
+ * 启用后台释放后，清扫期间经收集器分配器释放的块（对象块与析构中释放的载荷）
+ * 只被追加到本轮批次，清扫结束时整批交给辅助线程。
+ *
+ * 记账：
+ * 收集器在摘链时就扣减托管字节数，GC 配额与步进节奏不依赖后台线程的进度；
+ * 只有分配器自身看到的存活字节数会短暂滞后，drain() 可等待其追平。
+ *
+ * 线程安全前提：
+ * lua_Alloc 并不保证可并发调用，因此后台释放默认关闭，只应在分配器的释放路径
+ * 可与修改器线程并发时启用。每个批次携带交付时的分配器函数快照。
+ */
+
+#include "common/types.hpp"
+#include "runtime/lua_allocator.hpp"
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Lua {
+
+/** @brief 由垃圾回收器拥有的后台释放队列与辅助线程。 */
+class GCBackgroundFree {
+public:
+    GCBackgroundFree() = default;
+
+    /** @brief 释放全部已交付的块并结束辅助线程。 */
+    ~GCBackgroundFree();
+
+    GCBackgroundFree(const GCBackgroundFree&) = delete;
+    GCBackgroundFree& operator=(const GCBackgroundFree&) = delete;
+
+    /**
+     * @brief LuaAllocator 延迟释放回调，把块追加到本轮批次
+     * @param context GCBackgroundFree 实例
+     * @return false 表示无法记录（批次扩容失败），调用方应立即同步释放
+     */
+    static bool deferRelease(void* context, void* pointer, std::size_t size) noexcept;
+
+    /**
+     * @brief 把本轮批次连同分配器快照交给辅助线程
+     *
+     * 线程尚未启动时按需启动；启动或入队失败则在当前线程同步释放，不丢块。
+     */
+    void flush(LuaAllocatorFunction function, void* userData) noexcept;
+
+    /** @brief 等待所有已交付的块归还分配器。 */
+    void drain() noexcept;
+
+    /** @brief 辅助线程已归还的块数量。 */
+    [[nodiscard]] usize getReleasedBlocks() const noexcept {
+        return releasedBlocks_.load(std::memory_order_relaxed);
+    }
+
+private:
+    struct Block {
+        void* pointer;
+        std::size_t size;
+    };
+
+    /**
+     * @brief 一次清扫交付的块
+     *
+     * 批次元数据使用全局堆而非 lua_Alloc：它在辅助线程上释放，不能反过来依赖被保护的分配器。
+     */
+    struct Batch {
+        LuaAllocatorFunction function;
+        void* userData;
+        std::vector<Block> blocks;
+    };
+
+    static void releaseBatch(const Batch& batch) noexcept;
+    bool startWorker() noexcept;
+    void run() noexcept;
+
+    /** @brief 修改器线程正在积累的批次，只在清扫期间写入 */
+    std::vector<Block> collecting_;
+
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    std::condition_variable idle_;
+    /** @brief 已交付、等待辅助线程处理的批次 */
+    std::vector<Batch> queue_;
+    bool stopping_ = false;
+    bool busy_ = false;
+    std::thread worker_;
+    std::atomic<usize> releasedBlocks_{0};
+};
+
+} // namespace Lua
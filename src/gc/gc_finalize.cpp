@@ -29,9 +29,9 @@ Value GarbageCollector::getFinalizer(Userdata* userdata) const {
     return userdata->getMetatable()->get(Value(gcName));
 }
 
-void GarbageCollector::prepareFinalizers() {
+void GarbageCollector::prepareFinalizers(GCObject* stop) {
     GCObject* obj = allObjects_;
-    while (obj != nullptr) {
+    while (obj != stop) {
         if (obj->getType() == GCObjectType::Userdata && obj->getColor() == GCColor::White &&
             (obj->getMarked() & (GCBits::FIXED | GCBits::FINALIZED)) == 0) {
             auto* userdata = static_cast<Userdata*>(obj);
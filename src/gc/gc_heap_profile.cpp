@@ -0,0 +1,574 @@
+/**
+ * @file gc_heap_profile.cpp
+ * @brief 堆普查与分配点采样实现
+ */
+
+#include "gc/gc_heap_profile.hpp"
+
+#include "core/function.hpp"
+#include "core/gc_string.hpp"
+#include "core/thread.hpp"
+#include "core/userdata.hpp"
+#include "gc/garbage_collector.hpp"
+#include "vm/state/global_state.hpp"
+#include "vm/state/lua_state.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cstdio>
+#include <limits>
+#include <ostream>
+
+namespace Lua {
+
+namespace {
+
+constexpr u32 kVirtualRoot = 0;
+constexpr u32 kUndefined = std::numeric_limits<u32>::max();
+/** @brief 折叠栈的最大深度；更深的支配链并入最后一帧 */
+constexpr usize kMaxFoldedDepth = 64;
+/** @brief 保留者路径最多列出的支配者数，超出时省略靠近根的部分 */
+constexpr usize kMaxRetainerPath = 16;
+/** @brief 分配样本最多记录的调用帧数，超出时截去外层帧 */
+constexpr usize kMaxSampleFrames = 64;
+/** @brief 字符串标签保留的最大字符数 */
+constexpr usize kMaxStringLabel = 32;
+
+const char* typeName(GCObjectType type) noexcept {
+    switch (type) {
+    case GCObjectType::String:
+        return "string";
+    case GCObjectType::Table:
+        return "table";
+    case GCObjectType::Function:
+        return "function";
+    case GCObjectType::Userdata:
+        return "userdata";
+    case GCObjectType::Thread:
+        return "thread";
+    case GCObjectType::Proto:
+        return "proto";
+    case GCObjectType::Upval:
+        return "upvalue";
+    }
+    return "?";
+}
+
+std::string sourceLocation(const Proto* proto, i32 line) {
+    StrView name = "?";
+    if (proto != nullptr && proto->getSource() != nullptr) {
+        name = proto->getSource()->view();
+    }
+    if (!name.empty() && (name.front() == '@' || name.front() == '=')) {
+        name.remove_prefix(1);
+    }
+    std::string location(name);
+    location += ':';
+    location += std::to_string(line);
+    return location;
+}
+
+/** @brief 用于聚合的标签：Lua 函数与原型按定义位置区分，其余按类型 */
+std::string kindLabel(GCObject* obj) {
+    if (obj->getType() == GCObjectType::Function) {
+        auto* function = static_cast<Function*>(obj);
+        if (function->isCFunction() || function->getProto() == nullptr) {
+            return "function [C]";
+        }
+        return "function <" + sourceLocation(function->getProto(), function->getProto()->getLineDefined()) + ">";
+    }
+    if (obj->getType() == GCObjectType::Proto) {
+        auto* proto = static_cast<Proto*>(obj);
+        return "proto <" + sourceLocation(proto, proto->getLineDefined()) + ">";
+    }
+    return typeName(obj->getType());
+}
+
+/** @brief 指向具体对象的标签，地址格式与 tostring 一致 */
+std::string objectLabel(GCObject* obj) {
+    if (obj->getType() == GCObjectType::String) {
+        const StrView text = static_cast<GCString*>(obj)->view();
+        std::string label = "string \"";
+        label.append(text.substr(0, kMaxStringLabel));
+        label += text.size() > kMaxStringLabel ? "...\"" : "\"";
+        return label;
+    }
+
+    char address[32];
+    std::snprintf(address, sizeof(address), "%p", static_cast<void*>(obj));
+    return kindLabel(obj) + ": " + address;
+}
+
+usize framePc(const CallInfo& ci, const Proto* proto) noexcept {
+    const auto code = proto->getInstructionSpan();
+    if (code.empty() || ci.savedpc == nullptr || ci.savedpc <= code.data()) {
+        return 0;
+    }
+    return std::min(static_cast<usize>(ci.savedpc - code.data()) - 1, code.size() - 1);
+}
+
+/** @brief 由外到内追加调用帧，帧之间以分号分隔 */
+void appendSampleFrames(std::string& out, LuaState* state) {
+    Stack& stack = state->getStack();
+    LuaVector<CallInfo>& callStack = state->getCallStack();
+    const usize frameCount = std::min(state->getCallStackSize(), callStack.size());
+    const usize first = frameCount > kMaxSampleFrames ? frameCount - kMaxSampleFrames : 0;
+
+    for (usize i = first; i < frameCount; ++i) {
+        const CallInfo& ci = callStack[i];
+        if (ci.func >= stack.size() || !stack.at(ci.func).isFunction()) {
+            continue;
+        }
+
+        Function* function = stack.at(ci.func).asFunction();
+        if (!out.empty()) {
+            out += ';';
+        }
+        if (function->isCFunction() || function->getProto() == nullptr) {
+            out += "[C]";
+        } else {
+            Proto* proto = function->getProto();
+            out += sourceLocation(proto, proto->getLine(framePc(ci, proto)));
+        }
+    }
+}
+
+} // namespace
+
+// =====================================================================
+// GCHeapCensus
+// =====================================================================
+
+usize GCHeapCensus::typeIndex(GCObjectType type) noexcept {
+    return static_cast<usize>(type) - static_cast<usize>(GCObjectType::String);
+}
+
+usize GCHeapCensus::sizeClassIndex(usize bytes) noexcept {
+    if (bytes <= 16) {
+        return 0;
+    }
+    return std::min<usize>(static_cast<usize>(std::bit_width(bytes - 1)) - 4, kSizeClassCount - 1);
+}
+
+usize GCHeapCensus::sizeClassLimit(usize index) noexcept {
+    return index + 1 < kSizeClassCount ? usize{16} << index : std::numeric_limits<usize>::max();
+}
+
+bool GCHeapCensus::writeFolded(std::ostream& out) const {
+    std::vector<const std::pair<const std::string, usize>*> entries;
+    entries.reserve(retentionStacks.size());
+    for (const auto& entry : retentionStacks) {
+        entries.push_back(&entry);
+    }
+    std::sort(entries.begin(), entries.end(), [](const auto* lhs, const auto* rhs) { return lhs->first < rhs->first; });
+
+    for (const auto* entry : entries) {
+        out << entry->first << ' ' << entry->second << '\n';
+    }
+    return static_cast<bool>(out);
+}
+
+// =====================================================================
+// GCAllocationProfile
+// =====================================================================
+
+void GCAllocationProfile::record(std::string stack, usize samples, usize bytes) {
+    Entry& entry = sites_[std::move(stack)];
+    entry.samples += samples;
+    entry.bytes += bytes;
+    sampleCount_ += samples;
+}
+
+void GCAllocationProfile::clear() noexcept {
+    sites_.clear();
+    sampleCount_ = 0;
+}
+
+std::vector<GCAllocationSite> GCAllocationProfile::getSites() const {
+    std::vector<GCAllocationSite> sites;
+    sites.reserve(sites_.size());
+    for (const auto& [stack, entry] : sites_) {
+        sites.push_back(GCAllocationSite{stack, entry.samples, entry.bytes});
+    }
+    std::sort(sites.begin(), sites.end(), [](const GCAllocationSite& lhs, const GCAllocationSite& rhs) {
+        return lhs.bytes != rhs.bytes ? lhs.bytes > rhs.bytes : lhs.stack < rhs.stack;
+    });
+    return sites;
+}
+
+bool GCAllocationProfile::writeFolded(std::ostream& out) const {
+    for (const GCAllocationSite& site : getSites()) {
+        out << site.stack << ' ' << site.bytes << '\n';
+    }
+    return static_cast<bool>(out);
+}
+
+// =====================================================================
+// 堆遍历与支配树
+// =====================================================================
+
+/**
+ * @brief 一次堆普查的对象图
+ *
+ * 节点 0 是虚拟根，根集对象都是它的后继。支配树采用 Cooper–Harvey–Kennedy 迭代算法：
+ * 按逆后序反复以前驱的直接支配者求交，直到不再变化；对象图通常几轮即收敛。
+ */
+class GCHeapWalker {
+public:
+    explicit GCHeapWalker(GarbageCollector& gc) : gc_(gc), nodes_{nullptr} {}
+
+    void visit(GCObject* obj) {
+        const auto [it, inserted] = index_.try_emplace(obj, static_cast<u32>(nodes_.size()));
+        if (inserted) {
+            nodes_.push_back(obj);
+            pending_.push_back(it->second);
+        }
+        edges_.push_back(Edge{current_, it->second});
+    }
+
+    void walk(LuaState* currentState) {
+        const usize weakTableCount = gc_.weakTables_.size();
+        gc_.heapWalker_ = this;
+        try {
+            walkFromRoots(currentState);
+        } catch (...) {
+            gc_.heapWalker_ = nullptr;
+            gc_.weakTables_.resize(weakTableCount);
+            throw;
+        }
+        gc_.heapWalker_ = nullptr;
+        // 表遍历会登记弱表；普查不属于任何回收周期，撤销这些登记
+        gc_.weakTables_.resize(weakTableCount);
+    }
+
+    void summarize(GCHeapCensus& census, usize retainerLimit) {
+        computeDominators();
+
+        const usize count = nodes_.size();
+        std::vector<usize> retainedBytes(count, 0);
+        std::vector<usize> retainedObjects(count, 0);
+        for (u32 node = 1; node < count; ++node) {
+            retainedBytes[node] = nodes_[node]->getSize();
+            retainedObjects[node] = 1;
+            census.reachable.count += 1;
+            census.reachable.bytes += retainedBytes[node];
+        }
+        // 后序中支配者总在被支配者之后，一趟即可向上累加
+        for (const u32 node : postorder_) {
+            if (node != kVirtualRoot) {
+                retainedBytes[idom_[node]] += retainedBytes[node];
+                retainedObjects[idom_[node]] += retainedObjects[node];
+            }
+        }
+
+        std::vector<u32> candidates;
+        candidates.reserve(count > 0 ? count - 1 : 0);
+        for (u32 node = 1; node < count; ++node) {
+            candidates.push_back(node);
+        }
+        const usize limit = std::min(retainerLimit, candidates.size());
+        std::partial_sort(candidates.begin(), candidates.begin() + static_cast<std::ptrdiff_t>(limit),
+                          candidates.end(), [&retainedBytes](u32 lhs, u32 rhs) {
+                              return retainedBytes[lhs] != retainedBytes[rhs] ? retainedBytes[lhs] > retainedBytes[rhs]
+                                                                              : lhs < rhs;
+                          });
+        census.topRetainers.reserve(limit);
+        for (usize i = 0; i < limit; ++i) {
+            const u32 node = candidates[i];
+            GCObject* obj = nodes_[node];
+            census.topRetainers.push_back(GCRetainer{obj->getType(), objectLabel(obj), retainerPath(node),
+                                                     obj->getSize(), retainedBytes[node], retainedObjects[node]});
+        }
+
+        foldRetentionStacks(census);
+    }
+
+private:
+    struct Edge {
+        u32 from;
+        u32 to;
+    };
+
+    struct TrieNode {
+        u32 parent;
+        u32 label;
+        u32 depth;
+    };
+
+    void walkFromRoots(LuaState* currentState) {
+        current_ = kVirtualRoot;
+        for (GCObject* root : gc_.roots_) {
+            if (root != nullptr) {
+                gc_.markObject(root);
+            }
+        }
+        if (currentState != nullptr) {
+            currentState->getGlobalState().markRoots(gc_, currentState);
+        } else if (gc_.globalState_ != nullptr) {
+            gc_.globalState_->markRoots(gc_, nullptr);
+        }
+        for (Userdata* userdata : gc_.pendingFinalizers_) {
+            gc_.markObject(userdata);
+        }
+
+        while (!pending_.empty()) {
+            current_ = pending_.back();
+            pending_.pop_back();
+            gc_.traverseObject(nodes_[current_]);
+        }
+    }
+
+    void computeDominators() {
+        const usize count = nodes_.size();
+
+        // 后继与前驱按压缩行格式存放
+        std::vector<u32> successorStart(count + 1, 0);
+        std::vector<u32> predecessorStart(count + 1, 0);
+        for (const Edge& edge : edges_) {
+            ++successorStart[edge.from + 1];
+            ++predecessorStart[edge.to + 1];
+        }
+        for (usize i = 0; i < count; ++i) {
+            successorStart[i + 1] += successorStart[i];
+            predecessorStart[i + 1] += predecessorStart[i];
+        }
+        std::vector<u32> successors(edges_.size());
+        std::vector<u32> predecessors(edges_.size());
+        {
+            std::vector<u32> successorFill(successorStart.begin(), successorStart.end() - 1);
+            std::vector<u32> predecessorFill(predecessorStart.begin(), predecessorStart.end() - 1);
+            for (const Edge& edge : edges_) {
+                successors[successorFill[edge.from]++] = edge.to;
+                predecessors[predecessorFill[edge.to]++] = edge.from;
+            }
+        }
+        edges_.clear();
+        edges_.shrink_to_fit();
+
+        // 迭代深度优先求后序编号
+        std::vector<u32> postIndex(count, kUndefined);
+        std::vector<bool> visited(count, false);
+        std::vector<std::pair<u32, u32>> stack;
+        postorder_.reserve(count);
+        stack.emplace_back(kVirtualRoot, successorStart[kVirtualRoot]);
+        visited[kVirtualRoot] = true;
+        while (!stack.empty()) {
+            auto& [node, cursor] = stack.back();
+            if (cursor < successorStart[node + 1]) {
+                const u32 next = successors[cursor++];
+                if (!visited[next]) {
+                    visited[next] = true;
+                    stack.emplace_back(next, successorStart[next]);
+                }
+                continue;
+            }
+            postIndex[node] = static_cast<u32>(postorder_.size());
+            postorder_.push_back(node);
+            stack.pop_back();
+        }
+
+        idom_.assign(count, kUndefined);
+        idom_[kVirtualRoot] = kVirtualRoot;
+        const auto intersect = [this, &postIndex](u32 lhs, u32 rhs) {
+            while (lhs != rhs) {
+                while (postIndex[lhs] < postIndex[rhs]) {
+                    lhs = idom_[lhs];
+                }
+                while (postIndex[rhs] < postIndex[lhs]) {
+                    rhs = idom_[rhs];
+                }
+            }
+            return lhs;
+        };
+
+        bool changed = true;
+        while (changed) {
+            changed = false;
+            for (auto it = postorder_.rbegin(); it != postorder_.rend(); ++it) {
+                const u32 node = *it;
+                if (node == kVirtualRoot) {
+                    continue;
+                }
+                u32 dominator = kUndefined;
+                for (u32 i = predecessorStart[node]; i < predecessorStart[node + 1]; ++i) {
+                    const u32 predecessor = predecessors[i];
+                    if (idom_[predecessor] == kUndefined) {
+                        continue;
+                    }
+                    dominator = dominator == kUndefined ? predecessor : intersect(predecessor, dominator);
+                }
+                if (idom_[node] != dominator) {
+                    idom_[node] = dominator;
+                    changed = true;
+                }
+            }
+        }
+    }
+
+    std::string retainerPath(u32 node) const {
+        std::vector<u32> chain;
+        for (u32 dominator = idom_[node]; dominator != kVirtualRoot; dominator = idom_[dominator]) {
+            chain.push_back(dominator);
+        }
+
+        std::string path = chain.size() > kMaxRetainerPath ? "... > " : "";
+        const usize shown = std::min(chain.size(), kMaxRetainerPath);
+        for (usize i = shown; i > 0; --i) {
+            path += objectLabel(nodes_[chain[i - 1]]);
+            if (i > 1) {
+                path += " > ";
+            }
+        }
+        return path.empty() ? "<root>" : path;
+    }
+
+    u32 labelOf(GCObject* obj, std::unordered_map<std::string, u32>& labelIds, std::vector<std::string>& labels) {
+        std::string label = kindLabel(obj);
+        const auto [it, inserted] = labelIds.try_emplace(std::move(label), static_cast<u32>(labels.size()));
+        if (inserted) {
+            labels.push_back(it->first);
+        }
+        return it->second;
+    }
+
+    /**
+     * @brief 沿支配树按标签建立前缀树，连续相同的标签（链表、嵌套表）折叠为一帧
+     */
+    void foldRetentionStacks(GCHeapCensus& census) {
+        const usize count = nodes_.size();
+        std::unordered_map<std::string, u32> labelIds;
+        std::vector<std::string> labels;
+        std::unordered_map<u64, u32> children;
+        std::vector<TrieNode> trie{TrieNode{kUndefined, kUndefined, 0}};
+        std::vector<usize> weights{0};
+        std::vector<u32> trieOf(count, 0);
+
+        // 逆后序保证支配者先于被支配者处理
+        for (auto it = postorder_.rbegin(); it != postorder_.rend(); ++it) {
+            const u32 node = *it;
+            if (node == kVirtualRoot) {
+                continue;
+            }
+            const u32 parent = trieOf[idom_[node]];
+            const u32 label = labelOf(nodes_[node], labelIds, labels);
+
+            u32 slot = parent;
+            if (trie[parent].label != label && trie[parent].depth < kMaxFoldedDepth) {
+                const u64 key = (static_cast<u64>(parent) << 32) | label;
+                const auto [child, inserted] = children.try_emplace(key, static_cast<u32>(trie.size()));
+                if (inserted) {
+                    trie.push_back(TrieNode{parent, label, trie[parent].depth + 1});
+                    weights.push_back(0);
+                }
+                slot = child->second;
+            }
+            trieOf[node] = slot;
+            weights[slot] += nodes_[node]->getSize();
+        }
+
+        std::vector<u32> frames;
+        for (u32 slot = 1; slot < trie.size(); ++slot) {
+            if (weights[slot] == 0) {
+                continue;
+            }
+            frames.clear();
+            for (u32 frame = slot; frame != 0; frame = trie[frame].parent) {
+                frames.push_back(trie[frame].label);
+            }
+            std::string stack;
+            for (usize i = frames.size(); i > 0; --i) {
+                stack += labels[frames[i - 1]];
+                if (i > 1) {
+                    stack += ';';
+                }
+            }
+            census.retentionStacks[std::move(stack)] += weights[slot];
+        }
+    }
+
+    GarbageCollector& gc_;
+    std::vector<GCObject*> nodes_;
+    std::unordered_map<GCObject*, u32> index_;
+    std::vector<u32> pending_;
+    std::vector<Edge> edges_;
+    std::vector<u32> postorder_;
+    std::vector<u32> idom_;
+    u32 current_ = kVirtualRoot;
+};
+
+// =====================================================================
+// GarbageCollector 堆诊断接口
+// =====================================================================
+
+GCHeapCensus GarbageCollector::takeHeapCensus(LuaState* currentState, usize retainerLimit) {
+    GCHeapCensus census;
+    for (GCObject* obj = allObjects_; obj != nullptr; obj = obj->getNext()) {
+        const usize bytes = obj->getSize();
+        GCCensusBucket& type = census.types[GCHeapCensus::typeIndex(obj->getType())];
+        GCCensusBucket& sizeClass = census.sizeClasses[GCHeapCensus::sizeClassIndex(bytes)];
+        ++type.count;
+        type.bytes += bytes;
+        ++sizeClass.count;
+        sizeClass.bytes += bytes;
+        ++census.total.count;
+        census.total.bytes += bytes;
+    }
+
+    GCHeapWalker walker(*this);
+    walker.walk(currentState);
+    walker.summarize(census, retainerLimit);
+    return census;
+}
+
+void GarbageCollector::recordHeapEdge(GCObject* obj) {
+    heapWalker_->visit(obj);
+}
+
+void GarbageCollector::setAllocationSampleInterval(usize bytes) noexcept {
+    allocationSampleInterval_ = std::min(bytes, static_cast<usize>(std::numeric_limits<isize>::max()));
+    allocationSampleCountdown_ =
+        allocationSampleInterval_ == 0 ? std::numeric_limits<isize>::max() : static_cast<isize>(allocationSampleInterval_);
+}
+
+usize GarbageCollector::getAllocationSampleInterval() const noexcept {
+    return allocationSampleInterval_;
+}
+
+void GarbageCollector::resetAllocationProfile() noexcept {
+    allocationProfile_.clear();
+}
+
+void GarbageCollector::recordAllocationSample(GCObject* obj) noexcept {
+    if (allocationSampleInterval_ == 0) {
+        allocationSampleCountdown_ = std::numeric_limits<isize>::max();
+        return;
+    }
+
+    // 一次大分配可能跨过多个间隔，按跨过的间隔数计权，保持字节估计无偏
+    const usize interval = allocationSampleInterval_;
+    const usize deficit = static_cast<usize>(-allocationSampleCountdown_);
+    const usize samples = deficit / interval + 1;
+    allocationSampleCountdown_ += static_cast<isize>(samples * interval);
+
+    LuaState* state = nullptr;
+    if (globalState_ != nullptr) {
+        Thread* running = globalState_->getRunningThread();
+        state = running != nullptr ? running->getLuaState() : globalState_->getMainThread();
+    }
+
+    try {
+        std::string stack;
+        if (state != nullptr) {
+            appendSampleFrames(stack, state);
+        }
+        if (!stack.empty()) {
+            stack += ';';
+        }
+        stack += typeName(obj->getType());
+        allocationProfile_.record(std::move(stack), samples, samples * interval);
+    } catch (...) {
+        // 样本只用于诊断；记录失败时丢弃，不影响已完成的分配
+    }
+}
+
+} // namespace Lua
@@ -0,0 +1,121 @@
+#pragma once
+
+/**
+ * @file gc_heap_profile.hpp
+ * @brief 堆普查与分配点采样——定位内存由谁持有、由哪段代码分配
+ *
+ * 设计说明：
+ * 堆普查（GarbageCollector::takeHeapCensus）按类型与 2 的幂尺寸级别统计全部托管对象，
+ * 并从根集重新遍历对象图：遍历复用各类型的标记函数，但 markObject 只把边交给普查，
+ * 不改变颜色、灰栈或回收阶段。随后在“虚拟根 → 根集 → 对象”图上求支配树，
+ * 对象的保留大小为其支配子树的大小之和，即断开它后可回收的字节数。弱引用不计为边。
+ *
+ * 分配采样：
+ * createManaged 对每次分配递减一个内联字节计数器，计数器耗尽时记录一个样本：
+ * 当前运行线程（或主线程）的调用栈，Lua 帧解析为“源:行”，叶节点为对象类型。
+ * 样本在记录时即解析为字符串，不持有 Proto 指针，因此不影响回收。
+ *
+ * 导出：
+ * 两者都可写为折叠栈格式（每行“帧;帧;叶 权重”），可直接交给 flamegraph.pl、
+ * inferno 或 speedscope。普查的栈是支配链，权重为对象自身字节数。
+ *
+ * 诊断数据使用全局堆而非 lua_Alloc，避免普查本身改变托管内存记账。
+ */
+
+#include "common/types.hpp"
+
+#include <array>
+#include <iosfwd>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace Lua {
+
+/** @brief 一类对象的数量与字节数。 */
+struct GCCensusBucket {
+    usize count = 0;
+    usize bytes = 0;
+};
+
+/** @brief 支配树中保留大小靠前的对象。 */
+struct GCRetainer {
+    GCObjectType type = GCObjectType::Table;
+    /** @brief 与 tostring 一致的对象描述，函数与原型附带定义位置 */
+    std::string label;
+    /** @brief 从根到该对象的支配链（不含自身），以 " > " 连接 */
+    std::string path;
+    usize selfBytes = 0;
+    usize retainedBytes = 0;
+    usize retainedObjects = 0;
+};
+
+/** @brief 一次堆普查的结果。 */
+struct GCHeapCensus {
+    /** @brief 尺寸级别数：16、32 … 64 KiB，最后一级收纳更大的对象。 */
+    static constexpr usize kSizeClassCount = 14;
+    static constexpr usize kTypeCount = 7;
+
+    /** @brief 按 GCObjectType 排列的统计，下标见 typeIndex() */
+    std::array<GCCensusBucket, kTypeCount> types{};
+    std::array<GCCensusBucket, kSizeClassCount> sizeClasses{};
+
+    /** @brief 收集器链表中的全部对象，含尚未回收的垃圾 */
+    GCCensusBucket total;
+    /** @brief 从根可达的对象 */
+    GCCensusBucket reachable;
+
+    std::vector<GCRetainer> topRetainers;
+
+    /** @brief 以支配链聚合的折叠栈及其自身字节数 */
+    std::unordered_map<std::string, usize> retentionStacks;
+
+    [[nodiscard]] static usize typeIndex(GCObjectType type) noexcept;
+    [[nodiscard]] static usize sizeClassIndex(usize bytes) noexcept;
+    /** @brief 尺寸级别的上界（含）；最后一级返回 usize 最大值 */
+    [[nodiscard]] static usize sizeClassLimit(usize index) noexcept;
+
+    [[nodiscard]] const GCCensusBucket& forType(GCObjectType type) const noexcept {
+        return types[typeIndex(type)];
+    }
+
+    /** @brief 写出折叠栈；返回流状态 */
+    bool writeFolded(std::ostream& out) const;
+};
+
+/** @brief 采样得到的分配点。 */
+struct GCAllocationSite {
+    /** @brief 折叠栈，外层帧在前，叶节点为对象类型 */
+    std::string stack;
+    usize samples = 0;
+    /** @brief 估计分配字节数（样本数乘以采样间隔） */
+    usize bytes = 0;
+};
+
+/** @brief 分配采样器累积的按调用栈聚合的样本。 */
+class GCAllocationProfile {
+public:
+    void record(std::string stack, usize samples, usize bytes);
+    void clear() noexcept;
+
+    [[nodiscard]] usize getSampleCount() const noexcept {
+        return sampleCount_;
+    }
+
+    /** @brief 按估计字节数降序排列的分配点 */
+    [[nodiscard]] std::vector<GCAllocationSite> getSites() const;
+
+    /** @brief 写出以估计字节数为权重的折叠栈；返回流状态 */
+    bool writeFolded(std::ostream& out) const;
+
+private:
+    struct Entry {
+        usize samples = 0;
+        usize bytes = 0;
+    };
+
+    std::unordered_map<std::string, Entry> sites_;
+    usize sampleCount_ = 0;
+};
+
+} // namespace Lua
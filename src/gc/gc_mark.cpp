@@ -4,6 +4,8 @@
  */
 
 #include "gc/garbage_collector.hpp"
+#include "gc/gc_parallel_mark.hpp"
+#include "common/macros.hpp"
 #include "core/function.hpp"
 #include "core/gc_string.hpp"
 #include "core/table.hpp"
@@ -14,29 +16,12 @@
 #include "vm/state/global_state.hpp"
 #include "vm/state/lua_state.hpp"
 #include <algorithm>
+#include <new>
 
 namespace Lua {
 
 namespace {
 
-void markWideStackRoots(GarbageCollector& gc, LuaState* state) {
-    Stack& stack = state->getStack();
-    usize scanTop = std::min(state->getAbsoluteTop(), stack.size());
-
-    LuaVector<CallInfo>& callStack = state->getCallStack();
-    usize callStackSize = state->getCallStackSize();
-    for (usize i = 0; i < callStackSize && i < callStack.size(); i++) {
-        scanTop = std::max(scanTop, std::min(callStack[i].top, stack.size()));
-        if (callStack[i].func < stack.size()) {
-            gc.markValue(stack.at(callStack[i].func));
-        }
-    }
-
-    for (usize i = 0; i < scanTop; i++) {
-        gc.markValue(stack.at(i));
-    }
-}
-
 Function* frameFunction(Stack& stack, const CallInfo& ci) {
     if (ci.func >= stack.size()) {
         return nullptr;
@@ -68,107 +53,155 @@ usize frameCurrentPc(const CallInfo& ci, Proto* proto) {
     return static_cast<usize>((ci.savedpc - begin) - 1);
 }
 
-void markLuaFrameLocals(GarbageCollector& gc, LuaState* state, const CallInfo& ci, Proto* proto) {
-    Stack& stack = state->getStack();
-    usize pc = frameCurrentPc(ci, proto);
+void markSlots(GarbageCollector& gc, Stack& stack, usize begin, usize end) {
+    for (usize i = begin; i < end; i++) {
+        gc.markValue(stack[i]);
+    }
+}
 
-    for (usize i = 0; i < proto->getLocVarCount(); i++) {
-        const LocVar& local = proto->getLocVar(i);
-        if (local.reg < 0) {
+/**
+ * @brief 按栈映射扫描 Lua 调用帧，返回该帧占用的栈区间末端
+ *
+ * 安全点上未被映射选中的寄存器已经死亡，直接置为 nil：这样栈上任何非 nil 槽位在本次标记后
+ * 都指向存活对象，后续以整个窗口扫描的帧（钩子中的非安全点、无栈映射的原型）不会读到已回收
+ * 对象。仍有开放上值引用的槽位保留。按栈位置从高到低调用，以便沿降序的开放上值链表前进。
+ */
+usize markLuaFrame(GarbageCollector& gc, Stack& stack, const CallInfo& ci, Proto* proto, usize limit, bool topFrame,
+                   Upvalue*& openUpvalue) {
+    const usize stackSize = stack.size();
+    const usize frameTop = std::min(ci.top, stackSize);
+    const usize registerEnd = topFrame ? frameTop : std::min(frameTop, limit);
+    const usize end = topFrame ? std::max(frameTop, limit) : std::max(registerEnd, limit);
+
+    // 多返回值可越过 ci.top 暂存，直到下一条指令消费
+    markSlots(gc, stack, std::max(frameTop, ci.base), end);
+
+    const u64* live = ci.savedpc != nullptr ? proto->findStackMap(frameCurrentPc(ci, proto)) : nullptr;
+    const usize registers = proto->getMaxStackSize();
+    for (usize slot = registerEnd; slot-- > ci.base;) {
+        const usize reg = slot - ci.base;
+        if (live == nullptr || reg >= registers || ((live[reg / 64] >> (reg % 64)) & 1) != 0) {
+            gc.markValue(stack[slot]);
             continue;
         }
 
-        usize slot = ci.base + static_cast<usize>(local.reg);
-        if (slot >= stack.size()) {
-            continue;
+        while (openUpvalue != nullptr && openUpvalue->getStackIndex() > slot) {
+            openUpvalue = openUpvalue->getNext();
         }
-
-        if (local.startpc <= static_cast<i32>(pc) && static_cast<i32>(pc) < local.endpc) {
-            gc.markValue(stack.at(slot));
+        if (openUpvalue != nullptr && openUpvalue->getStackIndex() == slot) {
+            gc.markValue(stack[slot]);
+        } else {
+            stack[slot] = Value();
         }
     }
-}
-
-void markLuaFrameStackWindow(GarbageCollector& gc, LuaState* state, const CallInfo& ci) {
-    Stack& stack = state->getStack();
-    usize top = std::min(ci.top, stack.size());
-    usize base = std::min(ci.base, top);
-
-    for (usize i = base; i < top; i++) {
-        gc.markValue(stack.at(i));
-    }
-}
-
-void markCFrameStackWindow(GarbageCollector& gc, LuaState* state, const CallInfo& ci) {
-    Stack& stack = state->getStack();
-    usize absTop = std::min(state->getAbsoluteTop(), stack.size());
-    usize top = std::min({ci.top, absTop, stack.size()});
 
-    for (usize i = ci.base; i < top; i++) {
-        gc.markValue(stack.at(i));
-    }
+    // 可变参数保存在 func 与 base 之间
+    markSlots(gc, stack, std::min(ci.func + 1, stackSize), std::min(ci.base, stackSize));
+    return end;
 }
 
-void markPreciseStackRoots(GarbageCollector& gc, LuaState* state) {
+/**
+ * @brief 扫描线程栈根
+ *
+ * 每个调用帧占据从 func 到下一帧 func 的区间，最上层帧到栈顶为止：C 帧整体扫描，Lua 帧由
+ * markLuaFrame 按栈映射处理。最上层帧之上的物理栈槽不属于任何帧，清为 nil 而不扫描。
+ */
+void markStackRoots(GarbageCollector& gc, LuaState* state) {
     Stack& stack = state->getStack();
+    const usize stackSize = stack.size();
+    const usize absTop = std::min(state->getAbsoluteTop(), stackSize);
     LuaVector<CallInfo>& callStack = state->getCallStack();
-    usize callStackSize = state->getCallStackSize();
+    const usize frameCount = std::min(state->getCallStackSize(), callStack.size());
 
-    if (callStackSize == 0 || callStack.empty()) {
-        usize scanTop = std::min(state->getAbsoluteTop(), stack.size());
-        for (usize i = 0; i < scanTop; i++) {
-            gc.markValue(stack.at(i));
+    if (frameCount == 0) {
+        markSlots(gc, stack, 0, absTop);
+        for (usize i = absTop; i < stackSize; i++) {
+            stack[i] = Value();
         }
         return;
     }
 
-    for (usize i = 0; i < callStackSize && i < callStack.size(); i++) {
+    Upvalue* openUpvalue = state->getOpenUpvalues();
+    usize usedTop = 0;
+    for (usize i = frameCount; i-- > 0;) {
         const CallInfo& ci = callStack[i];
-        if (ci.func < stack.size()) {
-            gc.markValue(stack.at(ci.func));
-        }
+        const bool topFrame = i + 1 == frameCount;
+        const usize limit = topFrame ? absTop : std::min(callStack[i + 1].func, stackSize);
 
         Function* function = frameFunction(stack, ci);
         Proto* proto = function != nullptr ? function->getProto() : nullptr;
+        usize end = 0;
         if (proto != nullptr) {
-            /**
-             * @brief 钩子可在 VM 指令之间运行，此时未命名临时值仍可能存活于寄存器中。
-             *
-             * 常规垃圾回收使用 LocVar 区间，使已过期的循环局部变量不会延长弱表条目的生命周期。
-             */
-            if (state->isDebugHookActive()) {
-                markLuaFrameStackWindow(gc, state, ci);
-            }
-            markLuaFrameLocals(gc, state, ci, proto);
+            end = markLuaFrame(gc, stack, ci, proto, limit, topFrame, openUpvalue);
         } else {
-            markCFrameStackWindow(gc, state, ci);
+            end = std::max(std::min(ci.base, stackSize), limit);
+            markSlots(gc, stack, std::min(ci.base, stackSize), end);
+        }
+        if (ci.func < stackSize) {
+            gc.markValue(stack[ci.func]);
+        }
+        if (topFrame) {
+            usedTop = end;
         }
     }
+
+    markSlots(gc, stack, 0, std::min(callStack[0].func, stackSize));
+    for (usize i = usedTop; i < stackSize; i++) {
+        stack[i] = Value();
+    }
 }
 
 } // namespace
 
 bool GarbageCollector::valueContainsObject(const Value& value) {
-    return value.isString() || value.isTable() || value.isFunction() || value.isUserdata() || value.isThread();
+    return value.isCollectable();
 }
 
 GCObject* GarbageCollector::objectFromValue(const Value& value) {
-    if (value.isString()) {
+    switch (value.getType()) {
+    case ValueType::String:
         return value.asString();
-    }
-    if (value.isTable()) {
+    case ValueType::Table:
         return value.asTable();
-    }
-    if (value.isFunction()) {
+    case ValueType::Function:
         return value.asFunction();
-    }
-    if (value.isUserdata()) {
+    case ValueType::Userdata:
         return value.asUserdata();
-    }
-    if (value.isThread()) {
+    case ValueType::Thread:
         return value.asThread();
+    default:
+        return nullptr;
+    }
+}
+
+void GarbageCollector::traverseObject(GCObject* obj) {
+    /**
+     * @brief 按类型直接调用具体遍历，不经 GCObject::mark 的二次分派。
+     *
+     * 字符串没有子引用，在 markObject 中直接变黑，不会出现在灰栈里。
+     */
+    switch (obj->getType()) {
+    case GCObjectType::Table:
+        markTable(static_cast<Table*>(obj));
+        break;
+    case GCObjectType::Function:
+        static_cast<Function*>(obj)->mark(*this);
+        break;
+    case GCObjectType::Proto:
+        static_cast<Proto*>(obj)->mark(*this);
+        break;
+    case GCObjectType::Upval:
+        static_cast<Upvalue*>(obj)->mark(*this);
+        break;
+    case GCObjectType::Userdata:
+        static_cast<Userdata*>(obj)->mark(*this);
+        break;
+    case GCObjectType::Thread:
+        static_cast<Thread*>(obj)->mark(*this);
+        break;
+    case GCObjectType::String:
+        break;
     }
-    return nullptr;
 }
 
 void GarbageCollector::mark() {
@@ -219,6 +252,36 @@ void GarbageCollector::mark(LuaState* currentState) {
     }
 
     // 5. 传播标记
+    propagateMarksInParallel();
+}
+
+void GarbageCollector::propagateMarksInParallel() {
+    if (parallelMarkThreads_ <= 1 || objectCount_ < parallelMarkThreshold_ || grayList_.empty()) {
+        propagateMarks();
+        return;
+    }
+
+    if (parallelMarkPool_ == nullptr) {
+        parallelMarkPool_.reset(new (std::nothrow) GCParallelMark(*this, parallelMarkThreads_));
+        if (parallelMarkPool_ == nullptr) {
+            propagateMarks();
+            return;
+        }
+    }
+
+    GCParallelMark& parallel = *parallelMarkPool_;
+    parallelMark_ = &parallel;
+    [[maybe_unused]] const bool completed = parallel.run(grayList_);
+    parallelMark_ = nullptr;
+    if (parallel.getWorkerCount() > 1) {
+        ++parallelMarkCycles_;
+    }
+
+    /**
+     * @brief 弱表登记与其他收集器对象的标记只在修改器线程上进行；
+     * 工作者失败时退回的灰色对象也在这里由串行传播完成或重新抛出分配异常。
+     */
+    parallel.finishOnOwner();
     propagateMarks();
 }
 
@@ -244,9 +307,14 @@ usize GarbageCollector::propagateMarks(usize budget) {
          *
          * 若子队列分配失败，原队列槽仍然存在；将对象改回灰色即可使后续重试安全且幂等。
          */
+        if (objectIndex > 0) {
+            // 灰栈后进先出：下一个待扫描对象通常就在当前槽之下，提前取其对象头
+            LUA_PREFETCH(grayList_[objectIndex - 1]);
+        }
+
         obj->setColor(GCColor::Black);
         try {
-            obj->mark(*this);
+            traverseObject(obj);
         } catch (...) {
             obj->setColor(GCColor::Gray);
             throw;
@@ -268,6 +336,15 @@ void GarbageCollector::markObject(GCObject* obj) {
         return;
     }
 
+    if (parallelMark_ != nullptr) {
+        parallelMark_->shade(obj);
+        return;
+    }
+    if (heapWalker_ != nullptr) [[unlikely]] {
+        recordHeapEdge(obj);
+        return;
+    }
+
     GarbageCollector* owner = obj->getOwnerCollector();
     if (owner != nullptr && owner != this) {
         if (std::find(externalMarked_.begin(), externalMarked_.end(), obj) != externalMarked_.end()) {
@@ -295,15 +372,24 @@ void GarbageCollector::markObject(GCObject* obj) {
         return;
     }
 
+    // 字符串没有子引用，直接变黑，省去一次灰栈出入
+    if (obj->getType() == GCObjectType::String) {
+        obj->setColor(GCColor::Black);
+        return;
+    }
+
     /**
      * @brief 改变颜色前发布队列条目；若分配失败，对象保持白色，后续收集可再次尝试。
      */
     grayList_.push_back(obj);
     obj->setColor(GCColor::Gray);
+    if (obj->getType() == GCObjectType::Table) {
+        static_cast<Table*>(obj)->prefetchContents();
+    }
 }
 
 void GarbageCollector::markValue(const Value& value) {
-    if (valueContainsObject(value)) {
+    if (value.isCollectable()) {
         markObject(objectFromValue(value));
     }
 }
@@ -321,6 +407,18 @@ void GarbageCollector::writeBarrier(GCObject* owner, GCObject* child) {
         return;
     }
 
+    if (generational_) {
+        /**
+         * @brief 分代模式只记录老年代所有者，不标记子对象。
+         *
+         * 所有者转为灰色并进入记忆集，下一次次要收集重扫它；之后的写入不再触发屏障。
+         */
+        if ((owner->getMarked() & GCBits::OLD) != 0) {
+            rememberObject(owner);
+        }
+        return;
+    }
+
     markObject(child);
     propagateMarks();
 }
@@ -344,6 +442,13 @@ void GarbageCollector::writeBarrierDeferredNoexcept(GCObject* owner, const Value
         return;
     }
 
+    if (generational_) {
+        if ((owner->getMarked() & GCBits::OLD) != 0) {
+            rememberObject(owner);
+        }
+        return;
+    }
+
     if (incrementalPhase_ == IncrementalPhase::Sweep) {
         /**
          * @brief 清扫不会返回传播阶段，因此放弃剩余游标。
@@ -372,7 +477,8 @@ void GarbageCollector::writeBarrierDeferredNoexcept(GCObject* owner, const Value
 }
 
 void GarbageCollector::writeRootBarrier(GCObject* child) {
-    if (child == nullptr || child->getOwnerCollector() != this || !child->isWhite()) {
+    // 分代模式每次收集都重新标记全部根，且新生代在收集之外必须保持白色
+    if (generational_ || child == nullptr || child->getOwnerCollector() != this || !child->isWhite()) {
         return;
     }
 
@@ -387,11 +493,7 @@ void GarbageCollector::markState(LuaState* state) {
 
     markObject(state->getGlobalTable());
 
-    if (preciseStackRoots_) {
-        markPreciseStackRoots(*this, state);
-    } else {
-        markWideStackRoots(*this, state);
-    }
+    markStackRoots(*this, state);
 
     Upvalue* uv = state->getOpenUpvalues();
     while (uv != nullptr) {
@@ -0,0 +1,448 @@
+/**
+ * @file gc_parallel_mark.cpp
+ * @brief 完整收集并行标记传播实现
+ */
+
+#include "gc/gc_parallel_mark.hpp"
+
+#include "common/macros.hpp"
+#include "core/gc_object.hpp"
+#include "core/table.hpp"
+#include "gc/garbage_collector.hpp"
+
+#include <algorithm>
+
+namespace Lua {
+
+namespace {
+
+/** @brief 私有灰栈达到该长度且共享区为空时，把一半发布给窃取者 */
+constexpr usize kShareThreshold = 64;
+
+} // namespace
+
+thread_local GCParallelMark::Worker* GCParallelMark::currentWorker_ = nullptr;
+
+GCParallelMark::GCParallelMark(GarbageCollector& collector, usize threads) noexcept
+    : collector_(collector), requestedThreads_(std::max<usize>(threads, 1)), workerCount_(0),
+      workers_(LuaStdAllocator<Worker>(&workerAllocator_)),
+      ownerQueue_(LuaStdAllocator<GCObject*>(&workerAllocator_)) {
+    if (const LuaAllocator* allocator = collector.getAllocator(); allocator != nullptr && allocator->isConfigured()) {
+        workerAllocator_.set(&GCParallelMark::allocateSerialized, this);
+    }
+}
+
+void* GCParallelMark::allocateSerialized(void* userData, void* pointer, std::size_t oldSize, std::size_t newSize) {
+    auto* self = static_cast<GCParallelMark*>(userData);
+    const LuaAllocator* backing = self->collector_.getAllocator();
+    std::scoped_lock lock(self->allocatorMutex_);
+    return backing->getFunction()(backing->getUserData(), pointer, oldSize, newSize);
+}
+
+GCParallelMark::~GCParallelMark() {
+    {
+        std::scoped_lock lock(poolMutex_);
+        stopping_ = true;
+    }
+    poolWake_.notify_all();
+    for (std::thread& helper : helpers_) {
+        if (helper.joinable()) {
+            helper.join();
+        }
+    }
+}
+
+bool GCParallelMark::run(LuaVector<GCObject*>& grayList) noexcept {
+    if (!prepare(grayList.data(), grayList.size())) {
+        return false;
+    }
+    grayList.clear();
+
+    {
+        std::scoped_lock lock(poolMutex_);
+        ++generation_;
+        runningHelpers_ = helpers_.size();
+    }
+    poolWake_.notify_all();
+
+    work(0);
+    {
+        std::unique_lock lock(poolMutex_);
+        poolDone_.wait(lock, [this] { return runningHelpers_ == 0; });
+    }
+    if (!failed_.load(std::memory_order_relaxed)) {
+        return true;
+    }
+
+    restoreGray(grayList);
+    return false;
+}
+
+void GCParallelMark::finishOnOwner() {
+    for (usize i = 0; i < workerCount_; ++i) {
+        Worker& worker = workers_[i];
+        for (Table* table : worker.weakTables) {
+            collector_.weakTables_.push_back(table);
+        }
+        worker.weakTables.clear();
+    }
+
+    /** @brief 其他收集器的对象沿用串行路径，由 externalMarked_ 去重。 */
+    for (usize i = 0; i < workerCount_; ++i) {
+        Worker& worker = workers_[i];
+        for (GCObject* obj : worker.external) {
+            collector_.markObject(obj);
+        }
+        worker.external.clear();
+    }
+}
+
+void GCParallelMark::startHelpers() noexcept {
+    try {
+        LuaVector<Worker> workers(requestedThreads_, LuaStdAllocator<Worker>(&workerAllocator_));
+        for (Worker& worker : workers) {
+            worker.local = LuaVector<GCObject*>(LuaStdAllocator<GCObject*>(&workerAllocator_));
+            worker.shared = LuaVector<GCObject*>(LuaStdAllocator<GCObject*>(&workerAllocator_));
+            worker.weakTables = LuaVector<Table*>(LuaStdAllocator<Table*>(&workerAllocator_));
+            worker.external = ExternalSet(ExternalSet::allocator_type(&workerAllocator_));
+        }
+        helpers_.reserve(requestedThreads_ - 1);
+        workers_.swap(workers);
+    } catch (...) {
+        // 工作者数组已就绪时修改器线程可单独传播
+        return;
+    }
+
+    for (usize index = 1; index < requestedThreads_; ++index) {
+        try {
+            helpers_.emplace_back([this, index] { helperLoop(index); });
+        } catch (...) {
+            // 线程数不足时以已启动的工作者继续，修改器线程总能单独完成
+            break;
+        }
+    }
+}
+
+void GCParallelMark::helperLoop(usize index) noexcept {
+    u64 seen = 0;
+    std::unique_lock lock(poolMutex_);
+    while (true) {
+        poolWake_.wait(lock, [this, &seen] { return stopping_ || generation_ != seen; });
+        if (stopping_) {
+            return;
+        }
+        seen = generation_;
+        lock.unlock();
+
+        work(index);
+
+        lock.lock();
+        if (--runningHelpers_ == 0) {
+            poolDone_.notify_one();
+        }
+    }
+}
+
+bool GCParallelMark::prepare(GCObject* const* seeds, usize seedCount) noexcept {
+    workerCount_ = 0;
+    if (workers_.empty()) {
+        startHelpers();
+        if (workers_.empty()) {
+            return false;
+        }
+    }
+
+    /** @brief 工作线程此时都阻塞在轮次等待上，本轮状态可直接重置。 */
+    const usize workerCount = helpers_.size() + 1;
+    for (usize i = 0; i < workerCount; ++i) {
+        Worker& worker = workers_[i];
+        worker.local.clear();
+        worker.shared.clear();
+        worker.sharedSize.store(0);
+        worker.weakTables.clear();
+        worker.external.clear();
+    }
+    ownerQueue_.clear();
+    finished_ = false;
+    idleWorkers_.store(0);
+    failed_.store(false);
+
+    try {
+        // 在修改器线程上预留容量，传播期间的扩容才需经锁调用分配器
+        const usize localReserve = std::max(kShareThreshold * 2, seedCount / workerCount + 1);
+        for (usize i = 0; i < workerCount; ++i) {
+            workers_[i].local.reserve(localReserve);
+        }
+        usize next = 0;
+        for (usize i = 0; i < seedCount; ++i) {
+            GCObject* seed = seeds[i];
+            if (seed->getType() == GCObjectType::Thread) {
+                ownerQueue_.push_back(seed);
+            } else {
+                workers_[next++ % workerCount].local.push_back(seed);
+            }
+        }
+    } catch (...) {
+        for (usize i = 0; i < workerCount; ++i) {
+            workers_[i].local.clear();
+        }
+        ownerQueue_.clear();
+        return false;
+    }
+
+    ownerPending_.store(ownerQueue_.size());
+    workerCount_ = workerCount;
+    return true;
+}
+
+void GCParallelMark::work(usize index) noexcept {
+    Worker& self = workers_[index];
+    currentWorker_ = &self;
+    const bool owner = index == 0;
+
+    while (!failed_.load(std::memory_order_relaxed)) {
+        if (owner && ownerPending_.load() != 0) {
+            if (!traverseOwnerObject()) {
+                break;
+            }
+            continue;
+        }
+        if (self.local.empty()) {
+            if (acquireWork(index) || awaitWork(index)) {
+                continue;
+            }
+            break;
+        }
+
+        /** @brief 与串行传播相同：遍历完成前对象一直留在灰栈槽中，失败时可原样退回。 */
+        const usize slot = self.local.size() - 1;
+        GCObject* obj = self.local[slot];
+        if (slot > 0) {
+            LUA_PREFETCH(self.local[slot - 1]);
+        }
+
+        obj->setColorConcurrent(GCColor::Black);
+        try {
+            collector_.traverseObject(obj);
+        } catch (...) {
+            obj->setColorConcurrent(GCColor::Gray);
+            fail();
+            break;
+        }
+
+        self.local[slot] = self.local.back();
+        self.local.pop_back();
+
+        if (self.local.size() >= kShareThreshold && self.sharedSize.load() == 0) {
+            shareWork(self);
+        }
+    }
+
+    currentWorker_ = nullptr;
+}
+
+bool GCParallelMark::traverseOwnerObject() noexcept {
+    /** @brief 工作线程只会在队列末尾追加，遍历期间槽位下标保持有效。 */
+    usize slot = 0;
+    GCObject* obj = nullptr;
+    {
+        std::scoped_lock lock(ownerMutex_);
+        slot = ownerQueue_.size() - 1;
+        obj = ownerQueue_[slot];
+    }
+
+    obj->setColorConcurrent(GCColor::Black);
+    try {
+        collector_.traverseObject(obj);
+    } catch (...) {
+        obj->setColorConcurrent(GCColor::Gray);
+        fail();
+        return false;
+    }
+
+    std::scoped_lock lock(ownerMutex_);
+    ownerQueue_[slot] = ownerQueue_.back();
+    ownerQueue_.pop_back();
+    ownerPending_.store(ownerQueue_.size());
+    return true;
+}
+
+void GCParallelMark::queueOwnerObject(GCObject* obj) {
+    {
+        std::scoped_lock lock(ownerMutex_);
+        ownerQueue_.push_back(obj);
+        ownerPending_.store(ownerQueue_.size());
+    }
+    if (currentWorker_ != &workers_[0]) {
+        // 修改器线程可能正在空闲等待，只唤醒一个工作者不一定轮到它
+        wakeIdle(true);
+    }
+}
+
+bool GCParallelMark::acquireWork(usize index) noexcept {
+    Worker& self = workers_[index];
+    try {
+        for (usize offset = 0; offset < workerCount_; ++offset) {
+            Worker& victim = workers_[(index + offset) % workerCount_];
+            if (victim.sharedSize.load() == 0) {
+                continue;
+            }
+
+            std::scoped_lock lock(victim.mutex);
+            const usize available = victim.shared.size();
+            if (available == 0) {
+                continue;
+            }
+            // 取回自己的共享区时全部取走，从他人处只窃取一半
+            const usize take = offset == 0 ? available : (available + 1) / 2;
+            self.local.insert(self.local.end(), victim.shared.end() - static_cast<std::ptrdiff_t>(take),
+                              victim.shared.end());
+            victim.shared.resize(available - take);
+            victim.sharedSize.store(victim.shared.size());
+            return true;
+        }
+    } catch (...) {
+        fail();
+    }
+    return false;
+}
+
+bool GCParallelMark::awaitWork(usize index) noexcept {
+    std::unique_lock lock(idleMutex_);
+    idleWorkers_.fetch_add(1);
+    while (true) {
+        if (finished_ || failed_.load()) {
+            return false;
+        }
+
+        const bool ownerWork = index == 0 && ownerPending_.load() != 0;
+        if (ownerWork || hasSharedWork()) {
+            idleWorkers_.fetch_sub(1);
+            lock.unlock();
+            if (ownerWork || acquireWork(index)) {
+                return true;
+            }
+            lock.lock();
+            idleWorkers_.fetch_add(1);
+            continue;
+        }
+
+        /**
+         * @brief 只有活动工作者会发布共享工作或排队线程对象，而它在转为空闲前已确认自己的共享区为空；
+         * 因此全部空闲且修改器队列为空时不会再有新的灰色对象。
+         */
+        if (idleWorkers_.load() == workerCount_ && ownerPending_.load() == 0) {
+            finished_ = true;
+            idleWake_.notify_all();
+            return false;
+        }
+        idleWake_.wait(lock);
+    }
+}
+
+bool GCParallelMark::hasSharedWork() const noexcept {
+    for (usize i = 0; i < workerCount_; ++i) {
+        if (workers_[i].sharedSize.load() != 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void GCParallelMark::shareWork(Worker& self) noexcept {
+    const auto half = static_cast<std::ptrdiff_t>(self.local.size() / 2);
+    {
+        std::scoped_lock lock(self.mutex);
+        try {
+            self.shared.insert(self.shared.end(), self.local.begin(), self.local.begin() + half);
+        } catch (...) {
+            // 发布失败不影响正确性，这些对象仍由自己遍历
+            return;
+        }
+        self.local.erase(self.local.begin(), self.local.begin() + half);
+        self.sharedSize.store(self.shared.size());
+    }
+    wakeIdle(false);
+}
+
+void GCParallelMark::wakeIdle(bool all) noexcept {
+    /**
+     * @brief 发布方先写入工作计数再读取空闲数，等待方先增加空闲数再读取工作计数；
+     * 两侧都是顺序一致的原子操作，至少一方能看到对方，因此跳过通知不会丢失唤醒。
+     */
+    if (idleWorkers_.load() == 0) {
+        return;
+    }
+    {
+        std::scoped_lock lock(idleMutex_);
+    }
+    if (all) {
+        idleWake_.notify_all();
+    } else {
+        idleWake_.notify_one();
+    }
+}
+
+void GCParallelMark::fail() noexcept {
+    failed_.store(true);
+    wakeIdle(true);
+}
+
+void GCParallelMark::restoreGray(LuaVector<GCObject*>& grayList) noexcept {
+    for (usize i = 0; i < workerCount_; ++i) {
+        Worker& worker = workers_[i];
+        for (GCObject* obj : worker.local) {
+            grayList.push_back(obj);
+        }
+        for (GCObject* obj : worker.shared) {
+            grayList.push_back(obj);
+        }
+        worker.local.clear();
+        worker.shared.clear();
+        worker.sharedSize.store(0);
+    }
+    for (GCObject* obj : ownerQueue_) {
+        grayList.push_back(obj);
+    }
+    ownerQueue_.clear();
+    ownerPending_.store(0);
+}
+
+void GCParallelMark::shade(GCObject* obj) {
+    GarbageCollector* owner = obj->getOwnerCollector();
+    if (owner != nullptr && owner != &collector_) {
+        (void)currentWorker_->external.insert(obj);
+        return;
+    }
+
+    if (obj->getType() == GCObjectType::String) {
+        (void)obj->tryShadeConcurrent(GCColor::Black);
+        return;
+    }
+
+    if (!obj->tryShadeConcurrent(GCColor::Gray)) {
+        return;
+    }
+    try {
+        if (obj->getType() == GCObjectType::Thread) {
+            queueOwnerObject(obj);
+        } else {
+            currentWorker_->local.push_back(obj);
+        }
+    } catch (...) {
+        /**
+         * @brief 对象未入栈则退回白色；引用它的父对象会因本次失败保持灰色并在串行传播中重扫。
+         */
+        obj->setColorConcurrent(GCColor::White);
+        throw;
+    }
+    if (obj->getType() == GCObjectType::Table) {
+        static_cast<Table*>(obj)->prefetchContents();
+    }
+}
+
+void GCParallelMark::recordWeakTable(Table* table) {
+    currentWorker_->weakTables.push_back(table);
+}
+
+} // namespace Lua
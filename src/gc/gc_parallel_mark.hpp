@@ -0,0 +1,161 @@
+#pragma once
+
+/**
+ * @file gc_parallel_mark.hpp
+ * @brief 完整收集的并行标记传播——灰色对象由常驻工作线程以工作窃取方式遍历
+ *
+ * 设计说明：
+ * 根集仍由修改器线程串行标记；之后灰栈中的种子分给各工作者（修改器线程自身是 0 号工作者），
+ * 每个工作者从私有灰栈弹出对象遍历，子对象经 GCObject::tryShadeConcurrent 原子着色，
+ * 赢得比较交换的线程负责压栈，因此每个对象只被遍历一次。传播期间标记位的读取都是原子加载，
+ * 改写都是比较交换循环，不会覆盖其他工作者同时完成的着色。
+ *
+ * 工作窃取：
+ * 私有灰栈增长到阈值且共享区为空时，工作者把栈底一半（靠近根、子图通常更大）移入
+ * 自己的共享区；空闲工作者先取回自己的共享区，再从其他工作者的共享区末尾窃取一半，
+ * 找不到工作时在条件变量上等待。全部工作者同时空闲且没有待修改器处理的对象即传播结束。
+ *
+ * 修改器线程独占的部分：
+ * 线程对象的遍历会把栈上死寄存器置为 nil，只由 0 号工作者执行：着色后进入修改器队列，
+ * 不进入可被窃取的灰栈。弱表与属于其他收集器的对象记录在各工作者的私有列表中，
+ * 传播结束后由修改器线程并入收集器弱表列表或按原有路径标记。
+ * 任一工作者分配失败时全部停止，剩余灰色对象退回收集器灰栈，由串行传播继续或重新抛出。
+ *
+ * 工作线程在首次并行传播时启动，之后常驻并在两次传播之间阻塞等待。
+ * 工作者数组、私有灰栈、共享区、记录集合与修改器队列与串行灰栈一样经 lua_Alloc 分配；
+ * 传播期间多个线程可能同时扩容，这些请求经互斥锁串行后再调用收集器的分配器函数，
+ * 分配器函数因此同一时刻只被调用一次，但可能在工作线程上被调用。
+ * 修改器线程在分发种子时预留私有灰栈容量，多数传播不会在工作线程上分配。
+ */
+
+#include "common/types.hpp"
+#include "runtime/lua_allocator.hpp"
+
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+
+namespace Lua {
+
+class GarbageCollector;
+class GCObject;
+class Table;
+
+/** @brief 由垃圾回收器拥有、跨收集复用的并行标记工作者集合。 */
+class GCParallelMark {
+public:
+    GCParallelMark(GarbageCollector& collector, usize threads) noexcept;
+
+    /** @brief 通知常驻工作线程退出并等待结束。 */
+    ~GCParallelMark();
+
+    GCParallelMark(const GCParallelMark&) = delete;
+    GCParallelMark& operator=(const GCParallelMark&) = delete;
+
+    /**
+     * @brief 把灰栈中的种子分给工作者并传播到没有灰色对象
+     *
+     * 种子分发失败时 grayList 保持原样；工作者失败时剩余灰色对象追加回 grayList。
+     * grayList 在标记开始时已预留对象总数的容量，而每个对象至多出现在一个灰栈中，因此追加不会分配。
+     *
+     * @return true 表示全部灰色对象已遍历
+     */
+    bool run(LuaVector<GCObject*>& grayList) noexcept;
+
+    /**
+     * @brief 在修改器线程上并入本轮记录的弱表，并按串行路径标记其他收集器的对象
+     *
+     * 须在收集器退出并行模式后调用；串行标记新产生的灰色对象留在收集器灰栈中。
+     */
+    void finishOnOwner();
+
+    /**
+     * @brief 工作线程上的 markObject：原子着色并压入当前工作者的私有灰栈
+     */
+    void shade(GCObject* obj);
+
+    /** @brief 在当前工作者的私有列表中登记弱表，传播结束后并入收集器 */
+    void recordWeakTable(Table* table);
+
+    /** @brief 最近一次传播实际参与的工作者数量（含修改器线程） */
+    [[nodiscard]] usize getWorkerCount() const noexcept {
+        return workerCount_;
+    }
+
+private:
+    using ExternalSet = std::unordered_set<GCObject*, std::hash<GCObject*>, std::equal_to<GCObject*>,
+                                           LuaStdAllocator<GCObject*>>;
+
+    struct Worker {
+        /** @brief 只由所属线程访问的灰栈 */
+        LuaVector<GCObject*> local;
+        /** @brief 保护 shared */
+        std::mutex mutex;
+        /** @brief 可被其他工作者窃取的灰色对象 */
+        LuaVector<GCObject*> shared;
+        /** @brief shared 的大小，供窃取者免锁探测 */
+        std::atomic<usize> sharedSize{0};
+        /** @brief 本轮遇到的弱表，只由所属线程写入 */
+        LuaVector<Table*> weakTables;
+        /** @brief 本轮遇到的其他收集器对象（去重），只由所属线程写入 */
+        ExternalSet external;
+    };
+
+    /** @brief workerAllocator_ 的分配器函数：持锁转发给收集器的分配器函数 */
+    static void* allocateSerialized(void* userData, void* pointer, std::size_t oldSize, std::size_t newSize);
+
+    void startHelpers() noexcept;
+    void helperLoop(usize index) noexcept;
+    bool prepare(GCObject* const* seeds, usize seedCount) noexcept;
+    void work(usize index) noexcept;
+    bool traverseOwnerObject() noexcept;
+    void queueOwnerObject(GCObject* obj);
+    bool acquireWork(usize index) noexcept;
+    bool awaitWork(usize index) noexcept;
+    bool hasSharedWork() const noexcept;
+    void shareWork(Worker& self) noexcept;
+    void wakeIdle(bool all) noexcept;
+    void fail() noexcept;
+    void restoreGray(LuaVector<GCObject*>& grayList) noexcept;
+
+    /** @brief 当前线程所属的工作者；shade() 经由它找到私有灰栈 */
+    static thread_local Worker* currentWorker_;
+
+    GarbageCollector& collector_;
+    usize requestedThreads_;
+    usize workerCount_;
+
+    /** @brief 串行化工作线程上的 lua_Alloc 调用 */
+    std::mutex allocatorMutex_;
+    /** @brief 工作者容器使用的分配器；收集器未配置分配器时同样未配置，容器退回全局堆 */
+    LuaAllocator workerAllocator_;
+
+    LuaVector<Worker> workers_;
+    std::vector<std::thread> helpers_;
+
+    /** @brief 保护常驻线程的轮次状态 */
+    std::mutex poolMutex_;
+    std::condition_variable poolWake_;
+    std::condition_variable poolDone_;
+    u64 generation_ = 0;
+    usize runningHelpers_ = 0;
+    bool stopping_ = false;
+
+    /** @brief 空闲工作者在此等待可窃取的工作、修改器队列中的对象或传播结束 */
+    std::mutex idleMutex_;
+    std::condition_variable idleWake_;
+    bool finished_ = false;
+    std::atomic<usize> idleWorkers_{0};
+    std::atomic<bool> failed_{false};
+
+    /** @brief 只能由修改器线程遍历的灰色对象（线程），遍历完成前一直留在队列中 */
+    std::mutex ownerMutex_;
+    LuaVector<GCObject*> ownerQueue_;
+    std::atomic<usize> ownerPending_{0};
+};
+
+} // namespace Lua
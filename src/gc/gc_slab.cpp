@@ -0,0 +1,187 @@
+/**
+ * @file gc_slab.cpp
+ * @brief 垃圾回收小对象块池实现
+ */
+
+#include "gc/gc_slab.hpp"
+#include "common/macros.hpp"
+#include "runtime/lua_allocator.hpp"
+
+#include <algorithm>
+#include <functional>
+#include <memory>
+#include <new>
+
+namespace Lua {
+
+GCSlabAllocator* GCSlabAllocator::create(LuaAllocator* backing) noexcept {
+    void* memory = nullptr;
+    if (backing != nullptr && backing->isConfigured()) {
+        memory = backing->allocate(sizeof(GCSlabAllocator));
+    } else {
+        memory = ::operator new(sizeof(GCSlabAllocator), std::nothrow);
+    }
+    if (memory == nullptr) {
+        return nullptr;
+    }
+    return ::new (memory) GCSlabAllocator(backing);
+}
+
+void* GCSlabAllocator::allocateRaw(usize size) const noexcept {
+    if (backing_ != nullptr && backing_->isConfigured()) {
+        return backing_->allocate(size);
+    }
+    return ::operator new(size, std::nothrow);
+}
+
+void GCSlabAllocator::deallocateRaw(void* memory, usize size) const noexcept {
+    if (backing_ != nullptr && backing_->isConfigured()) {
+        backing_->deallocate(memory, size);
+    } else {
+        ::operator delete(memory);
+    }
+}
+
+GCSlabAllocator::PageHeader* GCSlabAllocator::allocatePage(usize index) noexcept {
+    auto* page = static_cast<PageHeader*>(allocateRaw(kPageBytes));
+    if (page == nullptr) {
+        return nullptr;
+    }
+    try {
+        // 页目录也经后备分配器；预留初始容量使少量页只多一次目录请求
+        if (pages_.capacity() == 0) {
+            pages_.reserve(kInitialPageDirectory);
+        }
+        pages_.insert(std::upper_bound(pages_.begin(), pages_.end(), page, std::less<>()), page);
+    } catch (...) {
+        deallocateRaw(page, kPageBytes);
+        return nullptr;
+    }
+
+    // 新页只按需递增切分，不预先串成链表
+    page->prevAvailable = nullptr;
+    page->nextAvailable = nullptr;
+    page->freeList = nullptr;
+    page->bumpCursor = reinterpret_cast<char*>(page) + sizeof(PageHeader);
+    page->liveBlocks = 0;
+    page->classIndex = static_cast<u32>(index);
+    page->available = false;
+    linkAvailable(page);
+    return page;
+}
+
+GCSlabAllocator::PageHeader* GCSlabAllocator::findPage(void* block) const noexcept {
+    auto it = std::upper_bound(pages_.begin(), pages_.end(), block, std::less<>());
+    return *(it - 1);
+}
+
+void GCSlabAllocator::linkAvailable(PageHeader* page) noexcept {
+    PageHeader*& head = available_[page->classIndex];
+    page->prevAvailable = nullptr;
+    page->nextAvailable = head;
+    if (head != nullptr) {
+        head->prevAvailable = page;
+    }
+    head = page;
+    page->available = true;
+}
+
+void GCSlabAllocator::unlinkAvailable(PageHeader* page) noexcept {
+    if (page->prevAvailable != nullptr) {
+        page->prevAvailable->nextAvailable = page->nextAvailable;
+    } else {
+        available_[page->classIndex] = page->nextAvailable;
+    }
+    if (page->nextAvailable != nullptr) {
+        page->nextAvailable->prevAvailable = page->prevAvailable;
+    }
+    page->prevAvailable = nullptr;
+    page->nextAvailable = nullptr;
+    page->available = false;
+}
+
+void* GCSlabAllocator::allocate(usize size) noexcept {
+    const usize index = classIndex(size);
+    PageHeader* page = available_[index];
+    if (page == nullptr) {
+        page = allocatePage(index);
+        if (page == nullptr) {
+            return nullptr;
+        }
+    }
+
+    const usize blockBytes = (index + 1) * kGranularity;
+    char* const pageEnd = reinterpret_cast<char*>(page) + kPageBytes;
+    void* block = nullptr;
+    if (FreeBlock* freed = page->freeList; freed != nullptr) {
+        page->freeList = freed->next;
+        block = freed;
+    } else {
+        block = page->bumpCursor;
+        page->bumpCursor += blockBytes;
+    }
+
+    // 页尾不足一块的余量直接放弃
+    if (page->freeList == nullptr && static_cast<usize>(pageEnd - page->bumpCursor) < blockBytes) {
+        unlinkAvailable(page);
+    }
+    ++page->liveBlocks;
+    ++liveBlocks_;
+    return block;
+}
+
+void GCSlabAllocator::deallocate(void* block, [[maybe_unused]] usize size) noexcept {
+    PageHeader* page = findPage(block);
+    LUA_ASSERT(page->classIndex == classIndex(size));
+    auto* freed = static_cast<FreeBlock*>(block);
+    freed->next = page->freeList;
+    page->freeList = freed;
+    if (!page->available) {
+        linkAvailable(page);
+    }
+    --page->liveBlocks;
+    --liveBlocks_;
+    if (ownerReleased_ && liveBlocks_ == 0) {
+        destroy();
+    }
+}
+
+usize GCSlabAllocator::releaseEmptyPages() noexcept {
+    usize released = 0;
+    auto kept = std::remove_if(pages_.begin(), pages_.end(), [&](PageHeader* page) {
+        if (page->liveBlocks != 0) {
+            return false;
+        }
+        if (page->available) {
+            unlinkAvailable(page);
+        }
+        deallocateRaw(page, kPageBytes);
+        ++released;
+        return true;
+    });
+    pages_.erase(kept, pages_.end());
+    return released;
+}
+
+void GCSlabAllocator::releaseOwner() noexcept {
+    ownerReleased_ = true;
+    if (liveBlocks_ == 0) {
+        destroy();
+    }
+}
+
+void GCSlabAllocator::destroy() noexcept {
+    for (PageHeader* page : pages_) {
+        deallocateRaw(page, kPageBytes);
+    }
+
+    LuaAllocator* backing = backing_;
+    this->~GCSlabAllocator();
+    if (backing != nullptr && backing->isConfigured()) {
+        backing->deallocate(this, sizeof(GCSlabAllocator));
+    } else {
+        ::operator delete(this);
+    }
+}
+
+} // namespace Lua
@@ -0,0 +1,155 @@
+#pragma once
+
+/**
+ * @file gc_slab.hpp
+ * @brief 垃圾回收小对象块池——按尺寸分级的定长块分配
+ *
+ * 设计说明：
+ * 短字符串、表、闭包、上值等小对象在堆中占绝大多数，逐个经 lua_Alloc 分配会让
+ * 分配器元数据与碎片开销超过载荷本身。块池从后备分配器成页申请内存，按 16 字节
+ * 粒度分级：每个级别有独立的当前页，分配先弹出空闲链表，否则在当前页内指针递增；
+ * 清扫释放的块压回对应级别的空闲链表。同级对象集中在少数页中，清扫时访存更集中。
+ *
+ * 配额：
+ * 后备分配器只看到整页请求与页目录，其记账与配额按页粒度精确；清扫结束时归还空页。
+ * 收集器的托管字节仍按对象大小计费：暂停与步长参数以存活对象字节定义，页内余量
+ * 不计入，且由空页归还限定在每个级别少数未满页之内。
+ *
+ * 生命周期：
+ * 对象可能随 StringPool 迁移到其他收集器，因此对象头记录的是块池指针而非
+ * 收集器。收集器析构时只放弃所有权；最后一个存活块归还后块池才释放全部页。
+ */
+
+#include "common/types.hpp"
+#include "runtime/lua_allocator.hpp"
+
+#include <array>
+
+namespace Lua {
+
+/** @brief 由垃圾回收器拥有的小对象块池。 */
+class GCSlabAllocator {
+public:
+    /** @brief 尺寸级别粒度（字节），同时保证块对齐。 */
+    static constexpr usize kGranularity = 16;
+    /** @brief 块池承接的最大块大小（字节），覆盖表、闭包、上值与完整用户数据头。 */
+    static constexpr usize kMaxBlockBytes = 256;
+    /** @brief 每次向后备分配器申请的页大小（字节）。 */
+    static constexpr usize kPageBytes = 4096;
+
+    /**
+     * @brief 创建块池
+     * @param backing 后备分配器；未配置时使用 ::operator new
+     * @return 块池指针；内存不足时返回 nullptr
+     */
+    [[nodiscard]] static GCSlabAllocator* create(LuaAllocator* backing) noexcept;
+
+    GCSlabAllocator(const GCSlabAllocator&) = delete;
+    GCSlabAllocator& operator=(const GCSlabAllocator&) = delete;
+
+    /**
+     * @brief 判断请求大小是否由块池承接
+     */
+    [[nodiscard]] static constexpr bool handles(usize size) noexcept {
+        return size != 0 && size <= kMaxBlockBytes;
+    }
+
+    /**
+     * @brief 分配一个块
+     * @param size 请求字节数，必须满足 handles(size)
+     * @return 块地址；申请新页失败时返回 nullptr，由调用方按内存不足处理
+     */
+    [[nodiscard]] void* allocate(usize size) noexcept;
+
+    /**
+     * @brief 归还一个块
+     * @param block allocate() 返回的地址
+     * @param size 分配时的请求字节数
+     *
+     * 所有者已放弃且这是最后一个存活块时，块池在返回前销毁自身。
+     */
+    void deallocate(void* block, usize size) noexcept;
+
+    /**
+     * @brief 所有者（收集器）放弃块池
+     *
+     * 没有存活块时立即销毁；否则延迟到最后一个块归还。
+     */
+    void releaseOwner() noexcept;
+
+    /**
+     * @brief 把没有存活块的页归还后备分配器
+     * @return 归还的页数
+     *
+     * 由完整清扫与新生代清扫结束时调用；逐块释放时不归还，避免分配与释放交替时反复申请同一页。
+     */
+    usize releaseEmptyPages() noexcept;
+
+    /** @brief 后备分配器；未配置时块池使用全局堆。 */
+    [[nodiscard]] LuaAllocator* getBackingAllocator() const noexcept {
+        return backing_;
+    }
+
+    /** @brief 当前存活块数量。 */
+    [[nodiscard]] usize getLiveBlocks() const noexcept {
+        return liveBlocks_;
+    }
+
+    /** @brief 已向后备分配器申请的页数量。 */
+    [[nodiscard]] usize getPageCount() const noexcept {
+        return pages_.size();
+    }
+
+    /** @brief 后备分配器视角下块池占用的字节数（页粒度）。 */
+    [[nodiscard]] usize getReservedBytes() const noexcept {
+        return pages_.size() * kPageBytes;
+    }
+
+private:
+    static constexpr usize kClassCount = kMaxBlockBytes / kGranularity;
+    /** @brief 页目录首次分配的容量（页数）。 */
+    static constexpr usize kInitialPageDirectory = 16;
+
+    struct FreeBlock {
+        FreeBlock* next;
+    };
+
+    /** @brief 页头；块从页头之后按级别大小切分。 */
+    struct alignas(kGranularity) PageHeader {
+        /** @brief 同级别非满页的双向链表 */
+        PageHeader* prevAvailable;
+        PageHeader* nextAvailable;
+        FreeBlock* freeList;
+        /** @brief 本页尚未切分的区间 [bumpCursor, 页尾) */
+        char* bumpCursor;
+        u32 liveBlocks;
+        u32 classIndex;
+        bool available;
+    };
+
+    explicit GCSlabAllocator(LuaAllocator* backing) noexcept
+        : backing_(backing), pages_(LuaStdAllocator<PageHeader*>(backing)) {}
+    ~GCSlabAllocator() = default;
+
+    [[nodiscard]] static constexpr usize classIndex(usize size) noexcept {
+        return (size - 1) / kGranularity;
+    }
+
+    [[nodiscard]] void* allocateRaw(usize size) const noexcept;
+    void deallocateRaw(void* memory, usize size) const noexcept;
+    [[nodiscard]] PageHeader* allocatePage(usize index) noexcept;
+    [[nodiscard]] PageHeader* findPage(void* block) const noexcept;
+    void linkAvailable(PageHeader* page) noexcept;
+    void unlinkAvailable(PageHeader* page) noexcept;
+    void destroy() noexcept;
+
+    LuaAllocator* backing_;
+    /** @brief 各级别仍有空闲块或未切分区间的页 */
+    std::array<PageHeader*, kClassCount> available_{};
+    /** @brief 按地址升序排列的全部页，释放时据此定位块所属页；与收集器工作表一样经后备分配器分配 */
+    LuaVector<PageHeader*> pages_;
+    usize liveBlocks_ = 0;
+    bool ownerReleased_ = false;
+};
+
+} // namespace Lua
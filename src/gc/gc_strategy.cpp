@@ -33,6 +33,18 @@ const char* IncrementalGC::summary() const noexcept {
     return "phased mark/atomic/sweep/finalize collection driven by GC debt and step budget";
 }
 
+usize GenerationalGC::collect(GCContext& context) const {
+    return context.collector.collectGenerationalMajor(context.stringPool, context.currentState, true);
+}
+
+const char* GenerationalGC::name() const noexcept {
+    return "generational";
+}
+
+const char* GenerationalGC::summary() const noexcept {
+    return "minor collections over young objects with remembered old owners, periodic major collections";
+}
+
 const GCStrategy& markSweepGCStrategy() noexcept {
     static const MarkSweepGC strategy;
     return strategy;
@@ -43,6 +55,11 @@ const GCStrategy& incrementalGCStrategy() noexcept {
     return strategy;
 }
 
+const GCStrategy& generationalGCStrategy() noexcept {
+    static const GenerationalGC strategy;
+    return strategy;
+}
+
 Opt<std::reference_wrapper<const GCStrategy>> findGCStrategy(StrView name) noexcept {
     if (name == markSweepGCStrategy().name()) {
         return std::cref(markSweepGCStrategy());
@@ -50,6 +67,9 @@ Opt<std::reference_wrapper<const GCStrategy>> findGCStrategy(StrView name) noexc
     if (name == incrementalGCStrategy().name()) {
         return std::cref(incrementalGCStrategy());
     }
+    if (name == generationalGCStrategy().name()) {
+        return std::cref(generationalGCStrategy());
+    }
     return std::nullopt;
 }
 
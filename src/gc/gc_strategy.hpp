@@ -50,10 +50,24 @@ public:
     [[nodiscard]] const char* summary() const noexcept override;
 };
 
+/**
+ * @brief 分代策略：次要收集只标记并清扫新生代，存活者晋升为老年代。
+ *
+ * 显式 collect() 执行一次主要收集，即完整标记清除后把全部存活对象晋升。
+ */
+class GenerationalGC final : public GCStrategy {
+public:
+    [[nodiscard]] usize collect(GCContext& context) const override;
+    [[nodiscard]] const char* name() const noexcept override;
+    [[nodiscard]] const char* summary() const noexcept override;
+};
+
 /** @brief 获取共享的标记清除策略实例。 */
 [[nodiscard]] const GCStrategy& markSweepGCStrategy() noexcept;
 /** @brief 获取共享的增量策略实例。 */
 [[nodiscard]] const GCStrategy& incrementalGCStrategy() noexcept;
+/** @brief 获取共享的分代策略实例。 */
+[[nodiscard]] const GCStrategy& generationalGCStrategy() noexcept;
 /** @brief 按名称查找垃圾回收策略。 */
 [[nodiscard]] Opt<std::reference_wrapper<const GCStrategy>> findGCStrategy(StrView name) noexcept;
 
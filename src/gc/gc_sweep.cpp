@@ -4,6 +4,7 @@
  */
 
 #include "gc/garbage_collector.hpp"
+#include "gc/gc_background_free.hpp"
 #include "core/gc_string.hpp"
 #include "core/string_pool.hpp"
 #include "core/upvalue.hpp"
@@ -18,7 +19,28 @@ bool isOpenUpvalue(GCObject* obj) {
 
 } // namespace
 
+GarbageCollector::BackgroundFreeScope::BackgroundFreeScope(GarbageCollector& collector) noexcept
+    : collector_(collector), armed_(false) {
+    LuaAllocator* allocator = collector_.allocator_;
+    if (collector_.backgroundFree_ == nullptr || allocator == nullptr || !allocator->isConfigured() ||
+        allocator->hasDeferredRelease()) {
+        return;
+    }
+    allocator->setDeferredRelease(&GCBackgroundFree::deferRelease, collector_.backgroundFree_.get());
+    armed_ = true;
+}
+
+GarbageCollector::BackgroundFreeScope::~BackgroundFreeScope() {
+    if (!armed_) {
+        return;
+    }
+    LuaAllocator* allocator = collector_.allocator_;
+    allocator->setDeferredRelease(nullptr, nullptr);
+    collector_.backgroundFree_->flush(allocator->getFunction(), allocator->getUserData());
+}
+
 usize GarbageCollector::sweep(StringPool& stringPool) {
+    BackgroundFreeScope backgroundFree(*this);
     usize collected = 0;
 
     auto sweepMatching = [&](auto shouldSweep) {
@@ -83,6 +105,60 @@ usize GarbageCollector::sweep(StringPool& stringPool) {
     collected += sweepMatching([](GCObject* obj) { return obj->getType() == GCObjectType::Thread; });
     collected += sweepMatching([](GCObject* obj) { return obj->getType() != GCObjectType::Thread; });
 
+    /** @brief 完整清扫结束后归还空页，增量清扫在 sweepStep() 走完链表、新生代清扫结束时同样处理。 */
+    if (slab_ != nullptr) {
+        (void)slab_->releaseEmptyPages();
+    }
+
+    return collected;
+}
+
+usize GarbageCollector::sweepYoung(StringPool& stringPool) {
+    BackgroundFreeScope backgroundFree(*this);
+    usize collected = 0;
+
+    /**
+     * @brief 只遍历链表头到老年代边界之间的新生代。
+     *
+     * 存活者（含所属线程仍存活的白色开放上值）在第二遍中晋升，清扫结束后整个区间并入老年代。
+     */
+    auto sweepMatching = [&](auto shouldSweep, bool promoteSurvivors) {
+        GCObject* prev = nullptr;
+        GCObject* obj = allObjects_;
+
+        while (obj != nullptr && obj != oldBoundary_) {
+            GCObject* next = obj->getNext();
+            bool isFixed = (obj->getMarked() & GCBits::FIXED) != 0;
+
+            if (shouldSweep(obj) && obj->getColor() == GCColor::White && !isFixed && !isOpenUpvalue(obj)) {
+                if (prev == nullptr) {
+                    allObjects_ = next;
+                } else {
+                    prev->setNext(next);
+                }
+
+                destroyObject(obj, stringPool);
+                ++collected;
+            } else {
+                if (promoteSurvivors) {
+                    promoteObject(obj);
+                }
+                prev = obj;
+            }
+
+            obj = next;
+        }
+    };
+
+    // 与完整清扫相同，先回收线程，使其析构时仍能关闭新生代开放上值
+    sweepMatching([](GCObject* obj) { return obj->getType() == GCObjectType::Thread; }, false);
+    sweepMatching([](GCObject* obj) { return obj->getType() != GCObjectType::Thread; }, true);
+
+    // 新生代对象同样占用块池页，分代模式下可能长期不做完整清扫
+    if (slab_ != nullptr) {
+        (void)slab_->releaseEmptyPages();
+    }
+
     return collected;
 }
 
@@ -4,6 +4,7 @@
  */
 
 #include "gc/garbage_collector.hpp"
+#include "gc/gc_parallel_mark.hpp"
 #include "core/gc_string.hpp"
 #include "core/table.hpp"
 #include "core/value.hpp"
@@ -41,15 +42,20 @@ WeakMode readWeakMode(Table* table, GlobalState* globalState) {
     return result;
 }
 
-void setWeakBits(Table* table, const WeakMode& mode) {
-    u8 marked = table->getMarked() & ~GCBits::WEAKBITS;
+void setWeakBits(Table* table, const WeakMode& mode, bool concurrent) {
+    u8 weakBits = 0;
     if (mode.keys) {
-        marked |= GCBits::WEAKKEY;
+        weakBits |= GCBits::WEAKKEY;
     }
     if (mode.values) {
-        marked |= GCBits::WEAKVALUE;
+        weakBits |= GCBits::WEAKVALUE;
+    }
+    if (concurrent) {
+        // 并行标记时其他工作者可能同时比较交换此表的颜色位
+        table->updateMarkedConcurrent(GCBits::WEAKBITS, weakBits);
+    } else {
+        table->setMarked(static_cast<u8>((table->getMarked() & ~GCBits::WEAKBITS) | weakBits));
     }
-    table->setMarked(marked);
 }
 
 } // namespace
@@ -60,10 +66,14 @@ void GarbageCollector::markTable(Table* table) {
     }
 
     const WeakMode mode = readWeakMode(table, globalState_);
-    setWeakBits(table, mode);
+    setWeakBits(table, mode, parallelMark_ != nullptr);
 
     if (mode.keys || mode.values) {
-        weakTables_.push_back(table);
+        if (parallelMark_ != nullptr) {
+            parallelMark_->recordWeakTable(table);
+        } else {
+            weakTables_.push_back(table);
+        }
     }
 
     table->markContents(*this, mode.keys, mode.values);
@@ -79,7 +89,7 @@ void GarbageCollector::reconcileWeakTableModes() {
         }
 
         const WeakMode mode = readWeakMode(table, globalState_);
-        setWeakBits(table, mode);
+        setWeakBits(table, mode, false);
 
         /**
          * @brief 使用当前模式重新扫描。
@@ -38,6 +38,7 @@
 #include <cstdio>
 #include <cstring>
 #include <cctype>
+#include <chrono>
 #include <cmath>
 #include <limits>
 
@@ -188,6 +189,11 @@ i32 luaB_tostring(LuaState* L) {
         return 1;
     }
 
+    if (original.isNumber()) {
+        L->pushString(L->getGlobalState().getStringPool().internNumber(original.asNumber()));
+        return 1;
+    }
+
     // 默认转换逻辑
     if (L->isString(1)) {
         s = L->toString(1);
@@ -258,7 +264,11 @@ i32 luaB_tonumber(LuaState* L) {
         bool hasDigit = false;
 
         if (base == 10) {
-            // 十进制：支持小数点和科学计数法
+            // 十进制：常见文本走 from_chars 快速路径，其余形式保持 strtod 语义
+            if (luaTryParseDecimalNumber(StrView(s), result)) {
+                L->pushNumber(result);
+                return 1;
+            }
             char* endptr = nullptr;
             result = std::strtod(s, &endptr);
             if (endptr == s) {
@@ -407,13 +417,13 @@ i32 luaB_error(LuaState* L) {
                 GCString* str = L->getGlobalState().getStringPool().intern(fullMessage.c_str());
                 L->setTop(0);
                 L->pushString(str);
-                return L->error();
+                return L->raiseError();
             }
         }
     }
 
     L->setTop(1); // 只保留错误消息
-    return L->error();
+    return L->raiseError();
 }
 
 // =====================================================================
@@ -1839,37 +1849,74 @@ i32 luaB_setfenv(LuaState* L) {
 // collectgarbage(opt [, arg]) - 垃圾回收控制
 // =====================================================================
 
-static i32 collectGarbageControlArgument(LuaState* L) {
-    if (L->getTop() < 2 || L->at(2).isNil()) {
+static i32 collectGarbageControlArgument(LuaState* L, i32 index = 2) {
+    if (L->getTop() < index || L->at(index).isNil()) {
         return 0;
     }
 
-    const Value value = L->at(2);
+    const Value value = L->at(index);
     LuaNumber number = 0.0;
     if (value.isNumber()) {
         number = value.asNumber();
     } else if (!value.isString()) {
-        L->error("bad argument #2 to 'collectgarbage' (number expected)");
+        L->error(std::format("bad argument #{} to 'collectgarbage' (number expected)", index).c_str());
     } else {
         GCString* string = value.asString();
         L->consumeNativeWork(string->getLength());
         if (!luaStringToNumber(string->view(), number, L->getGlobalState().getAllocator())) {
-            L->error("bad argument #2 to 'collectgarbage' (number expected)");
+            L->error(std::format("bad argument #{} to 'collectgarbage' (number expected)", index).c_str());
         }
     }
 
     if (!std::isfinite(number)) {
-        L->error("bad argument #2 to 'collectgarbage' (finite number expected)");
+        L->error(std::format("bad argument #{} to 'collectgarbage' (finite number expected)", index).c_str());
     }
 
     const LuaNumber truncated = std::trunc(number);
     if (truncated < static_cast<LuaNumber>(std::numeric_limits<i32>::min()) ||
         truncated > static_cast<LuaNumber>(std::numeric_limits<i32>::max())) {
-        L->error("bad argument #2 to 'collectgarbage' (number out of range)");
+        L->error(std::format("bad argument #{} to 'collectgarbage' (number out of range)", index).c_str());
     }
     return static_cast<i32>(truncated);
 }
 
+/**
+ * @brief 切换到分代或增量模式，并返回切换前的模式名
+ *
+ * 旧模式名即策略名，标记-清扫报告为 "mark-sweep"。离开分代模式时恢复进入前的
+ * 标记-清扫或增量策略；其他情况下 "incremental" 切换到增量策略。
+ * 参数为 0 或缺省时保持原值。
+ */
+static i32 collectGarbageSwitchMode(LuaState* L, bool generational) {
+    auto& gc = L->getGlobalState().getGC();
+    const char* previous = gc.getStrategyName();
+    const i32 first = collectGarbageControlArgument(L, 2);
+    const i32 second = collectGarbageControlArgument(L, 3);
+
+    if (generational) {
+        if (first != 0) {
+            (void)gc.setMinorMultiplier(first);
+        }
+        if (second != 0) {
+            (void)gc.setMajorMultiplier(second);
+        }
+        (void)gc.useStrategy("generational");
+    } else {
+        if (first != 0) {
+            (void)gc.setPause(first);
+        }
+        if (second != 0) {
+            (void)gc.setStepMultiplier(second);
+        }
+        if (!gc.leaveGenerationalMode()) {
+            (void)gc.useStrategy("incremental");
+        }
+    }
+
+    L->pushString(L->getGlobalState().getStringPool().intern(previous));
+    return 1;
+}
+
 /**
  * @brief collectgarbage(opt [, arg])
  *
@@ -1887,7 +1934,10 @@ static i32 collectGarbageControlArgument(LuaState* L) {
  * - "stop"：停止自动垃圾回收
  * - "restart"：重启自动垃圾回收
  * - "step"：推进一段有界 GC 工作，完成一轮收集时返回 true
- * - "strategy"：查询或切换教学用垃圾回收策略（标记-清扫或增量占位策略）
+ * - "stepus"：在给定微秒数内推进 GC 工作，返回是否完成一轮收集及剩余债务（KB）
+ * - "strategy"：查询或切换垃圾回收策略（标记-清扫、增量或分代）
+ * - "generational"：切换到分代模式，可选次要/主要收集倍数，返回旧模式名
+ * - "incremental"：离开分代模式（恢复进入前的策略）或切换到增量模式，可选 pause/stepmul，返回旧模式名
  * - "setpause"：设置自动 GC 暂停参数，返回旧值
  * - "setstepmul"：设置 step 工作量倍数，返回旧值
  */
@@ -1937,6 +1987,12 @@ i32 luaB_collectgarbage(LuaState* L) {
         } else if (strcmp(opt, "step") == 0) {
             L->pushBoolean(gc.step(L, collectGarbageControlArgument(L)));
             return 1;
+        } else if (strcmp(opt, "stepus") == 0) {
+            const bool finished = gc.stepFor(L, std::chrono::microseconds(collectGarbageControlArgument(L)));
+            L->pushBoolean(finished);
+            const isize debt = gc.getDebtBytes();
+            L->pushNumber(debt > 0 ? static_cast<LuaNumber>(debt) / 1024.0 : 0.0);
+            return 2;
         } else if (strcmp(opt, "strategy") == 0) {
             if (L->getTop() >= 2) {
                 Value strategy = L->at(2);
@@ -1961,6 +2017,14 @@ i32 luaB_collectgarbage(LuaState* L) {
             L->pushNumber(0);
             return 1;
         }
+    } else if (firstChar == 'g') {
+        if (strcmp(opt, "generational") == 0) {
+            return collectGarbageSwitchMode(L, true);
+        }
+    } else if (firstChar == 'i') {
+        if (strcmp(opt, "incremental") == 0) {
+            return collectGarbageSwitchMode(L, false);
+        }
     }
 
     // 无效的操作类型
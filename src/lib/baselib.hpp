@@ -78,7 +78,7 @@ i32 luaB_tonumber(LuaState* L);
 /**
  * @brief error(message [, level]) - 抛出错误
  * @param L Lua状态机指针
- * @return 不返回（抛出错误）
+ * @return 由 pcall 直接保护时以状态返回 0（见 LuaState::raiseError），否则不返回（抛出错误）
  */
 i32 luaB_error(LuaState* L);
 
@@ -2,7 +2,8 @@
  * @file coroutinelib.cpp
  * @brief Lua协程库实现
  *
- * 实现 coroutine.create / resume / yield / status / running / wrap
+ * 实现 coroutine.create / resume / yield / status / running / wrap，
+ * 以及由运行时协程调度器驱动的 spawn / sleep / join / channel
  */
 
 #include "lib/coroutinelib.hpp"
@@ -13,9 +14,13 @@
 #include "core/gc_string.hpp"
 #include "core/table.hpp"
 #include "core/upvalue.hpp"
+#include "core/userdata.hpp"
 #include "vm/state/global_state.hpp"
+#include "vm/state/stack.hpp"
 #include "common/lua_error.hpp"
 
+#include <cmath>
+
 namespace Lua {
 
 // =====================================================================
@@ -35,41 +40,10 @@ static i32 coroutine_create(LuaState* L) {
 }
 
 // =====================================================================
-/** @brief 恢复协程，返回成功标志及结果，或失败标志及错误。 */
+// coroutine.resume / coroutine.yield 定义在 core/thread.cpp：
+// VM 按函数指针识别它们，以便在调度循环内直接切换协程
 // =====================================================================
 
-static i32 coroutine_resume(LuaState* L) {
-    i32 totalArgs = L->getTop();
-    if (totalArgs < 1 || !L->at(1).isThread()) {
-        L->error("bad argument #1 to 'resume' (coroutine expected)");
-    }
-
-    Thread* thread = L->at(1).asThread();
-    i32 resumeArgs = totalArgs - 1;
-
-    // Thread::resume 从 L 的栈顶传递恢复参数，再将 true/false 与结果压回 L
-    thread->resume(L, resumeArgs);
-
-    // 返回值数量等于 resume 压入的全部值（true/false 与结果）
-    // L->getTop() 包含位置 1 的线程参数
-    return L->getTop() - 1;
-}
-
-// =====================================================================
-// coroutine.yield(...) → 在恢复方协程中返回值
-// =====================================================================
-
-static i32 coroutine_yield(LuaState* L) {
-    if (!L->canYield()) {
-        L->error("cannot yield across non-resumable call boundaries");
-    }
-
-    i32 nresults = L->getTop(); // 所有参数即 yield 值
-    L->setStatus(ThreadStatus::Yield);
-    L->setYieldResults(nresults);
-    return 0; // C 函数返回 0 — vmPrecall 会检测 Yield 状态
-}
-
 // =====================================================================
 // coroutine.status(co) → 字符串
 // =====================================================================
@@ -119,78 +93,10 @@ static i32 coroutine_running(LuaState* L) {
 // =====================================================================
 // coroutine.wrap(f) → 函数
 //
-// 创建协程并返回一个迭代器函数；每次调用该函数相当于 resume，
-// 但直接返回 yield 值（不含前导 true），出错时直接抛出错误。
+// 创建协程并返回一个迭代器函数（coroutineWrapResume，upvalue[0] 存储 Thread*）；
+// 每次调用该函数相当于 resume，但直接返回 yield 值（不含前导 true），出错时直接抛出错误。
 // =====================================================================
 
-/**
- * @brief wrap 返回的迭代器函数；upvalue[0] 存储 Thread*
- */
-static i32 wrap_iterator(LuaState* L) {
-    // 取出 upvalue 中的 Thread
-    const CallInfo& ci = L->getCurrentCallInfo();
-    Function* self = L->getStack()[ci.func].asFunction();
-    Upvalue* uv = self->getUpvalue(0);
-    if (!uv) {
-        L->error("cannot resume dead coroutine");
-    }
-    Value threadVal = uv->getValue(L->getStack());
-    if (!threadVal.isThread()) {
-        L->error("cannot resume dead coroutine");
-    }
-    Thread* thread = threadVal.asThread();
-
-    // 收集调用参数
-    i32 nargs = L->getTop();
-
-    // resume 会向 L 推入 true/false + 结果
-    // 先记住调用前栈顶位置（参数区之后）
-    usize beforeTop = L->getAbsoluteTop();
-
-    // 将参数复制到 beforeTop 之后（resume 需要从栈顶取）
-    // 参数已经在 base+1 .. base+nargs，直接 resume 即可
-    thread->resume(L, nargs);
-
-    // resume 替换了参数区，现在 L 栈顶布局：
-    //   [... | 成功标志 | 结果1 | 结果2 | ...]
-    // getTop() 包含了原始 thread arg（这里没有），直接算
-    usize afterTop = L->getAbsoluteTop();
-    usize pushed = afterTop - beforeTop + static_cast<usize>(nargs);
-
-    // 第一个推入的值是 bool（ok/fail）
-    // 在 beforeTop - nargs 位置… 不对——resume 在推入时已清理了参数
-    // 最简单：从 afterTop 回退 pushed 个位置取 bool
-    usize resultBase = afterTop - pushed;
-    Value okVal = L->getStack().at(resultBase);
-    bool ok = okVal.isBoolean() && okVal.asBoolean();
-
-    if (!ok) {
-        // 错误：第二个值是错误消息，直接 error
-        Value errMsg;
-        if (pushed >= 2) {
-            errMsg = L->getStack().at(resultBase + 1);
-        }
-        // 抛出 Lua 错误
-        L->pushValue(errMsg);
-        return L->error();
-    }
-
-    // 成功：把 bool 之后的结果值搬到栈帧起点
-    i32 nresults = static_cast<i32>(pushed) - 1; // 减去 bool
-    L->consumeNativeWork(nresults == 0 ? 1 : static_cast<u64>(nresults));
-    usize dst = resultBase;
-    for (i32 i = 0; i < nresults; i++) {
-        L->getStack().at(dst + static_cast<usize>(i)) = L->getStack().at(resultBase + 1 + static_cast<usize>(i));
-    }
-    const usize resultTop = dst + static_cast<usize>(nresults);
-    for (usize slot = resultTop; slot < afterTop; ++slot) {
-        L->getStack()[slot] = Value();
-    }
-    L->setAbsoluteTop(resultTop);
-
-    return nresults;
-}
-
 static i32 coroutine_wrap(LuaState* L) {
     if (L->getTop() < 1 || !L->at(1).isFunction()) {
         L->error("bad argument #1 to 'wrap' (function expected)");
@@ -200,7 +106,7 @@ static i32 coroutine_wrap(LuaState* L) {
     Thread* thread = Thread::create(L, func);
 
     /** @brief 创建 C 闭包，将协程对象作为关闭上值。 */
-    Function* closure = L->getGlobalState().getGC().create<Function>(wrap_iterator);
+    Function* closure = L->getGlobalState().getGC().create<Function>(coroutineWrapResume, 1);
 
     Upvalue* uv = L->getGlobalState().getGC().create<Upvalue>(Value(thread));
     closure->addUpvalue(uv);
@@ -209,6 +115,182 @@ static i32 coroutine_wrap(LuaState* L) {
     return 1;
 }
 
+// =====================================================================
+// 调度任务：spawn / sleep / join
+//
+// 任务是交给 CoroutineScheduler 的普通协程，由宿主调用 lua_runtime_scheduler_run 执行。
+// 任务内的 sleep、join 与通道 receive 登记等待后以普通挂起让出，由调度器在到期或被唤醒时
+// 恢复；任务内的 coroutine.yield 只是让出到就绪队列末尾。
+// =====================================================================
+
+/** @brief 要求调用者是调度器正在运行的任务本身，且挂起不会穿过宿主调用边界 */
+static Thread* requireSchedulerTask(LuaState* L, const char* name) {
+    Thread* task = L->getGlobalState().getScheduler().getCurrentTask();
+    if (task == nullptr || task->getLuaState() != L) {
+        L->error((Str(name) + ": not inside a scheduler task").c_str());
+    }
+    if (!L->canYield()) {
+        L->error("cannot yield across non-resumable call boundaries");
+    }
+    return task;
+}
+
+static i32 yieldToScheduler(LuaState* L) {
+    L->setStatus(ThreadStatus::Yield);
+    L->setYieldResults(0);
+    return 0;
+}
+
+// coroutine.spawn(f, ...) → 任务协程
+static i32 coroutine_spawn(LuaState* L) {
+    const i32 nargs = L->getTop();
+    if (nargs < 1 || !L->at(1).isFunction()) {
+        L->error("bad argument #1 to 'spawn' (function expected)");
+    }
+
+    Thread* thread = Thread::create(L, L->at(1).asFunction());
+    L->pushValue(Value(thread));
+
+    const usize argumentBase = L->getCurrentCallInfo().base + 1;
+    const std::span<const Value> arguments(&L->getStack()[argumentBase], static_cast<usize>(nargs - 1));
+    L->getGlobalState().getScheduler().spawn(thread, arguments);
+    return 1;
+}
+
+// coroutine.sleep([seconds]) — 0 或省略时只让出到就绪队列末尾
+static i32 coroutine_sleep(LuaState* L) {
+    f64 seconds = 0;
+    if (L->getTop() >= 1 && !L->at(1).isNil()) {
+        if (!L->at(1).isNumber()) {
+            L->error("bad argument #1 to 'sleep' (number expected)");
+        }
+        seconds = L->at(1).asNumber();
+    }
+    Thread* task = requireSchedulerTask(L, "sleep");
+
+    constexpr f64 kMaxMilliseconds = 1e15;
+    const f64 milliseconds = seconds > 0 ? std::ceil(std::min(seconds * 1000, kMaxMilliseconds)) : 0;
+    L->getGlobalState().getScheduler().sleep(task, static_cast<u64>(milliseconds));
+    return yieldToScheduler(L);
+}
+
+// coroutine.join(task) → true, 结果... | false, 错误
+static i32 coroutine_join(LuaState* L) {
+    if (L->getTop() < 1 || !L->at(1).isThread()) {
+        L->error("bad argument #1 to 'join' (coroutine expected)");
+    }
+    Thread* target = L->at(1).asThread();
+
+    if (target->isTaskFinished()) {
+        LuaState* finished = target->getLuaState();
+        const i32 count = finished->getTop();
+        for (i32 i = 1; i <= count; ++i) {
+            L->pushValue(finished->at(i));
+        }
+        return count;
+    }
+
+    CoroutineScheduler& scheduler = L->getGlobalState().getScheduler();
+    if (!scheduler.isTask(target)) {
+        L->error("join: coroutine is not a scheduler task");
+    }
+    Thread* task = requireSchedulerTask(L, "join");
+    if (task == target) {
+        L->error("join: task cannot join itself");
+    }
+    scheduler.join(target, task);
+    return yieldToScheduler(L);
+}
+
+// =====================================================================
+// 通道：channel() / ch:send(v) / ch:receive()
+//
+// 无界 FIFO。缓冲值与等待的接收任务不会同时存在，共用一个队列：队列存放在通道用户数据的
+// 环境表中（[head, tail) 整数键），随用户数据一同被回收。
+// =====================================================================
+
+struct ChannelData {
+    i32 head = 1;
+    i32 tail = 1;
+    /** @brief 队列中是等待的接收任务而非缓冲值 */
+    bool receivers = false;
+};
+
+static ChannelData* checkChannel(LuaState* L, const char* name) {
+    Table* metatable = L->getGlobalState().getScheduler().getChannelMetatable();
+    if (L->getTop() < 1 || !L->at(1).isUserdata() || metatable == nullptr ||
+        L->at(1).asUserdata()->getMetatable() != metatable) {
+        L->error((Str("bad argument #1 to '") + name + "' (channel expected)").c_str());
+    }
+    return L->at(1).asUserdata()->getTypedData<ChannelData>();
+}
+
+static Value popChannelEntry(ChannelData* channel, Table* queue) {
+    const Value key(static_cast<LuaNumber>(channel->head));
+    Value entry = queue->get(key);
+    queue->set(key, Value());
+    if (++channel->head == channel->tail) {
+        channel->head = 1;
+        channel->tail = 1;
+        channel->receivers = false;
+    }
+    return entry;
+}
+
+static void pushChannelEntry(ChannelData* channel, Table* queue, const Value& entry) {
+    queue->set(Value(static_cast<LuaNumber>(channel->tail)), entry);
+    ++channel->tail;
+}
+
+static i32 coroutine_channel(LuaState* L) {
+    GlobalState& globalState = L->getGlobalState();
+    Userdata* ud = globalState.getGC().create<Userdata>(sizeof(ChannelData));
+    L->pushValue(Value(ud));
+    ud->constructData<ChannelData>();
+    ud->setEnvironment(globalState.getGC().create<Table>());
+    ud->setMetatable(globalState.getScheduler().getChannelMetatable());
+    return 1;
+}
+
+// ch:send(v) — 有等待的接收任务时直接交给最早的一个，否则缓冲
+//
+// 排队的接收任务可能已不再等待（任务被调度器丢弃或由其他方唤醒），这样的条目直接跳过，
+// 值只交给仍在等待的接收方；没有时留在缓冲中。
+static i32 channel_send(LuaState* L) {
+    ChannelData* channel = checkChannel(L, "send");
+    if (L->getTop() < 2 || L->at(2).isNil()) {
+        L->error("bad argument #2 to 'send' (value expected)");
+    }
+    Table* queue = L->at(1).asUserdata()->getEnvironment();
+    const Value value = L->at(2);
+
+    CoroutineScheduler& scheduler = L->getGlobalState().getScheduler();
+    while (channel->receivers) {
+        const Value receiver = popChannelEntry(channel, queue);
+        if (scheduler.wake(receiver.asThread(), std::span<const Value>(&value, 1))) {
+            return 0;
+        }
+    }
+    pushChannelEntry(channel, queue, value);
+    return 0;
+}
+
+// ch:receive() → 值；缓冲为空时当前任务等待下一次 send
+static i32 channel_receive(LuaState* L) {
+    ChannelData* channel = checkChannel(L, "receive");
+    Table* queue = L->at(1).asUserdata()->getEnvironment();
+    if (!channel->receivers && channel->head != channel->tail) {
+        L->pushValue(popChannelEntry(channel, queue));
+        return 1;
+    }
+
+    Thread* task = requireSchedulerTask(L, "receive");
+    pushChannelEntry(channel, queue, Value(task));
+    channel->receivers = true;
+    L->getGlobalState().getScheduler().wait(task);
+    return yieldToScheduler(L);
+}
+
 // =====================================================================
 // 模块注册
 // =====================================================================
@@ -225,12 +307,29 @@ void CoroutineLibModule::registerFunctions(LuaState* L) {
 
     FunctionRegistrar(L)
         .addGlobal("create", coroutine_create)
-        .addGlobal("resume", coroutine_resume)
-        .addGlobal("yield", coroutine_yield)
+        .addGlobal("resume", coroutineResume)
+        .addGlobal("yield", coroutineYield)
         .addGlobal("status", coroutine_status)
         .addGlobal("running", coroutine_running)
         .addGlobal("wrap", coroutine_wrap)
+        .addGlobal("spawn", coroutine_spawn)
+        .addGlobal("sleep", coroutine_sleep)
+        .addGlobal("join", coroutine_join)
+        .addGlobal("channel", coroutine_channel)
         .commitToTable(coTable);
+
+    /** @brief 通道元表属于运行时；同一运行时再次打开协程库时沿用，已有通道保持有效。 */
+    CoroutineScheduler& scheduler = L->getGlobalState().getScheduler();
+    if (scheduler.getChannelMetatable() == nullptr) {
+        Table* channelMT = L->getGlobalState().getGC().create<Table>();
+        scheduler.setChannelMetatable(channelMT);
+        FunctionRegistrar(L)
+            .addGlobal("send", channel_send)
+            .addGlobal("receive", channel_receive)
+            .commitToTable(channelMT);
+        GCString* indexKey = L->getGlobalState().getStringPool().intern("__index");
+        channelMT->set(Value(indexKey), Value(channelMT));
+    }
 }
 
 void openCoroutineLib(LuaState* L) {
@@ -1025,6 +1025,7 @@ i32 luaDebug_getlocal(LuaState* L) {
         return 1;
     }
 
+    VM::materializeCompatArg(ownerL, *frame.ci, static_cast<usize>(localInfo->reg));
     L->pushString(localInfo->varname);
     L->pushValue(ownerL->getStack().at(absSlot));
     return 2;
@@ -1532,6 +1533,7 @@ const char* apiDebugGetLocal(LuaState* L, const lua_Debug* ar, int n) {
     usize slot = 0;
     const char* name = findApiLocal(L, frame, n, slot);
     if (name != nullptr) {
+        VM::materializeCompatArg(L, *frame.ci, slot - frame.ci->base);
         L->pushValue(L->getStack().at(slot));
     }
     return name;
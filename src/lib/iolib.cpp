@@ -12,6 +12,7 @@
 #include "lib/iolib.hpp"
 #include "lib/lib_registry.hpp"
 #include "lib/lib_manager.hpp"
+#include "lib/string_buffer.hpp"
 #include "common/number_conversion.hpp"
 #include "core/gc_string.hpp"
 #include "core/function.hpp"
@@ -275,7 +276,7 @@ static FileHandleData* toFileHandle(LuaState* L, i32 idx) {
 }
 
 static Function* createCClosureWithClosedUpvalues(LuaState* L, CFunction func, const Vec<Value>& upvalues) {
-    Function* closure = L->getGlobalState().getGC().create<Function>(func);
+    Function* closure = L->getGlobalState().getGC().create<Function>(func, upvalues.size());
 
     for (const Value& value : upvalues) {
         Upvalue* uv = L->getGlobalState().getGC().create<Upvalue>(value);
@@ -985,6 +986,16 @@ static i32 f_write_impl(LuaState* L, FileHandleData* handle, i32 firstArg, const
                 success = false;
                 break;
             }
+        } else if (const StringBufferData* buffer = toStringBuffer(L, L->at(i))) {
+            // string.buffer 直接写出字节，不驻留中间字符串
+            const usize len = buffer->size();
+            if (routeRuntimeOutput) {
+                routedOutput.append(buffer->data(), len);
+            } else if (std::fwrite(buffer->data(), 1, len, fp) != len) {
+                success = false;
+                break;
+            }
+            shouldFlushLine = shouldFlushLine || std::memchr(buffer->data(), '\n', len) != nullptr;
         } else {
             L->error("invalid argument to write");
         }
@@ -0,0 +1,261 @@
+/**
+ * @file string_buffer.cpp
+ * @brief Lua 字符串缓冲区实现
+ *
+ * 详细说明：
+ * 缓冲区字节保存在 Userdata 内构造的 StringBufferData 中，随 Userdata
+ * 回收而释放。追加操作直接写入 LuaAllocator 管理的可增长存储，
+ * 只有 tostring/get 会驻留字符串。存储容量作为 Userdata 的外部字节
+ * 计入垃圾回收的内存总量与债务。
+ *
+ * @author Lua C++ 项目
+ * @date 2026-10-18
+ */
+
+#include "lib/string_buffer.hpp"
+#include "lib/lib_registry.hpp"
+#include "lib/stringlib.hpp"
+#include "common/number_conversion.hpp"
+#include "core/gc_string.hpp"
+#include "core/table.hpp"
+#include "core/userdata.hpp"
+#include "gc/garbage_collector.hpp"
+#include "vm/state/global_state.hpp"
+#include "vm/state/lua_state.hpp"
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <format>
+
+namespace Lua {
+
+namespace {
+
+/** @brief 缓冲区元表在注册表中的键，与 luaL_newmetatable 约定一致，供 C 代码按名取用。 */
+constexpr const char* kStringBufferMetatable = "string.buffer";
+
+StringBufferData* checkStringBuffer(LuaState* L, i32 idx, const char* funcName) {
+    StringBufferData* buffer = idx <= L->getTop() ? toStringBuffer(L, L->at(idx)) : nullptr;
+    if (buffer == nullptr) {
+        const char* actual = idx <= L->getTop() ? L->typeName(L->type(idx)) : "no value";
+        L->error(std::format("bad argument #{} to '{}' (string.buffer expected, got {})", idx, funcName, actual).c_str());
+    }
+    return buffer;
+}
+
+/**
+ * @brief 读取非负字节数参数并截断到 limit
+ *
+ * NaN 与无穷大直接拒绝；比较在转换前完成，保证转换到 usize 的值可以表示。
+ */
+usize checkByteCount(LuaState* L, i32 idx, const char* funcName, usize limit) {
+    const Value& value = L->at(idx);
+    if (!value.isNumber() || !std::isfinite(value.asNumber()) || value.asNumber() < 0) {
+        L->error(std::format("bad argument #{} to '{}' (non-negative number expected)", idx, funcName).c_str());
+    }
+    const LuaNumber count = value.asNumber();
+    return count >= static_cast<LuaNumber>(limit) ? limit : static_cast<usize>(count);
+}
+
+/**
+ * @brief 把第 1 个参数（缓冲区自身）的字节存储容量同步到垃圾回收计费
+ */
+void accountBufferStorage(LuaState* L, const StringBufferData& buffer) {
+    L->at(1).asUserdata()->setExternalSize(buffer.bytes.capacity());
+}
+
+/**
+ * @brief 追加前检查资源上限并回收已消费前缀
+ *
+ * 缓冲区最终要能转为字符串，因此总长度受 maxStringBytes 约束。
+ */
+void prepareAppend(LuaState* L, StringBufferData& buffer, usize addition, const char* funcName) {
+    const usize limit = L->getGlobalState().getResourcePolicy().maxStringBytes;
+    const usize current = buffer.size();
+    if (addition > limit || current > limit - addition) {
+        L->error(std::format("string.buffer.{}: result exceeds resource limit", funcName).c_str());
+    }
+    L->consumeNativeWork(addition == 0 ? 1 : addition);
+
+    if (buffer.readOffset != 0 && buffer.readOffset >= current) {
+        std::memmove(buffer.bytes.data(), buffer.data(), current);
+        buffer.bytes.resize(current);
+        buffer.readOffset = 0;
+    }
+    buffer.bytes.reserve(buffer.bytes.size() + addition);
+    accountBufferStorage(L, buffer);
+}
+
+void appendBytes(LuaState* L, StringBufferData& buffer, const char* data, usize count, const char* funcName) {
+    prepareAppend(L, buffer, count, funcName);
+    buffer.bytes.append(data, count);
+}
+
+void pushBufferSelf(LuaState* L) {
+    L->pushValue(L->at(1));
+}
+
+} // namespace
+
+StringBufferData* toStringBuffer(LuaState* L, const Value& value) {
+    if (!value.isUserdata()) {
+        return nullptr;
+    }
+    Userdata* ud = value.asUserdata();
+    if (ud->getDataSize() != sizeof(StringBufferData) || ud->getMetatable() == nullptr ||
+        ud->getMetatable() != L->getGlobalState().getStringBufferMetatable()) {
+        return nullptr;
+    }
+    return ud->getTypedData<StringBufferData>();
+}
+
+i32 strbuf_new(LuaState* L) {
+    usize reserveBytes = 0;
+    if (L->getTop() >= 1 && !L->at(1).isNil()) {
+        reserveBytes = checkByteCount(L, 1, "new", L->getGlobalState().getResourcePolicy().maxStringBytes);
+    }
+
+    GlobalState& gs = L->getGlobalState();
+    Table* bufferMT = gs.getStringBufferMetatable();
+    Userdata* ud = gs.getGC().create<Userdata>(sizeof(StringBufferData));
+    StringBufferData* buffer = ud->constructData<StringBufferData>(LuaStdAllocator<char>(gs.getAllocator()));
+    ud->setMetatable(bufferMT);
+    L->pushUserdata(ud);
+
+    buffer->bytes.reserve(reserveBytes);
+    ud->setExternalSize(buffer->bytes.capacity());
+    return 1;
+}
+
+i32 strbuf_put(LuaState* L) {
+    StringBufferData* buffer = checkStringBuffer(L, 1, "put");
+    for (i32 i = 2; i <= L->getTop(); ++i) {
+        const Value& value = L->at(i);
+        if (value.isString()) {
+            GCString* str = value.asString();
+            appendBytes(L, *buffer, str->c_str(), str->getLength(), "put");
+        } else if (value.isNumber()) {
+            std::array<char, 64> digits{};
+            const StrView text = luaNumberToView(value.asNumber(), digits);
+            appendBytes(L, *buffer, text.data(), text.size(), "put");
+        } else if (StringBufferData* source = toStringBuffer(L, value)) {
+            /** @brief 先预留再取源指针，使 buf:put(buf) 在扩容后仍读取有效存储。 */
+            const usize count = source->size();
+            prepareAppend(L, *buffer, count, "put");
+            buffer->bytes.append(source->data(), count);
+        } else {
+            L->error(std::format("bad argument #{} to 'put' (string expected, got {})", i, L->typeName(L->type(i)))
+                         .c_str());
+        }
+    }
+    pushBufferSelf(L);
+    return 1;
+}
+
+i32 strbuf_putf(LuaState* L) {
+    StringBufferData* buffer = checkStringBuffer(L, 1, "putf");
+    if (L->getTop() < 2) {
+        L->error("string.buffer.putf: missing format string");
+    }
+
+    /**
+     * @brief 格式参数引用自身时，格式化期间的扩容会使参数指针失效，
+     * 此时先格式化到临时缓冲再追加。
+     */
+    bool aliased = false;
+    for (i32 i = 2; i <= L->getTop() && !aliased; ++i) {
+        aliased = toStringBuffer(L, L->at(i)) == buffer;
+    }
+
+    prepareAppend(L, *buffer, 0, "putf");
+    if (!aliased) {
+        appendStringFormat(L, 2, buffer->bytes);
+        // 格式化直接写入存储，扩容发生在 prepareAppend 之后
+        accountBufferStorage(L, *buffer);
+    } else {
+        LuaString formatted(LuaStdAllocator<char>(L->getGlobalState().getAllocator()));
+        appendStringFormat(L, 2, formatted);
+        appendBytes(L, *buffer, formatted.data(), formatted.size(), "putf");
+    }
+    pushBufferSelf(L);
+    return 1;
+}
+
+i32 strbuf_get(LuaState* L) {
+    StringBufferData* buffer = checkStringBuffer(L, 1, "get");
+    StringPool& pool = L->getGlobalState().getStringPool();
+    const i32 top = L->getTop();
+
+    if (top < 2) {
+        GCString* str = pool.intern(buffer->data(), buffer->size());
+        buffer->bytes.clear();
+        buffer->readOffset = 0;
+        L->pushString(str);
+        return 1;
+    }
+
+    for (i32 i = 2; i <= top; ++i) {
+        const usize count = checkByteCount(L, i, "get", buffer->size());
+        GCString* str = pool.intern(buffer->data(), count);
+        buffer->readOffset += count;
+        L->pushString(str);
+    }
+    if (buffer->size() == 0) {
+        buffer->bytes.clear();
+        buffer->readOffset = 0;
+    }
+    return top - 1;
+}
+
+i32 strbuf_reset(LuaState* L) {
+    StringBufferData* buffer = checkStringBuffer(L, 1, "reset");
+    buffer->bytes.clear();
+    buffer->readOffset = 0;
+    pushBufferSelf(L);
+    return 1;
+}
+
+i32 strbuf_tostring(LuaState* L) {
+    StringBufferData* buffer = checkStringBuffer(L, 1, "tostring");
+    L->pushString(L->getGlobalState().getStringPool().intern(buffer->data(), buffer->size()));
+    return 1;
+}
+
+i32 strbuf_len(LuaState* L) {
+    StringBufferData* buffer = checkStringBuffer(L, 1, "len");
+    L->pushNumber(static_cast<LuaNumber>(buffer->size()));
+    return 1;
+}
+
+void registerStringBufferLib(LuaState* L, Table* stringTable) {
+    if (!L || !stringTable) {
+        return;
+    }
+
+    GlobalState& gs = L->getGlobalState();
+    StringPool& pool = gs.getStringPool();
+
+    // 缓冲区元表同时充当方法表
+    Table* bufferMT = gs.getGC().create<Table>();
+    gs.getRegistry()->set(Value(pool.intern(kStringBufferMetatable)), Value(bufferMT));
+    gs.setStringBufferMetatable(bufferMT);
+
+    FunctionRegistrar(L)
+        .addGlobal("put", strbuf_put)
+        .addGlobal("putf", strbuf_putf)
+        .addGlobal("get", strbuf_get)
+        .addGlobal("reset", strbuf_reset)
+        .addGlobal("tostring", strbuf_tostring)
+        .addGlobal("len", strbuf_len)
+        .commitToTable(bufferMT);
+
+    FunctionRegistrar::registerToTable(L, bufferMT, "__tostring", strbuf_tostring);
+    FunctionRegistrar::registerToTable(L, bufferMT, "__len", strbuf_len);
+    bufferMT->set(Value(pool.intern("__index")), Value(bufferMT));
+
+    Table* bufferLib = gs.getGC().create<Table>();
+    stringTable->set(Value(pool.intern("buffer")), Value(bufferLib));
+    FunctionRegistrar::registerToTable(L, bufferLib, "new", strbuf_new);
+}
+
+} // namespace Lua
@@ -0,0 +1,131 @@
+/**
+ * @file string_buffer.hpp
+ * @brief Lua 字符串缓冲区：string.buffer 原生字节构建器
+ *
+ * 详细说明：
+ * string.buffer 为循环拼接场景提供可变字节缓冲区，避免 `s = s .. x`
+ * 在每次迭代中驻留一个新的中间字符串。缓冲区以 Userdata 承载，
+ * 字节存储通过 LuaAllocator 分配，只有调用 tostring/get 时才驻留结果。
+ *
+ * 提供的接口：
+ * - string.buffer.new([size])：创建缓冲区，可选预留容量
+ * - buf:put(...)：追加字符串、数字或其他缓冲区
+ * - buf:putf(fmt, ...)：按 string.format 规则追加格式化结果
+ * - buf:get([n, ...])：消费并返回前 n 个字节（缺省为全部）
+ * - buf:reset()：清空内容但保留已分配容量
+ * - buf:tostring() / tostring(buf)：返回当前内容，不消费
+ * - buf:len() / #buf：返回未消费字节数
+ *
+ * 字符串库中不会回调 Lua 代码的函数（len、sub、find、format 的 %s 等）
+ * 直接读取缓冲区字节；io 文件的 write 也可直接写出缓冲区。
+ *
+ * @author Lua C++ 项目
+ * @date 2026-10-18
+ */
+
+#pragma once
+
+#include "common/types.hpp"
+#include "runtime/lua_allocator.hpp"
+
+namespace Lua {
+
+// 前向声明
+class LuaState;
+class Table;
+class Value;
+
+/**
+ * @brief string.buffer 用户数据载荷
+ *
+ * get() 只前移读偏移；追加前若已消费部分超过一半则整体前移，
+ * 使交替的 put/get 保持摊还 O(1)。
+ */
+struct StringBufferData {
+    explicit StringBufferData(const LuaStdAllocator<char>& allocator) : bytes(allocator) {}
+
+    /** @brief 已写入的字节（含尚未消费的前缀）。 */
+    LuaString bytes;
+    /** @brief 已被 get() 消费的字节数。 */
+    usize readOffset = 0;
+
+    [[nodiscard]] const char* data() const noexcept {
+        return bytes.data() + readOffset;
+    }
+
+    [[nodiscard]] usize size() const noexcept {
+        return bytes.size() - readOffset;
+    }
+};
+
+/**
+ * @brief 将 string.buffer 注册到字符串库表
+ * @param L Lua 状态指针
+ * @param stringTable 全局 string 表
+ *
+ * 创建缓冲区元表（登记在注册表的 "string.buffer" 项）并设置 `string.buffer`。
+ */
+void registerStringBufferLib(LuaState* L, Table* stringTable);
+
+/**
+ * @brief 若值为 string.buffer 则返回其载荷
+ * @param L Lua 状态指针
+ * @param value 待检查的值
+ * @return 缓冲区载荷；不是缓冲区时返回 nullptr
+ */
+StringBufferData* toStringBuffer(LuaState* L, const Value& value);
+
+// =====================================================================
+// 字符串缓冲区函数声明
+// =====================================================================
+
+/**
+ * @brief string.buffer.new([size])——创建缓冲区
+ * @param L Lua 状态指针
+ * @return 返回值数量（1：缓冲区）
+ */
+i32 strbuf_new(LuaState* L);
+
+/**
+ * @brief buf:put(...)——追加字符串、数字或缓冲区
+ * @param L Lua 状态指针
+ * @return 返回值数量（1：缓冲区自身）
+ */
+i32 strbuf_put(LuaState* L);
+
+/**
+ * @brief buf:putf(fmt, ...)——追加格式化结果
+ * @param L Lua 状态指针
+ * @return 返回值数量（1：缓冲区自身）
+ */
+i32 strbuf_putf(LuaState* L);
+
+/**
+ * @brief buf:get([n, ...])——消费并返回字节
+ * @param L Lua 状态指针
+ * @return 返回值数量（每个长度参数一个字符串，缺省时 1 个）
+ */
+i32 strbuf_get(LuaState* L);
+
+/**
+ * @brief buf:reset()——清空缓冲区
+ * @param L Lua 状态指针
+ * @return 返回值数量（1：缓冲区自身）
+ */
+i32 strbuf_reset(LuaState* L);
+
+/**
+ * @brief buf:tostring()——返回当前内容
+ * @param L Lua 状态指针
+ * @return 返回值数量（1：字符串）
+ */
+i32 strbuf_tostring(LuaState* L);
+
+/**
+ * @brief buf:len()——返回未消费字节数
+ * @param L Lua 状态指针
+ * @return 返回值数量（1：长度）
+ */
+i32 strbuf_len(LuaState* L);
+
+} // namespace Lua
@@ -9,12 +9,14 @@
  */
 
 #include "lib/stringlib.hpp"
+#include "lib/string_buffer.hpp"
 #include "common/number_conversion.hpp"
 #include "lib/lib_registry.hpp"
 #include "lib/lib_manager.hpp"
 #include "core/gc_string.hpp"
 #include "core/table.hpp"
 #include "core/upvalue.hpp"
+#include "core/userdata.hpp"
 #include "core/function.hpp"
 #include "runtime/runtime_services.hpp"
 #include "vm/state/global_state.hpp"
@@ -22,6 +24,7 @@
 #include "vm/vm_internal.hpp"
 #include "gc/garbage_collector.hpp"
 #include <algorithm>
+#include <array>
 #include <cctype>
 #include <cerrno>
 #include <cstring>
@@ -46,6 +49,12 @@ namespace Lua {
 static inline const char* getStringArg(LuaState* L, i32 idx, const char* funcName, usize* len = nullptr) {
     const char* str = L->toString(idx);
     if (str == nullptr) {
+        if (const StringBufferData* buffer = toStringBuffer(L, L->at(idx))) {
+            if (len) {
+                *len = buffer->size();
+            }
+            return buffer->data();
+        }
         L->error(std::format("bad argument #{} to 'string.{}' (string expected)", idx, funcName).c_str());
     }
     if (len) {
@@ -95,6 +104,12 @@ static i32 getIntegerArg(LuaState* L, i32 idx, const char* funcName,
 static inline const char* getStringLikeArg(LuaState* L, i32 idx, const char* funcName, usize* len = nullptr) {
     const char* str = L->toString(idx);
     if (str == nullptr) {
+        if (const StringBufferData* buffer = toStringBuffer(L, L->at(idx))) {
+            if (len) {
+                *len = buffer->size();
+            }
+            return buffer->data();
+        }
         L->error(std::format("bad argument #{} to 'string.{}' (string expected)", idx, funcName).c_str());
     }
     if (len) {
@@ -104,6 +119,21 @@ static inline const char* getStringLikeArg(LuaState* L, i32 idx, const char* fun
     return str;
 }
 
+/**
+ * @brief 将 string.buffer 参数替换为驻留快照
+ *
+ * gsub 的函数/表替换会回调 Lua 代码，回调可能修改同一缓冲区，
+ * 因此主串与模式不能直接引用缓冲区存储。
+ */
+static void snapshotStringBufferArg(LuaState* L, i32 idx) {
+    if (idx > L->getTop()) {
+        return;
+    }
+    if (const StringBufferData* buffer = toStringBuffer(L, L->at(idx))) {
+        L->at(idx) = Value(L->getGlobalState().getStringPool().intern(buffer->data(), buffer->size()));
+    }
+}
+
 static inline bool isFormatFlag(char ch) {
     return ch == '-' || ch == '+' || ch == ' ' || ch == '#' || ch == '0';
 }
@@ -971,7 +1001,11 @@ static void addStringReplacement(MatchState* ms, LuaString& result, const char*
                                  usize rlen) {
     for (usize i = 0; i < rlen; i++) {
         if (repl[i] != L_ESC) {
-            pushStringOutput(ms->L, result, repl[i], "gsub");
+            // 整段追加不含转义的字面文本，避免逐字节检查输出上限
+            const void* escape = std::memchr(repl + i, L_ESC, rlen - i);
+            const usize runEnd = escape ? static_cast<usize>(static_cast<const char*>(escape) - repl) : rlen;
+            appendStringOutput(ms->L, result, repl + i, runEnd - i, "gsub");
+            i = runEnd - 1;
         } else {
             i++;
             if (i >= rlen)
@@ -989,7 +1023,9 @@ static void addStringReplacement(MatchState* ms, LuaString& result, const char*
                         ms->L->error("invalid capture index");
                     }
                 } else if (ms->capture[ci].len == CAP_POSITION) {
-                    const Str position = luaNumberToString(static_cast<f64>(ms->capture[ci].init - ms->src_init + 1));
+                    std::array<char, 64> digits{};
+                    const StrView position =
+                        luaNumberToView(static_cast<f64>(ms->capture[ci].init - ms->src_init + 1), digits);
                     appendStringOutput(ms->L, result, position.data(), position.size(), "gsub");
                 } else if (ms->capture[ci].len >= 0) {
                     appendStringOutput(ms->L, result, ms->capture[ci].init, static_cast<usize>(ms->capture[ci].len),
@@ -1014,7 +1050,8 @@ static bool addValueReplacement(LuaState* L, LuaString& result, const Value& val
     }
 
     if (value.isNumber()) {
-        const Str number = luaNumberToString(value.asNumber());
+        std::array<char, 64> buffer{};
+        const StrView number = luaNumberToView(value.asNumber(), buffer);
         appendStringOutput(L, result, number.data(), number.size(), "gsub");
         return true;
     }
@@ -1052,6 +1089,9 @@ i32 str_gsub(LuaState* L) {
         L->error("string.gsub: missing arguments");
     }
 
+    snapshotStringBufferArg(L, 1);
+    snapshotStringBufferArg(L, 2);
+
     usize slen, plen;
     const char* s = getStringArg(L, 1, "gsub", &slen);
     const char* pattern = getStringArg(L, 2, "gsub", &plen);
@@ -1149,83 +1189,59 @@ i32 str_gsub(LuaState* L) {
 // string.gmatch(s, pattern) → 迭代器函数
 // =====================================================================
 
-/** @brief 从调用栈获取当前 C 闭包。 */
-static Function* getCurrentCClosure(LuaState* L) {
-    const CallInfo& ci = L->getCurrentCallInfo();
-    Value funcVal = L->getStack()[ci.func];
-    return funcVal.isFunction() ? funcVal.asFunction() : nullptr;
-}
+/**
+ * @brief gmatch 迭代状态，保存在迭代器闭包唯一的 Userdata 上值中
+ *
+ * 主题串与模式串由另外两个上值保持存活，这里只缓存其原始指针；
+ * MatchState（含捕获数组）在各次迭代间复用，每步只需读取一个上值。
+ */
+struct GmatchState {
+    const char* subject;
+    usize subjectLength;
+    const char* pattern;
+    usize patternLength;
+    usize position;
+    MatchState ms;
+};
 
-/** @brief 从当前闭包获取已关闭上值的值。 */
-static Value getUpval(LuaState* L, usize index) {
-    Function* closure = getCurrentCClosure(L);
-    if (!closure)
+/** @brief 从当前 C 闭包的第 0 个上值取出 gmatch 状态。 */
+static GmatchState* getGmatchState(LuaState* L) {
+    const CallInfo& ci = L->getCurrentCallInfo();
+    const Value funcVal = L->getStack()[ci.func];
+    Upvalue* uv = funcVal.isFunction() ? funcVal.asFunction()->getUpvalue(0) : nullptr;
+    if (!uv) {
         L->error("gmatch: internal error");
-    Upvalue* uv = closure->getUpvalue(index);
-    if (!uv)
+    }
+    const Value stateVal = uv->getValue(L->getStack());
+    if (!stateVal.isUserdata() || stateVal.asUserdata()->getDataSize() != sizeof(GmatchState)) {
         L->error("gmatch: internal error");
-    return uv->getValue(L->getStack());
-}
-
-/** @brief 设置当前闭包中已关闭上值的值。 */
-static void setUpval(LuaState* L, usize index, const Value& val) {
-    Function* closure = getCurrentCClosure(L);
-    if (!closure)
-        return;
-    Upvalue* uv = closure->getUpvalue(index);
-    if (!uv)
-        return;
-    uv->setValue(L->getStack(), val);
+    }
+    return stateVal.asUserdata()->getTypedData<GmatchState>();
 }
 
-/** @brief gmatch 迭代器函数；上值：[0]=字符串，[1]=模式，[2]=位置。 */
+/** @brief gmatch 迭代器函数；上值：[0]=迭代状态，[1]=字符串，[2]=模式。 */
 static i32 gmatch_aux(LuaState* L) {
-    Value sVal = getUpval(L, 0);
-    Value pVal = getUpval(L, 1);
-    Value posVal = getUpval(L, 2);
-
-    if (!sVal.isString() || !pVal.isString())
-        return 0;
-
-    GCString* subject = sVal.asString();
-    GCString* patString = pVal.asString();
-    const char* s = subject->c_str();
-    usize slen = subject->getLength();
-    const char* pattern = patString->c_str();
-    usize plen = patString->getLength();
-    const auto convertedPosition = checkedLuaInteger(posVal.asNumber(), IntegerConversion::Exact);
-    if (!convertedPosition.has_value() || *convertedPosition < 0) {
-        return 0;
-    }
-    usize pos = static_cast<usize>(*convertedPosition);
-
-    MatchState ms;
-    prepareMatchState(&ms, L, s, slen, pattern, plen);
-
-    for (usize i = pos; i <= slen; i++) {
+    GmatchState* state = getGmatchState(L);
+    const char* s = state->subject;
+    const usize slen = state->subjectLength;
+    MatchState& ms = state->ms;
+    // 迭代器可能在其他协程中调用，每步都重新绑定状态与步数预算
+    prepareMatchState(&ms, L, s, slen, state->pattern, state->patternLength);
+
+    for (usize i = state->position; i <= slen; i++) {
         ms.level = 0;
-        MatchResult e = tryMatch(&ms, PatternCursor{s + i, s + slen}, pattern);
+        MatchResult e = tryMatch(&ms, PatternCursor{s + i, s + slen}, state->pattern);
         if (e.has_value()) {
             const char* matchEnd = e.value();
             // 推进位置：若为空匹配，则向前移动 1
-            usize newpos = (matchEnd == s + i) ? i + 1 : static_cast<usize>(matchEnd - s);
-            setUpval(L, 2, Value(static_cast<f64>(newpos)));
+            state->position = (matchEnd == s + i) ? i + 1 : static_cast<usize>(matchEnd - s);
             return push_captures(&ms, s + i, matchEnd);
         }
     }
+    state->position = slen + 1;
     return 0;
 }
 
-/** @brief 创建带已关闭上值的 C 闭包，模式与 iolib 相同。 */
-static Function* createClosureWithUpvalues(LuaState* L, CFunction func, const LuaVector<Value>& upvalues) {
-    Function* closure = L->getGlobalState().getGC().create<Function>(func);
-    for (const Value& v : upvalues) {
-        Upvalue* uv = L->getGlobalState().getGC().create<Upvalue>(v);
-        closure->addUpvalue(uv);
-    }
-    return closure;
-}
-
 i32 str_gmatch(LuaState* L) {
     if (L->getTop() < 2) {
         L->error("string.gmatch: missing arguments");
@@ -1243,34 +1259,39 @@ i32 str_gmatch(LuaState* L) {
         patLen--;
     }
 
-    auto& pool = L->getGlobalState().getStringPool();
+    GlobalState& gs = L->getGlobalState();
+    GarbageCollector& gc = gs.getGC();
+    StringPool& pool = gs.getStringPool();
+    GCString* subject = pool.intern(s, slen);
+    L->pushString(subject);
+    GCString* pattern = pool.intern(pat, patLen);
+    L->pushString(pattern);
 
-    LuaVector<Value> upvalues(LuaStdAllocator<Value>(L->getGlobalState().getAllocator()));
-    upvalues.push_back(Value(pool.intern(s, slen)));
-    upvalues.push_back(Value(pool.intern(pat, patLen)));
-    upvalues.push_back(Value(0.0));
+    Userdata* stateData = gc.create<Userdata>(sizeof(GmatchState));
+    L->pushUserdata(stateData);
+    stateData->constructData<GmatchState>(
+        GmatchState{subject->c_str(), subject->getLength(), pattern->c_str(), pattern->getLength(), 0, MatchState{}});
 
-    Function* iter = createClosureWithUpvalues(L, gmatch_aux, upvalues);
+    Function* iter = gc.create<Function>(gmatch_aux, 3);
     L->pushFunction(iter);
+    iter->addUpvalue(gc.create<Upvalue>(Value(stateData)));
+    iter->addUpvalue(gc.create<Upvalue>(Value(subject)));
+    iter->addUpvalue(gc.create<Upvalue>(Value(pattern)));
     return 1;
 }
 
-i32 str_format(LuaState* L) {
-    if (L->getTop() < 1) {
-        L->error("string.format: missing format string");
-    }
-
+void appendStringFormat(LuaState* L, i32 formatIndex, LuaString& result) {
     usize fmtLen = 0;
-    const char* fmt = getStringArg(L, 1, "format", &fmtLen);
+    const char* fmt = getStringArg(L, formatIndex, "format", &fmtLen);
 
     const LuaStdAllocator<char> stringAllocator(L->getGlobalState().getAllocator());
-    LuaString result(stringAllocator);
-    if (fmtLen > stringOutputLimit(L)) {
+    const usize limit = stringOutputLimit(L);
+    if (fmtLen > limit || result.size() > limit - fmtLen) {
         L->error("string.format: result exceeds resource limit");
     }
-    result.reserve(fmtLen);
+    result.reserve(result.size() + fmtLen);
 
-    i32 argIdx = 2;
+    i32 argIdx = formatIndex + 1;
     const char* p = fmt;
     const char* fmtEnd = fmt + fmtLen;
 
@@ -1402,7 +1423,15 @@ i32 str_format(LuaState* L) {
             p++;
         }
     }
+}
 
+i32 str_format(LuaState* L) {
+    if (L->getTop() < 1) {
+        L->error("string.format: missing format string");
+    }
+
+    LuaString result(LuaStdAllocator<char>(L->getGlobalState().getAllocator()));
+    appendStringFormat(L, 1, result);
     GCString* str = L->getGlobalState().getStringPool().intern(result.data(), result.size());
     L->pushString(str);
     return 1;
@@ -1607,6 +1636,8 @@ void StringLibModule::registerFunctions(LuaState* L) {
 
     GCString* indexKey = gs.getStringPool().intern("__index");
     stringMT->set(Value(indexKey), Value(stringTable));
+
+    registerStringBufferLib(L, stringTable);
 }
 
 void StringLibModule::initialize(LuaState* L) {
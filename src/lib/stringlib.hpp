@@ -21,6 +21,7 @@
 
 #include "common/types.hpp"
 #include "lib/lib_module.hpp"
+#include "runtime/lua_allocator.hpp"
 #include "vm/state/lua_state.hpp"
 
 namespace Lua {
@@ -140,6 +141,16 @@ i32 str_gmatch(LuaState* L);
  */
 i32 str_format(LuaState* L);
 
+/**
+ * @brief 按 string.format 规则把格式化结果追加到已有缓冲
+ * @param L Lua 状态指针
+ * @param formatIndex 格式串所在栈索引，其后的栈值为格式参数
+ * @param result 输出缓冲；资源上限按追加后的总长度检查
+ *
+ * 供 string.buffer 的 putf 复用，避免先驻留中间字符串再拷贝。
+ */
+void appendStringFormat(LuaState* L, i32 formatIndex, LuaString& result);
+
 /**
  * @brief string.dump(function)——导出函数字节码
  * @param L Lua 状态指针
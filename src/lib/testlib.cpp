@@ -497,7 +497,8 @@ i32 t_testC(LuaState* L) {
             (void)luaL_loadfile(reinterpret_cast<lua_State*>(L), L->at(idx).asString()->c_str());
         } else if (op == "pushcclosure") {
             const i32 upvalueCount = readNumber(L, command.args.at(0));
-            if (upvalueCount < 0 || upvalueCount > L->getTop()) {
+            if (upvalueCount < 0 || upvalueCount > L->getTop() ||
+                static_cast<usize>(upvalueCount) > Function::MaxUpvalues) {
                 L->error("testC: invalid C closure upvalue count");
             }
             Vec<Value> values;
@@ -505,7 +506,7 @@ i32 t_testC(LuaState* L) {
             for (i32 i = upvalueCount; i > 0; --i) {
                 values.push_back(L->at(-i));
             }
-            Function* closure = L->getGlobalState().getGC().create<Function>(t_testC);
+            Function* closure = L->getGlobalState().getGC().create<Function>(t_testC, static_cast<usize>(upvalueCount));
             closure->setEnv(currentEnvironment(L));
             for (const Value& value : values) {
                 closure->addUpvalue(L->getGlobalState().getGC().create<Upvalue>(value));
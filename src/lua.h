@@ -60,7 +60,12 @@ enum {
     LUA_GCCOUNTB = 4,
     LUA_GCSTEP = 5,
     LUA_GCSETPAUSE = 6,
-    LUA_GCSETSTEPMUL = 7
+    LUA_GCSETSTEPMUL = 7,
+    LUA_GCGEN = 10,
+    LUA_GCINC = 11,
+    LUA_GCSTEPUS = 12,
+    LUA_GCDEBT = 13,
+    LUA_GCMARKSWEEP = 14
 };
 
 typedef struct lua_State lua_State;
@@ -70,6 +75,8 @@ typedef int (*lua_CFunction)(lua_State* L);
 typedef void* (*lua_Alloc)(void* ud, void* ptr, size_t osize, size_t nsize);
 typedef const char* (*lua_Reader)(lua_State* L, void* data, size_t* size);
 typedef int (*lua_Writer)(lua_State* L, const void* data, size_t size, void* userData);
+typedef ptrdiff_t lua_KContext;
+typedef int (*lua_KFunction)(lua_State* L, int status, lua_KContext ctx);
 
 #define LUA_HOOKCALL 0
 #define LUA_HOOKRET 1
@@ -181,6 +188,9 @@ lua_State* lua_newthread(lua_State* L) LUA_CXX_MAY_THROW;
 lua_State* lua_trynewthread(lua_State* L) LUA_CXX_NOEXCEPT;
 int lua_resume(lua_State* L, int nargs) LUA_CXX_NOEXCEPT;
 int lua_yield(lua_State* L, int nresults) LUA_CXX_MAY_THROW;
+/* Project extension: yieldable C calls resumed through a continuation. */
+void lua_callk(lua_State* L, int nargs, int nresults, lua_KContext ctx, lua_KFunction k) LUA_CXX_MAY_THROW;
+int lua_yieldk(lua_State* L, int nresults, lua_KContext ctx, lua_KFunction k) LUA_CXX_MAY_THROW;
 int lua_status(lua_State* L) LUA_CXX_MAY_THROW;
 int lua_gc(lua_State* L, int what, int data) LUA_CXX_MAY_THROW;
 int lua_load(lua_State* L, lua_Reader reader, void* data, const char* chunkname) LUA_CXX_NOEXCEPT;
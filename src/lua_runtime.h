@@ -174,6 +174,16 @@ int lua_runtime_begin_execution(lua_State* L, const lua_RuntimeExecutionLimits*
  */
 int lua_runtime_get_metrics(lua_State* L, lua_RuntimeMetrics* metrics) LUA_CXX_NOEXCEPT;
 
+/**
+ * @brief Drive the built-in coroutine scheduler on the owner thread.
+ * @details Fires expired `coroutine.sleep` timers, then resumes ready `coroutine.spawn` tasks until the ready queue is
+ * empty or `budget` resumptions have run. It never blocks waiting for sleeping tasks.
+ * Pass `LUA_RUNTIME_UNLIMITED` to drain the ready queue. Task errors do not escape; `coroutine.join` reports them.
+ * Returns the number of unfinished tasks, or a negated `LUA_RUNTIME_ERR_*` value.
+ * The call is rejected with `-LUA_RUNTIME_ERR_BUSY` while Lua code is executing.
+ */
+int lua_runtime_scheduler_run(lua_State* L, uint64_t budget) LUA_CXX_NOEXCEPT;
+
 /** @brief Acquire a cross-thread cancellation handle that safely outlives the state. */
 lua_CancellationHandle* lua_runtime_get_cancellation_handle(lua_State* L, int* runtime_status) LUA_CXX_NOEXCEPT;
 
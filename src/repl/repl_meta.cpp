@@ -92,10 +92,10 @@ void printGcStrategy(RuntimeServices& services, std::ostream& out) {
     out << "  command: strategy" << '\n';
     out << "  active: " << services.gc.getStrategyName() << '\n';
     out << "  active summary: " << services.gc.getStrategy().summary() << '\n';
-    out << "  available: mark-sweep, incremental" << '\n';
+    out << "  available: mark-sweep, incremental, generational" << '\n';
     out << "  planned: incremental write barriers and scheduling" << '\n';
     out << "  boundary: RuntimeServices.gc owns the active collector" << '\n';
-    out << "  switch: collectgarbage(\"strategy\", \"mark-sweep\"|\"incremental\")" << '\n';
+    out << "  switch: collectgarbage(\"strategy\", \"mark-sweep\"|\"incremental\"|\"generational\")" << '\n';
 }
 
 const char* binaryOpName(BinaryExpr::Op op) {
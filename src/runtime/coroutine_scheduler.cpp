@@ -0,0 +1,298 @@
+/**
+ * @file coroutine_scheduler.cpp
+ * @brief 运行时内置协程调度器实现
+ */
+
+#include "runtime/coroutine_scheduler.hpp"
+
+#include "core/table.hpp"
+#include "core/thread.hpp"
+#include "gc/garbage_collector.hpp"
+#include "vm/state/lua_state.hpp"
+#include "vm/state/stack.hpp"
+
+#include <algorithm>
+#include <utility>
+
+namespace Lua {
+
+namespace {
+
+/** @brief 收回宿主栈上为一次恢复中转的值，清空槽位以免留下额外的可达引用 */
+void restoreHostTop(LuaState* host, usize top) noexcept {
+    Stack& stack = host->getStack();
+    for (usize slot = top; slot < host->getAbsoluteTop(); ++slot) {
+        stack[slot] = Value();
+    }
+    host->setAbsoluteTop(top);
+}
+
+} // namespace
+
+CoroutineScheduler::CoroutineScheduler(LuaAllocator* allocator)
+    : allocator_(allocator), epoch_(Clock::now()), tasks_(TaskMap::allocator_type(allocator)),
+      ready_(LuaStdAllocator<Thread*>(allocator)), overflow_(LuaStdAllocator<TimerEntry>(allocator)) {
+    for (LuaVector<TimerEntry>& slot : wheel_) {
+        slot = LuaVector<TimerEntry>(LuaStdAllocator<TimerEntry>(allocator));
+    }
+}
+
+u64 CoroutineScheduler::currentTick() const noexcept {
+    const auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(Clock::now() - epoch_);
+    return static_cast<u64>(elapsed.count());
+}
+
+bool CoroutineScheduler::isSuspendedTask(Thread* thread) const noexcept {
+    if (tasks_.empty()) {
+        return false;
+    }
+    const auto entry = tasks_.find(thread);
+    return entry != tasks_.end() && entry->second.state != TaskState::Running;
+}
+
+void CoroutineScheduler::spawn(Thread* thread, std::span<const Value> arguments) {
+    auto [entry, inserted] = tasks_.try_emplace(thread, allocator_);
+    if (!inserted) {
+        return;
+    }
+    try {
+        Task& task = entry->second;
+        task.resumeValues.assign(arguments.begin(), arguments.end());
+        makeReady(thread, task);
+    } catch (...) {
+        tasks_.erase(entry);
+        throw;
+    }
+}
+
+void CoroutineScheduler::makeReady(Thread* thread, Task& task) {
+    ready_.push_back(thread);
+    task.state = TaskState::Ready;
+}
+
+void CoroutineScheduler::sleep(Thread* thread, u64 milliseconds) {
+    Task& task = tasks_.at(thread);
+    if (milliseconds == 0) {
+        makeReady(thread, task);
+        return;
+    }
+
+    /** @brief 到期刻度总在最近推进的刻度之后，保证 advanceTimers 会经过它所在的槽。 */
+    const u64 deadline = std::max(currentTick(), lastTick_) + milliseconds;
+    addTimer(TimerEntry{thread, deadline});
+    task.state = TaskState::Sleeping;
+}
+
+void CoroutineScheduler::addTimer(const TimerEntry& entry) {
+    if (entry.deadline <= lastTick_ + kWheelSlots) {
+        wheel_[entry.deadline % kWheelSlots].push_back(entry);
+    } else {
+        overflow_.push_back(entry);
+        std::push_heap(overflow_.begin(), overflow_.end(), LaterDeadline{});
+    }
+    ++timerCount_;
+}
+
+void CoroutineScheduler::expireTimer(const TimerEntry& entry) {
+    --timerCount_;
+    if (auto task = tasks_.find(entry.thread); task != tasks_.end() && task->second.state == TaskState::Sleeping) {
+        makeReady(entry.thread, task->second);
+    }
+}
+
+void CoroutineScheduler::wait(Thread* thread) {
+    tasks_.at(thread).state = TaskState::Waiting;
+}
+
+bool CoroutineScheduler::wake(Thread* thread, std::span<const Value> values) {
+    auto entry = tasks_.find(thread);
+    if (entry == tasks_.end() || entry->second.state != TaskState::Waiting) {
+        return false;
+    }
+    Task& task = entry->second;
+    task.resumeValues.assign(values.begin(), values.end());
+    makeReady(thread, task);
+    return true;
+}
+
+void CoroutineScheduler::join(Thread* target, Thread* joiner) {
+    tasks_.at(target).joiners.push_back(joiner);
+    wait(joiner);
+}
+
+void CoroutineScheduler::advanceTimers() {
+    const u64 now = currentTick();
+    if (now <= lastTick_) {
+        return;
+    }
+    if (timerCount_ == 0) {
+        lastTick_ = now;
+        return;
+    }
+
+    /**
+     * @brief 轮槽只保存 lastTick_ 之后一圈内到期的定时器。
+     *
+     * 经过的刻度超过一圈时每个槽只需扫描一次；经过不足一圈时，槽中晚于 now 的定时器
+     * 属于下一次经过该槽的刻度。
+     */
+    const u64 elapsed = std::min<u64>(now - lastTick_, kWheelSlots);
+    for (u64 tick = lastTick_ + 1; tick <= lastTick_ + elapsed; ++tick) {
+        LuaVector<TimerEntry>& slot = wheel_[tick % kWheelSlots];
+        usize kept = 0;
+        for (usize i = 0; i < slot.size(); ++i) {
+            const TimerEntry entry = slot[i];
+            if (entry.deadline > now) {
+                slot[kept++] = entry;
+                continue;
+            }
+            expireTimer(entry);
+        }
+        slot.resize(kept);
+    }
+    lastTick_ = now;
+
+    // 溢出堆中已到期的直接唤醒，进入新一圈的移入轮槽
+    while (!overflow_.empty() && overflow_.front().deadline <= now + kWheelSlots) {
+        const TimerEntry entry = overflow_.front();
+        if (entry.deadline > now) {
+            // 先放入轮槽再出堆，分配失败时定时器仍留在堆中
+            wheel_[entry.deadline % kWheelSlots].push_back(entry);
+        }
+        std::pop_heap(overflow_.begin(), overflow_.end(), LaterDeadline{});
+        overflow_.pop_back();
+        if (entry.deadline <= now) {
+            expireTimer(entry);
+        }
+    }
+}
+
+void CoroutineScheduler::finishTask(LuaState* host, Thread* thread, usize resultBase) {
+    const usize resultTop = host->getAbsoluteTop();
+    const std::span<const Value> results(&host->getStack()[resultBase], resultTop - resultBase);
+
+    /** @brief 成功标志与结果留在已结束协程的栈上，之后的 join 直接从中读取。 */
+    LuaState* state = thread->getLuaState();
+    state->setTop(0);
+    for (const Value& value : results) {
+        state->pushValue(value);
+    }
+    thread->setTaskFinished();
+
+    auto entry = tasks_.find(thread);
+    if (entry == tasks_.end()) {
+        return;
+    }
+    LuaVector<Thread*> joiners = std::move(entry->second.joiners);
+    tasks_.erase(entry);
+    for (Thread* joiner : joiners) {
+        wake(joiner, results);
+    }
+}
+
+void CoroutineScheduler::abortTask(LuaState* host, Thread* thread, usize resultBase, const char* message) noexcept {
+    /** @brief 未结束的协程不能再被恢复：它的结果槽即将被改写。 */
+    if (!thread->isDead() && thread->getCoroutineStatus() != CoroutineStatus::Running) {
+        thread->abortResume(ThreadStatus::ErrRun);
+    }
+
+    restoreHostTop(host, resultBase);
+    try {
+        host->pushBoolean(false);
+        host->pushString(host->getGlobalState().getStringPool().intern(message));
+        finishTask(host, thread, resultBase);
+        restoreHostTop(host, resultBase);
+        return;
+    } catch (...) {
+        restoreHostTop(host, resultBase);
+    }
+
+    /** @brief 无法交付失败结果时至少不再把它当作根或未结束任务；等待它的任务随之丢弃。 */
+    if (auto entry = tasks_.find(thread); entry != tasks_.end()) {
+        for (Thread* joiner : entry->second.joiners) {
+            tasks_.erase(joiner);
+        }
+        tasks_.erase(thread);
+    }
+    thread->getLuaState()->setAbsoluteTop(0);
+    thread->setTaskFinished();
+}
+
+usize CoroutineScheduler::run(LuaState* host, u64 budget) {
+    struct RunGuard {
+        CoroutineScheduler& scheduler;
+        ~RunGuard() {
+            scheduler.current_ = nullptr;
+            scheduler.running_ = false;
+        }
+    } guard{*this};
+    running_ = true;
+
+    advanceTimers();
+    for (u64 resumed = 0; resumed < budget && !ready_.empty(); ++resumed) {
+        Thread* thread = ready_.front();
+        ready_.pop_front();
+        auto entry = tasks_.find(thread);
+        if (entry == tasks_.end() || entry->second.state != TaskState::Ready) {
+            continue;
+        }
+
+        const usize hostTop = host->getAbsoluteTop();
+        if (thread->isDead()) {
+            // 防御：任务在调度器之外结束时按失败交付，避免恢复已结束的协程
+            abortTask(host, thread, hostTop, "task ended outside the scheduler");
+            continue;
+        }
+
+        Task& task = entry->second;
+        try {
+            for (const Value& value : task.resumeValues) {
+                host->pushValue(value);
+            }
+            const i32 nargs = static_cast<i32>(task.resumeValues.size());
+            task.resumeValues.clear();
+            task.state = TaskState::Running;
+
+            current_ = thread;
+            thread->resume(host, nargs);
+            current_ = nullptr;
+
+            if (thread->isDead()) {
+                finishTask(host, thread, hostTop);
+            } else if (task.state == TaskState::Running) {
+                // 普通 coroutine.yield：让出到就绪队列末尾，挂起值被丢弃
+                makeReady(thread, task);
+            }
+        } catch (...) {
+            current_ = nullptr;
+            abortTask(host, thread, hostTop, "task aborted by scheduler error");
+            throw;
+        }
+        restoreHostTop(host, hostTop);
+    }
+    return tasks_.size();
+}
+
+void CoroutineScheduler::mark(GarbageCollector& gc) const {
+    gc.markObject(channelMetatable_);
+    for (const auto& [thread, task] : tasks_) {
+        gc.markObject(thread);
+        for (const Value& value : task.resumeValues) {
+            gc.markValue(value);
+        }
+    }
+}
+
+void CoroutineScheduler::clear() noexcept {
+    tasks_.clear();
+    ready_.clear();
+    for (LuaVector<TimerEntry>& slot : wheel_) {
+        slot.clear();
+    }
+    overflow_.clear();
+    timerCount_ = 0;
+    channelMetatable_ = nullptr;
+    current_ = nullptr;
+}
+
+} // namespace Lua
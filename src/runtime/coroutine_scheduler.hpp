@@ -0,0 +1,174 @@
+#pragma once
+
+/**
+ * @file coroutine_scheduler.hpp
+ * @brief 运行时内置的协程调度器：就绪队列、定时轮与等待唤醒
+ */
+
+#include "common/types.hpp"
+#include "core/value.hpp"
+#include "runtime/lua_allocator.hpp"
+
+#include <array>
+#include <chrono>
+#include <deque>
+#include <functional>
+#include <span>
+#include <unordered_map>
+
+namespace Lua {
+
+class GarbageCollector;
+class LuaState;
+class Table;
+class Thread;
+
+/**
+ * @brief 单个运行时上下文的协程调度器
+ *
+ * 任务就是普通协程对象。就绪任务按先进先出排队，休眠任务挂在以单调时钟毫秒为刻度的
+ * 定时轮上，等待 join 或通道的任务只留在任务表中，由唤醒方直接移回就绪队列。一圈之内
+ * 到期的定时器插入与到期都是 O(1)（到期按经过的刻度摊还）；更远的定时器先进入按到期
+ * 时刻排序的溢出堆（O(log n)），进入最后一圈时才移入轮槽，因此每个槽只保存本圈到期的
+ * 定时器，大量长时间休眠的任务不会拖慢每轮调度。
+ *
+ * 调度器由 GlobalState 拥有，任务表中的协程与待交付的恢复值作为垃圾回收根标记。
+ * 只有宿主经 lua_runtime_scheduler_run 驱动任务执行；任务结束后其成功标志与结果留在
+ * 协程自身栈上，供 join 读取。
+ */
+class CoroutineScheduler {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    /** @brief 不限制单次运行恢复任务的次数 */
+    static constexpr u64 UnlimitedBudget = ~u64{0};
+
+    explicit CoroutineScheduler(LuaAllocator* allocator);
+
+    CoroutineScheduler(const CoroutineScheduler&) = delete;
+    CoroutineScheduler& operator=(const CoroutineScheduler&) = delete;
+
+    /**
+     * @brief 登记新任务并排入就绪队列
+     * @param arguments 首次恢复时传给入口函数的参数
+     */
+    void spawn(Thread* thread, std::span<const Value> arguments);
+
+    /** @brief 正在运行的任务休眠 milliseconds 毫秒；为 0 时只让出到就绪队列末尾 */
+    void sleep(Thread* thread, u64 milliseconds);
+
+    /** @brief 正在运行的任务转入等待，直到 wake 交付恢复值 */
+    void wait(Thread* thread);
+
+    /**
+     * @brief 唤醒等待中的任务；values 成为其挂起调用的返回值
+     * @return 任务不在等待（已结束、已丢弃或已被其他方唤醒）时不交付并返回 false
+     */
+    bool wake(Thread* thread, std::span<const Value> values);
+
+    /** @brief 正在运行的 joiner 等待 target 结束 */
+    void join(Thread* target, Thread* joiner);
+
+    bool isTask(Thread* thread) const noexcept {
+        return tasks_.contains(thread);
+    }
+
+    /**
+     * @brief 任务是否挂起在调度器中（就绪、休眠或等待）
+     *
+     * 这样的协程只能由 run 恢复：直接 resume 会让调度器失去它的状态。
+     */
+    bool isSuspendedTask(Thread* thread) const noexcept;
+
+    /** @brief 由 run 恢复、当前正在执行的任务；不在调度中时为空指针 */
+    Thread* getCurrentTask() const noexcept {
+        return current_;
+    }
+
+    bool isRunning() const noexcept {
+        return running_;
+    }
+
+    /** @brief 尚未结束的任务数量（就绪、休眠与等待） */
+    usize getTaskCount() const noexcept {
+        return tasks_.size();
+    }
+
+    /**
+     * @brief 推进定时轮并依次恢复就绪任务
+     * @param host 作为恢复方的宿主状态，恢复参数与结果经其栈顶中转
+     * @param budget 本次最多恢复的任务次数
+     * @return 仍未结束的任务数量
+     *
+     * 就绪队列为空或预算用尽时返回，不等待休眠任务到期。
+     */
+    usize run(LuaState* host, u64 budget);
+
+    /** @brief 通道用户数据共享的元表，由协程库打开时创建 */
+    Table* getChannelMetatable() const noexcept {
+        return channelMetatable_;
+    }
+    void setChannelMetatable(Table* metatable) noexcept {
+        channelMetatable_ = metatable;
+    }
+
+    void mark(GarbageCollector& gc) const;
+
+    /** @brief 丢弃全部任务与定时器；用于 GarbageCollector::clearAll() 之前 */
+    void clear() noexcept;
+
+private:
+    enum class TaskState : u8 { Ready, Running, Sleeping, Waiting };
+
+    struct Task {
+        explicit Task(LuaAllocator* allocator)
+            : resumeValues(LuaStdAllocator<Value>(allocator)), joiners(LuaStdAllocator<Thread*>(allocator)) {}
+
+        TaskState state = TaskState::Ready;
+        /** @brief 下次恢复时传入的值：首次恢复的入口参数，或唤醒方交付的结果 */
+        LuaVector<Value> resumeValues;
+        LuaVector<Thread*> joiners;
+    };
+
+    struct TimerEntry {
+        Thread* thread;
+        u64 deadline;
+    };
+
+    /** @brief 定时轮槽数；刻度为 1 毫秒，超过一圈的定时器留在溢出堆中 */
+    static constexpr usize kWheelSlots = 256;
+
+    /** @brief 溢出堆比较器：到期时刻最早的定时器位于堆顶 */
+    struct LaterDeadline {
+        bool operator()(const TimerEntry& lhs, const TimerEntry& rhs) const noexcept {
+            return lhs.deadline > rhs.deadline;
+        }
+    };
+
+    using TaskMap = std::unordered_map<Thread*, Task, std::hash<Thread*>, std::equal_to<Thread*>,
+                                       LuaStdAllocator<std::pair<Thread* const, Task>>>;
+
+    u64 currentTick() const noexcept;
+    void makeReady(Thread* thread, Task& task);
+    void addTimer(const TimerEntry& entry);
+    void expireTimer(const TimerEntry& entry);
+    void advanceTimers();
+    void finishTask(LuaState* host, Thread* thread, usize resultBase);
+    void abortTask(LuaState* host, Thread* thread, usize resultBase, const char* message) noexcept;
+
+    LuaAllocator* allocator_;
+    Clock::time_point epoch_;
+    u64 lastTick_ = 0;
+    TaskMap tasks_;
+    std::deque<Thread*, LuaStdAllocator<Thread*>> ready_;
+    std::array<LuaVector<TimerEntry>, kWheelSlots> wheel_;
+    /** @brief 到期时刻超出 lastTick_ 一圈以上的定时器，按 LaterDeadline 组织为最小堆 */
+    LuaVector<TimerEntry> overflow_;
+    /** @brief 轮槽与溢出堆中的定时器总数 */
+    usize timerCount_ = 0;
+    Table* channelMetatable_ = nullptr;
+    Thread* current_ = nullptr;
+    bool running_ = false;
+};
+
+} // namespace Lua
@@ -68,6 +68,11 @@ inline bool releaseImplementationAllocation(void*) noexcept {
 
 using LuaAllocatorFunction = void* (*)(void* userData, void* pointer, std::size_t oldSize, std::size_t newSize);
 
+/**
+ * @brief 延迟释放回调：返回 true 表示已接管该块，稍后再交给分配器函数释放
+ */
+using LuaDeferredReleaseFunction = bool (*)(void* context, void* pointer, std::size_t size) noexcept;
+
 /** @brief 封装 Lua 分配器回调及其用户数据的内存分配器。 */
 class LuaAllocator {
 public:
@@ -101,6 +106,9 @@ public:
             return;
         }
         if (function_ != nullptr && pointer != nullptr) {
+            if (deferredRelease_ != nullptr && deferredRelease_(deferredContext_, pointer, oldSize)) {
+                return;
+            }
             try {
                 (void)function_(userData_, pointer, oldSize, 0);
             } catch (...) {
@@ -122,9 +130,25 @@ public:
         return userData_;
     }
 
+    /**
+     * @brief 挂接或解除延迟释放回调
+     *
+     * 垃圾回收器只在清扫期间挂接，把该窗口内的释放交给后台线程；传入 nullptr 解除。
+     */
+    void setDeferredRelease(LuaDeferredReleaseFunction function, void* context) noexcept {
+        deferredRelease_ = function;
+        deferredContext_ = context;
+    }
+
+    [[nodiscard]] bool hasDeferredRelease() const noexcept {
+        return deferredRelease_ != nullptr;
+    }
+
 private:
     LuaAllocatorFunction function_ = nullptr;
     void* userData_ = nullptr;
+    LuaDeferredReleaseFunction deferredRelease_ = nullptr;
+    void* deferredContext_ = nullptr;
 };
 
 /** @brief 将 Lua 分配器适配到标准容器分配器接口。 */
@@ -42,11 +42,21 @@
 #include <cassert>
 #endif
 
+struct lua_State;
+
 namespace Lua {
 
 // 前向声明
 using Instruction = u32; // 与 core/function.hpp 中的定义一致
 
+/**
+ * @brief C 函数的续延（公开 API 的 lua_KFunction）
+ *
+ * 由 lua_yieldk / lua_callk 登记在 C 调用帧上；协程挂起后再恢复时，执行从续延继续，
+ * 而不是回到已经展开的原 C 函数。
+ */
+using ContinuationFunction = int (*)(::lua_State* L, int status, isize ctx);
+
 /**
  * @brief 调用信息类
  *
@@ -72,7 +82,9 @@ public:
     /**
      * @brief 默认构造函数
      */
-    CallInfo() : func(0), base(0), top(0), savedpc(nullptr), nresults(0), tailcalls(0), hookLine(-1), hookPc(-1) {}
+    CallInfo()
+        : func(0), base(0), top(0), savedpc(nullptr), nresults(0), tailcalls(0), hookLine(-1), hookPc(-1),
+          continuation(nullptr), continuationContext(0) {}
 
     // =====================================================================
     // 成员变量（公开访问，类似C结构体）
@@ -142,6 +154,16 @@ public:
      */
     i32 hookPc;
 
+    /**
+     * @brief C 调用帧登记的续延；为空时挂起后的恢复值直接作为该 C 函数的返回值
+     */
+    ContinuationFunction continuation;
+
+    /**
+     * @brief 登记续延时一并保存、恢复时原样传回续延的上下文值
+     */
+    isize continuationContext;
+
     // =====================================================================
     // 辅助方法
     // =====================================================================
@@ -158,6 +180,8 @@ public:
         tailcalls = 0;
         hookLine = -1;
         hookPc = -1;
+        continuation = nullptr;
+        continuationContext = 0;
     }
 
     // =====================================================================
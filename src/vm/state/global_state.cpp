@@ -32,8 +32,8 @@ GlobalState& GlobalState::getInstance() {
 // =====================================================================
 
 GlobalState::GlobalState(StringPool& stringPool, LuaAllocator* allocator)
-    : ownerThread_(std::this_thread::get_id()), sandboxPolicy_(), nativeModules_(&sandboxPolicy_), gc_(allocator),
-      stringPool_(stringPool), registry_(nullptr), mainThread_(nullptr), memerrmsg_(nullptr),
+    : ownerThread_(std::this_thread::get_id()), sandboxPolicy_(), nativeModules_(&sandboxPolicy_), scheduler_(allocator),
+      gc_(allocator), stringPool_(stringPool), registry_(nullptr), mainThread_(nullptr), memerrmsg_(nullptr),
       apiExceptionMessage_(nullptr), instructionBudgetErrorMessage_(nullptr), nativeWorkBudgetErrorMessage_(nullptr),
       deadlineErrorMessage_(nullptr), cancellationErrorMessage_(nullptr), sandboxLibraryErrorMessage_(nullptr),
       sandboxFilesystemErrorMessage_(nullptr), sandboxProcessErrorMessage_(nullptr),
@@ -131,6 +131,9 @@ GlobalState::~GlobalState() {
     }
 #endif
 
+    threadStatePoolClosed_ = true;
+    clearThreadStatePool();
+
     // 注意：不需要手动删除registry_，因为GC会处理
     // 但需要从根对象中移除
     if (registry_) {
@@ -185,6 +188,11 @@ void GlobalState::setMetatable(ValueType type, Table* metatable) noexcept {
     }
 }
 
+void GlobalState::setStringBufferMetatable(Table* metatable) noexcept {
+    gc_.writeRootBarrier(metatable);
+    stringBufferMetatable_ = metatable;
+}
+
 void GlobalState::setMainThread(LuaState* mainThread) noexcept {
     mainThread_ = mainThread;
 }
@@ -194,6 +202,36 @@ void GlobalState::setRunningThread(Thread* t) noexcept {
     runningThread_ = t;
 }
 
+// =====================================================================
+// 协程状态池
+// =====================================================================
+
+LuaState* GlobalState::takeThreadState() noexcept {
+    if (threadStatePoolSize_ == 0) {
+        return nullptr;
+    }
+    LuaState* state = threadStatePool_[--threadStatePoolSize_];
+    threadStatePool_[threadStatePoolSize_] = nullptr;
+    gc_.releaseRetainedBytes(state->getRetainedBytes());
+    return state;
+}
+
+bool GlobalState::recycleThreadState(LuaState* state) noexcept {
+    if (threadStatePoolClosed_ || threadStatePoolSize_ == threadStatePool_.size() || !state->resetForReuse()) {
+        return false;
+    }
+    threadStatePool_[threadStatePoolSize_++] = state;
+    // 闲置状态仍占用分配器内存，计入内存总量与债务，使池不会绕过回收节奏
+    gc_.accountRetainedBytes(state->getRetainedBytes());
+    return true;
+}
+
+void GlobalState::clearThreadStatePool() noexcept {
+    while (LuaState* state = takeThreadState()) {
+        LuaState::destroyState(state);
+    }
+}
+
 void GlobalState::markRoots(GarbageCollector& gc, LuaState* currentState) const {
     gc.markObject(registry_);
     gc.markObject(memerrmsg_);
@@ -217,6 +255,7 @@ void GlobalState::markRoots(GarbageCollector& gc, LuaState* currentState) const
     for (Table* metatable : metatables_) {
         gc.markObject(metatable);
     }
+    gc.markObject(stringBufferMetatable_);
 
     if (currentState != nullptr) {
         gc.markState(currentState);
@@ -227,6 +266,7 @@ void GlobalState::markRoots(GarbageCollector& gc, LuaState* currentState) const
     }
 
     gc.markObject(runningThread_);
+    scheduler_.mark(gc);
 }
 
 GCString* GlobalState::getExecutionPolicyErrorMessage(ExecutionStopReason reason) const noexcept {
@@ -268,6 +308,8 @@ void GlobalState::resetRuntimeReferencesForClearAll() noexcept {
     mainThread_ = nullptr;
     runningThread_ = nullptr;
     metatables_.fill(nullptr);
+    stringBufferMetatable_ = nullptr;
+    scheduler_.clear();
     if (registry_ != nullptr) {
         registry_->clear();
     }
@@ -30,11 +30,13 @@
 #include "gc/garbage_collector.hpp"
 #include "runtime/native_module_registry.hpp"
 #include "runtime/compilation_policy.hpp"
+#include "runtime/coroutine_scheduler.hpp"
 #include "runtime/execution_policy.hpp"
 #include "runtime/runtime_random.hpp"
 #include "runtime/resource_policy.hpp"
 #include "runtime/sandbox_policy.hpp"
 #include "runtime/trace_runtime.hpp"
+#include "vm/vm_constants.hpp"
 
 #include <array>
 #include <stdexcept>
@@ -218,6 +220,14 @@ public:
         return traceRuntime_;
     }
 
+    CoroutineScheduler& getScheduler() noexcept {
+        return scheduler_;
+    }
+
+    const CoroutineScheduler& getScheduler() const noexcept {
+        return scheduler_;
+    }
+
     NativeModuleRegistry& getNativeModules() noexcept {
         return nativeModules_;
     }
@@ -355,6 +365,20 @@ public:
      */
     void setMetatable(ValueType type, Table* metatable) noexcept;
 
+    /**
+     * @brief 获取 string.buffer 对象共用的元表
+     * @return 元表指针（string 库未打开时为 nullptr）
+     */
+    Table* getStringBufferMetatable() const noexcept {
+        return stringBufferMetatable_;
+    }
+
+    /**
+     * @brief 设置 string.buffer 对象共用的元表
+     * @param metatable 元表指针
+     */
+    void setStringBufferMetatable(Table* metatable) noexcept;
+
     // =====================================================================
     // 元方法名称管理
     // =====================================================================
@@ -375,6 +399,34 @@ public:
     }
     void setRunningThread(Thread* t) noexcept;
 
+    // =====================================================================
+    // 协程状态池
+    // =====================================================================
+
+    /**
+     * @brief 取出一个已重置的协程状态
+     * @return 池为空时返回空指针，由 LuaState::newThread 重新分配
+     */
+    LuaState* takeThreadState() noexcept;
+
+    /**
+     * @brief 回收协程对象销毁时释放的 Lua 状态
+     * @return 状态已重置并放入池中时返回 true；池已满、已关闭或状态不可复用时返回 false，
+     *         由调用方销毁该状态
+     */
+    bool recycleThreadState(LuaState* state) noexcept;
+
+    /**
+     * @brief 销毁池中的全部协程状态
+     *
+     * 除关闭时外，垃圾回收器在显式完整收集后与分配失败重试前调用，把闲置内存交还分配器。
+     */
+    void clearThreadStatePool() noexcept;
+
+    usize getThreadStatePoolSize() const noexcept {
+        return threadStatePoolSize_;
+    }
+
 private:
     static constexpr usize kMetatableCount = static_cast<usize>(ValueType::Thread) + 1;
 
@@ -420,6 +472,22 @@ private:
     /** @brief 当前上下文拥有的跟踪输出端、序列号与调试开关。 */
     TraceRuntime traceRuntime_;
 
+    /**
+     * @brief 已死亡协程留下的可复用 Lua 状态
+     *
+     * 声明在垃圾回收器之前：析构函数先清空并关闭池，回收器析构时销毁的协程对象随后直接释放状态。
+     */
+    std::array<LuaState*, THREAD_POOL_CAPACITY> threadStatePool_{};
+    usize threadStatePoolSize_ = 0;
+    bool threadStatePoolClosed_ = false;
+
+    /**
+     * @brief 协程调度器；只保存垃圾回收对象的原始指针
+     *
+     * 声明在垃圾回收器之前：回收器析构时经 resetRuntimeReferencesForClearAll 清空调度器，此时它必须仍然存活。
+     */
+    CoroutineScheduler scheduler_;
+
     /**
      * @brief 垃圾回收器（由GlobalState拥有）
      */
@@ -461,6 +529,11 @@ private:
      */
     std::array<Table*, kMetatableCount> metatables_{}; // 9种基础类型
 
+    /**
+     * @brief string.buffer 元表，缓存后类型检查无需经注册表按名查找
+     */
+    Table* stringBufferMetatable_ = nullptr;
+
     /**
      * @brief 元方法名称数组（17个元方法）
      */
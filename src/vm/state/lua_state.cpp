@@ -11,6 +11,7 @@
 #include "lua.h"
 #include "common/lua_error.hpp"
 #include "common/number_conversion.hpp"
+#include "compiler/opcode.hpp"
 #if LUA_CPP_ENABLE_DEBUGGER
 #include "debugger/debug_runtime.hpp"
 #endif
@@ -285,9 +286,11 @@ LuaState* LuaState::newThread(LuaState* parentL) {
 
     GlobalState& globalState = parentL->getGlobalState();
     LuaAllocator* allocator = globalState.getAllocator();
-    LuaState* L = nullptr;
+    LuaState* L = globalState.takeThreadState();
 
-    if (allocator != nullptr && allocator->isConfigured()) {
+    if (L != nullptr) {
+        // 复用已回收的状态，值栈与调用栈内存原样保留
+    } else if (allocator != nullptr && allocator->isConfigured()) {
         void* memory = allocator->allocate(sizeof(LuaState));
         if (memory == nullptr) {
             return nullptr;
@@ -346,22 +349,29 @@ LuaState::LuaState() : LuaState(GlobalState::getInstance()) {}
 
 LuaState::LuaState(CtorToken, GlobalState& globalState) : LuaState(globalState) {}
 
-LuaState::LuaState(CtorToken, GlobalState& globalState, bool allocatorOwnedSelf) : LuaState(globalState) {
-    allocatorOwnedSelf_ = allocatorOwnedSelf;
-}
+/** @brief 仅由 newThread 使用：协程以较小的值栈与调用栈起步。 */
+LuaState::LuaState(CtorToken, GlobalState& globalState, bool allocatorOwnedSelf)
+    : ownedContext_(nullptr, EngineContextDeleter{}), allocatorOwnedSelf_(allocatorOwnedSelf),
+      globalState_(globalState),
+      stack_(THREAD_INITIAL_STACK_SIZE, globalState_.getAllocator(), &globalState_.getResourcePolicy()), top_(0),
+      callStack_(THREAD_INITIAL_CI_SIZE, LuaStdAllocator<CallInfo>(globalState_.getAllocator())), currentCI_(0),
+      globalTable_(nullptr), status_(ThreadStatus::OK), openUpvalues_(nullptr),
+      openUpvalueIndex_(globalState_.getAllocator()) {}
 
 LuaState::LuaState(CtorToken, EngineContext* ownedContext, bool allocatorOwnedContext, bool allocatorOwnedSelf)
     : ownedContext_(ownedContext, EngineContextDeleter{allocatorOwnedContext}), allocatorOwnedSelf_(allocatorOwnedSelf),
       globalState_(ownedContext_->globalState()),
       stack_(INITIAL_STACK_SIZE, globalState_.getAllocator(), &globalState_.getResourcePolicy()), top_(0),
       callStack_(INITIAL_CI_SIZE, LuaStdAllocator<CallInfo>(globalState_.getAllocator())), currentCI_(0),
-      globalTable_(nullptr), status_(ThreadStatus::OK), openUpvalues_(nullptr) {}
+      globalTable_(nullptr), status_(ThreadStatus::OK), openUpvalues_(nullptr),
+      openUpvalueIndex_(globalState_.getAllocator()) {}
 
 LuaState::LuaState(GlobalState& globalState)
     : ownedContext_(nullptr, EngineContextDeleter{}), allocatorOwnedSelf_(false), globalState_(globalState),
       stack_(INITIAL_STACK_SIZE, globalState_.getAllocator(), &globalState_.getResourcePolicy()), top_(0),
       callStack_(INITIAL_CI_SIZE, LuaStdAllocator<CallInfo>(globalState_.getAllocator())), currentCI_(0),
-      globalTable_(nullptr), status_(ThreadStatus::OK), openUpvalues_(nullptr) {}
+      globalTable_(nullptr), status_(ThreadStatus::OK), openUpvalues_(nullptr),
+      openUpvalueIndex_(globalState_.getAllocator()) {}
 
 LuaState::~LuaState() {
 #if LUA_CPP_ENABLE_DEBUGGER
@@ -388,6 +398,61 @@ LuaState::~LuaState() {
     }
 }
 
+bool LuaState::resetForReuse() noexcept {
+    if (!isChildThread_ || stack_.capacity() > THREAD_POOL_MAX_STACK_SIZE ||
+        callStack_.capacity() > THREAD_POOL_MAX_CI_SIZE) {
+        return false;
+    }
+
+    try {
+        closeUpvalues(0);
+    } catch (...) {
+        // 无法确认上值已全部关闭时不复用，由调用方按析构路径销毁
+        return false;
+    }
+
+#if LUA_CPP_ENABLE_DEBUGGER
+    if (Debugger::DebugController* debugger = globalState_.getDebugController()) {
+        debugger->unregisterState(*this);
+    }
+#endif
+
+    if (hookFunc_ != nullptr) {
+        globalState_.getGC().removeRoot(hookFunc_);
+    }
+    hookFunc_ = nullptr;
+    apiDebugHook_ = nullptr;
+    hookMask_ = 0;
+    hookCount_ = 0;
+    hookCountdown_ = 0;
+    hookActive_ = false;
+
+    for (usize slot = 0; slot < stack_.capacity(); ++slot) {
+        stack_[slot] = Value();
+    }
+    stack_.clear();
+    top_ = 0;
+    currentCI_ = 0;
+    globalTable_ = nullptr;
+    status_ = ThreadStatus::OK;
+    allowYield_ = 0;
+    yieldResults_ = 0;
+    savedNexeccalls_ = 1;
+    hostCallDepth_ = 0;
+    yieldableHostDepth_ = 0;
+    continuationFrames_ = false;
+    raiseHostDepth_ = -1;
+    raiseFrame_ = 0;
+    raisedError_ = false;
+    thread_ = nullptr;
+    return true;
+}
+
+usize LuaState::getRetainedBytes() const noexcept {
+    return sizeof(LuaState) + stack_.capacity() * sizeof(Value) + callStack_.capacity() * sizeof(CallInfo) +
+           openUpvalueIndex_.getCapacityBytes();
+}
+
 // =====================================================================
 // 初始化
 // =====================================================================
@@ -445,32 +510,22 @@ void LuaState::setGlobalTable(Table* table) {
 // =====================================================================
 
 Upvalue* LuaState::findOrCreateUpvalue(usize stackIndex) {
-    // 1. 在链表中查找已存在的upvalue（按栈索引降序）
-    Upvalue* prev = nullptr;
-    Upvalue* curr = openUpvalues_;
-
-    while (curr != nullptr && curr->getStackIndex() > stackIndex) {
-        prev = curr;
-        curr = curr->getNext();
-    }
-
-    // 2. 找到了，直接返回
-    if (curr != nullptr && curr->getStackIndex() == stackIndex) {
-        return curr;
+    // 1. 按栈槽直接查找已存在的upvalue
+    if (Upvalue* existing = openUpvalueIndex_.find(stackIndex)) {
+        return existing;
     }
 
-    // 3. 没找到，创建新的upvalue
-    // ✅ 改进：只传递索引，不传递指针
+    // 2. 没找到，创建新的upvalue并先登记索引；登记失败时新对象不可达，由GC回收
     Upvalue* newUpval = globalState_.getGC().create<Upvalue>(stackIndex, stack_);
+    openUpvalueIndex_.insert(stackIndex, newUpval);
 
-    // 4. 插入链表（保持降序）
-    newUpval->setNext(curr);
-    if (prev == nullptr) {
-        // 插入到链表头
-        openUpvalues_ = newUpval;
-    } else {
-        // 插入到prev之后
+    // 3. 插入链表（保持降序）：插在栈索引更高的最近节点之后
+    if (Upvalue* prev = openUpvalueIndex_.findAbove(stackIndex)) {
+        newUpval->setNext(prev->getNext());
         prev->setNext(newUpval);
+    } else {
+        newUpval->setNext(openUpvalues_);
+        openUpvalues_ = newUpval;
     }
 
     return newUpval;
@@ -481,8 +536,9 @@ void LuaState::closeUpvalues(usize level) {
     while (openUpvalues_ != nullptr && openUpvalues_->getStackIndex() >= level) {
         Upvalue* uv = openUpvalues_;
         openUpvalues_ = uv->getNext(); // 从链表移除
-        uv->close(stack_);             // ✅ 改进：传入stack_引用
-        uv->setNext(nullptr);          // 清除链表指针
+        openUpvalueIndex_.erase(uv->getStackIndex());
+        uv->close(stack_);    // ✅ 改进：传入stack_引用
+        uv->setNext(nullptr); // 清除链表指针
     }
 }
 
@@ -905,6 +961,7 @@ i32 LuaState::pcall(i32 nargs, i32 nresults, i32 errfunc) {
     };
 
     auto finishMemoryError = [&]() -> i32 {
+        raisedError_ = false;
         closeUnwoundUpvalues();
         restoreCallFrames();
         restoreStackPrefix();
@@ -948,6 +1005,7 @@ i32 LuaState::pcall(i32 nargs, i32 nresults, i32 errfunc) {
     };
 
     auto finishError = [&](Value errorValue, i32 status) -> i32 {
+        raisedError_ = false;
         HandlerResult handled = invokeErrorHandler(errorValue);
         closeUnwoundUpvalues();
         restoreCallFrames();
@@ -975,9 +1033,35 @@ i32 LuaState::pcall(i32 nargs, i32 nresults, i32 errfunc) {
         }
     }
 
+    /** @brief 被保护调用期间允许 error() 以状态返回；异常展开时同样还原外层 pcall 的设置。 */
+    struct RaiseGate {
+        LuaState& state;
+        i32 savedDepth;
+        usize savedFrame;
+
+        ~RaiseGate() {
+            state.raiseHostDepth_ = savedDepth;
+            state.raiseFrame_ = savedFrame;
+        }
+    };
+
     try {
         RuntimeServices services(globalState_);
-        VM::call(services, this, nargs, nresults);
+        {
+            RaiseGate gate{*this, raiseHostDepth_, raiseFrame_};
+            raiseHostDepth_ = hostCallDepth_ + 1;
+            raiseFrame_ = savedCurrentCI + 1;
+            VM::call(services, this, nargs, nresults);
+        }
+        if (raisedError_) {
+            // error() 以状态返回：出错的调用帧仍在原处，错误值位于栈顶
+            Value errorValue = top();
+            try {
+                return finishError(errorValue, LUA_ERRRUN);
+            } catch (...) {
+                return finishMemoryError();
+            }
+        }
         setStatus(ThreadStatus::OK);
         return LUA_OK;
 
@@ -1239,8 +1323,7 @@ Opt<StrView> LuaState::tryToString(i32 idx) {
         }
         if (v.isNumber()) {
             // 将数字转换为字符串并替换栈上的值
-            Str text = luaNumberToString(v.asNumber());
-            GCString* str = globalState_.getStringPool().intern(text);
+            GCString* str = globalState_.getStringPool().internNumber(v.asNumber());
             v = Value(str);
             return str->view();
         }
@@ -1373,4 +1456,29 @@ i32 LuaState::error() {
     throw RuntimeError(top());
 }
 
+i32 LuaState::raiseError() {
+    if (hostCallDepth_ != raiseHostDepth_ || currentCI_ < raiseFrame_ || globalState_.getDebugController() != nullptr) {
+        return error();
+    }
+
+    // 被保护函数与 error() 之间只能是同一调度循环内的 Lua 帧，且调用方正停在 CALL/TAILCALL 上
+    for (usize frame = raiseFrame_; frame < currentCI_; ++frame) {
+        const Value& function = stack_[callStack_[frame].func];
+        if (!function.isFunction() || !function.asFunction()->isLuaFunction()) {
+            return error();
+        }
+    }
+    if (currentCI_ > raiseFrame_) {
+        const CallInfo& caller = callStack_[currentCI_ - 1];
+        const OpCode op = caller.savedpc != nullptr ? GET_OPCODE(caller.savedpc[-1]) : OpCode::MOVE;
+        if (op != OpCode::CALL && op != OpCode::TAILCALL) {
+            return error();
+        }
+    }
+
+    setStatus(ThreadStatus::ErrRun);
+    raisedError_ = true;
+    return 0;
+}
+
 } // namespace Lua
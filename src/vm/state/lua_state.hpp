@@ -29,6 +29,7 @@
 #include "vm/state/global_state.hpp"
 #include "vm/state/stack.hpp"
 #include "vm/state/call_info.hpp"
+#include "vm/state/open_upvalue_index.hpp"
 #include "vm/vm_constants.hpp"
 #include <expected>
 
@@ -577,6 +578,21 @@ public:
      */
     i32 error();
 
+    /**
+     * @brief error() 的入口：以栈顶的值报错，能以状态返回时不抛出 C++ 异常
+     * @return 以状态返回时为 0，错误值留在栈顶；否则同 error() 抛出
+     *
+     * 只有当前 C 函数由 pcall 保护的调度循环直接以 CALL/TAILCALL 调用、中间全是 Lua 帧且
+     * 未附加调试器时才走状态返回：precall、CALL 处理器、调度循环与 VM::call 依次原样返回，
+     * 由 pcall 在同一现场完成收尾。
+     */
+    i32 raiseError();
+
+    /** @brief 是否有经 raiseError 以状态返回、尚待 pcall 收尾的错误 */
+    bool hasRaisedError() const noexcept {
+        return raisedError_;
+    }
+
     // =====================================================================
     // 调用信息管理
     // =====================================================================
@@ -656,13 +672,13 @@ public:
      * 多个闭包可以共享指向同一栈位置的上值，确保变量语义的正确性。
      *
      * 查找策略：
-     * 1. 遍历openUpvalues_链表（按栈索引降序排列）
-     * 2. 如果找到匹配的栈位置，返回现有Upvalue
-     * 3. 如果没找到，创建新的Upvalue并插入链表
+     * 1. 在栈槽索引中按位置直接查找，命中则返回现有Upvalue
+     * 2. 如果没找到，创建新的Upvalue并登记到索引
+     * 3. 由索引定位栈索引更高的最近节点，插入openUpvalues_链表
      *
      * 链表维护：
      * - 链表按stackIndex降序排列
-     * - 新Upvalue插入到正确位置以保持有序
+     * - 查找与插入定位都不遍历链表，开销不随开放上值数量增长
      *
      * GC集成：
      * - 新创建的Upvalue会注册到GC系统
@@ -678,10 +694,9 @@ public:
      * 关闭操作将开放状态的上值转换为关闭状态。
      *
      * 处理策略：
-     * 1. 遍历openUpvalues_链表
-     * 2. 找到所有栈索引 >= level的Upvalue
-     * 3. 调用Upvalue::close()关闭它们
-     * 4. 从链表中移除
+     * 1. 从openUpvalues_链表头依次取出栈索引 >= level的Upvalue
+     * 2. 调用Upvalue::close()关闭它们
+     * 3. 从链表和栈槽索引中移除，开销只与关闭的数量成正比
      *
      * 调用时机：
      * - 函数返回时
@@ -696,10 +711,27 @@ public:
 
     /**
      * @brief 创建子线程（协程用）
-     * 共享全局状态和全局表，拥有独立值栈和调用栈。
+     * 共享全局状态和全局表，拥有独立值栈和调用栈。优先复用全局状态池中的已回收状态，
+     * 新分配的状态以 THREAD_INITIAL_STACK_SIZE / THREAD_INITIAL_CI_SIZE 起步并按倍增扩展。
      */
     static LuaState* newThread(LuaState* parentL);
 
+    /**
+     * @brief 将已脱离协程对象的子线程状态重置为刚创建时的空状态，保留值栈与调用栈的内存
+     * @return 状态不是子线程，或值栈超过 THREAD_POOL_MAX_STACK_SIZE、调用栈超过
+     *         THREAD_POOL_MAX_CI_SIZE 时不做修改并返回 false
+     *
+     * 仅供 GlobalState 的协程状态池使用；newThread 负责重新填入基础调用帧与全局表。
+     */
+    bool resetForReuse() noexcept;
+
+    /**
+     * @brief 状态自身及其值栈、调用栈与开放上值索引占用的字节数
+     *
+     * 协程状态池按此值把闲置状态计入垃圾回收器的内存总量。
+     */
+    [[nodiscard]] usize getRetainedBytes() const noexcept;
+
     /**
      * @brief 挂起许可计数器
      */
@@ -710,8 +742,31 @@ public:
         if (allowYield_ > 0)
             allowYield_--;
     }
+    /**
+     * @brief 能否挂起：处于恢复中的协程，且没有穿过未登记续延的宿主调用（VM::call）
+     */
     bool canYield() const noexcept {
-        return allowYield_ > 0;
+        return allowYield_ > 0 && hostCallDepth_ <= yieldableHostDepth_;
+    }
+
+    /**
+     * @brief 挂起可穿越的宿主调用深度；恢复时设为当时的深度，lua_callk 期间加一
+     */
+    void setYieldableHostDepth(i32 depth) noexcept {
+        yieldableHostDepth_ = depth;
+    }
+    i32 getYieldableHostDepth() const noexcept {
+        return yieldableHostDepth_;
+    }
+
+    /**
+     * @brief 挂起现场是否含有登记了续延的 C 帧；为真时只能经原生恢复逐层完成续延
+     */
+    bool hasContinuationFrames() const noexcept {
+        return continuationFrames_;
+    }
+    void setContinuationFrames(bool pending) noexcept {
+        continuationFrames_ = pending;
     }
 
     /**
@@ -754,6 +809,11 @@ public:
         thread_ = t;
     }
 
+    /** @brief 是否为 newThread 创建的协程状态（由协程对象拥有，与主状态共享全局表） */
+    bool isChildThread() const noexcept {
+        return isChildThread_;
+    }
+
     Thread* getMainThreadFacade() const noexcept {
         return mainThreadFacade_;
     }
@@ -905,6 +965,11 @@ private:
      */
     Upvalue* openUpvalues_;
 
+    /**
+     * @brief 开放上值按栈槽的索引，与openUpvalues_链表同步维护
+     */
+    OpenUpvalueIndex openUpvalueIndex_;
+
     // =====================================================================
     // Coroutine 相关字段
     // =====================================================================
@@ -929,6 +994,28 @@ private:
      */
     i32 hostCallDepth_ = 0;
 
+    /**
+     * @brief 挂起可穿越的宿主调用深度（见 canYield）
+     */
+    i32 yieldableHostDepth_ = 0;
+
+    /**
+     * @brief 调用栈中是否可能含有登记了续延、待恢复时完成的 C 帧
+     */
+    bool continuationFrames_ = false;
+
+    /**
+     * @brief 错误可以状态返回的宿主调用深度与被保护函数的调用帧序号（见 raiseError）
+     *
+     * 由 pcall 在其 VM::call 期间设置；更深的宿主调用（元方法、C 函数内的 lua_call）深度不符，
+     * 照常抛出异常。
+     */
+    i32 raiseHostDepth_ = -1;
+    usize raiseFrame_ = 0;
+
+    /** @brief raiseError 已以状态返回，错误值位于栈顶 */
+    bool raisedError_ = false;
+
     /**
      * @brief 所属协程对象（主线程为空指针）
      */
@@ -0,0 +1,71 @@
+/**
+ * @file open_upvalue_index.cpp
+ * @brief 开放上值栈槽索引实现
+ */
+
+#include "vm/state/open_upvalue_index.hpp"
+
+#include <bit>
+
+namespace Lua {
+
+OpenUpvalueIndex::OpenUpvalueIndex(LuaAllocator* allocator)
+    : slots_(LuaStdAllocator<Upvalue*>(allocator)), buckets_(LuaStdAllocator<u64>(allocator)),
+      summary_(LuaStdAllocator<u64>(allocator)) {}
+
+Upvalue* OpenUpvalueIndex::findAbove(usize slot) const noexcept {
+    const usize next = slot + 1;
+    usize bucket = next / kBucketBits;
+    if (bucket >= buckets_.size()) {
+        return nullptr;
+    }
+
+    u64 bits = buckets_[bucket] & (~u64{0} << (next % kBucketBits));
+    if (bits == 0) {
+        // 本桶内没有更高的栈槽：由第二级位图跳到下一个非空桶
+        const usize first = bucket + 1;
+        if (first >= buckets_.size()) {
+            return nullptr;
+        }
+        usize group = first / kBucketBits;
+        u64 groupBits = summary_[group] & (~u64{0} << (first % kBucketBits));
+        while (groupBits == 0) {
+            if (++group >= summary_.size()) {
+                return nullptr;
+            }
+            groupBits = summary_[group];
+        }
+        bucket = group * kBucketBits + static_cast<usize>(std::countr_zero(groupBits));
+        bits = buckets_[bucket];
+    }
+    return slots_[bucket * kBucketBits + static_cast<usize>(std::countr_zero(bits))];
+}
+
+void OpenUpvalueIndex::insert(usize slot, Upvalue* upvalue) {
+    const usize bucket = slot / kBucketBits;
+    if (bucket >= buckets_.size()) {
+        // 先扩展第二级位图：中途抛出时较大的数组只多出空记录，不破坏查找
+        const usize bucketCount = bucket + 1;
+        summary_.resize((bucketCount + kBucketBits - 1) / kBucketBits, 0);
+        buckets_.resize(bucketCount, 0);
+        slots_.resize(bucketCount * kBucketBits, nullptr);
+    }
+
+    slots_[slot] = upvalue;
+    buckets_[bucket] |= u64{1} << (slot % kBucketBits);
+    summary_[bucket / kBucketBits] |= u64{1} << (bucket % kBucketBits);
+}
+
+void OpenUpvalueIndex::erase(usize slot) noexcept {
+    if (slot >= slots_.size()) {
+        return;
+    }
+    const usize bucket = slot / kBucketBits;
+    slots_[slot] = nullptr;
+    buckets_[bucket] &= ~(u64{1} << (slot % kBucketBits));
+    if (buckets_[bucket] == 0) {
+        summary_[bucket / kBucketBits] &= ~(u64{1} << (bucket % kBucketBits));
+    }
+}
+
+} // namespace Lua
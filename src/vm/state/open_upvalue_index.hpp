@@ -0,0 +1,65 @@
+/**
+ * @file open_upvalue_index.hpp
+ * @brief 开放上值按栈槽的分桶索引
+ *
+ * 开放上值链表按栈索引降序排列，关闭时从表头逐个弹出；但查找和插入需要从表头
+ * 向下遍历，深栈上捕获低位局部变量时开销随开放上值数量线性增长。本索引按栈槽
+ * 直接记录开放上值，并用两级位图定位某个栈槽之上最近的开放上值，使查找为 O(1)、
+ * 插入位置的定位与开放上值数量无关。
+ */
+
+#pragma once
+
+#include "common/types.hpp"
+#include "runtime/lua_allocator.hpp"
+
+namespace Lua {
+
+class Upvalue;
+
+/**
+ * @brief 开放上值的栈槽索引
+ *
+ * 每个栈槽一个上值指针；第一级位图每位对应一个栈槽，每个 64 位字即一个桶；第二级位图
+ * 每位对应一个非空桶。三个数组只按出现过的最高栈槽增长，不随值栈容量预留。
+ * 索引只记录位置，不持有上值：链表仍是垃圾回收标记与关闭顺序的依据。
+ */
+class OpenUpvalueIndex {
+public:
+    explicit OpenUpvalueIndex(LuaAllocator* allocator);
+
+    /** @brief 栈槽上的开放上值；没有时返回空指针 */
+    Upvalue* find(usize slot) const noexcept {
+        return slot < slots_.size() ? slots_[slot] : nullptr;
+    }
+
+    /**
+     * @brief 栈索引大于 slot 的开放上值中栈索引最小的一个
+     * @return 降序链表中新上值应当插在其后的节点；没有时返回空指针
+     */
+    Upvalue* findAbove(usize slot) const noexcept;
+
+    /**
+     * @brief 登记栈槽上新建的开放上值
+     *
+     * 可能因扩展数组抛出内存异常；此时已有记录保持不变。
+     */
+    void insert(usize slot, Upvalue* upvalue);
+
+    /** @brief 上值关闭后移除其栈槽记录 */
+    void erase(usize slot) noexcept;
+
+    /** @brief 三个数组已向分配器申请的字节数 */
+    [[nodiscard]] usize getCapacityBytes() const noexcept {
+        return slots_.capacity() * sizeof(Upvalue*) + (buckets_.capacity() + summary_.capacity()) * sizeof(u64);
+    }
+
+private:
+    static constexpr usize kBucketBits = 64;
+
+    LuaVector<Upvalue*> slots_;
+    LuaVector<u64> buckets_;
+    LuaVector<u64> summary_;
+};
+
+} // namespace Lua
@@ -131,10 +131,11 @@ void Stack::setTop(usize newTop) {
     if (newTop > stack_.size()) {
         const usize limit =
             resourcePolicy_ != nullptr ? std::min(resourcePolicy_->maxStackSlots, MAX_STACK_SIZE) : MAX_STACK_SIZE;
-        const usize newCapacity = newTop > limit - std::min(limit, EXTRA_STACK) ? limit : newTop + EXTRA_STACK;
+        const usize doubled = stack_.size() > limit / 2 ? limit : stack_.size() * 2;
+        const usize padded = newTop > limit - std::min(limit, EXTRA_STACK) ? limit : newTop + EXTRA_STACK;
 
-        // 需要扩展栈
-        stack_.resize(newCapacity);
+        // 与 ensureSpace 相同按倍增扩展，小栈起步的协程逐帧加深时不必每次重新分配
+        stack_.resize(std::max(doubled, padded));
     }
 
     // 如果新栈顶大于当前栈顶，用nil填充
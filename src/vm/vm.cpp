@@ -36,6 +36,7 @@
 #endif
 
 #include <cassert>
+#include <exception>
 
 namespace Lua {
 
@@ -194,6 +195,19 @@ void enforceExecutionPolicy(GlobalState& globalState) {
     }
 }
 
+/**
+ * @brief error() 已以状态返回时退出调度循环
+ *
+ * raiseError 只在 pcall 直接进入的调度循环里放行，此时不会处于切换进来的协程上；万一如此，
+ * 改为抛出异常，交给切换链的异常展开。
+ */
+ExecResult raiseFromDispatch(VM::detail::CoroutineSwitchChain& chain) {
+    if (chain.depth > 0) [[unlikely]] {
+        throw RuntimeError(chain.state->top());
+    }
+    return ExecResult::Raised;
+}
+
 enum class DispatchBackend : u8 {
     Switch,
     Table,
@@ -208,17 +222,11 @@ enum class DispatchBackend : u8 {
  * 跟踪使用。新 Lua 调用帧尚无保存位置，因此空 savedpc 从 PC 0 开始。计数钩子先于行钩子
  * 运行；两者都可能修改栈或调用信息，所以执行操作码前会在每个钩子之后刷新 `base`。
  */
-ExecResult runDispatchBackend(VMContext& context, DispatchBackend backend) {
-    RuntimeServices& services = context.services;
-    LuaState* L = context.state;
-    Proto* proto = context.proto;
-    i32 nexeccalls = context.nexeccalls;
-
-    // 深度检查
-    if (!proto)
-        throw RuntimeError("VM::executeProto: null proto");
-    if (nexeccalls >= MAX_CALLS)
-        throw StackOverflowError("VM: stack overflow (too many nested calls)");
+ExecResult runDispatchLoop(RuntimeServices& services, VM::detail::CoroutineSwitchChain& chain,
+                           DispatchBackend backend) {
+    LuaState*& L = chain.state;
+    i32& nexeccalls = chain.nexeccalls;
+    Proto* proto = nullptr;
 
     // ---- 局部执行状态 ----
     Function* func = nullptr;
@@ -322,10 +330,24 @@ reentry: // ⭐ 重入点：从 CallInfo 恢复所有执行状态
                     continue;
                 case HandlerStatus::Reenter:
                     goto reentry;
+                case HandlerStatus::Switched:
+                    L = opContext.state;
+                    ++chain.depth;
+                    goto reentry;
                 case HandlerStatus::Yielded:
+                    if (chain.depth > 0) {
+                        VM::detail::switchBack(chain, ExecResult::Yielded);
+                        goto reentry;
+                    }
                     return ExecResult::Yielded;
                 case HandlerStatus::Returned:
+                    if (chain.depth > 0) {
+                        VM::detail::switchBack(chain, ExecResult::Returned);
+                        goto reentry;
+                    }
                     return ExecResult::Returned;
+                case HandlerStatus::Raised:
+                    return raiseFromDispatch(chain);
                 }
             }
 
@@ -467,10 +489,24 @@ reentry: // ⭐ 重入点：从 CallInfo 恢复所有执行状态
                 continue;
             case HandlerStatus::Reenter:
                 goto reentry;
+            case HandlerStatus::Switched:
+                L = opContext.state;
+                ++chain.depth;
+                goto reentry;
             case HandlerStatus::Yielded:
+                if (chain.depth > 0) {
+                    VM::detail::switchBack(chain, ExecResult::Yielded);
+                    goto reentry;
+                }
                 return ExecResult::Yielded;
             case HandlerStatus::Returned:
+                if (chain.depth > 0) {
+                    VM::detail::switchBack(chain, ExecResult::Returned);
+                    goto reentry;
+                }
                 return ExecResult::Returned;
+            case HandlerStatus::Raised:
+                return raiseFromDispatch(chain);
             }
         } // while 循环
     } // 代码引用作用域
@@ -478,6 +514,32 @@ reentry: // ⭐ 重入点：从 CallInfo 恢复所有执行状态
     return ExecResult::Returned;
 }
 
+/**
+ * @brief 调度循环入口
+ *
+ * 切换进来的协程抛出的异常属于该协程的恢复，由 unwindSwitch 转换为恢复方看到的失败结果后
+ * 在恢复方的调用帧上重新进入循环；没有切换层时异常照常传播。
+ */
+ExecResult runDispatchBackend(VMContext& context, DispatchBackend backend) {
+    // 深度检查
+    if (!context.proto)
+        throw RuntimeError("VM::executeProto: null proto");
+    if (context.nexeccalls >= MAX_CALLS)
+        throw StackOverflowError("VM: stack overflow (too many nested calls)");
+
+    VM::detail::CoroutineSwitchChain chain{context.state, context.nexeccalls};
+    for (;;) {
+        try {
+            return runDispatchLoop(context.services, chain, backend);
+        } catch (...) {
+            if (chain.depth == 0) {
+                throw;
+            }
+            VM::detail::unwindSwitch(chain, std::current_exception());
+        }
+    }
+}
+
 } // namespace
 
 ExecResult SwitchDispatch::run(VMContext& context) {
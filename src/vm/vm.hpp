@@ -30,6 +30,7 @@ namespace Lua {
 
 // 前向声明
 class LuaState;
+class CallInfo;
 class Function;
 class Proto;
 class ITraceSink;
@@ -40,7 +41,8 @@ struct RuntimeServices;
  */
 enum class ExecResult : u8 {
     Returned, // 函数正常返回
-    Yielded   // 协程挂起
+    Yielded,  // 协程挂起
+    Raised    // error() 已以状态返回，出错现场留给 pcall 收尾（见 LuaState::raiseError）
 };
 
 /**
@@ -118,6 +120,21 @@ LUA_VM_COMPAT_DEPRECATED("pass RuntimeServices explicitly") void call(LuaState*
  */
 void call(RuntimeServices& services, LuaState* L, i32 nargs, i32 nresults);
 
+/**
+ * @brief 允许被调函数挂起的 call；调用方的 C 帧须已登记续延
+ *
+ * 被调函数挂起时本次调用连同调用方 C 函数一起展开，协程恢复后由续延接收结果。
+ */
+void callk(RuntimeServices& services, LuaState* L, i32 nargs, i32 nresults);
+
+/**
+ * @brief 调试接口读取 Lua 帧的局部变量寄存器 reg 之前调用，按需建立兼容 arg 表
+ *
+ * 代码生成器只为函数体引用 arg 的旧式可变参数函数设置 VARARG_NEEDSARG。其余函数仍声明局部变量 arg，
+ * 但调用时不分配表、寄存器保持 nil；debug.getlocal 与 lua_getlocal 首次读到它时在此由帧中的额外参数补建。
+ */
+void materializeCompatArg(LuaState* L, const CallInfo& ci, usize reg);
+
 /**
  * @brief 设置全局追踪输出端（空指针表示关闭追踪）
  */
@@ -5,6 +5,7 @@
 
 #include "vm/vm_internal.hpp"
 
+#include "common/config.hpp"
 #include "common/lua_error.hpp"
 #include "core/function.hpp"
 #include "core/metatable.hpp"
@@ -54,8 +55,20 @@ Str formatCallTypeError(const Value& value, const Str& callTargetName) {
     return Str("attempt to call a ") + typeName + " value";
 }
 
-bool precallImpl(LuaState* L, i32 funcIndex, i32 nArgs, i32 nResults, const Str& callTargetName,
-                 CallTargetNameResolver resolver = nullptr, void* resolverContext = nullptr);
+bool precallImpl(LuaState* L, i32 funcIndex, i32 nArgs, i32 nResults, CallTargetNameResolver resolver = nullptr,
+                 void* resolverContext = nullptr);
+
+/** @brief 由留在调用帧之下的额外参数建立 Lua 5.0 风格的 arg 表（含 n 字段） */
+Table* createCompatArgTable(LuaState* L, usize firstVararg, i32 nVarargs) {
+    Table* compatArgTable = L->getGlobalState().getGC().create<Table>();
+    if (nVarargs > 0) {
+        compatArgTable->setArrayRange(
+            1, std::span<const Value>(&L->getStack()[firstVararg], static_cast<usize>(nVarargs)));
+    }
+    GCString* nKey = L->getGlobalState().getStringPool().intern("n");
+    compatArgTable->set(Value(nKey), Value(static_cast<LuaNumber>(nVarargs)));
+    return compatArgTable;
+}
 
 } // namespace
 
@@ -158,22 +171,39 @@ void postcall(LuaState* L, i32 funcPos, i32 wantedResults, usize firstResult) {
 }
 
 bool precall(LuaState* L, i32 funcIndex, i32 nArgs, i32 nResults) {
-    return precallImpl(L, funcIndex, nArgs, nResults, Str());
-}
-
-bool precallWithName(LuaState* L, i32 funcIndex, i32 nArgs, i32 nResults, const Str& callTargetName) {
-    return precallImpl(L, funcIndex, nArgs, nResults, callTargetName);
+    return precallImpl(L, funcIndex, nArgs, nResults);
 }
 
 bool precallWithNameResolver(LuaState* L, i32 funcIndex, i32 nArgs, i32 nResults, CallTargetNameResolver resolver,
                              void* resolverContext) {
-    return precallImpl(L, funcIndex, nArgs, nResults, Str(), resolver, resolverContext);
+    return precallImpl(L, funcIndex, nArgs, nResults, resolver, resolverContext);
+}
+
+CallInfo& pushCFrame(LuaState* L, usize funcPos, i32 nArgs, i32 nResults) {
+    Stack& stack = L->getStack();
+    const usize argsTop = funcPos + 1 + static_cast<usize>(nArgs);
+    const usize frameTop = argsTop + static_cast<usize>(LUA_MINSTACK);
+
+    // 与 lua_checkstack 相同只预留容量：C 帧的逻辑栈顶是 absTop，pushValue / setTop 扩大物理栈顶时自行补 nil
+    if (stack.capacity() < frameTop) {
+        stack.ensureSpace(frameTop - stack.size());
+    }
+
+    CallInfo& ci = L->pushCallInfo();
+    ci.func = funcPos;
+    ci.base = funcPos + 1;
+    ci.top = frameTop;
+    ci.nresults = nResults;
+    ci.savedpc = nullptr;
+    ci.tailcalls = 0;
+    L->setAbsoluteTop(argsTop);
+    return ci;
 }
 
 namespace {
 
-bool precallImpl(LuaState* L, i32 funcIndex, i32 nArgs, i32 nResults, const Str& callTargetName,
-                 CallTargetNameResolver resolver, void* resolverContext) {
+bool precallImpl(LuaState* L, i32 funcIndex, i32 nArgs, i32 nResults, CallTargetNameResolver resolver,
+                 void* resolverContext) {
     Stack& stack = L->getStack();
     CallInfo& currentCI = L->getCurrentCallInfo();
     usize funcPos = currentCI.base + funcIndex;
@@ -182,32 +212,25 @@ bool precallImpl(LuaState* L, i32 funcIndex, i32 nArgs, i32 nResults, const Str&
     if (!funcVal.isFunction()) {
         Value tm = getMetamethodByObject(L, funcVal, TMS::TM_CALL);
         if (tm.isNil() || !tm.isFunction()) {
-            Str resolvedName = callTargetName;
-            if (resolvedName.empty() && resolver) {
-                resolvedName = resolver(resolverContext);
-            }
-            throw RuntimeError(formatCallTypeError(funcVal, resolvedName));
+            // 调用目标名只在报错时由调用方解析
+            throw RuntimeError(formatCallTypeError(funcVal, resolver != nullptr ? resolver(resolverContext) : Str()));
         }
 
-        Value originalFunc = funcVal;
         i32 actualCallArgs = nArgs;
         const bool variableArgCall = actualCallArgs < 0;
         if (variableArgCall) {
             actualCallArgs = static_cast<i32>(L->getAbsoluteTop()) - static_cast<i32>(funcPos + 1);
         }
 
-        LuaVector<Value> args(LuaStdAllocator<Value>(L->getGlobalState().getAllocator()));
-        args.reserve(static_cast<usize>(actualCallArgs));
-        for (i32 i = 1; i <= actualCallArgs; i++)
-            args.push_back(stack.at(funcPos + i));
-
-        while (stack.size() < funcPos + 2 + args.size()) {
-            stack.push(Value());
+        // 参数原地后移一格，被调对象成为第一个参数；只需一次栈空间检查，不复制到临时数组
+        const usize argsEnd = funcPos + 1 + static_cast<usize>(actualCallArgs);
+        if (stack.size() <= argsEnd) {
+            stack.setTop(argsEnd + 1);
         }
-        stack.at(funcPos) = tm;
-        stack.at(funcPos + 1) = originalFunc;
-        for (usize i = 0; i < args.size(); i++)
-            stack.at(funcPos + 2 + i) = args[i];
+        Value* slots = &stack[funcPos];
+        std::copy_backward(slots + 1, slots + 1 + actualCallArgs, slots + 2 + actualCallArgs);
+        slots[1] = funcVal;
+        slots[0] = tm;
         nArgs = actualCallArgs + 1;
         if (variableArgCall) {
             L->setAbsoluteTop(funcPos + 1 + static_cast<usize>(nArgs));
@@ -227,43 +250,23 @@ bool precallImpl(LuaState* L, i32 funcIndex, i32 nArgs, i32 nResults, const Str&
             actualNArgs = static_cast<i32>(L->getAbsoluteTop()) - static_cast<i32>(funcPos + 1);
         }
 
-        CallInfo& ci = L->pushCallInfo();
-        ci.func = funcPos;
-        ci.base = funcPos + 1;
-        ci.top = funcPos + 1 + actualNArgs + 20;
-        ci.nresults = nResults;
-        ci.savedpc = nullptr;
-        ci.tailcalls = 0;
-
-        while (stack.size() < ci.top)
-            stack.push(Value());
-        /**
-         * @brief 为更宽的 C 调用帧复用栈槽前清除非参数窗口。
-         *
-         * 调用返回后 Stack 会保留备用物理栈槽。保守垃圾回收会扫描 ci.top，因此绝不能看到
-         * 旧调用帧遗留的指针；这些指针指向的对象可能已经被回收。
-         */
-        const usize argumentTop = funcPos + 1 + static_cast<usize>(actualNArgs);
-        for (usize slot = argumentTop; slot < ci.top; ++slot) {
-            stack[slot] = Value();
-        }
-        L->setAbsoluteTop(funcPos + 1 + actualNArgs);
-
+        pushCFrame(L, funcPos, actualNArgs, nResults);
         dispatchCallHook(L);
 
-        i32 nReturnValues = func->callCFunction(L);
-
-        if (L->getStatus() == ThreadStatus::Yield) {
+        i32 nReturnValues = 0;
+        try {
+            nReturnValues = func->callCFunction(L);
+        } catch (const ContinuationUnwind&) {
+            // 经 lua_callk 调用的函数已挂起：C 帧连同续延留在调用栈上，与 C 函数直接挂起相同
             return false;
         }
 
-        dispatchReturnHook(L);
-
-        usize currentTop = L->getAbsoluteTop();
-        usize firstResult = currentTop - static_cast<usize>(nReturnValues);
-        postcall(L, static_cast<i32>(funcPos), nResults, firstResult);
+        // error() 以状态返回：与抛出异常一样不运行返回钩子，C 帧留给 pcall 收尾
+        if (L->hasRaisedError() || L->getStatus() == ThreadStatus::Yield) {
+            return false;
+        }
 
-        L->popCallInfo();
+        finishCCall(L, funcPos, nResults, nReturnValues);
         return false;
     }
 
@@ -291,15 +294,8 @@ bool precallImpl(LuaState* L, i32 funcIndex, i32 nArgs, i32 nResults, const Str&
         }
         i32 nVarargs = actualArgs - numParams;
         if ((proto->getVarargFlags() & VARARG_NEEDSARG) != 0) {
-            compatArgTable = L->getGlobalState().getGC().create<Table>();
-
-            for (i32 i = 0; i < nVarargs; i++) {
-                compatArgTable->set(Value(static_cast<LuaNumber>(i + 1)),
-                                    stack[oldBase + static_cast<usize>(numParams + i)]);
-            }
-
-            GCString* nKey = L->getGlobalState().getStringPool().intern("n");
-            compatArgTable->set(Value(nKey), Value(static_cast<LuaNumber>(nVarargs)));
+            // 代码生成器只为引用 arg 的函数设置 VARARG_NEEDSARG，其余函数由 materializeCompatArg 按需补建
+            compatArgTable = createCompatArgTable(L, oldBase + static_cast<usize>(numParams), nVarargs);
         }
         base = oldBase + static_cast<usize>(actualArgs);
         usize fixedTop = base + static_cast<usize>(numParams);
@@ -337,8 +333,8 @@ bool precallImpl(LuaState* L, i32 funcIndex, i32 nArgs, i32 nResults, const Str&
     /**
      * @brief 初始化每个非参数寄存器，即使底层 Stack 已因先前调用帧而足够大。
      *
-     * 宽范围垃圾回收根扫描会遍历整个 Lua 寄存器窗口；若保留陈旧值，其原对象被清扫后仍会
-     * 被误认为存活的垃圾回收指针。
+     * 局部变量依赖寄存器初值为 nil；debug.getlocal 也会把尚未写入的临时寄存器暴露给脚本。
+     * 栈映射之外或非安全点暂停的帧仍按整个寄存器窗口扫描，陈旧值同样不应出现在其中。
      */
     const usize firstLocal = base + static_cast<usize>(numParams);
     for (usize slot = firstLocal; slot < ci.top; ++slot) {
@@ -356,6 +352,16 @@ bool precallImpl(LuaState* L, i32 funcIndex, i32 nArgs, i32 nResults, const Str&
 
 } // namespace
 
+void finishCCall(LuaState* L, usize funcPos, i32 nResults, i32 nReturnValues) {
+    dispatchReturnHook(L);
+
+    usize currentTop = L->getAbsoluteTop();
+    usize firstResult = currentTop - static_cast<usize>(nReturnValues);
+    postcall(L, static_cast<i32>(funcPos), nResults, firstResult);
+
+    L->popCallInfo();
+}
+
 void reuseCurrentFrameForTailCall(LuaState* L, usize callerIndex, usize callerFunc, i32 callerTailcalls) {
     Stack& stack = L->getStack();
     CallInfo callee = L->getCurrentCallInfo();
@@ -394,3 +400,30 @@ void reuseCurrentFrameForTailCall(LuaState* L, usize callerIndex, usize callerFu
 }
 
 } // namespace Lua::VM::detail
+
+namespace Lua::VM {
+
+void materializeCompatArg(LuaState* L, const CallInfo& ci, usize reg) {
+    Stack& stack = L->getStack();
+    const Value& callee = stack[ci.func];
+    if (!callee.isFunction() || !callee.asFunction()->isLuaFunction()) {
+        return;
+    }
+    const Proto* proto = callee.asFunction()->getProto();
+    const u8 flags = proto->getVarargFlags();
+    if ((flags & VARARG_HASARG) == 0 || (flags & VARARG_NEEDSARG) != 0 || reg != proto->getNumParams()) {
+        return;
+    }
+    const usize slot = ci.base + reg;
+    if (slot >= stack.size() || !stack[slot].isNil()) {
+        return;
+    }
+
+    // precall 把固定参数搬到额外参数之上，额外参数仍位于 [func + 1 + numParams, base)
+    const usize firstVararg = ci.func + 1 + proto->getNumParams();
+    const i32 nVarargs = ci.base > firstVararg ? static_cast<i32>(ci.base - firstVararg) : 0;
+    Table* compatArgTable = detail::createCompatArgTable(L, firstVararg, nVarargs);
+    L->getStack()[slot] = Value(compatArgTable);
+}
+
+} // namespace Lua::VM
@@ -77,6 +77,33 @@ inline constexpr usize STACK_GROW_MARGIN = 16;
  */
 inline constexpr usize INITIAL_CI_SIZE = 8;
 
+/**
+ * @brief 协程状态的初始值栈大小
+ * 取 MIN_STACK_SIZE，即 C API 对新线程保证的空间；协程首次恢复时按需倍增。
+ */
+inline constexpr usize THREAD_INITIAL_STACK_SIZE = MIN_STACK_SIZE;
+
+/**
+ * @brief 协程状态的初始调用信息数组大小
+ * 挂起的协程至多占用 [基础帧, 入口 Lua 帧, yield C 帧] 三个调用帧，更深的调用按倍增扩展。
+ */
+inline constexpr usize THREAD_INITIAL_CI_SIZE = 4;
+
+/**
+ * @brief 每个全局状态最多缓存的已回收协程状态数
+ */
+inline constexpr usize THREAD_POOL_CAPACITY = 256;
+
+/**
+ * @brief 可进入回收池的协程值栈上限；栈曾增长得更大的状态直接释放，避免池长期占用内存
+ */
+inline constexpr usize THREAD_POOL_MAX_STACK_SIZE = 256;
+
+/**
+ * @brief 可进入回收池的协程调用信息数组上限；深递归留下的大调用栈同样直接释放
+ */
+inline constexpr usize THREAD_POOL_MAX_CI_SIZE = 64;
+
 /**
  * @brief 最大调用深度
  * 对应 Lua C: LUAI_MAXCALLS (luaconf.h)
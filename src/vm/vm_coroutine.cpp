@@ -0,0 +1,134 @@
+/**
+ * @file vm_coroutine.cpp
+ * @brief 调度循环内的协程切换
+ *
+ * Lua 代码以 CALL 调用 coroutine.resume 或 wrap 迭代器时，若 Thread::canSwitchResume 成立，
+ * 这里代替 C 函数调用：照常压入 resume 的 C 调用帧，由 Thread::beginResume 建立协程调用帧，
+ * 然后把调度循环的当前状态换成协程。协程挂起、返回或出错时，switchBack / unwindSwitch 用
+ * Thread::finishResume / failResume 向调用者发布结果，完成 resume 的 C 调用帧并换回调用者。
+ *
+ * 调用帧布局与原生恢复完全一致，因此调试回溯、垃圾回收与 lua_resume 看到的现场相同。
+ */
+
+#include "vm/vm_internal.hpp"
+
+#include "core/function.hpp"
+#include "core/thread.hpp"
+#include "vm/state/call_info.hpp"
+#include "vm/state/lua_state.hpp"
+#include "vm/state/stack.hpp"
+#include "vm/vm.hpp"
+#include "vm/vm_handlers.hpp"
+
+namespace Lua::VM::detail {
+
+namespace {
+
+/**
+ * @brief 以 resume 的 C 函数返回值完成其调用帧，并执行 CALL 对固定结果数的栈顶收尾
+ */
+void completeResumeCall(LuaState* L, bool wrapped) {
+    const CallInfo& resumeCI = L->getCurrentCallInfo();
+    const usize funcPos = resumeCI.func;
+    const i32 nResults = resumeCI.nresults;
+
+    const i32 nReturnValues = collectResumeResults(L, wrapped);
+    finishCCall(L, funcPos, nResults, nReturnValues);
+
+    if (nResults >= 0) {
+        const usize callerTop = L->getCurrentCallInfo().top;
+        L->getStack().setTop(callerTop);
+        L->setAbsoluteTop(callerTop);
+    }
+}
+
+bool isWrappedResume(LuaState* L) {
+    const CallInfo& resumeCI = L->getCurrentCallInfo();
+    return L->getStack()[resumeCI.func].asFunction()->getCFunction() == coroutineWrapResume;
+}
+
+/**
+ * @brief 换回恢复方：调度循环回到调用者的状态与调用深度
+ */
+LuaState* popSwitch(CoroutineSwitchChain& chain, Thread* thread) noexcept {
+    LuaState* caller = thread->getResumeCaller();
+    chain.state = caller;
+    chain.nexeccalls = thread->getResumeCallerNexeccalls();
+    --chain.depth;
+    return caller;
+}
+
+} // namespace
+
+Opt<HandlerStatus> switchResume(OpExecutionContext& context, i32 a, i32 nArgs, i32 nResults) {
+    const Value& callee = context.base[a];
+    if (!callee.isFunction()) {
+        return std::nullopt;
+    }
+    Function* function = callee.asFunction();
+    const CFunction entry = function->getCFunction();
+    const bool wrapped = entry == coroutineWrapResume;
+    if (!wrapped && entry != coroutineResume) {
+        return std::nullopt;
+    }
+
+    LuaState* L = context.state;
+    const usize funcPos = L->getCurrentCallInfo().base + static_cast<usize>(a);
+    const usize actualArgs =
+        nArgs >= 0 ? static_cast<usize>(nArgs) : L->getAbsoluteTop() - (funcPos + 1);
+    Thread* thread = nullptr;
+    if (wrapped) {
+        thread = wrappedCoroutine(L, function);
+    } else if (actualArgs >= 1 && context.base[a + 1].isThread()) {
+        thread = context.base[a + 1].asThread();
+    }
+    if (thread == nullptr || !thread->canSwitchResume(L)) {
+        return std::nullopt;
+    }
+
+    /** @brief 与 precall 为 C 函数建立的调用帧相同，使回溯与栈扫描看到同样的现场。 */
+    Stack& stack = L->getStack();
+    pushCFrame(L, funcPos, static_cast<i32>(actualArgs), nResults);
+
+    const i32 resumeArgs = static_cast<i32>(wrapped ? actualArgs : actualArgs - 1);
+    if (!thread->beginResume(L, resumeArgs)) {
+        // 失败标志与错误已压入调用者，按普通 C 调用返回
+        completeResumeCall(L, wrapped);
+        context.base = &stack[L->getCurrentCallInfo().base];
+        return HandlerStatus::Continue;
+    }
+
+    thread->setResumeCallerNexeccalls(context.nexeccalls);
+    context.state = thread->getLuaState();
+    context.nexeccalls = thread->getResumeNexeccalls();
+    return HandlerStatus::Switched;
+}
+
+void switchBack(CoroutineSwitchChain& chain, ExecResult result) {
+    Thread* thread = chain.state->getThread();
+    thread->finishResume(result);
+
+    LuaState* caller = popSwitch(chain, thread);
+    completeResumeCall(caller, isWrappedResume(caller));
+}
+
+void unwindSwitch(CoroutineSwitchChain& chain, std::exception_ptr error) {
+    for (;;) {
+        Thread* thread = chain.state->getThread();
+        thread->failResume(error);
+
+        LuaState* caller = popSwitch(chain, thread);
+        try {
+            completeResumeCall(caller, isWrappedResume(caller));
+            return;
+        } catch (...) {
+            // wrap 迭代器把协程错误重新抛给调用者；调用者本身也是切换进来的协程时继续向下传递
+            if (chain.depth == 0) {
+                throw;
+            }
+            error = std::current_exception();
+        }
+    }
+}
+
+} // namespace Lua::VM::detail
@@ -11,6 +11,7 @@
 #include "runtime/runtime_services.hpp"
 #include "vm/state/call_info.hpp"
 #include "vm/state/lua_state.hpp"
+#include "vm/state/stack.hpp"
 #include "vm/vm_internal.hpp"
 
 #include <cassert>
@@ -40,6 +41,49 @@ private:
     LuaState* state_;
 };
 
+/** @brief lua_callk 期间允许挂起穿越下一层宿主调用 */
+class YieldableCallGuard {
+public:
+    explicit YieldableCallGuard(LuaState* L) : state_(L), savedDepth_(L->getYieldableHostDepth()) {
+        state_->setYieldableHostDepth(state_->getHostCallDepth() + 1);
+    }
+
+    ~YieldableCallGuard() {
+        state_->setYieldableHostDepth(savedDepth_);
+    }
+
+    YieldableCallGuard(const YieldableCallGuard&) = delete;
+    YieldableCallGuard& operator=(const YieldableCallGuard&) = delete;
+
+private:
+    LuaState* state_;
+    i32 savedDepth_;
+};
+
+/**
+ * @brief 被调函数已挂起：canYield 只在每层宿主调用都登记了续延时放行，调用帧原样保留，
+ * 展开调用方 C 函数
+ */
+[[noreturn]] void unwindForYield(LuaState* L) {
+    L->setContinuationFrames(true);
+    throw detail::ContinuationUnwind{};
+}
+
+bool isLuaFrame(LuaState* L, const CallInfo& ci) {
+    const Value& function = L->getStack()[ci.func];
+    return function.isFunction() && function.asFunction()->isLuaFunction();
+}
+
+/** @brief 从当前调用帧向下连续的 Lua 帧数量 */
+i32 countLuaFrames(LuaState* L) {
+    const auto& callStack = L->getCallStack();
+    i32 count = 0;
+    for (usize index = L->getCurrentCI(); index > 0 && isLuaFrame(L, callStack[index]); --index) {
+        ++count;
+    }
+    return count;
+}
+
 } // namespace
 
 void call(LuaState* L, i32 nargs, i32 nresults) {
@@ -71,13 +115,27 @@ void call(RuntimeServices& services, LuaState* L, i32 nargs, i32 nresults) {
         i32 fpos = static_cast<i32>(newCI.func);
         i32 wantedResults = newCI.nresults;
 
-        executeProto(services, L, proto, 1);
+        const ExecResult result = executeProto(services, L, proto, 1);
+        if (result == ExecResult::Yielded) {
+            unwindForYield(L);
+        }
+        if (result == ExecResult::Raised) {
+            // 出错的调用帧留给发起这次调用的 pcall 收尾
+            return;
+        }
 
         L->popCallInfo();
         detail::postcall(L, fpos, wantedResults);
+    } else if (L->getStatus() == ThreadStatus::Yield) {
+        unwindForYield(L);
     }
 }
 
+void callk(RuntimeServices& services, LuaState* L, i32 nargs, i32 nresults) {
+    YieldableCallGuard yieldable(L);
+    call(services, L, nargs, nresults);
+}
+
 void execute(LuaState* L, Function* func) {
     if (L == nullptr) {
         throw RuntimeError("VM::execute: null state");
@@ -131,4 +189,62 @@ void execute(RuntimeServices& services, LuaState* L, Function* func) {
     L->popCallInfo();
 }
 
+namespace detail {
+
+ExecResult resumeContinuations(RuntimeServices& services, LuaState* L) {
+    for (;;) {
+        const CallInfo& ci = L->getCurrentCallInfo();
+        if (isLuaFrame(L, ci)) {
+            Proto* proto = L->getStack()[ci.func].asFunction()->getProto();
+            const i32 nexeccalls = countLuaFrames(L);
+            if (L->getCurrentCI() == static_cast<usize>(nexeccalls)) {
+                // 最外层 Lua 帧之下已没有续延，此后照常执行、挂起与切换恢复
+                L->setContinuationFrames(false);
+                return executeProto(services, L, proto, nexeccalls);
+            }
+            if (executeProto(services, L, proto, nexeccalls) == ExecResult::Yielded) {
+                return ExecResult::Yielded;
+            }
+
+            // 这一层的首个 Lua 帧已返回，像 VM::call 一样把结果交给其下的续延 C 帧
+            const CallInfo& callee = L->getCurrentCallInfo();
+            const i32 funcPos = static_cast<i32>(callee.func);
+            const i32 wantedResults = callee.nresults;
+            L->popCallInfo();
+            postcall(L, funcPos, wantedResults);
+            continue;
+        }
+
+        CallInfo& cframe = L->getCurrentCallInfo();
+        const ContinuationFunction continuation = cframe.continuation;
+        const isize context = cframe.continuationContext;
+        const usize funcPos = cframe.func;
+        const i32 nResults = cframe.nresults;
+        if (continuation == nullptr) {
+            throw RuntimeError("suspended C frame has no continuation");
+        }
+        // 续延只重入一次；续延内再次 lua_yieldk / lua_callk 时重新登记
+        cframe.continuation = nullptr;
+
+        i32 nReturnValues = 0;
+        try {
+            nReturnValues = continuation(reinterpret_cast<::lua_State*>(L), static_cast<int>(ThreadStatus::Yield), context);
+        } catch (const ContinuationUnwind&) {
+            return ExecResult::Yielded;
+        }
+        if (L->getStatus() == ThreadStatus::Yield) {
+            return ExecResult::Yielded;
+        }
+
+        finishCCall(L, funcPos, nResults, nReturnValues);
+        const CallInfo& caller = L->getCurrentCallInfo();
+        if (nResults >= 0 && isLuaFrame(L, caller)) {
+            L->getStack().setTop(caller.top);
+            L->setAbsoluteTop(caller.top);
+        }
+    }
+}
+
+} // namespace detail
+
 } // namespace Lua::VM
@@ -39,6 +39,10 @@ enum class HandlerStatus : u8 {
     Reenter,
     Yielded,
     Returned,
+    /** @brief state 与 nexeccalls 已换成被恢复的协程，调度循环在其调用帧上重入 */
+    Switched,
+    /** @brief 被调 C 函数经 LuaState::raiseError 以状态报错，调度循环原样返回 */
+    Raised,
 };
 
 using OpHandler = HandlerStatus (*)(OpExecutionContext& context, Instruction inst);
@@ -7,34 +7,10 @@
 #include "common/lua_error.hpp"
 #include "vm/vm_handlers/vm_diagnostics.hpp"
 
-#include <cctype>
-#include <cstdlib>
-#include <string>
-
 namespace Lua::VM::handlers {
 
 namespace {
 
-bool canConvertToNumber(const Value& value) {
-    if (value.isNumber()) {
-        return true;
-    }
-    if (!value.isString()) {
-        return false;
-    }
-
-    const char* text = value.asString()->c_str();
-    char* end = nullptr;
-    std::strtod(text, &end);
-    if (end == text) {
-        return false;
-    }
-    while (std::isspace(static_cast<unsigned char>(*end)) != 0) {
-        ++end;
-    }
-    return *end == '\0';
-}
-
 Str describeArithmeticOperand(OpExecutionContext& context, i32 rk, const Value& value) {
     Str sourceName;
     if (!ISK(rk)) {
@@ -50,19 +26,16 @@ HandlerStatus handleArithmetic(OpExecutionContext& context, Instruction inst) {
     i32 b = GETARG_B(inst);
     i32 c = GETARG_C(inst);
 
+    const usize frame = state->getCurrentCI();
     try {
         detail::execArithmetic(state, context.proto, context.base, a, b, c, GET_OPCODE(inst));
-    } catch (const RuntimeError& error) {
-        if (std::string(error.what()).find("attempt to perform arithmetic on non-number values") == std::string::npos) {
+    } catch (const OperandError& error) {
+        if (error.getKind() != RuntimeErrorKind::ArithmeticNonNumber || error.getFrame() != frame) {
             throw;
         }
 
-        Value left = getRK(context, b);
-        Value right = getRK(context, c);
-        if (!canConvertToNumber(left)) {
-            throw RuntimeError(describeArithmeticOperand(context, b, left));
-        }
-        throw RuntimeError(describeArithmeticOperand(context, c, right));
+        const i32 rk = error.getOperand() == 0 ? b : c;
+        throw RuntimeError(describeArithmeticOperand(context, rk, getRK(context, rk)));
     }
     return HandlerStatus::Continue;
 }
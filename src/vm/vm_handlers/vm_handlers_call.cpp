@@ -67,6 +67,10 @@ HandlerStatus handleCall(OpExecutionContext& context, Instruction inst) {
     const auto code = proto->getInstructionSpan();
     state->getCurrentCallInfo().savedpc = code.data() + context.pc;
 
+    if (const Opt<HandlerStatus> switched = detail::switchResume(context, a, nArgs, nResults)) {
+        return *switched;
+    }
+
     CallTargetDiagnosticContext diagnosticContext{proto, a, context.instructionPc};
     bool isLua = detail::precallWithNameResolver(state, a, nArgs, nResults, resolveCallTargetName, &diagnosticContext);
 
@@ -75,6 +79,10 @@ HandlerStatus handleCall(OpExecutionContext& context, Instruction inst) {
         return HandlerStatus::Reenter;
     }
 
+    if (state->hasRaisedError()) {
+        return HandlerStatus::Raised;
+    }
+
     if (state->getStatus() == ThreadStatus::Yield) {
         state->setSavedNexeccalls(context.nexeccalls);
         return HandlerStatus::Yielded;
@@ -116,6 +124,10 @@ HandlerStatus handleTailCall(OpExecutionContext& context, Instruction inst) {
         return HandlerStatus::Reenter;
     }
 
+    if (state->hasRaisedError()) {
+        return HandlerStatus::Raised;
+    }
+
     if (state->getStatus() == ThreadStatus::Yield) {
         state->setSavedNexeccalls(context.nexeccalls);
         return HandlerStatus::Yielded;
@@ -4,6 +4,7 @@
  */
 
 #include "vm/vm_handlers/vm_handler_utils.hpp"
+#include "vm/state/global_state.hpp"
 
 namespace Lua::VM::handlers {
 
@@ -18,6 +19,8 @@ HandlerStatus handleClosure(OpExecutionContext& context, Instruction inst) {
     i32 bx = GETARG_Bx(inst);
 
     detail::closure(state, context.base, proto, function, context.pc, a, bx);
+    [[maybe_unused]] const usize collected = state->getGlobalState().getGC().checkAutomatic(state);
+    context.base = refreshBase(state);
     return HandlerStatus::Continue;
 }
 
@@ -7,6 +7,8 @@
 #include "core/table.hpp"
 #include "core/upvalue.hpp"
 
+#include <cassert>
+
 namespace Lua::VM::handlers {
 
 namespace {
@@ -46,8 +48,7 @@ HandlerStatus handleSetGlobal(OpExecutionContext& context, Instruction inst) {
 
     Value val = context.base[a];
     detail::settable(state, Value(env), key, val);
-    context.base = refreshBase(state);
-    [[maybe_unused]] const usize collected = state->getGlobalState().getGC().maybeCollectAutomatic(state);
+    [[maybe_unused]] const usize collected = state->getGlobalState().getGC().checkAutomatic(state);
     context.base = refreshBase(state);
     return HandlerStatus::Continue;
 }
@@ -59,10 +60,9 @@ HandlerStatus handleGetUpval(OpExecutionContext& context, Instruction inst) {
     i32 a = GETARG_A(inst);
     i32 b = GETARG_B(inst);
 
-    Upvalue* uv = function->getUpvalue(b);
-    if (!uv) {
-        throw RuntimeError("VM: GETUPVAL invalid upvalue index");
-    }
+    // 下标由编译器或字节码校验器保证小于原型的上值数量，闭包创建时已填满对应的内联槽
+    assert(static_cast<usize>(b) < function->getUpvalueCount());
+    Upvalue* uv = function->getUpvalueUnchecked(static_cast<usize>(b));
     context.base[a] = uv->getValue(state->getStack());
     return HandlerStatus::Continue;
 }
@@ -74,10 +74,8 @@ HandlerStatus handleSetUpval(OpExecutionContext& context, Instruction inst) {
     i32 a = GETARG_A(inst);
     i32 b = GETARG_B(inst);
 
-    Upvalue* uv = function->getUpvalue(b);
-    if (!uv) {
-        throw RuntimeError("VM: SETUPVAL invalid upvalue index");
-    }
+    assert(static_cast<usize>(b) < function->getUpvalueCount());
+    Upvalue* uv = function->getUpvalueUnchecked(static_cast<usize>(b));
     uv->setValue(state->getStack(), context.base[a]);
     return HandlerStatus::Continue;
 }
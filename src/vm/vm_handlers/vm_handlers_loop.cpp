@@ -4,6 +4,7 @@
  */
 
 #include "vm/vm_handlers/vm_handler_utils.hpp"
+#include "common/number_conversion.hpp"
 #include "core/gc_string.hpp"
 #include "vm/state/call_info.hpp"
 
@@ -23,9 +24,15 @@ bool coerceNumber(Value& value) {
         return false;
     }
 
+    f64 number = 0.0;
+    if (luaTryParseDecimalNumber(value.asString()->view(), number)) {
+        value = Value(number);
+        return true;
+    }
+
     const char* text = value.asString()->c_str();
     char* end = nullptr;
-    f64 number = std::strtod(text, &end);
+    number = std::strtod(text, &end);
     if (end == text) {
         return false;
     }
@@ -9,8 +9,6 @@
 #include "vm/state/global_state.hpp"
 #include "vm/vm_handlers/vm_diagnostics.hpp"
 
-#include <string>
-
 namespace Lua::VM::handlers {
 
 namespace {
@@ -25,10 +23,11 @@ HandlerStatus handleGetTable(OpExecutionContext& context, Instruction inst) {
     Value table = context.base[b];
     Value key = getRK(context, c);
     Value result;
+    const usize frame = state->getCurrentCI();
     try {
         detail::gettable(state, table, key, result);
-    } catch (const RuntimeError& error) {
-        if (std::string(error.what()).find("attempt to index a non-table value") == std::string::npos) {
+    } catch (const OperandError& error) {
+        if (error.getKind() != RuntimeErrorKind::IndexNonTable || error.getFrame() != frame) {
             throw;
         }
         Str sourceName = diagnostics::describeRegister(context.proto, b, context.instructionPc).value_or(Str());
@@ -50,8 +49,7 @@ HandlerStatus handleSetTable(OpExecutionContext& context, Instruction inst) {
     Value key = getRK(context, b);
     Value val = getRK(context, c);
     detail::settable(state, table, key, val);
-    context.base = refreshBase(state);
-    [[maybe_unused]] const usize preCreateCollected = state->getGlobalState().getGC().maybeCollectAutomatic(state);
+    [[maybe_unused]] const usize collected = state->getGlobalState().getGC().checkAutomatic(state);
     context.base = refreshBase(state);
     return HandlerStatus::Continue;
 }
@@ -63,7 +61,7 @@ HandlerStatus handleNewTable(OpExecutionContext& context, Instruction inst) {
 
     Table* table = state->getGlobalState().getGC().create<Table>();
     context.base[a] = Value(table);
-    [[maybe_unused]] const usize postCreateCollected = state->getGlobalState().getGC().maybeCollectAutomatic(state);
+    [[maybe_unused]] const usize postCreateCollected = state->getGlobalState().getGC().checkAutomatic(state);
     context.base = refreshBase(state);
     return HandlerStatus::Continue;
 }
@@ -79,10 +77,11 @@ HandlerStatus handleSelf(OpExecutionContext& context, Instruction inst) {
     context.base[a + 1] = obj;
     Value key = getRK(context, c);
     Value result;
+    const usize frame = state->getCurrentCI();
     try {
         detail::gettable(state, obj, key, result);
-    } catch (const RuntimeError& error) {
-        if (std::string(error.what()).find("attempt to index a non-table value") == std::string::npos) {
+    } catch (const OperandError& error) {
+        if (error.getKind() != RuntimeErrorKind::IndexNonTable || error.getFrame() != frame) {
             throw;
         }
         Str sourceName = diagnostics::describeRegister(context.proto, b, context.instructionPc).value_or(Str());
@@ -7,8 +7,6 @@
 #include "common/lua_error.hpp"
 #include "vm/vm_handlers/vm_diagnostics.hpp"
 
-#include <string>
-
 namespace Lua::VM::handlers {
 
 namespace {
@@ -21,11 +19,11 @@ HandlerStatus handleUnaryMinus(OpExecutionContext& context, Instruction inst) {
 
     Value val = context.base[b];
     Value result;
+    const usize frame = state->getCurrentCI();
     try {
         detail::unaryMinus(state, result, val);
-    } catch (const RuntimeError& error) {
-        if (std::string(error.what()).find("attempt to perform arithmetic on a non-number value") ==
-            std::string::npos) {
+    } catch (const OperandError& error) {
+        if (error.getKind() != RuntimeErrorKind::ArithmeticNonNumber || error.getFrame() != frame) {
             throw;
         }
         Str sourceName = diagnostics::describeRegister(context.proto, b, context.instructionPc).value_or(Str());
@@ -20,7 +20,14 @@ namespace Lua {
 
 class LuaState;
 class Function;
+class CallInfo;
 class Proto;
+enum class ExecResult : u8;
+
+namespace VM {
+struct OpExecutionContext;
+enum class HandlerStatus : u8;
+} // namespace VM
 
 namespace VM::detail {
 
@@ -73,11 +80,14 @@ void length(LuaState* L, Value& result, const Value& val);
 void concat(RuntimeServices& services, LuaState* L, Value* base, i32 a, i32 b, i32 c);
 
 bool precall(LuaState* L, i32 funcIndex, i32 nArgs, i32 nResults);
-bool precallWithName(LuaState* L, i32 funcIndex, i32 nArgs, i32 nResults, const Str& callTargetName);
 using CallTargetNameResolver = Str (*)(void* context);
 bool precallWithNameResolver(LuaState* L, i32 funcIndex, i32 nArgs, i32 nResults, CallTargetNameResolver resolver,
                              void* resolverContext);
 void postcall(LuaState* L, i32 funcPos, i32 wantedResults, usize firstResult = 0);
+/** @brief C 函数返回后：返回钩子、按期望数量搬运结果并弹出其调用帧 */
+void finishCCall(LuaState* L, usize funcPos, i32 nResults, i32 nReturnValues);
+/** @brief 为已就位参数的 C 函数建立调用帧：预留 LUA_MINSTACK 个槽位的容量，栈顶设为参数之后 */
+CallInfo& pushCFrame(LuaState* L, usize funcPos, i32 nArgs, i32 nResults);
 void reuseCurrentFrameForTailCall(LuaState* L, usize callerIndex, usize callerFunc, i32 callerTailcalls);
 
 void setList(LuaState* L, Value* base, i32 a, i32 b, i32 c);
@@ -85,6 +95,44 @@ void closure(LuaState* L, Value* base, Proto* currentProto, Function* currentFun
 void vararg(LuaState* L, Value*& base, Proto* proto, i32 a, i32 b);
 void tforLoop(LuaState* L, Value*& base, Proto* proto, usize& pc, i32 a, i32 c);
 
+/**
+ * @brief 调度循环正在执行的状态
+ *
+ * depth 为经 switchResume 叠加在循环入口状态之上的协程层数；为 0 时挂起、返回与异常照常
+ * 离开调度循环，否则换回恢复方继续执行。
+ */
+struct CoroutineSwitchChain {
+    LuaState* state;
+    i32 nexeccalls;
+    usize depth = 0;
+};
+
+/**
+ * @brief CALL 的目标是 coroutine.resume 或 wrap 迭代器且可切换时，在当前调度循环内恢复协程
+ * @return 不适用时为空；恢复失败已按普通 C 调用返回时为 Continue；已切换时为 Switched
+ */
+Opt<HandlerStatus> switchResume(OpExecutionContext& context, i32 a, i32 nArgs, i32 nResults);
+/** @brief 切换进来的协程挂起或返回后换回恢复方 */
+void switchBack(CoroutineSwitchChain& chain, ExecResult result);
+/** @brief 切换进来的协程抛出异常后换回恢复方；wrap 迭代器的错误落到 depth 0 时重新抛出 */
+void unwindSwitch(CoroutineSwitchChain& chain, std::exception_ptr error);
+
+/**
+ * @brief 经 lua_callk 进入的被调函数挂起时，用来展开宿主 C 函数的信号
+ *
+ * VM::call 在被调函数挂起后抛出，穿过登记了续延的 C 函数，由 precall 接住并按该 C 函数
+ * 挂起处理。调用帧原样留在协程上，恢复时由 resumeContinuations 逐层完成。
+ */
+struct ContinuationUnwind {};
+
+/**
+ * @brief 挂起现场含续延 C 帧时的恢复执行
+ *
+ * 交替执行各层 Lua 帧与 C 帧的续延，直到协程再次挂起或最外层函数返回。每层 Lua 帧的
+ * 调度深度即该层连续 Lua 帧的数量。
+ */
+ExecResult resumeContinuations(RuntimeServices& services, LuaState* L);
+
 } // namespace VM::detail
 
 } // namespace Lua
@@ -10,6 +10,7 @@
 #include "common/number_conversion.hpp"
 #include "core/gc_string.hpp"
 #include "core/metatable.hpp"
+#include "core/string_pool.hpp"
 #include "core/table.hpp"
 #include "core/userdata.hpp"
 #include "vm/state/lua_state.hpp"
@@ -43,7 +44,7 @@ struct ConcatOperandText {
     StrView view;
 };
 
-bool concatOperandText(const Value& value, ConcatOperandText& text) {
+bool concatOperandText(StringPool& pool, const Value& value, ConcatOperandText& text) {
     if (value.isString()) {
         text.view = value.asString()->view();
         return true;
@@ -52,6 +53,15 @@ bool concatOperandText(const Value& value, ConcatOperandText& text) {
         return false;
     }
 
+    /**
+     * @brief 小整数操作数复用已驻留的数字文本，"id" .. i 之类的拼接不再反复格式化。
+     */
+    i64 integer = 0;
+    if (luaNumberToSmallInteger(value.asNumber(), integer)) {
+        text.view = pool.internNumber(value.asNumber())->view();
+        return true;
+    }
+
     text.view = luaNumberToView(value.asNumber(), text.numberBuffer);
     return true;
 }
@@ -121,7 +131,8 @@ void gettable(LuaState* L, Value t, const Value& key, Value& result) {
         } else {
             Value tm = getMetamethodByObject(L, t, TMS::TM_INDEX);
             if (tm.isNil()) {
-                throw RuntimeError("VM: attempt to index a non-table value");
+                throw OperandError(RuntimeErrorKind::IndexNonTable, 0, L->getCurrentCI(),
+                                   "VM: attempt to index a non-table value");
             }
             if (tm.isFunction()) {
                 callTMWithResult(L, result, tm, t, key);
@@ -156,7 +167,8 @@ void settable(LuaState* L, Value t, const Value& key, const Value& val) {
         } else {
             Value tm = getMetamethodByObject(L, t, TMS::TM_NEWINDEX);
             if (tm.isNil()) {
-                throw RuntimeError("VM: attempt to index a non-table value");
+                throw OperandError(RuntimeErrorKind::IndexNonTable, 0, L->getCurrentCI(),
+                                   "VM: attempt to index a non-table value");
             }
             if (tm.isFunction()) {
                 callTM(L, tm, t, key, val);
@@ -170,7 +182,8 @@ void settable(LuaState* L, Value t, const Value& key, const Value& val) {
 
 void arith(LuaState* L, Value& result, const Value& left, const Value& right, OpCode op) {
     f64 lval, rval;
-    if (tryToNumber(L, left, lval) && tryToNumber(L, right, rval)) {
+    const bool leftIsNumber = tryToNumber(L, left, lval);
+    if (leftIsNumber && tryToNumber(L, right, rval)) {
         f64 res = 0.0;
         switch (op) {
         case OpCode::ADD:
@@ -227,7 +240,8 @@ void arith(LuaState* L, Value& result, const Value& left, const Value& right, Op
         result = tmResult;
         return;
     }
-    throw RuntimeError("VM: attempt to perform arithmetic on non-number values");
+    throw OperandError(RuntimeErrorKind::ArithmeticNonNumber, leftIsNumber ? 1 : 0, L->getCurrentCI(),
+                       "VM: attempt to perform arithmetic on non-number values");
 }
 
 bool equal(LuaState* L, const Value& left, const Value& right) {
@@ -319,7 +333,8 @@ void unaryMinus(LuaState* L, Value& result, const Value& val) {
         result = tmResult;
         return;
     }
-    throw RuntimeError("VM: attempt to perform arithmetic on a non-number value");
+    throw OperandError(RuntimeErrorKind::ArithmeticNonNumber, 0, L->getCurrentCI(),
+                       "VM: attempt to perform arithmetic on a non-number value");
 }
 
 void length(LuaState* L, Value& result, const Value& val) {
@@ -359,7 +374,7 @@ void concat(RuntimeServices& services, LuaState* L, Value* base, i32 a, i32 b, i
 
         ConcatOperandText text1;
         ConcatOperandText text2;
-        const bool canConcat = concatOperandText(top2, text2) && concatOperandText(top1, text1);
+        const bool canConcat = concatOperandText(pool, top2, text2) && concatOperandText(pool, top1, text1);
 
         if (!canConcat) {
             Value result;
@@ -380,7 +395,7 @@ void concat(RuntimeServices& services, LuaState* L, Value* base, i32 a, i32 b, i
         std::memcpy(result.data() + text2.view.size(), text1.view.data(), text1.view.size());
         const StrView resultView = result.empty() ? StrView("") : StrView(result.data(), result.size());
         base[last - 1] = Value(pool.intern(resultView));
-        [[maybe_unused]] const usize collected = services.gc.maybeCollectAutomatic(L);
+        [[maybe_unused]] const usize collected = services.gc.checkAutomatic(L);
         total--;
         last--;
     }
@@ -44,6 +44,7 @@ int lua_public_c_header_probe(void) {
     REQUIRE_SYMBOL(lua_runtime_metrics_init);
     REQUIRE_SYMBOL(lua_runtime_begin_execution);
     REQUIRE_SYMBOL(lua_runtime_get_metrics);
+    REQUIRE_SYMBOL(lua_runtime_scheduler_run);
     REQUIRE_SYMBOL(lua_runtime_get_cancellation_handle);
     REQUIRE_SYMBOL(lua_runtime_request_cancellation);
     REQUIRE_SYMBOL(lua_runtime_release_cancellation_handle);
@@ -94,11 +95,13 @@ int lua_public_c_header_probe(void) {
     REQUIRE_SYMBOL(lua_setmetatable);
     REQUIRE_SYMBOL(lua_setfenv);
     REQUIRE_SYMBOL(lua_call);
+    REQUIRE_SYMBOL(lua_callk);
     REQUIRE_SYMBOL(lua_pcall);
     REQUIRE_SYMBOL(lua_cpcall);
     REQUIRE_SYMBOL(lua_load);
     REQUIRE_SYMBOL(lua_dump);
     REQUIRE_SYMBOL(lua_yield);
+    REQUIRE_SYMBOL(lua_yieldk);
     REQUIRE_SYMBOL(lua_resume);
     REQUIRE_SYMBOL(lua_status);
     REQUIRE_SYMBOL(lua_error);
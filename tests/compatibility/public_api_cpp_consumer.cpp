@@ -40,6 +40,7 @@ REQUIRE_SIGNATURE(lua_runtime_execution_limits_init, void (*)(lua_RuntimeExecuti
 REQUIRE_SIGNATURE(lua_runtime_metrics_init, void (*)(lua_RuntimeMetrics*) noexcept);
 REQUIRE_SIGNATURE(lua_runtime_begin_execution, int (*)(lua_State*, const lua_RuntimeExecutionLimits*) noexcept);
 REQUIRE_SIGNATURE(lua_runtime_get_metrics, int (*)(lua_State*, lua_RuntimeMetrics*) noexcept);
+REQUIRE_SIGNATURE(lua_runtime_scheduler_run, int (*)(lua_State*, uint64_t) noexcept);
 REQUIRE_SIGNATURE(lua_runtime_get_cancellation_handle, lua_CancellationHandle* (*)(lua_State*, int*) noexcept);
 REQUIRE_SIGNATURE(lua_runtime_request_cancellation, void (*)(lua_CancellationHandle*) noexcept);
 REQUIRE_SIGNATURE(lua_runtime_release_cancellation_handle, void (*)(lua_CancellationHandle*) noexcept);
@@ -96,6 +97,7 @@ REQUIRE_SIGNATURE(lua_setmetatable, int (*)(lua_State*, int) noexcept(false));
 REQUIRE_SIGNATURE(lua_getfenv, void (*)(lua_State*, int) noexcept(false));
 REQUIRE_SIGNATURE(lua_setfenv, int (*)(lua_State*, int) noexcept(false));
 REQUIRE_SIGNATURE(lua_call, void (*)(lua_State*, int, int) noexcept(false));
+REQUIRE_SIGNATURE(lua_callk, void (*)(lua_State*, int, int, lua_KContext, lua_KFunction) noexcept(false));
 REQUIRE_SIGNATURE(lua_pcall, int (*)(lua_State*, int, int, int) noexcept);
 REQUIRE_SIGNATURE(lua_cpcall, int (*)(lua_State*, lua_CFunction, void*) noexcept);
 REQUIRE_SIGNATURE(lua_error, int (*)(lua_State*) noexcept(false));
@@ -105,6 +107,7 @@ REQUIRE_SIGNATURE(lua_newthread, lua_State* (*)(lua_State*) noexcept(false));
 REQUIRE_SIGNATURE(lua_trynewthread, lua_State* (*)(lua_State*) noexcept);
 REQUIRE_SIGNATURE(lua_resume, int (*)(lua_State*, int) noexcept);
 REQUIRE_SIGNATURE(lua_yield, int (*)(lua_State*, int) noexcept(false));
+REQUIRE_SIGNATURE(lua_yieldk, int (*)(lua_State*, int, lua_KContext, lua_KFunction) noexcept(false));
 REQUIRE_SIGNATURE(lua_status, int (*)(lua_State*) noexcept(false));
 REQUIRE_SIGNATURE(lua_gc, int (*)(lua_State*, int, int) noexcept(false));
 REQUIRE_SIGNATURE(lua_load, int (*)(lua_State*, lua_Reader, void*, const char*) noexcept);
@@ -254,6 +257,11 @@ REQUIRE_PUBLIC_CONSTANT(LUA_GCCOUNTB);
 REQUIRE_PUBLIC_CONSTANT(LUA_GCSTEP);
 REQUIRE_PUBLIC_CONSTANT(LUA_GCSETPAUSE);
 REQUIRE_PUBLIC_CONSTANT(LUA_GCSETSTEPMUL);
+REQUIRE_PUBLIC_CONSTANT(LUA_GCGEN);
+REQUIRE_PUBLIC_CONSTANT(LUA_GCINC);
+REQUIRE_PUBLIC_CONSTANT(LUA_GCSTEPUS);
+REQUIRE_PUBLIC_CONSTANT(LUA_GCDEBT);
+REQUIRE_PUBLIC_CONSTANT(LUA_GCMARKSWEEP);
 REQUIRE_PUBLIC_CONSTANT(LUA_RUNTIME_OK);
 REQUIRE_PUBLIC_CONSTANT(LUA_RUNTIME_ERR_ARGUMENT);
 REQUIRE_PUBLIC_CONSTANT(LUA_RUNTIME_ERR_VERSION);
@@ -291,6 +299,8 @@ REQUIRE_PUBLIC_TYPE(lua_CFunction);
 REQUIRE_PUBLIC_TYPE(lua_Alloc);
 REQUIRE_PUBLIC_TYPE(lua_Reader);
 REQUIRE_PUBLIC_TYPE(lua_Writer);
+REQUIRE_PUBLIC_TYPE(lua_KContext);
+REQUIRE_PUBLIC_TYPE(lua_KFunction);
 REQUIRE_PUBLIC_TYPE(luaL_Reg);
 REQUIRE_PUBLIC_TYPE(luaL_Buffer);
 REQUIRE_PUBLIC_TYPE(lua_Debug);
@@ -316,7 +326,8 @@ static_assert(LUA_ERRTHREAD == 6 && LUA_ERRBUSY == 7);
 static_assert(LUA_TNONE == -1 && LUA_TNIL == 0 && LUA_TBOOLEAN == 1 && LUA_TLIGHTUSERDATA == 2 && LUA_TNUMBER == 3 &&
               LUA_TSTRING == 4 && LUA_TTABLE == 5 && LUA_TFUNCTION == 6 && LUA_TUSERDATA == 7 && LUA_TTHREAD == 8);
 static_assert(LUA_GCSTOP == 0 && LUA_GCRESTART == 1 && LUA_GCCOLLECT == 2 && LUA_GCCOUNT == 3 && LUA_GCCOUNTB == 4 &&
-              LUA_GCSTEP == 5 && LUA_GCSETPAUSE == 6 && LUA_GCSETSTEPMUL == 7);
+              LUA_GCSTEP == 5 && LUA_GCSETPAUSE == 6 && LUA_GCSETSTEPMUL == 7 && LUA_GCGEN == 10 &&
+              LUA_GCINC == 11 && LUA_GCSTEPUS == 12 && LUA_GCDEBT == 13 && LUA_GCMARKSWEEP == 14);
 static_assert(LUA_HOOKCALL == 0 && LUA_HOOKRET == 1 && LUA_HOOKLINE == 2 && LUA_HOOKCOUNT == 3 && LUA_HOOKTAILRET == 4);
 static_assert(LUA_MASKCALL == 1 && LUA_MASKRET == 2 && LUA_MASKLINE == 4 && LUA_MASKCOUNT == 8);
 static_assert(LUA_RUNTIME_API_VERSION == 1U);
@@ -454,7 +465,7 @@ int main() {
     static_assert(!noexcept(lua_call(nullptr, 0, 0)));
     static_assert(!noexcept(lua_error(nullptr)));
 
-    if (lua_public_c_header_probe() != 143) {
+    if (lua_public_c_header_probe() != 146) {
         return 1;
     }
 
@@ -785,6 +785,42 @@ int doubleApiArgument(lua_State* L) {
     return 1;
 }
 
+int continueYieldedApiValue(lua_State* L, int status, lua_KContext ctx) {
+    if (status != LUA_YIELD || lua_gettop(L) != 2 || lua_tonumber(L, 1) != 5) {
+        lua_pushstring(L, "continuation lost its frame");
+        return lua_error(L);
+    }
+    const lua_Number resumed = lua_tonumber(L, 2);
+    lua_settop(L, 1);
+    if (resumed < 100) {
+        lua_pushnumber(L, resumed * 2);
+        return lua_yieldk(L, 1, ctx, continueYieldedApiValue);
+    }
+    lua_pushnumber(L, resumed + static_cast<lua_Number>(ctx));
+    return 1;
+}
+
+int yieldDoubledWithContinuation(lua_State* L) {
+    lua_pushnumber(L, lua_tonumber(L, 1) * 2);
+    return lua_yieldk(L, 1, 7, continueYieldedApiValue);
+}
+
+int continueCalledApiValue(lua_State* L, int status, lua_KContext ctx) {
+    if (status != LUA_YIELD) {
+        lua_pushstring(L, "unexpected continuation status");
+        return lua_error(L);
+    }
+    lua_pushnumber(L, lua_tonumber(L, -1) + static_cast<lua_Number>(ctx));
+    return 1;
+}
+
+int callArgumentWithContinuation(lua_State* L) {
+    lua_pushvalue(L, 1);
+    lua_pushnumber(L, 3);
+    lua_callk(L, 1, 1, 11, continueCalledApiValue);
+    return continueCalledApiValue(L, LUA_YIELD, 11);
+}
+
 int allocateApiUserdata(lua_State* L) {
     if (gAllocatorFailureProbe != nullptr && gAllocatorFailureOffset != 0) {
         gAllocatorFailureProbe->failOnCall = gAllocatorFailureProbe->calls + gAllocatorFailureOffset;
@@ -1968,6 +2004,68 @@ void testPublicThreadYieldAndErrorApi(TestSuite& suite) {
     lua_close(L);
 }
 
+void testPublicContinuationApi(TestSuite& suite) {
+    lua_State* L = lua_open();
+    luaL_openlibs(L);
+    lua_pushcclosure(L, yieldDoubledWithContinuation, 0);
+    lua_setglobal(L, "api_yieldk");
+    lua_pushcclosure(L, callArgumentWithContinuation, 0);
+    lua_setglobal(L, "api_callk");
+
+    lua_State* yielded = lua_newthread(L);
+    pushLuaChunk(L, "return api_yieldk(5) + 1");
+    lua_xmove(L, yielded, 1);
+    ASSERT_EQ(suite, LUA_YIELD, lua_resume(yielded, 0), "lua_yieldk suspends the coroutine");
+    ASSERT_EQ(suite, 10.0, lua_tonumber(yielded, -1), "lua_yieldk publishes its yielded value");
+    lua_pop(yielded, 1);
+    lua_pushnumber(yielded, 30);
+    ASSERT_EQ(suite, LUA_YIELD, lua_resume(yielded, 1), "continuation may yield again through lua_yieldk");
+    ASSERT_EQ(suite, 60.0, lua_tonumber(yielded, -1), "re-yielding continuation publishes its value");
+    lua_pop(yielded, 1);
+    lua_pushnumber(yielded, 200);
+    ASSERT_EQ(suite, LUA_OK, lua_resume(yielded, 1), "continuation completes the suspended C function");
+    ASSERT_EQ(suite, 208.0, lua_tonumber(yielded, -1), "continuation result returns to the Lua caller");
+
+    lua_State* called = lua_newthread(L);
+    pushLuaChunk(L, "return api_callk(function(x) local y = coroutine.yield(x * 2) return y + 1 end) * 10");
+    lua_xmove(L, called, 1);
+    ASSERT_EQ(suite, LUA_YIELD, lua_resume(called, 0), "Lua callee yields across lua_callk");
+    ASSERT_EQ(suite, 6.0, lua_tonumber(called, -1), "yield inside lua_callk reaches the resumer");
+    lua_settop(called, 0);
+    lua_pushnumber(called, 20);
+    ASSERT_EQ(suite, LUA_OK, lua_resume(called, 1), "resume after lua_callk yield completes");
+    ASSERT_EQ(suite, 320.0, lua_tonumber(called, -1), "callee result flows through the continuation");
+
+    ASSERT_EQ(suite, LUA_OK,
+              luaL_dostring(L, "local f = coroutine.wrap(function()\n"
+                               "  return api_callk(function(x) return coroutine.yield(x * 2) + 1 end) * 10\n"
+                               "end)\n"
+                               "local first = f()\n"
+                               "local nested = coroutine.wrap(function()\n"
+                               "  return api_callk(function(x)\n"
+                               "    return api_callk(function(y) return coroutine.yield(y) end) + x\n"
+                               "  end)\n"
+                               "end)\n"
+                               "nested()\n"
+                               "api_result = first * 1000 + f(20)\n"
+                               "api_nested = nested(18)\n"
+                               "local co = coroutine.create(function() return pcall(coroutine.yield, 1) end)\n"
+                               "api_pcall_ok, api_pcall_message = select(2, coroutine.resume(co))"),
+              "Lua resumers drive lua_callk continuations");
+    lua_getglobal(L, "api_result");
+    ASSERT_EQ(suite, 6320.0, lua_tonumber(L, -1), "coroutine.wrap resumes through lua_callk continuations");
+    lua_getglobal(L, "api_nested");
+    ASSERT_EQ(suite, 43.0, lua_tonumber(L, -1), "nested lua_callk continuations unwind in order");
+    lua_getglobal(L, "api_pcall_ok");
+    ASSERT_TRUE(suite, lua_isboolean(L, -1) && lua_toboolean(L, -1) == 0,
+                "plain host calls still reject yields");
+    lua_getglobal(L, "api_pcall_message");
+    ASSERT_TRUE(suite, std::string(lua_tostring(L, -1)).find("cannot yield") != std::string::npos,
+                "yield across pcall reports the call boundary");
+
+    lua_close(L);
+}
+
 void testPublicThreadAllocatorLifecycle(TestSuite& suite) {
     ASSERT_TRUE(suite, lua_trynewthread(nullptr) == nullptr, "lua_trynewthread safely rejects a null parent");
 
@@ -1981,8 +2079,8 @@ void testPublicThreadAllocatorLifecycle(TestSuite& suite) {
     lua_State* co = lua_newthread(L);
     const size_t childAllocationAttempts = probe.allocationAttempts - attemptsBeforeThread;
     ASSERT_TRUE(suite, co != nullptr, "custom allocator creates child state");
-    ASSERT_TRUE(suite, ledger.blocks.size() >= blocksBeforeThread + 4,
-                "thread object, child state, stack, and CallInfo use allocator");
+    ASSERT_TRUE(suite, ledger.blocks.size() >= blocksBeforeThread + 3,
+                "child state, stack, and CallInfo use allocator; the thread object shares a slab page");
 
     void* childAllocatorData = nullptr;
     ASSERT_TRUE(suite, lua_getallocf(co, &childAllocatorData) == trackingLuaAllocator,
@@ -2156,8 +2254,8 @@ void testCustomAllocatorLifecycle(TestSuite& suite) {
     lua_newuserdata(L, 64);
     lua_newtable(L);
     lua_pushstring(L, "allocator-owned-string");
-    ASSERT_TRUE(suite, ledger.blocks.size() >= blocksBeforeObjects + 4,
-                "userdata payload and GC object blocks use allocator");
+    ASSERT_TRUE(suite, ledger.blocks.size() >= blocksBeforeObjects + 1,
+                "userdata payload uses allocator; small GC object blocks come from allocator-backed slab pages");
 
     lua_close(L);
     ASSERT_TRUE(suite, ledger.blocks.empty(), "lua_close releases state, context, fixed roots, objects, and payloads");
@@ -2189,25 +2287,19 @@ void testAllocatorBackedStringContentAndHardLimit(TestSuite& suite) {
         auto& pool = state->getGlobalState().getStringPool();
 
         const std::string boundaryText(24, 'b');
-        size_t boundaryBlocksBefore = 0;
-        for (const auto& block : ledger.blocks) {
-            if (block.second == boundaryText.size() + 1) {
-                ++boundaryBlocksBefore;
-            }
-        }
         Lua::GCString* boundaryString = pool.intern(Lua::StrView(boundaryText.data(), boundaryText.size()));
         ASSERT_TRUE(suite,
                     boundaryString != nullptr && boundaryString->getData() == boundaryText &&
                         boundaryString->c_str()[boundaryText.size()] == '\0',
                     "GCString boundary payload preserves content and terminator");
-        size_t boundaryBlocksAfter = 0;
+
+        const size_t singleBlockSize = sizeof(Lua::GCString) + text.size() + 1;
+        size_t singleBlocksBefore = 0;
         for (const auto& block : ledger.blocks) {
-            if (block.second == boundaryText.size() + 1) {
-                ++boundaryBlocksAfter;
+            if (block.second == singleBlockSize) {
+                ++singleBlocksBefore;
             }
         }
-        ASSERT_TRUE(suite, boundaryBlocksAfter > boundaryBlocksBefore,
-                    "GCString boundary payload uses one exact callback-sized block");
 
         size_t contentSizedBlocksBefore = 0;
         for (const auto& block : ledger.blocks) {
@@ -2220,17 +2312,23 @@ void testAllocatorBackedStringContentAndHardLimit(TestSuite& suite) {
         internAllocationAttempts = probe.allocationAttempts - attemptsBefore;
         ASSERT_TRUE(suite, interned != nullptr && interned->getData() == text,
                     "long interned string preserves allocator-backed contents");
-        ASSERT_TRUE(suite, internAllocationAttempts >= 3,
-                    "long string routes object, contents, and pool node through lua_Alloc");
+        ASSERT_TRUE(suite, internAllocationAttempts >= 2,
+                    "long string routes object with inline contents and pool node through lua_Alloc");
 
         size_t contentSizedBlocksAfter = 0;
+        size_t singleBlocksAfter = 0;
         for (const auto& block : ledger.blocks) {
             if (block.second >= text.size() + 1) {
                 ++contentSizedBlocksAfter;
             }
+            if (block.second == singleBlockSize) {
+                ++singleBlocksAfter;
+            }
         }
         ASSERT_TRUE(suite, contentSizedBlocksAfter > contentSizedBlocksBefore,
                     "allocator ledger observes a new long-string content block");
+        ASSERT_EQ(suite, singleBlocksBefore + 1, singleBlocksAfter,
+                  "long string header and contents share one exact callback-sized block");
 
         lua_close(L);
         ASSERT_TRUE(suite, ledger.blocks.empty() && ledger.sizeMismatches == 0 && ledger.unknownFrees == 0,
@@ -2300,8 +2398,8 @@ void testAllocatorBackedStringContentAndHardLimit(TestSuite& suite) {
         allocationFailed = true;
     }
     ASSERT_TRUE(suite, allocationFailed, "hard limit rejects long string contents");
-    ASSERT_EQ(suite, ledger.hardLimit, ledger.peakBytes,
-              "hard-limit probe admits the GCString object before rejecting its contents");
+    ASSERT_EQ(suite, liveBefore, ledger.peakBytes,
+              "hard-limit probe rejects the single string block without partial admission");
     ASSERT_TRUE(suite, ledger.peakBytes <= ledger.hardLimit, "allocator never exceeds its live-byte hard limit");
     ASSERT_EQ(suite, liveBefore, ledger.liveBytes, "hard-limit failure restores prior live bytes");
     ASSERT_EQ(suite, poolSizeBefore, pool.size(), "hard-limit failure leaves string pool unchanged");
@@ -3111,8 +3209,8 @@ void testAllocatorCanBeReplaced(TestSuite& suite) {
 
     const size_t secondAllocationsBefore = second.allocations;
     lua_newuserdata(L, 32);
-    ASSERT_TRUE(suite, second.allocations >= secondAllocationsBefore + 2,
-                "future object and payload allocations use replacement allocator");
+    ASSERT_TRUE(suite, second.allocations >= secondAllocationsBefore + 1,
+                "future payload allocations use replacement allocator");
 
     lua_close(L);
     ASSERT_TRUE(suite, second.frees > 0, "existing runtime blocks are released through current allocator");
@@ -3140,6 +3238,9 @@ void testAllocatorFailurePaths(TestSuite& suite) {
     lua_State* L = lua_newstate(trackingLuaAllocator, &probe);
     ASSERT_TRUE(suite, L != nullptr, "runtime allocation failure test creates state");
 
+    // The offsets below address the userdata header and payload calls
+    // individually, so object headers bypass the shared slab pages.
+    reinterpret_cast<Lua::LuaState*>(L)->getGlobalState().getGC().setSlabAllocationEnabled(false);
     lua_pushcclosure(L, allocateApiUserdata, 0);
     probe.failOnCall = probe.calls + 1;
     ASSERT_EQ(suite, LUA_ERRMEM, lua_pcall(L, 0, 1, 0), "pcall protection setup failure becomes LUA_ERRMEM");
@@ -4297,7 +4398,7 @@ void testLoadBufferAllocatorFailures(TestSuite& suite) {
               "baseline loadbuffer succeeds");
     const size_t loadAllocationAttempts = baselineProbe.allocationAttempts - attemptsBeforeLoad;
     ASSERT_TRUE(suite, loadAllocationAttempts > 0, "loadbuffer baseline observes allocator traffic");
-    ASSERT_TRUE(suite, parserNameObservation.attempts >= 8,
+    ASSERT_TRUE(suite, parserNameObservation.attempts >= 7,
                 "loadbuffer baseline routes parser scope names through lua_Alloc (" +
                     std::to_string(parserNameObservation.attempts) + " exact-size allocations)");
     ASSERT_TRUE(suite, expressionObservation.attempts >= 21 && statementObservation.attempts >= 9,
@@ -4755,10 +4856,32 @@ void testPublicTypeThreadAndGcApi(TestSuite& suite) {
     ASSERT_TRUE(suite, !gc.isAutomaticStopped(), "lua_gc restart enables automatic collection");
     const int stepResult = lua_gc(L, LUA_GCSTEP, 1);
     ASSERT_TRUE(suite, stepResult == 0 || stepResult == 1, "lua_gc step reports an incomplete or completed cycle");
+    ASSERT_EQ(suite, 0, lua_gc(L, LUA_GCSTEPUS, 0), "lua_gc stepus with no time does no work");
+    int timedSteps = 0;
+    while (lua_gc(L, LUA_GCSTEPUS, 50) == 0 && timedSteps < 100000) {
+        ++timedSteps;
+    }
+    ASSERT_TRUE(suite, timedSteps < 100000, "lua_gc stepus finishes a cycle within repeated time slices");
+    ASSERT_EQ(suite, 0, lua_gc(L, LUA_GCDEBT, 0), "lua_gc debt is zero right after a completed cycle");
     ASSERT_EQ(suite, 0, lua_gc(L, LUA_GCCOLLECT, 0), "lua_gc full collection reports success");
     ASSERT_TRUE(suite, !gc.isAutomaticStopped(), "lua_gc full collection leaves automatic collection running");
     ASSERT_EQ(suite, -1, lua_gc(L, 999, 0), "lua_gc rejects unknown operations");
 
+    const std::string initialStrategy = gc.getStrategyName();
+    ASSERT_TRUE(suite, gc.useStrategy("mark-sweep"), "collector accepts the mark-sweep strategy");
+    ASSERT_EQ(suite, static_cast<int>(LUA_GCMARKSWEEP), lua_gc(L, LUA_GCGEN, 0),
+              "lua_gc reports mark-sweep as the previous mode");
+    ASSERT_EQ(suite, static_cast<int>(LUA_GCGEN), lua_gc(L, LUA_GCINC, 0), "lua_gc reports the generational mode");
+    ASSERT_EQ(suite, std::string("mark-sweep"), std::string(gc.getStrategyName()),
+              "leaving generational mode restores mark-sweep");
+    ASSERT_EQ(suite, static_cast<int>(LUA_GCMARKSWEEP), lua_gc(L, LUA_GCINC, 0),
+              "lua_gc incremental switches away from mark-sweep");
+    ASSERT_EQ(suite, static_cast<int>(LUA_GCINC), lua_gc(L, LUA_GCGEN, 0), "lua_gc reports the incremental mode");
+    (void)lua_gc(L, LUA_GCINC, 0);
+    ASSERT_EQ(suite, std::string("incremental"), std::string(gc.getStrategyName()),
+              "leaving generational mode restores incremental");
+    (void)gc.useStrategy(initialStrategy);
+
     (void)lua_gc(L, LUA_GCSETPAUSE, 200);
     (void)lua_gc(L, LUA_GCSETSTEPMUL, 200);
     lua_close(L);
@@ -5419,6 +5542,7 @@ void registerLuaCApiTests() {
     registry.registerTest(kSuiteName, "public thread resume API", testPublicThreadResumeApi);
     registry.registerTest(kSuiteName, "public thread C function entry", testPublicThreadCFunctionEntry);
     registry.registerTest(kSuiteName, "public thread yield and error API", testPublicThreadYieldAndErrorApi);
+    registry.registerTest(kSuiteName, "public continuation API", testPublicContinuationApi);
     registry.registerTest(kSuiteName, "public thread allocator lifecycle", testPublicThreadAllocatorLifecycle);
     registry.registerTest(kSuiteName, "public resume allocation rollback", testPublicResumeAllocationRollback);
     registry.registerTest(kSuiteName, "Lua-level coroutine persistent allocation rollback",
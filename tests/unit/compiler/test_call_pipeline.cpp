@@ -187,6 +187,38 @@ void testCompatArgTableForOldStyleVararg(TestSuite& suite) {
     delete L;
 }
 
+void testCompatArgTableOnlyWhenReferenced(TestSuite& suite) {
+    LuaState* L = createFullState();
+    bool ok = runLua(L, R"lua(
+        _G.arg = nil
+
+        local function ignoresArg(a, ...)
+            local name, value = debug.getlocal(1, 2)
+            local _, again = debug.getlocal(1, 2)
+            return a, name, value, again
+        end
+        local a, name, value, again = ignoresArg(1, "x", nil, "z")
+        assert(a == 1 and name == "arg", "unreferenced arg keeps its local")
+        assert(value.n == 3 and value[1] == "x" and value[2] == nil and value[3] == "z",
+               "debug.getlocal materializes the table on first access")
+        assert(again == value, "later reads see the same table")
+
+        local function captures(...)
+            return function() return arg.n, arg[2] end
+        end
+        local n, v = captures("x", "y")()
+        assert(n == 2 and v == "y", "closure captures the compatibility table")
+
+        local function assigns(...)
+            arg = "replaced"
+            return arg
+        end
+        assert(assigns(1) == "replaced" and _G.arg == nil, "assignment targets the local arg")
+    )lua");
+    ASSERT_TRUE(suite, ok, "compat arg table is created only for functions that reference arg");
+    delete L;
+}
+
 // -- g(f()) last-arg multret --
 void testCallLastArgMultret(TestSuite& suite) {
     LuaState* L = createFullState();
@@ -659,6 +691,7 @@ void registerCallPipelineTests() {
     registry.registerTest(kSuiteName, "return list keeps values before calls", testReturnListKeepsValuesBeforeCalls);
     registry.registerTest(kSuiteName, "return ... multret", testReturnVarargMultret);
     registry.registerTest(kSuiteName, "compat arg table for old-style vararg", testCompatArgTableForOldStyleVararg);
+    registry.registerTest(kSuiteName, "compat arg table only when referenced", testCompatArgTableOnlyWhenReferenced);
     registry.registerTest(kSuiteName, "g(f()) last-arg multret", testCallLastArgMultret);
     registry.registerTest(kSuiteName, "g(fixed, f()) leading + multret", testCallLeadingFixedPlusMultret);
     registry.registerTest(kSuiteName, "g(f(), x) non-last collapse", testCallNonLastArgCollapsed);
@@ -138,6 +138,47 @@ void testFunctionUpvalues(TestSuite& suite) {
     delete proto;
 }
 
+void testFunctionInlineUpvalues(TestSuite& suite) {
+    LuaState* L = LuaState::newState();
+    {
+        ScopedGCRoots roots(L);
+        Proto* proto = roots.create<Proto>();
+        proto->setNumUpvalues(2);
+
+        // Test 1: 收集器创建的 Lua 闭包按原型上值数量尾随预留槽位
+        Function* func = roots.create<Function>(proto);
+        ASSERT_EQ(suite, (usize)2, func->getInlineUpvalueCapacity(), "Lua closure reserves proto upvalue slots");
+        ASSERT_EQ(suite, (usize)0, func->getUpvalueCount(), "Inline slots start empty");
+
+        Upvalue* uv1 = roots.create<Upvalue>(Value(1.0));
+        Upvalue* uv2 = roots.create<Upvalue>(Value(2.0));
+        func->addUpvalue(uv1);
+        func->addUpvalue(uv2);
+        ASSERT_TRUE(suite, func->getUpvalueUnchecked(1) == uv2, "Inline upvalue access");
+        ASSERT_EQ(suite, sizeof(Function) + 2 * sizeof(Upvalue*), func->getSize(), "Filled inline slots keep size");
+
+        // Test 2: 超出预留数量时溢出到单独堆块，已有上值保持不变
+        Upvalue* uv3 = roots.create<Upvalue>(Value(3.0));
+        func->addUpvalue(uv3);
+        ASSERT_EQ(suite, (usize)3, func->getUpvalueCount(), "Spilled upvalue count");
+        ASSERT_TRUE(suite, func->getUpvalue(0) == uv1 && func->getUpvalue(2) == uv3, "Spilled upvalues preserved");
+        ASSERT_EQ(suite, (usize)2, func->getInlineUpvalueCapacity(), "Spill keeps inline slots");
+        ASSERT_TRUE(suite, func->getSize() > sizeof(Function) + 2 * sizeof(Upvalue*), "Spill block is accounted");
+        ASSERT_TRUE(suite, func->getUpvalue(3) == nullptr, "Out of range upvalue");
+
+        // Test 3: C 闭包按创建时给出的数量预留槽位
+        auto testCFunc = [](LuaState*) -> i32 { return 0; };
+        Function* cfunc = roots.create<Function>(static_cast<CFunction>(testCFunc), 1);
+        cfunc->addUpvalue(uv1);
+        ASSERT_EQ(suite, (usize)1, cfunc->getInlineUpvalueCapacity(), "C closure reserves requested upvalue slots");
+        ASSERT_TRUE(suite, cfunc->getUpvalue(0) == uv1, "C closure upvalue");
+
+        (void)L->getGlobalState().getGC().collect(L);
+        ASSERT_TRUE(suite, func->getUpvalue(2) == uv3, "Upvalues survive collection");
+    }
+    delete L;
+}
+
 void testFunctionEnvironment(TestSuite& suite) {
     Proto* proto = new Proto();
     Function* func = new Function(proto);
@@ -163,6 +204,7 @@ void registerFunctionTests() {
     registry.registerTest("Function", "Proto Instructions", testProtoInstructions);
     registry.registerTest("Function", "Lua Function", testLuaFunction);
     registry.registerTest("Function", "Upvalues", testFunctionUpvalues);
+    registry.registerTest("Function", "Inline Upvalues", testFunctionInlineUpvalues);
     registry.registerTest("Function", "Environment", testFunctionEnvironment);
 }
 
@@ -9,6 +9,9 @@
 #include "../framework/test_framework.hpp"
 #include "core/gc_string.hpp"
 #include "core/string_pool.hpp"
+#include "core/table.hpp"
+
+#include <string>
 
 using namespace Lua;
 using namespace LuaTest;
@@ -57,6 +60,50 @@ void testGCStringHash(TestSuite& suite) {
     delete str1;
 }
 
+void testSeededHash(TestSuite& suite) {
+    StringPool& pool = StringPool::getInstance();
+    GCString* pooled = pool.intern("seeded-hash-key");
+    ASSERT_EQ(suite, GCString::computeHash("seeded-hash-key", pool.getHashSeed()), pooled->getHash(),
+              "Pooled string hash uses the pool seed");
+
+    StringPool first;
+    StringPool second;
+    ASSERT_TRUE(suite, first.getHashSeed() != second.getHashSeed(), "Independent pools draw distinct seeds");
+    ASSERT_TRUE(suite,
+                GCString::computeHash("collision-probe", first.getHashSeed()) !=
+                    GCString::computeHash("collision-probe", second.getHashSeed()),
+                "Seed changes the string hash");
+
+    // 长字符串只采样固定块，但首尾字节与长度总会参与哈希
+    std::string longText(1 << 20, 'x');
+    const usize longHash = GCString::computeHash(longText);
+    ASSERT_EQ(suite, longHash, GCString::computeHash(std::string(longText)), "Sampled hash is deterministic");
+    longText.back() = 'y';
+    ASSERT_TRUE(suite, GCString::computeHash(longText) != longHash, "Tail byte participates in sampled hash");
+    longText.back() = 'x';
+    longText.front() = 'y';
+    ASSERT_TRUE(suite, GCString::computeHash(longText) != longHash, "Head byte participates in sampled hash");
+    longText.push_back('x');
+    ASSERT_TRUE(suite, GCString::computeHash(longText) != longHash, "Length participates in sampled hash");
+
+    // 带种子的哈希读取全部字节，只在中段某一字节不同的长字符串不会对所有种子碰撞
+    std::string middleA(4096, 'm');
+    std::string middleB = middleA;
+    middleB[middleB.size() / 2 + 3] = 'n';
+    ASSERT_TRUE(suite,
+                GCString::computeHash(middleA, pool.getHashSeed()) != GCString::computeHash(middleB, pool.getHashSeed()),
+                "Middle byte participates in seeded long-string hash");
+    GCString* internedA = pool.intern(middleA);
+    GCString* internedB = pool.intern(middleB);
+    ASSERT_TRUE(suite, internedA->getHash() != internedB->getHash(), "Interned long strings differing mid-way do not collide");
+    pool.remove(internedB);
+    pool.remove(internedA);
+
+    ASSERT_EQ(suite, ValueHash{}(Value(0.0)), ValueHash{}(Value(-0.0)), "Positive and negative zero share a hash");
+
+    pool.remove(pooled);
+}
+
 void testStringPoolIntern(TestSuite& suite) {
     StringPool& pool = StringPool::getInstance();
 
@@ -142,6 +189,7 @@ void registerGCStringTests() {
     
     registry.registerTest("GCString", "Creation", testGCStringCreation);
     registry.registerTest("GCString", "Hash", testGCStringHash);
+    registry.registerTest("GCString", "Seeded Hash", testSeededHash);
     registry.registerTest("StringPool", "Intern", testStringPoolIntern);
     registry.registerTest("StringPool", "StringView", testStringPoolStringView);
     registry.registerTest("StringPool", "Remove", testStringPoolRemove);
@@ -22,62 +22,35 @@
 #include "gc/garbage_collector.hpp"
 #include "gc/gc_strategy.hpp"
 #include "lib/baselib.hpp"
+#include "lib/coroutinelib.hpp"
 #include "runtime/runtime_services.hpp"
 #include "vm/state/lua_state.hpp"
 #include "vm/state/stack.hpp"
 
 #include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
 #include <cstring>
+#include <limits>
 #include <memory>
 #include <new>
+#include <sstream>
 #include <type_traits>
 #include <stdexcept>
+#include <string>
 #include <utility>
+#include <vector>
 
 using namespace Lua;
 using namespace LuaTest;
 
-// Test GCObject implementation
-class TestGCObject : public GCObject {
-public:
-    TestGCObject() : GCObject(GCObjectType::String) {}
-    void mark(GarbageCollector& /*gc*/) override {}
-    usize getSize() const override {
-        return sizeof(TestGCObject);
-    }
-};
-
+// Construction fails before registration, so the header is never dispatched by type.
 class ThrowingGCObject : public GCObject {
 public:
     ThrowingGCObject() : GCObject(GCObjectType::String) {
         throw std::runtime_error("factory construction failure");
     }
-
-    void mark(GarbageCollector& /*gc*/) override {}
-    usize getSize() const override {
-        return sizeof(ThrowingGCObject);
-    }
-};
-
-class ThrowingMarkGCObject : public GCObject {
-public:
-    explicit ThrowingMarkGCObject(i32& destructorCalls)
-        : GCObject(GCObjectType::String), destructorCalls_(destructorCalls) {}
-
-    ~ThrowingMarkGCObject() override {
-        ++destructorCalls_;
-    }
-
-    void mark(GarbageCollector& /*gc*/) override {
-        throw std::runtime_error("registration mark failure");
-    }
-
-    usize getSize() const override {
-        return sizeof(ThrowingMarkGCObject);
-    }
-
-private:
-    i32& destructorCalls_;
 };
 
 struct GCAllocatorProbe {
@@ -185,7 +158,7 @@ static GarbageCollector& legacyGarbageCollectorForTest() {
 }
 
 void testGCObjectBasics(TestSuite& suite) {
-    TestGCObject* obj = new TestGCObject();
+    GCString* obj = new GCString("basics");
 
     // Test 1: GCObject creation
     ASSERT_TRUE(suite, obj != nullptr, "GCObject creation");
@@ -208,12 +181,20 @@ void testGCObjectBasics(TestSuite& suite) {
     // Test 6: isMarked (black is marked)
     ASSERT_TRUE(suite, obj->isMarked(), "isMarked (black)");
 
+    // Test 7: header carries no vtable and dispatches by type tag
+    static_assert(!std::is_polymorphic_v<GCObject>, "GCObject header has no vtable");
+    if constexpr (sizeof(void*) == 8) {
+        ASSERT_EQ(suite, static_cast<usize>(40), sizeof(GCObject), "64-bit GCObject header is 40 bytes");
+    }
+    GCObject* header = obj;
+    ASSERT_EQ(suite, sizeof(GCString) + 7, header->getSize(), "getSize dispatches to the concrete type");
+
     delete obj;
 }
 
 void testGCObjectChaining(TestSuite& suite) {
-    TestGCObject* obj1 = new TestGCObject();
-    TestGCObject* obj2 = new TestGCObject();
+    GCString* obj1 = new GCString("first");
+    GCString* obj2 = new GCString("second");
 
     // Test 1: Chain objects
     obj1->setNext(obj2);
@@ -341,27 +322,40 @@ void testAllocatorFactoryCleansUpRegistrationFailure(TestSuite& suite) {
     GCAllocatorProbe probe;
     LuaAllocator allocator(gcTrackingAllocator, &probe);
     GarbageCollector gc(&allocator);
+    // Route each object block through the allocator so the rollback is
+    // observable as a matching deallocation rather than a slab free-list push.
+    gc.setSlabAllocationEnabled(false);
     (void)gc.createRoot<Table>();
 
     // Registration scans constructor-owned edges during an active cycle.
-    // Inject a non-allocation mark failure after placement construction so
-    // the allocator-backed factory must roll back every ownership layer.
+    // Fail each allocator request of a root factory in turn: the object
+    // block, then root-list growth after the object is already registered.
+    // Every failure must roll back every ownership layer.
     (void)gc.step(nullptr, 0);
-    const usize objectCountBefore = gc.getObjectCount();
-    const usize liveAllocationsBefore = probe.allocations - probe.deallocations;
-    i32 destructorCalls = 0;
-    bool threw = false;
-    try {
-        [[maybe_unused]] ThrowingMarkGCObject* ignored = gc.create<ThrowingMarkGCObject>(destructorCalls);
-    } catch (const std::runtime_error&) {
-        threw = true;
+    usize rollbacks = 0;
+    bool restored = true;
+    bool created = false;
+    for (usize failAt = 1; !created && failAt <= 16; ++failAt) {
+        const usize objectCountBefore = gc.getObjectCount();
+        const usize rootCountBefore = gc.getRootCount();
+        const usize liveAllocationsBefore = probe.allocations - probe.deallocations;
+        probe.failOnAllocation = probe.allocationAttempts + failAt;
+        try {
+            (void)gc.createRoot<Table>();
+            created = true;
+        } catch (const std::bad_alloc&) {
+            ++rollbacks;
+            restored = restored && objectCountBefore == gc.getObjectCount() &&
+                       rootCountBefore == gc.getRootCount() &&
+                       liveAllocationsBefore == probe.allocations - probe.deallocations;
+        }
     }
+    probe.failOnAllocation = 0;
 
-    ASSERT_TRUE(suite, threw, "allocator-backed create<T> propagates registration mark failures");
-    ASSERT_EQ(suite, 1, destructorCalls, "registration failure destroys the placement-constructed object");
-    ASSERT_EQ(suite, objectCountBefore, gc.getObjectCount(), "registration failure restores the collector object list");
-    ASSERT_EQ(suite, liveAllocationsBefore, probe.allocations - probe.deallocations,
-              "registration failure returns the object block to the configured allocator");
+    ASSERT_TRUE(suite, created, "allocator-backed createRoot<T> succeeds once requests stop failing");
+    ASSERT_TRUE(suite, rollbacks >= 2, "object block and registration-time root growth failures both propagate");
+    ASSERT_TRUE(suite, restored,
+                "registration failure restores the object list, root set, and configured allocator blocks");
 }
 
 void testAllocatorBackedRootAndExternalMarkQueuesRollback(TestSuite& suite) {
@@ -443,6 +437,202 @@ void testAllocatorBackedRootAndExternalMarkQueuesRollback(TestSuite& suite) {
               "root and external-mark queue storage returns to the configured allocator");
 }
 
+void testStringSingleAllocationAndSlab(TestSuite& suite) {
+    GCAllocatorProbe probe;
+    LuaAllocator allocator(gcTrackingAllocator, &probe);
+    {
+        GarbageCollector survivor(&allocator);
+        GCString* migrated = nullptr;
+        {
+            GarbageCollector collector(&allocator);
+
+            const Str longText(200, 'x');
+            const usize beforeLong = probe.allocations;
+            GCString* longString = collector.create<GCString>(StrView(longText));
+            ASSERT_EQ(suite, beforeLong + 1, probe.allocations, "long strings store header and bytes in one block");
+            ASSERT_TRUE(suite, longString->view() == longText, "long string bytes follow the header");
+            ASSERT_EQ(suite, sizeof(GCString) + longText.size() + 1, longString->getSize(),
+                      "string size counts header and trailing bytes exactly");
+
+            std::vector<GCString*> shortStrings;
+            const usize beforeShort = probe.allocations;
+            for (i32 i = 0; i < 32; ++i) {
+                shortStrings.push_back(collector.create<GCString>(StrView(std::to_string(i))));
+            }
+            // 块池自身、一页与页目录
+            ASSERT_TRUE(suite, probe.allocations - beforeShort <= 3, "short strings are packed into shared slab pages");
+            bool contentsMatch = true;
+            for (i32 i = 0; i < 32; ++i) {
+                contentsMatch = contentsMatch && shortStrings[static_cast<usize>(i)]->view() == std::to_string(i);
+            }
+            ASSERT_TRUE(suite, contentsMatch, "slab strings keep their own bytes");
+
+            migrated = shortStrings.front();
+            survivor.registerObject(migrated);
+        }
+        ASSERT_TRUE(suite, migrated->view() == "0", "migrated slab string outlives its original collector");
+    }
+    ASSERT_EQ(suite, probe.allocations, probe.deallocations, "slab pages are released after the last block");
+}
+
+struct ConcurrentAllocatorProbe {
+    std::atomic<usize> allocations{0};
+    std::atomic<usize> deallocations{0};
+};
+
+// Background freeing calls the allocator from a helper thread, so this probe counts atomically.
+static void* concurrentTrackingAllocator(void* userData, void* pointer, std::size_t, std::size_t newSize) {
+    auto* probe = static_cast<ConcurrentAllocatorProbe*>(userData);
+    if (newSize == 0) {
+        if (pointer != nullptr) {
+            probe->deallocations.fetch_add(1, std::memory_order_relaxed);
+            std::free(pointer);
+        }
+        return nullptr;
+    }
+    void* result = std::realloc(pointer, newSize);
+    if (result != nullptr && pointer == nullptr) {
+        probe->allocations.fetch_add(1, std::memory_order_relaxed);
+    }
+    return result;
+}
+
+void testBackgroundFreeReleasesSweptBlocks(TestSuite& suite) {
+    ConcurrentAllocatorProbe probe;
+    LuaAllocator allocator(concurrentTrackingAllocator, &probe);
+    {
+        GarbageCollector gc(&allocator);
+        gc.setStringPool(&StringPool::getInstance());
+        gc.setSlabAllocationEnabled(false);
+        ASSERT_TRUE(suite, !gc.isBackgroundFreeEnabled(), "background freeing is off by default");
+        gc.setBackgroundFreeEnabled(true);
+        ASSERT_TRUE(suite, gc.isBackgroundFreeEnabled(), "background freeing can be enabled");
+
+        for (i32 i = 0; i < 32; ++i) {
+            Table* table = gc.create<Table>();
+            for (i32 slot = 1; slot <= 8; ++slot) {
+                table->setArray(slot, Value(static_cast<LuaNumber>(slot)));
+            }
+        }
+        const usize accountedBefore = gc.getAccountedMemory();
+        ASSERT_EQ(suite, static_cast<usize>(32), gc.collect(), "unreachable tables are swept");
+        ASSERT_TRUE(suite, gc.getAccountedMemory() < accountedBefore,
+                    "managed bytes drop when objects are unlinked, before the helper frees them");
+
+        ASSERT_TRUE(suite, gc.getBackgroundFreedBlocks() >= 64,
+                    "an explicit collect returns after the helper frees object blocks and array payloads");
+
+        gc.setBackgroundFreeEnabled(false);
+        ASSERT_TRUE(suite, !gc.isBackgroundFreeEnabled(), "disabling drains and stops the helper");
+        (void)gc.create<Table>();
+        ASSERT_EQ(suite, static_cast<usize>(1), gc.collect(), "sweeping frees inline again once disabled");
+    }
+    ASSERT_EQ(suite, probe.allocations.load(), probe.deallocations.load(),
+              "every block reaches the allocator once the collector is gone");
+}
+
+void testSlabAllocatesSmallObjectsInPages(TestSuite& suite) {
+    GCAllocatorProbe probe;
+    LuaAllocator allocator(gcTrackingAllocator, &probe);
+    {
+        GarbageCollector gc(&allocator);
+        gc.setStringPool(&StringPool::getInstance());
+        ASSERT_TRUE(suite, gc.isSlabAllocationEnabled(), "slab allocation is enabled by default");
+
+        const usize beforeTables = probe.allocations;
+        for (i32 i = 0; i < 64; ++i) {
+            (void)gc.create<Table>();
+        }
+        const usize pages = gc.getSlabReservedBytes() / GCSlabAllocator::kPageBytes;
+        ASSERT_EQ(suite, pages * GCSlabAllocator::kPageBytes, gc.getSlabReservedBytes(),
+                  "slab quota is reported at page granularity");
+        ASSERT_TRUE(suite, pages > 0 && pages <= 4, "tables share a few size-class pages");
+        // 另加块池自身与一次页目录请求
+        ASSERT_TRUE(suite, probe.allocations - beforeTables <= pages + 2,
+                    "table objects cost the allocator one request per page, not per object");
+
+        const usize freedBeforeSweep = probe.deallocations;
+        (void)gc.collect();
+        ASSERT_EQ(suite, static_cast<usize>(0), gc.getObjectCount(), "unreachable tables are swept");
+        ASSERT_EQ(suite, static_cast<usize>(0), gc.getSlabReservedBytes(), "empty pages are released after a sweep");
+        ASSERT_TRUE(suite, probe.deallocations - freedBeforeSweep >= pages, "released pages return to the allocator");
+
+        std::vector<Table*> kept;
+        for (i32 i = 0; i < 64; ++i) {
+            Table* table = gc.create<Table>();
+            if (i % 2 == 0) {
+                gc.addRoot(table);
+                kept.push_back(table);
+            }
+        }
+        const usize reserved = gc.getSlabReservedBytes();
+        (void)gc.collect();
+        ASSERT_EQ(suite, kept.size(), gc.getObjectCount(), "only rooted tables survive");
+        ASSERT_EQ(suite, reserved, gc.getSlabReservedBytes(), "pages with live blocks are kept");
+        const usize afterSweep = probe.allocations;
+        for (i32 i = 0; i < 32; ++i) {
+            (void)gc.create<Table>();
+        }
+        ASSERT_EQ(suite, afterSweep, probe.allocations, "swept blocks are reused from the page free lists");
+
+        for (Table* table : kept) {
+            gc.removeRoot(table);
+        }
+        (void)gc.collect();
+        ASSERT_EQ(suite, static_cast<usize>(0), gc.getSlabReservedBytes(), "pages are released once their last block dies");
+
+        ASSERT_TRUE(suite, gc.useStrategy("generational"), "collector enters generational mode");
+        Table* anchor = gc.create<Table>();
+        gc.addRoot(anchor);
+        ASSERT_TRUE(suite, gc.step(nullptr, 0), "first generational step runs a major collection");
+        const usize anchorReserved = gc.getSlabReservedBytes();
+        for (i32 i = 0; i < 256; ++i) {
+            (void)gc.create<Table>();
+        }
+        ASSERT_TRUE(suite, gc.getSlabReservedBytes() > anchorReserved, "young tables take new pages");
+        ASSERT_TRUE(suite, gc.step(nullptr, 0), "second generational step completes");
+        ASSERT_EQ(suite, static_cast<usize>(1), gc.getMinorCollectionCount(), "young garbage is swept by a minor collection");
+        ASSERT_EQ(suite, anchorReserved, gc.getSlabReservedBytes(), "minor collections release pages emptied of young garbage");
+        gc.removeRoot(anchor);
+        ASSERT_TRUE(suite, gc.useStrategy("incremental"), "collector leaves generational mode");
+        (void)gc.collect();
+
+        gc.setSlabAllocationEnabled(false);
+        const usize beforeDirect = probe.allocations;
+        (void)gc.create<Table>();
+        ASSERT_EQ(suite, beforeDirect + 1, probe.allocations, "disabling the slab allocates objects individually");
+    }
+    ASSERT_EQ(suite, probe.allocations, probe.deallocations, "slab pages and direct blocks are all released");
+}
+
+void testClosureUpvalueSpillUsesAllocator(TestSuite& suite) {
+    GCAllocatorProbe probe;
+    LuaAllocator allocator(gcTrackingAllocator, &probe);
+    {
+        GarbageCollector gc(&allocator);
+        gc.setStringPool(&StringPool::getInstance());
+
+        Function* closure = gc.create<Function>(gcRecordingFinalizer);
+        gc.addRoot(closure);
+        std::vector<Upvalue*> upvalues;
+        for (i32 i = 0; i < 5; ++i) {
+            upvalues.push_back(gc.create<Upvalue>(Value(static_cast<LuaNumber>(i))));
+        }
+
+        const usize allocationsBefore = probe.allocations;
+        const usize deallocationsBefore = probe.deallocations;
+        for (Upvalue* upvalue : upvalues) {
+            closure->addUpvalue(upvalue);
+        }
+        ASSERT_EQ(suite, allocationsBefore + 2, probe.allocations,
+                  "the spill array and its regrowth come from the collector's allocator");
+        ASSERT_EQ(suite, deallocationsBefore + 1, probe.deallocations,
+                  "the outgrown spill array returns to the collector's allocator");
+        ASSERT_TRUE(suite, closure->getUpvalue(4) == upvalues.back(), "spilled upvalues keep their order");
+    }
+    ASSERT_EQ(suite, probe.allocations, probe.deallocations, "the spill array is released with the closure");
+}
+
 void testGarbageCollectorRoots(TestSuite& suite) {
     GarbageCollector gc;
 
@@ -502,7 +692,7 @@ void testGarbageCollectorStrategySelection(TestSuite& suite) {
     ASSERT_TRUE(suite, gc.useStrategy("incremental"), "Collector should accept incremental strategy");
     ASSERT_EQ(suite, Str("incremental"), Str(gc.getStrategyName()), "Collector should switch active strategy by name");
 
-    ASSERT_TRUE(suite, !gc.useStrategy("generational"), "Unknown GC strategy should be rejected");
+    ASSERT_TRUE(suite, !gc.useStrategy("copying"), "Unknown GC strategy should be rejected");
     ASSERT_EQ(suite, Str("incremental"), Str(gc.getStrategyName()),
               "Rejected strategy should not change the active strategy");
 
@@ -549,6 +739,320 @@ void testCollectGarbageStrategyCommand(TestSuite& suite) {
     delete L;
 }
 
+void testParallelMarkMatchesSerialReachability(TestSuite& suite) {
+    GarbageCollector gc;
+    gc.setStringPool(&StringPool::getInstance());
+    ASSERT_EQ(suite, static_cast<usize>(1), gc.getParallelMarkThreads(), "Full collections mark serially by default");
+    gc.setParallelMarkThreads(4);
+    gc.setParallelMarkThreshold(0);
+
+    // Wide fan-out gives idle workers something to steal; the chains keep
+    // each worker's private stack busy long enough to publish work.
+    Table* root = gc.createRoot<Table>();
+    std::vector<Table*> kept;
+    for (i32 i = 1; i <= 256; ++i) {
+        Table* link = gc.create<Table>();
+        root->setArray(i, Value(link));
+        kept.push_back(link);
+        for (i32 depth = 0; depth < 16; ++depth) {
+            Table* next = gc.create<Table>();
+            link->setArray(1, Value(next));
+            link->setArray(2, Value(gc.create<GCString>(StrView(std::to_string(i * 100 + depth)))));
+            kept.push_back(next);
+            link = next;
+        }
+    }
+
+    Table* weak = gc.create<Table>();
+    Table* weakMetatable = gc.create<Table>();
+    weakMetatable->set(Value(GlobalState::getInstance().getMetamethodName(TMS::TM_MODE)),
+                       Value(gc.create<GCString>(StrView("v"))));
+    weak->setMetatable(weakMetatable);
+    weak->setArray(1, Value(kept.front()));
+    weak->setArray(2, Value(gc.create<Table>()));
+    root->set(Value(gc.create<GCString>(StrView("weak"))), Value(weak));
+    for (i32 i = 0; i < 100; ++i) {
+        (void)gc.create<Table>();
+    }
+
+    const usize objectsBefore = gc.getObjectCount();
+    ASSERT_EQ(suite, static_cast<usize>(101), gc.collect(),
+              "Parallel marking frees exactly the unreachable tables and the weakly held value");
+    ASSERT_EQ(suite, static_cast<usize>(1), gc.getParallelMarkCycles(), "The full collection marked in parallel");
+    ASSERT_EQ(suite, objectsBefore - 101, gc.getObjectCount(), "Every reachable object survived");
+    ASSERT_TRUE(suite, weak->getArray(1).isTable() && weak->getArray(1).asTable() == kept.front(),
+                "Weak entries with strong referents survive the serial atomic phase");
+    ASSERT_TRUE(suite, weak->getArray(2).isNil(), "Weak entries with dead referents are cleared");
+
+    bool chainsIntact = true;
+    for (i32 i = 1; i <= 256; ++i) {
+        Table* link = root->getArray(i).asTable();
+        for (i32 depth = 0; depth < 16 && chainsIntact; ++depth) {
+            const Value next = link->getArray(1);
+            chainsIntact = next.isTable() && link->getArray(2).isString();
+            link = chainsIntact ? next.asTable() : link;
+        }
+    }
+    ASSERT_TRUE(suite, chainsIntact, "Deep chains traversed by different workers stay intact");
+    ASSERT_EQ(suite, static_cast<usize>(0), gc.collect(), "A second parallel collection finds no garbage");
+}
+
+void testParallelMarkUsesAllocator(TestSuite& suite) {
+    GCAllocatorProbe probe;
+    LuaAllocator allocator(gcTrackingAllocator, &probe);
+    {
+        GarbageCollector gc(&allocator);
+        gc.setStringPool(&StringPool::getInstance());
+        Table* root = gc.createRoot<Table>();
+        for (i32 i = 1; i <= 512; ++i) {
+            Table* child = gc.create<Table>();
+            child->setArray(1, Value(gc.create<Table>()));
+            root->setArray(i, Value(child));
+        }
+
+        (void)gc.collect();
+        const usize beforeSerial = probe.allocations;
+        (void)gc.collect();
+        const usize serialAllocations = probe.allocations - beforeSerial;
+
+        gc.setParallelMarkThreads(4);
+        gc.setParallelMarkThreshold(0);
+        const usize beforeParallel = probe.allocations;
+        ASSERT_EQ(suite, static_cast<usize>(0), gc.collect(), "parallel marking keeps every reachable table");
+        ASSERT_EQ(suite, static_cast<usize>(1), gc.getParallelMarkCycles(), "the collection marked in parallel");
+        ASSERT_TRUE(suite, probe.allocations - beforeParallel > serialAllocations,
+                    "worker stacks and queues are allocated through the configured allocator");
+    }
+    ASSERT_EQ(suite, probe.allocations, probe.deallocations, "parallel mark storage returns to the allocator");
+}
+
+void testParallelMarkKeepsSuspendedCoroutineStacks(TestSuite& suite) {
+    LuaState* L = LuaState::newIsolatedState();
+    GarbageCollector& gc = L->getGlobalState().getGC();
+    gc.useStrategy("mark-sweep");
+    gc.setParallelMarkThreads(4);
+    gc.setParallelMarkThreshold(0);
+    openBaseLib(L);
+    openCoroutineLib(L);
+
+    // Suspended coroutines keep their only references in stack registers, so
+    // their stacks must be scanned (on the owner thread) during every parallel
+    // collection; repeated collections reuse the same worker pool.
+    const Str source = R"(
+        local threads = {}
+        for i = 1, 64 do
+            threads[i] = coroutine.create(function()
+                local held = {i, tostring(i), {i * 2}}
+                while true do
+                    coroutine.yield(held[1] + held[3][1])
+                end
+            end)
+            assert(coroutine.resume(threads[i]))
+        end
+        for round = 1, 4 do
+            local garbage = {}
+            for j = 1, 500 do garbage[j] = {j} end
+            garbage = nil
+            collectgarbage()
+            for i = 1, #threads do
+                local ok, value = coroutine.resume(threads[i])
+                assert(ok and value == i * 3)
+            end
+        end
+    )";
+    RuntimeServices services(L->getGlobalState());
+    Parser parser(source, services);
+    auto parsed = parser.parse();
+    ASSERT_TRUE(suite, parsed.has_value(), "coroutine workload parses");
+    if (!parsed.has_value()) {
+        delete L;
+        return;
+    }
+
+    Chunk chunk = std::move(*parsed);
+    CodeGenerator codegen(services);
+    Proto* proto = codegen.generate(chunk, "gc_parallel_coroutines");
+    ASSERT_TRUE(suite, proto != nullptr, "coroutine workload compiles");
+    if (proto != nullptr) {
+        Function* function = gc.create<Function>(proto);
+        function->setEnv(L->getGlobalTable());
+        L->pushFunction(function);
+        ASSERT_EQ(suite, LUA_OK, L->pcall(0, 0, 0), "parallel collections keep suspended coroutine locals alive");
+        ASSERT_TRUE(suite, gc.getParallelMarkCycles() >= 4, "every explicit collection marked in parallel");
+    }
+
+    delete L;
+}
+
+void testMarkTraversalSkipsScalarSlots(TestSuite& suite) {
+    GarbageCollector gc;
+    gc.setStringPool(&StringPool::getInstance());
+
+    // Interleave scalars, strings, and child tables so the prefetching slot
+    // scan must skip non-collectable values without losing live children.
+    Table* root = gc.createRoot<Table>();
+    std::vector<Table*> children;
+    for (i32 i = 1; i <= 64; ++i) {
+        switch (i % 4) {
+        case 0: {
+            Table* child = gc.create<Table>();
+            children.push_back(child);
+            root->setArray(i, Value(child));
+            break;
+        }
+        case 1:
+            root->setArray(i, Value(static_cast<LuaNumber>(i)));
+            break;
+        case 2:
+            root->setArray(i, Value(gc.create<GCString>(StrView(std::to_string(i)))));
+            break;
+        default:
+            root->setArray(i, Value(true));
+            break;
+        }
+    }
+    Table* hashValue = gc.create<Table>();
+    root->set(Value(gc.create<GCString>(StrView("key"))), Value(hashValue));
+    for (i32 i = 0; i < 3; ++i) {
+        (void)gc.create<Table>();
+    }
+
+    ASSERT_EQ(suite, static_cast<usize>(3), gc.collect(), "Type-switched marking frees only unreachable tables");
+    bool childrenKept = true;
+    for (usize i = 0; i < children.size(); ++i) {
+        const Value slot = root->getArray(static_cast<i32>((i + 1) * 4));
+        childrenKept = childrenKept && slot.isTable() && slot.asTable() == children[i];
+    }
+    ASSERT_TRUE(suite, childrenKept, "Array children between scalar slots stay reachable");
+    ASSERT_TRUE(suite, root->getArray(2).isString() && root->getArray(2).asString()->view() == "2",
+                "String slots survive marking");
+    ASSERT_TRUE(suite, hashValue->getOwnerCollector() == &gc, "Hash-part children stay reachable");
+
+    GCString* loose = gc.create<GCString>(StrView("loose"));
+    gc.markObject(loose);
+    ASSERT_TRUE(suite, loose->isBlack(), "Strings have no children and turn black without entering the gray stack");
+    gc.removeRoot(root);
+    gc.clearAll();
+}
+
+void testGenerationalMinorCollectionSweepsYoungObjects(TestSuite& suite) {
+    GarbageCollector gc;
+    gc.setStringPool(&StringPool::getInstance());
+    ASSERT_TRUE(suite, gc.useStrategy("generational"), "Collector should accept generational strategy");
+    ASSERT_TRUE(suite, gc.isGenerational(), "Generational strategy enables generational mode");
+
+    Table* root = new Table();
+    gc.registerObject(root);
+    gc.addRoot(root);
+    Table* oldGarbage = new Table();
+    gc.registerObject(oldGarbage);
+    root->setArray(1, Value(oldGarbage));
+
+    ASSERT_TRUE(suite, gc.step(nullptr, 0), "A generational step completes a collection");
+    ASSERT_EQ(suite, static_cast<usize>(1), gc.getMajorCollectionCount(), "The first generational step is major");
+    ASSERT_TRUE(suite, (root->getMarked() & GCBits::OLD) != 0 && root->isBlack(),
+                "Major collection promotes survivors to black old objects");
+
+    // 老年代对象变为不可达后只在主要收集中回收
+    root->setArray(1, Value());
+    Table* youngGarbage = new Table();
+    gc.registerObject(youngGarbage);
+    Table* youngChild = new Table();
+    gc.registerObject(youngChild);
+    root->setArray(2, Value(youngChild));
+    ASSERT_EQ(suite, static_cast<usize>(1), gc.getRememberedSetSize(),
+              "Storing a young object into an old owner remembers the owner");
+    ASSERT_TRUE(suite, root->isGray(), "Remembered owner turns gray until the next minor collection");
+
+    const usize objectsBefore = gc.getObjectCount();
+    ASSERT_TRUE(suite, gc.step(nullptr, 0), "Second generational step completes");
+    ASSERT_EQ(suite, static_cast<usize>(1), gc.getMinorCollectionCount(), "Second step runs a minor collection");
+    ASSERT_EQ(suite, objectsBefore - 1, gc.getObjectCount(), "Minor collection frees only young garbage");
+    ASSERT_TRUE(suite, root->getArray(2).isTable() && root->getArray(2).asTable() == youngChild,
+                "Minor collection keeps young objects reachable from remembered owners");
+    ASSERT_TRUE(suite, (youngChild->getMarked() & GCBits::OLD) != 0, "Minor survivors are promoted");
+    ASSERT_EQ(suite, static_cast<usize>(0), gc.getRememberedSetSize(), "Scanned owners leave the remembered set");
+
+    ASSERT_EQ(suite, static_cast<usize>(1), gc.collect(), "Explicit collection is major and frees old garbage");
+    ASSERT_EQ(suite, static_cast<usize>(2), gc.getMajorCollectionCount(), "Explicit collection counts as major");
+
+    ASSERT_TRUE(suite, gc.useStrategy("mark-sweep"), "Collector should leave generational mode");
+    ASSERT_TRUE(suite, (root->getMarked() & GCBits::OLD) == 0 && root->isWhite(),
+                "Leaving generational mode clears generations");
+
+    gc.removeRoot(root);
+    gc.clearAll();
+}
+
+void testGenerationalModeKeepsLuaObjectGraph(TestSuite& suite) {
+    LuaState* L = LuaState::newIsolatedState();
+    GarbageCollector& gc = L->getGlobalState().getGC();
+    gc.useStrategy("mark-sweep");
+    openBaseLib(L);
+
+    const Str source = R"(
+        assert(collectgarbage('generational') == 'mark-sweep')
+        local function makeBox()
+            local v
+            return function(x)
+                if x then v = x end
+                return v
+            end
+        end
+        local box = makeBox()
+        local kept = {}
+        local weak = setmetatable({}, {__mode = 'v'})
+        collectgarbage()
+
+        box({42})
+        for i = 1, 2000 do
+            local t = {i, tostring(i)}
+            if i % 10 == 0 then kept[#kept + 1] = t end
+            weak[i] = {}
+            if i % 100 == 0 then collectgarbage('step') end
+        end
+        collectgarbage('step')
+
+        assert(box()[1] == 42)
+        for i = 1, #kept do
+            assert(kept[i][1] == i * 10 and kept[i][2] == tostring(i * 10))
+        end
+        local alive = 0
+        for _ in pairs(weak) do alive = alive + 1 end
+        assert(alive < 100)
+        assert(collectgarbage('incremental') == 'generational')
+        assert(collectgarbage('strategy') == 'mark-sweep')
+        assert(collectgarbage('incremental') == 'mark-sweep')
+        assert(collectgarbage('generational') == 'incremental')
+        assert(collectgarbage('incremental') == 'generational')
+        assert(collectgarbage('strategy') == 'incremental')
+    )";
+    RuntimeServices services(L->getGlobalState());
+    Parser parser(source, services);
+    auto parsed = parser.parse();
+    ASSERT_TRUE(suite, parsed.has_value(), "generational workload parses");
+    if (!parsed.has_value()) {
+        delete L;
+        return;
+    }
+
+    Chunk chunk = std::move(*parsed);
+    CodeGenerator codegen(services);
+    Proto* proto = codegen.generate(chunk, "gc_generational_workload");
+    ASSERT_TRUE(suite, proto != nullptr, "generational workload compiles");
+    if (proto != nullptr) {
+        Function* function = gc.create<Function>(proto);
+        function->setEnv(L->getGlobalTable());
+        L->pushFunction(function);
+        ASSERT_EQ(suite, LUA_OK, L->pcall(0, 0, 0), "generational collections keep the live Lua object graph");
+        ASSERT_TRUE(suite, gc.getMinorCollectionCount() > 0, "workload steps run minor collections");
+        ASSERT_EQ(suite, Str("incremental"), Str(gc.getStrategyName()), "collectgarbage('incremental') switches back");
+    }
+
+    gc.useStrategy("mark-sweep");
+    delete L;
+}
+
 void testCollectGarbageControlParameters(TestSuite& suite) {
     LuaState* L = LuaState::newIsolatedState();
     GarbageCollector& gc = L->getGlobalState().getGC();
@@ -585,6 +1089,14 @@ void testCollectGarbageControlParameters(TestSuite& suite) {
                 "setstepmul returns the previous step multiplier");
     ASSERT_EQ(suite, 400, gc.getStepMultiplier(), "setstepmul stores the new step multiplier");
 
+    L->setTop(0);
+    L->pushString(pool.intern("stepus"));
+    L->pushNumber(100000.0);
+    nresults = luaB_collectgarbage(L);
+    ASSERT_EQ(suite, 2, nresults, "collectgarbage('stepus') returns completion and remaining debt");
+    ASSERT_TRUE(suite, L->at(L->getTop() - 1).isBoolean(), "stepus reports whether a cycle completed");
+    ASSERT_TRUE(suite, L->top().isNumber() && L->top().asNumber() >= 0.0, "stepus reports non-negative debt in KB");
+
     (void)gc.setPause(200);
     (void)gc.setStepMultiplier(200);
     delete L;
@@ -636,6 +1148,44 @@ void testCollectGarbageStepRunsIncrementalCycle(TestSuite& suite) {
     gc.clearAll();
 }
 
+void testTimedStepStopsAtDeadline(TestSuite& suite) {
+    GarbageCollector gc;
+    gc.setStringPool(&StringPool::getInstance());
+
+    Table* root = gc.createRoot<Table>();
+    for (i32 i = 1; i <= 512; ++i) {
+        root->setArray(i, Value(gc.create<Table>()));
+    }
+    for (i32 i = 0; i < 512; ++i) {
+        (void)gc.create<Table>();
+    }
+    const usize liveObjects = 513;
+
+    const usize objectsBefore = gc.getObjectCount();
+    const isize debtBefore = gc.getDebtBytes();
+    ASSERT_TRUE(suite, !gc.stepFor(nullptr, std::chrono::microseconds(0)), "A zero time budget does no work");
+    ASSERT_EQ(suite, objectsBefore, gc.getObjectCount(), "A zero time budget sweeps nothing");
+    ASSERT_EQ(suite, debtBefore, gc.getDebtBytes(), "A zero time budget pays no debt");
+
+    // A 1 us deadline expires after the first slice, so the cycle spans many calls.
+    i32 calls = 0;
+    bool finished = false;
+    while (!finished && calls < 100000) {
+        finished = gc.stepFor(nullptr, std::chrono::microseconds(1));
+        ++calls;
+    }
+    ASSERT_TRUE(suite, finished, "Repeated timed steps finish the cycle");
+    ASSERT_TRUE(suite, calls > 1, "An expired deadline stops work after one slice");
+    ASSERT_EQ(suite, liveObjects, gc.getObjectCount(), "Timed steps reclaim exactly the unreachable tables");
+    ASSERT_TRUE(suite, gc.getDebtBytes() <= 0, "A completed cycle leaves the collector in credit");
+
+    for (i32 i = 0; i < 512; ++i) {
+        (void)gc.create<Table>();
+    }
+    ASSERT_TRUE(suite, gc.stepFor(nullptr, std::chrono::seconds(10)), "A generous budget completes the cycle in one call");
+    ASSERT_EQ(suite, liveObjects, gc.getObjectCount(), "The single timed step reclaims the new garbage");
+}
+
 void testIncrementalGCDebtTracksAllocationAndCycleCompletion(TestSuite& suite) {
     GarbageCollector gc;
     StringPool& pool = StringPool::getInstance();
@@ -664,6 +1214,43 @@ void testIncrementalGCDebtTracksAllocationAndCycleCompletion(TestSuite& suite) {
     gc.clearAll();
 }
 
+void testAllocationDrivesAutomaticCheckpoint(TestSuite& suite) {
+    GarbageCollector gc;
+    StringPool& pool = StringPool::getInstance();
+    gc.setStringPool(&pool);
+
+    Table* table = gc.create<Table>();
+    gc.addRoot(table);
+    ASSERT_TRUE(suite, !gc.isCollectionPending(), "Allocation below the threshold leaves the checkpoint clear");
+
+    table->set(Value(1.0), Value(2.0));
+    gc.accountObjectSizeChange(table);
+    table->set(Value(1.0), Value(3.0));
+    gc.accountObjectSizeChange(table);
+    ASSERT_TRUE(suite, !gc.isCollectionPending(), "Overwriting an existing slot does not arm the checkpoint");
+    ASSERT_EQ(suite, static_cast<usize>(0), gc.checkAutomatic(nullptr), "A clear checkpoint skips the collector");
+
+    while (!gc.isCollectionPending()) {
+        (void)gc.create<Table>();
+    }
+    ASSERT_TRUE(suite, gc.getAccountedMemory() >= gc.getAutomaticThresholdBytes() || gc.getDebtBytes() > 0,
+                "The checkpoint arms once allocation makes the collection due");
+    (void)gc.checkAutomatic(nullptr);
+    ASSERT_TRUE(suite, !gc.isCollectionPending(), "Running the checkpoint consumes the request");
+
+    gc.stopAutomatic();
+    (void)gc.create<Table>();
+    ASSERT_TRUE(suite, !gc.isCollectionPending(), "A stopped collector does not arm the checkpoint");
+
+    (void)gc.setManagedMemoryBudgetBytes(gc.getAccountedMemory());
+    ASSERT_TRUE(suite, gc.isCollectionPending(), "A finite managed budget keeps the checkpoint armed");
+    (void)gc.setManagedMemoryBudgetBytes(std::numeric_limits<usize>::max());
+    gc.restartAutomatic();
+
+    gc.removeRoot(table);
+    gc.clearAll();
+}
+
 void testWriteBarrierPreservesTableReferenceGraph(TestSuite& suite) {
     GarbageCollector gc;
     StringPool& pool = StringPool::getInstance();
@@ -848,6 +1435,112 @@ void testFastMemoryAccountingTracksDynamicObjects(TestSuite& suite) {
               "fast memory ledger returns to zero after all objects unregister");
 }
 
+void testHeapCensusAttributesRetainedBytes(TestSuite& suite) {
+    GarbageCollector gc;
+    StringPool pool;
+    pool.setGarbageCollector(&gc);
+
+    Table* root = gc.create<Table>();
+    Table* owner = gc.create<Table>();
+    Table* other = gc.create<Table>();
+    Table* shared = gc.create<Table>();
+    gc.addRoot(root);
+    root->set(Value(1.0), Value(owner));
+    root->set(Value(2.0), Value(other));
+    owner->set(Value(0.0), Value(shared));
+    other->set(Value(0.0), Value(shared));
+    for (i32 i = 1; i <= 100; ++i) {
+        Table* child = gc.create<Table>();
+        child->set(Value(1.0), Value(static_cast<LuaNumber>(i)));
+        owner->set(Value(static_cast<LuaNumber>(i)), Value(child));
+    }
+    (void)gc.create<Table>();
+
+    const GCHeapCensus census = gc.takeHeapCensus(nullptr, 4);
+    ASSERT_EQ(suite, static_cast<usize>(105), census.forType(GCObjectType::Table).count,
+              "census counts every table in the collector");
+    ASSERT_EQ(suite, static_cast<usize>(104), census.reachable.count, "census excludes unreachable garbage");
+    usize sizeClassObjects = 0;
+    for (const GCCensusBucket& bucket : census.sizeClasses) {
+        sizeClassObjects += bucket.count;
+    }
+    ASSERT_EQ(suite, census.total.count, sizeClassObjects, "size classes partition the heap");
+
+    ASSERT_EQ(suite, static_cast<usize>(4), census.topRetainers.size(), "census reports the requested retainers");
+    ASSERT_EQ(suite, static_cast<usize>(104), census.topRetainers[0].retainedObjects,
+              "the root dominates the whole reachable graph");
+    ASSERT_EQ(suite, census.reachable.bytes, census.topRetainers[0].retainedBytes,
+              "the root retains every reachable byte");
+    ASSERT_EQ(suite, static_cast<usize>(101), census.topRetainers[1].retainedObjects,
+              "a shared child is not attributed to either of its owners");
+    ASSERT_TRUE(suite, census.topRetainers[1].label.starts_with("table: "), "retainers carry a tostring-style label");
+
+    std::ostringstream folded;
+    ASSERT_TRUE(suite, census.writeFolded(folded), "census exports folded stacks");
+    std::istringstream lines(folded.str());
+    std::string line;
+    usize foldedBytes = 0;
+    while (std::getline(lines, line)) {
+        foldedBytes += static_cast<usize>(std::stoull(line.substr(line.rfind(' ') + 1)));
+    }
+    ASSERT_EQ(suite, census.reachable.bytes, foldedBytes, "folded retention stacks weigh every reachable byte");
+
+    ASSERT_EQ(suite, static_cast<usize>(1), gc.collect(pool), "census leaves the collector ready for a normal cycle");
+
+    gc.removeRoot(root);
+    gc.clearAll();
+}
+
+void testAllocationSamplingRecordsLuaSites(TestSuite& suite) {
+    LuaState* L = LuaState::newIsolatedState();
+    GarbageCollector& gc = L->getGlobalState().getGC();
+    openBaseLib(L);
+
+    const Str source = "local t = {}\nfor i = 1, 20 do t[i] = {} end\n";
+    RuntimeServices services(L->getGlobalState());
+    Parser parser(source, services);
+    auto parsed = parser.parse();
+    ASSERT_TRUE(suite, parsed.has_value(), "sampling workload parses");
+    if (!parsed.has_value()) {
+        delete L;
+        return;
+    }
+
+    Chunk chunk = std::move(*parsed);
+    CodeGenerator codegen(services);
+    Proto* proto = codegen.generate(chunk, "sampler");
+    ASSERT_TRUE(suite, proto != nullptr, "sampling workload compiles");
+    if (proto != nullptr) {
+        Function* function = gc.create<Function>(proto);
+        function->setEnv(L->getGlobalTable());
+        L->pushFunction(function);
+
+        gc.setAllocationSampleInterval(1);
+        ASSERT_EQ(suite, LUA_OK, L->pcall(0, 0, 0), "sampled workload runs");
+        gc.setAllocationSampleInterval(0);
+
+        const GCAllocationProfile& profile = gc.getAllocationProfile();
+        ASSERT_TRUE(suite, profile.getSampleCount() > 0, "a one-byte interval samples every allocation");
+        bool loopSite = false;
+        for (const GCAllocationSite& site : profile.getSites()) {
+            loopSite = loopSite || (site.stack.ends_with("sampler:2;table") && site.samples > 0);
+        }
+        ASSERT_TRUE(suite, loopSite, "samples attribute loop allocations to their source line and type");
+
+        std::ostringstream folded;
+        ASSERT_TRUE(suite, profile.writeFolded(folded), "allocation profile exports folded stacks");
+        ASSERT_TRUE(suite, folded.str().find("sampler:2;table ") != std::string::npos,
+                    "folded output carries the allocation site");
+
+        gc.resetAllocationProfile();
+        (void)gc.create<Table>();
+        ASSERT_EQ(suite, static_cast<usize>(0), gc.getAllocationProfile().getSampleCount(),
+                  "disabled sampling records nothing");
+    }
+
+    delete L;
+}
+
 void testIncrementalBarriersPublishConstructedAndProtoGraphs(TestSuite& suite) {
     GarbageCollector gc;
     StringPool pool;
@@ -1080,6 +1773,65 @@ void testExplicitCollectionKeepsAnonymousTemporaries(TestSuite& suite) {
     delete L;
 }
 
+void testStackMapExcludesDeadTemporaries(TestSuite& suite) {
+    LuaState* L = LuaState::newIsolatedState();
+    GarbageCollector& gc = L->getGlobalState().getGC();
+    openBaseLib(L);
+
+    const Str source = R"(
+        local t = {}
+        t[1] = {1, 2, 3, 4}
+        local n = #t
+        tostring(n)
+        collectgarbage('collect')
+        assert(t[1][4] == 4 and n == 1)
+    )";
+    RuntimeServices services(L->getGlobalState());
+    Parser parser(source, services);
+    auto parsed = parser.parse();
+    ASSERT_TRUE(suite, parsed.has_value(), "stack-map regression parses");
+    if (!parsed.has_value()) {
+        delete L;
+        return;
+    }
+
+    Chunk chunk = std::move(*parsed);
+    CodeGenerator codegen(services);
+    Proto* proto = codegen.generate(chunk, "gc_stack_map");
+    ASSERT_TRUE(suite, proto != nullptr, "stack-map regression compiles");
+    if (proto != nullptr) {
+        ASSERT_TRUE(suite, proto->getStackMapSize() > 0, "codegen records stack maps at safepoints");
+
+        // 第一个 CALL 是 tostring(n)：R4、R5 只在表构造器中使用过
+        const auto code = proto->getInstructionSpan();
+        usize callPc = code.size();
+        for (usize pc = 0; pc < code.size(); ++pc) {
+            if (GET_OPCODE(code[pc]) == OpCode::CALL) {
+                callPc = pc;
+                break;
+            }
+        }
+        ASSERT_TRUE(suite, callPc < code.size(), "stack-map regression contains a call");
+        const u64* live = callPc < code.size() ? proto->findStackMap(callPc) : nullptr;
+        ASSERT_TRUE(suite, live != nullptr, "calls are safepoints");
+        if (live != nullptr) {
+            const i32 a = GETARG_A(code[callPc]);
+            ASSERT_TRUE(suite, (live[0] & 1) != 0 && (live[0] & 2) != 0, "in-scope locals stay in the map");
+            ASSERT_TRUE(suite, ((live[0] >> a) & 1) != 0 && ((live[0] >> (a + 1)) & 1) != 0,
+                        "callee and argument registers stay in the map");
+            ASSERT_TRUE(suite, proto->getMaxStackSize() > static_cast<usize>(a + 2), "constructor widened the frame");
+            ASSERT_TRUE(suite, ((live[0] >> (a + 2)) & 1) == 0, "dead constructor temporaries are not scanned");
+        }
+
+        Function* function = gc.create<Function>(proto);
+        function->setEnv(L->getGlobalTable());
+        L->pushFunction(function);
+        ASSERT_EQ(suite, LUA_OK, L->pcall(0, 0, 0), "map-driven collection keeps live registers");
+    }
+
+    delete L;
+}
+
 void testWeakTableValuesAreCleared(TestSuite& suite) {
     LuaState* L = LuaState::newIsolatedState();
     GarbageCollector& gc = L->getGlobalState().getGC();
@@ -1481,6 +2233,44 @@ void testUpvalueCloseAll(TestSuite& suite) {
     delete L;
 }
 
+void testUpvalueIndexOrder(TestSuite& suite) {
+    LuaState* L = LuaState::newIsolatedState();
+    for (i32 i = 0; i < 5000; ++i) {
+        L->pushNumber(static_cast<f64>(i));
+    }
+
+    // Test 1: 乱序创建后链表仍按栈索引降序，跨越索引的桶与第二级位图
+    const usize slots[] = {4500, 10, 200, 4100, 70, 4099};
+    for (usize slot : slots) {
+        (void)L->findOrCreateUpvalue(slot);
+    }
+    usize previous = static_cast<usize>(-1);
+    usize count = 0;
+    bool descending = true;
+    for (Upvalue* uv = L->getOpenUpvalues(); uv != nullptr; uv = uv->getNext()) {
+        descending = descending && uv->getStackIndex() < previous;
+        previous = uv->getStackIndex();
+        ++count;
+    }
+    ASSERT_TRUE(suite, descending && count == 6, "Open upvalues stay sorted");
+    ASSERT_TRUE(suite, L->findOrCreateUpvalue(4100)->getStackIndex() == 4100, "Indexed lookup");
+
+    // Test 2: 只关闭 level 之上的上值，索引同步移除
+    Upvalue* low = L->findOrCreateUpvalue(70);
+    Upvalue* high = L->findOrCreateUpvalue(4500);
+    L->closeUpvalues(150);
+    ASSERT_TRUE(suite, high->isClosed() && low->isOpen(), "Close above level");
+    ASSERT_TRUE(suite, L->getOpenUpvalues() == low, "Closed upvalues leave the list");
+    Upvalue* reopened = L->findOrCreateUpvalue(4500);
+    ASSERT_TRUE(suite, reopened != high && reopened->isOpen(), "Closed slot gets a fresh upvalue");
+    ASSERT_TRUE(suite, L->getOpenUpvalues() == reopened && reopened->getNext() == low, "Reinsert above");
+
+    L->closeUpvalues(0);
+    ASSERT_TRUE(suite, L->getOpenUpvalues() == nullptr && low->isClosed(), "Close all indexed upvalues");
+
+    delete L;
+}
+
 void registerGCTests() {
     auto& registry = TestRegistry::getInstance();
 
@@ -1495,21 +2285,36 @@ void registerGCTests() {
                           testAllocatorFactoryCleansUpRegistrationFailure);
     registry.registerTest("GC", "Allocator Root And External Mark Queue Rollback",
                           testAllocatorBackedRootAndExternalMarkQueuesRollback);
+    registry.registerTest("GC", "String Single Allocation And Slab", testStringSingleAllocationAndSlab);
+    registry.registerTest("GC", "Background Free Of Swept Blocks", testBackgroundFreeReleasesSweptBlocks);
+    registry.registerTest("GC", "Slab Small Object Allocation", testSlabAllocatesSmallObjectsInPages);
+    registry.registerTest("GC", "Closure Upvalue Spill Uses Allocator", testClosureUpvalueSpillUsesAllocator);
     registry.registerTest("GC", "GC Roots", testGarbageCollectorRoots);
     registry.registerTest("GC", "GC Collect", testGarbageCollectorCollect);
     registry.registerTest("GC", "GC Strategy Selection", testGarbageCollectorStrategySelection);
     registry.registerTest("GC", "GC Strategy Equivalence", testGCStrategiesHaveEquivalentReachability);
     registry.registerTest("GC", "collectgarbage Strategy", testCollectGarbageStrategyCommand);
+    registry.registerTest("GC", "Parallel Mark Matches Serial Reachability", testParallelMarkMatchesSerialReachability);
+    registry.registerTest("GC", "Parallel Mark Uses Allocator", testParallelMarkUsesAllocator);
+    registry.registerTest("GC", "Parallel Mark Suspended Coroutine Stacks",
+                          testParallelMarkKeepsSuspendedCoroutineStacks);
+    registry.registerTest("GC", "Mark Traversal Skips Scalar Slots", testMarkTraversalSkipsScalarSlots);
+    registry.registerTest("GC", "Generational Minor Collection", testGenerationalMinorCollectionSweepsYoungObjects);
+    registry.registerTest("GC", "Generational Lua Workload", testGenerationalModeKeepsLuaObjectGraph);
     registry.registerTest("GC", "collectgarbage Control Parameters", testCollectGarbageControlParameters);
     registry.registerTest("GC", "collectgarbage Incremental Step", testCollectGarbageStepRunsIncrementalCycle);
+    registry.registerTest("GC", "Timed Step Stops At Deadline", testTimedStepStopsAtDeadline);
     registry.registerTest("GC", "Incremental GC Debt Tracks Allocation And Cycle Completion",
                           testIncrementalGCDebtTracksAllocationAndCycleCompletion);
+    registry.registerTest("GC", "Allocation Drives Automatic Checkpoint", testAllocationDrivesAutomaticCheckpoint);
     registry.registerTest("GC", "Write Barrier Table Graph", testWriteBarrierPreservesTableReferenceGraph);
     registry.registerTest("GC", "Write Barrier Object References",
                           testWriteBarrierPreservesMetatableFunctionAndUpvalueRefs);
     registry.registerTest("GC", "Composite Marking", testGarbageCollectorMarksCompositeObjects);
     registry.registerTest("GC", "collectgarbage Collect", testCollectGarbageCollectReclaimsMemory);
     registry.registerTest("GC", "Fast Memory Accounting", testFastMemoryAccountingTracksDynamicObjects);
+    registry.registerTest("GC", "Heap Census Retained Bytes", testHeapCensusAttributesRetainedBytes);
+    registry.registerTest("GC", "Allocation Sampling Lua Sites", testAllocationSamplingRecordsLuaSites);
     registry.registerTest("GC", "Incremental Constructor And Proto Barriers",
                           testIncrementalBarriersPublishConstructedAndProtoGraphs);
     registry.registerTest("GC", "Incremental Sweep Registration Cursor",
@@ -1522,6 +2327,7 @@ void registerGCTests() {
                           testClosingUpvalueDuringIncrementalSweepRestartsMark);
     registry.registerTest("GC", "Explicit Collection Anonymous Temporaries",
                           testExplicitCollectionKeepsAnonymousTemporaries);
+    registry.registerTest("GC", "Stack Map Excludes Dead Temporaries", testStackMapExcludesDeadTemporaries);
     registry.registerTest("GC", "Weak Table Values", testWeakTableValuesAreCleared);
     registry.registerTest("GC", "Weak Table Keys", testWeakTableKeysAreCleared);
     registry.registerTest("GC", "Incremental Weak Mode Mutation", testIncrementalWeakToStrongModeTransition);
@@ -1538,4 +2344,5 @@ void registerGCTests() {
     registry.registerTest("GC", "Upvalue Open", testUpvalueOpen);
     registry.registerTest("GC", "Upvalue Closed", testUpvalueClosed);
     registry.registerTest("GC", "Upvalue Close All", testUpvalueCloseAll);
+    registry.registerTest("GC", "Upvalue Index Order", testUpvalueIndexOrder);
 }
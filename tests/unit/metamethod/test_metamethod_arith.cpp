@@ -323,6 +323,52 @@ void testRuntimeMetamethodOpcodeExecution(TestSuite& suite) {
               "tailcall through __call metamethod should return the metamethod result");
 }
 
+void testCallMetamethodArgumentShift(TestSuite& suite) {
+    UPtr<LuaState> state = LuaState::create();
+    LuaState* L = state.get();
+    StandardLibrary::openAll(L);
+
+    bool ok = runLua(L, R"lua(
+        local callable = setmetatable({ tag = "obj" }, {
+            __call = function(self, ...)
+                local n = select("#", ...)
+                local last = select(n, ...)
+                return self.tag, n, last
+            end
+        })
+
+        local args = {}
+        for i = 1, 200 do
+            args[i] = i
+        end
+        _shift_tag, _shift_count, _shift_last = callable(unpack(args))
+        _shift_tag_fixed, _shift_count_fixed, _shift_last_fixed = callable(1, nil, 3)
+
+        local V = {}
+        V.__index = V
+        V.__add = function(a, b) return setmetatable({ x = a.x + b.x }, V) end
+        V.__eq = function(a, b) return a.x == b.x end
+        local acc = setmetatable({ x = 0 }, V)
+        local one = setmetatable({ x = 1 }, V)
+        for i = 1, 1000 do
+            acc = acc + one
+        end
+        _vector_sum = acc.x
+        _vector_eq = acc == setmetatable({ x = 1000 }, V)
+    )lua");
+
+    ASSERT_TRUE(suite, ok, "__call argument shift script should execute");
+    ASSERT_EQ(suite, std::string("obj"), std::string(L->getGlobal("_shift_tag").asString()->c_str()),
+              "variadic __call receives the callable as self");
+    ASSERT_EQ(suite, 200.0, L->getGlobal("_shift_count").asNumber(), "variadic __call keeps every argument");
+    ASSERT_EQ(suite, 200.0, L->getGlobal("_shift_last").asNumber(), "variadic __call keeps the last argument");
+    ASSERT_EQ(suite, 3.0, L->getGlobal("_shift_count_fixed").asNumber(), "fixed __call keeps nil arguments");
+    ASSERT_EQ(suite, 3.0, L->getGlobal("_shift_last_fixed").asNumber(), "fixed __call keeps argument order");
+    ASSERT_EQ(suite, 1000.0, L->getGlobal("_vector_sum").asNumber(), "repeated __add frames");
+    ASSERT_TRUE(suite, L->getGlobal("_vector_eq").isBoolean() && L->getGlobal("_vector_eq").asBoolean(),
+                "__eq frame result");
+}
+
 /**
  * @brief 注册所有元方法算术测试
  */
@@ -335,4 +381,5 @@ void registerMetamethodArithTests() {
     registry.registerTest("Metamethod", "Lua function metamethods and basic type metatable",
                           testLuaFunctionMetamethodsAndBasicTypeMetatable);
     registry.registerTest("Metamethod", "Runtime metamethod opcode execution", testRuntimeMetamethodOpcodeExecution);
+    registry.registerTest("Metamethod", "__call argument shift", testCallMetamethodArgumentShift);
 }
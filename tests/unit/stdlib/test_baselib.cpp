@@ -15,7 +15,13 @@
 #include "compiler/opcode.hpp"
 #include "compiler/parser/parser.hpp"
 #include "compiler/codegen/codegen.hpp"
+#include "common/number_conversion.hpp"
 
+#include <array>
+#include <cctype>
+#include <cerrno>
+#include <cmath>
+#include <cstdio>
 #include <iostream>
 #include <filesystem>
 #include <fstream>
@@ -264,6 +270,117 @@ void testTostringWrapper(TestSuite& suite) {
                 "tostring preserves embedded NUL strings");
 }
 
+void testNumberFormattingMatchesLua51(TestSuite& suite) {
+    const double samples[] = {0.0,
+                              -0.0,
+                              1.0,
+                              -1.0,
+                              0.1,
+                              -0.5,
+                              1.0 / 3.0,
+                              2.0 / 3.0,
+                              3.14159265358979,
+                              1e-4,
+                              1.5e-5,
+                              123456.789,
+                              1e13,
+                              99999999999999.0,
+                              1e14,
+                              1e15,
+                              123456789012345678.0,
+                              1e100,
+                              -2.5e-300,
+                              4.9406564584124654e-324,
+                              2.2250738585072014e-308,
+                              std::numeric_limits<double>::max(),
+                              std::numeric_limits<double>::infinity(),
+                              -std::numeric_limits<double>::infinity(),
+                              9007199254740993.0,
+                              0.30000000000000004};
+
+    for (double value : samples) {
+        std::array<char, 64> buffer{};
+        const std::string formatted(luaNumberToView(value, buffer));
+        char expected[64];
+        std::snprintf(expected, sizeof(expected), "%.14g", value);
+        ASSERT_TRUE(suite, formatted == expected, "luaNumberToView matches %.14g for " + std::string(expected));
+    }
+
+    u64 state = 0x9E3779B97F4A7C15ull;
+    bool allMatch = true;
+    for (int i = 0; i < 20000 && allMatch; ++i) {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        double value = 0.0;
+        if (i % 2 == 0) {
+            u64 bits = state;
+            std::memcpy(&value, &bits, sizeof(value));
+        } else {
+            value = static_cast<double>(static_cast<i64>(state % 2000000) - 1000000) / 1000.0;
+        }
+        if (std::isnan(value)) {
+            continue;
+        }
+        std::array<char, 64> buffer{};
+        char expected[64];
+        std::snprintf(expected, sizeof(expected), "%.14g", value);
+        allMatch = std::string(luaNumberToView(value, buffer)) == expected;
+    }
+    ASSERT_TRUE(suite, allMatch, "luaNumberToView matches %.14g across random bit patterns");
+
+    const char* parseSamples[] = {"42",   " 42 ", "-7.5", "+1e3", ".5",    "5.",  "0x10", "1e",   "",
+                                  "- 1", "--1", "1e400", "1e-310", "inf", "nan", "12a", "\t3\n", "0X1F"};
+    for (const char* text : parseSamples) {
+        LuaNumber parsed = 0.0;
+        const bool accepted = luaStringToNumber(StrView(text), parsed);
+        char* end = nullptr;
+        errno = 0;
+        const double expected = std::strtod(text, &end);
+        bool expectedAccepted = end != text;
+        while (expectedAccepted && *end != '\0' && std::isspace(static_cast<unsigned char>(*end)) != 0) {
+            ++end;
+        }
+        expectedAccepted = expectedAccepted && *end == '\0' && errno != ERANGE;
+        ASSERT_TRUE(suite, accepted == expectedAccepted, "luaStringToNumber acceptance matches strtod for " + std::string(text));
+        if (accepted && expectedAccepted && !std::isnan(expected)) {
+            ASSERT_TRUE(suite, parsed == expected, "luaStringToNumber value matches strtod for " + std::string(text));
+        }
+    }
+}
+
+void testSmallIntegerStringCache(TestSuite& suite) {
+    LuaState* L = createFullState();
+    bool ok = runLua(L, R"lua(
+        local t = {}
+        for i = -300, 70000, 7 do
+            t[tostring(i)] = i
+        end
+        gLookups = t["-293"] == -293 and t["-6"] == -6 and t["65535"] == 65535 and t["69994"] == 69994
+        gSame = rawequal(tostring(12), tostring(12)) and tostring(12) == "12"
+        gConcat = "id" .. 255 .. ":" .. -256 .. ":" .. 1.5 .. ":" .. 65536
+        collectgarbage("collect")
+        gAfterCollect = tostring(70) .. tostring(-1)
+    )lua");
+
+    ASSERT_TRUE(suite, ok, "small integer string chunk runs");
+    ASSERT_TRUE(suite, getGlobalBool(L, "gLookups"), "tostring keys address the same table slots");
+    ASSERT_TRUE(suite, getGlobalBool(L, "gSame"), "cached integers intern to the same string");
+    ASSERT_TRUE(suite, getGlobalStr(L, "gConcat") == "id255:-256:1.5:65536", "concat formats cached and uncached numbers");
+    ASSERT_TRUE(suite, getGlobalStr(L, "gAfterCollect") == "70-1", "cache entries survive collection of their strings");
+
+    StringPool& pool = L->getGlobalState().getStringPool();
+    GCString* cached = pool.internNumber(4242.0);
+    ASSERT_TRUE(suite, cached == pool.internNumber(4242.0), "internNumber returns the cached object");
+    ASSERT_TRUE(suite, cached == pool.intern("4242"), "cached integer strings are ordinary interned strings");
+    ASSERT_TRUE(suite, pool.internNumber(-0.0)->view() == "-0", "negative zero bypasses the integer cache");
+    pool.remove(cached);
+    GCString* replacement = pool.internNumber(4242.0);
+    ASSERT_TRUE(suite, replacement != cached && replacement->view() == "4242",
+                "removing a cached string invalidates its cache slot");
+    delete L;
+}
+
 void testTonumberWrapper(TestSuite& suite) {
     LuaStdLibTestContext ctx(openBaseLib);
     if (!ctx.ensureGlobalFunction("tonumber", suite, "tonumber function exists")) {
@@ -654,6 +771,51 @@ void testErrorPreservesLuaObject(TestSuite& suite) {
     ASSERT_TRUE(suite, levelZero.isBoolean() && levelZero.asBoolean(), "error(message, 0) keeps raw message");
 }
 
+void testPcallErrorStatusPath(TestSuite& suite) {
+    LuaState* L = createFullState();
+
+    bool ok = runLua(L, R"lua(
+        local function deep(n, v) if n == 0 then error(v, 0) end return deep(n - 1, v) + 1 end
+        local okDeep, deepValue = pcall(deep, 5, 'deep')
+        gStatusNested = (not okDeep and deepValue == 'deep')
+
+        local okTail, tailValue = pcall(function(v) return error(v, 0) end, 'tail')
+        gStatusTail = (not okTail and tailValue == 'tail')
+
+        local okDirect, directValue = pcall(error, 'direct', 0)
+        gStatusDirect = (not okDirect and directValue == 'direct')
+
+        local getter
+        pcall(function() local captured = 'closed'; getter = function() return captured end; error('x') end)
+        gStatusUpvalueClosed = (getter() == 'closed')
+
+        local okNested, innerOk, innerValue = pcall(function()
+            local iok, ivalue = pcall(error, 'inner', 0)
+            return iok, ivalue
+        end)
+        gStatusNestedPcall = (okNested and innerOk == false and innerValue == 'inner')
+
+        local okMeta, metaValue = pcall(function()
+            local t = setmetatable({}, { __index = function() error('from __index', 0) end })
+            return t.x
+        end)
+        gStatusMetamethod = (not okMeta and metaValue == 'from __index')
+
+        local okX, trace = xpcall(function() deep(2, 'traced') end, debug.traceback)
+        gStatusXpcallTrace = (not okX and string.find(trace, 'deep', 1, true) ~= nil)
+    )lua");
+
+    ASSERT_TRUE(suite, ok, "pcall status error chunk runs");
+    ASSERT_TRUE(suite, L->getGlobal("gStatusNested").asBoolean(), "error through nested Lua frames reaches pcall");
+    ASSERT_TRUE(suite, L->getGlobal("gStatusTail").asBoolean(), "tail-called error reaches pcall");
+    ASSERT_TRUE(suite, L->getGlobal("gStatusDirect").asBoolean(), "pcall(error, v) returns v");
+    ASSERT_TRUE(suite, L->getGlobal("gStatusUpvalueClosed").asBoolean(), "unwound frame closes its upvalues");
+    ASSERT_TRUE(suite, L->getGlobal("gStatusNestedPcall").asBoolean(), "inner pcall does not leak into outer");
+    ASSERT_TRUE(suite, L->getGlobal("gStatusMetamethod").asBoolean(), "error inside metamethod still propagates");
+    ASSERT_TRUE(suite, L->getGlobal("gStatusXpcallTrace").asBoolean(), "xpcall handler sees the erroring frames");
+    ASSERT_FALSE(suite, L->hasRaisedError(), "no raised error is left pending");
+}
+
 void testCallErrorNamesOffendingValue(TestSuite& suite) {
     LuaState* L = createFullState();
 
@@ -1756,6 +1918,8 @@ void registerBaselibTests() {
     registry.registerTest(kSuiteName, "type", testTypeWrapper);
     registry.registerTest(kSuiteName, "tostring", testTostringWrapper);
     registry.registerTest(kSuiteName, "tonumber", testTonumberWrapper);
+    registry.registerTest(kSuiteName, "number formatting", testNumberFormattingMatchesLua51);
+    registry.registerTest(kSuiteName, "small integer strings", testSmallIntegerStringCache);
     registry.registerTest(kSuiteName, "assert", testAssertWrapper);
     registry.registerTest(kSuiteName, "metatable", testMetatableWrapper);
     registry.registerTest(kSuiteName, "rawget", testRawgetWrapper);
@@ -1768,6 +1932,7 @@ void registerBaselibTests() {
     registry.registerTest(kSuiteName, "select", testSelectWrapper);
     registry.registerTest(kSuiteName, "pcall", testPcallWrapper);
     registry.registerTest(kSuiteName, "error object", testErrorPreservesLuaObject);
+    registry.registerTest(kSuiteName, "pcall status error", testPcallErrorStatusPath);
     registry.registerTest(kSuiteName, "call error naming", testCallErrorNamesOffendingValue);
     registry.registerTest(kSuiteName, "runtime error line", testRuntimeErrorMessageCarriesLine);
     registry.registerTest(kSuiteName, "xpcall", testXpcallWrapper);
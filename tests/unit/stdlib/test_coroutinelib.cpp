@@ -6,6 +6,7 @@
 #include "../framework/test_framework.hpp"
 #include "lib/lib_manager.hpp"
 #include "lib/coroutinelib.hpp"
+#include "vm/state/global_state.hpp"
 #include "vm/state/lua_state.hpp"
 #include "core/function.hpp"
 #include "core/gc_string.hpp"
@@ -16,7 +17,9 @@
 #include "compiler/codegen/codegen.hpp"
 #include "runtime/runtime_services.hpp"
 
+#include <chrono>
 #include <string>
+#include <thread>
 
 using namespace Lua;
 using namespace LuaTest;
@@ -586,6 +589,207 @@ void testCoroutineTransfersReleaseDuplicateRoots(TestSuite& suite) {
     delete L;
 }
 
+// ==================================================================
+// Test: Lua-to-Lua resume switches frames inside one dispatch loop
+// ==================================================================
+
+void testNestedResumeSwitch(TestSuite& suite) {
+    LuaState* L = createState();
+    bool ok = runLua(L, R"(
+        local depth = 1000
+        local function nest(level)
+            if level == depth then
+                return coroutine.create(function(x)
+                    local y = coroutine.yield(x + 1)
+                    return y * 2
+                end)
+            end
+            local inner = nest(level + 1)
+            return coroutine.create(function(x)
+                local _, v = coroutine.resume(inner, x)
+                local _, w = coroutine.resume(inner, coroutine.yield(v))
+                return w
+            end)
+        end
+
+        local outer = nest(1)
+        local ok1, v1 = coroutine.resume(outer, 1)
+        local ok2, v2 = coroutine.resume(outer, 21)
+        r_nested_first = ok1 and v1
+        r_nested_second = ok2 and v2
+        r_nested_dead = coroutine.status(outer) == "dead"
+
+        local observer = coroutine.create(function()
+            local parent = coroutine.running()
+            local child = coroutine.create(function()
+                coroutine.yield(coroutine.status(parent), coroutine.running() ~= parent)
+            end)
+            return coroutine.resume(child)
+        end)
+        local _, childOk, parentStatus, distinct = coroutine.resume(observer)
+        r_switch_status = childOk and parentStatus == "normal" and distinct
+    )");
+    ASSERT_TRUE(suite, ok, "nested switched resume chunk runs");
+    ASSERT_EQ(suite, getGlobalNumber(L, "r_nested_first"), 2.0, "yield crosses every nested resume");
+    ASSERT_EQ(suite, getGlobalNumber(L, "r_nested_second"), 42.0, "values flow back through the chain");
+    ASSERT_TRUE(suite, getGlobalBool(L, "r_nested_dead"), "outer coroutine finishes");
+    ASSERT_TRUE(suite, getGlobalBool(L, "r_switch_status"), "resumer is normal while a switched child runs");
+    delete L;
+}
+
+// ==================================================================
+// Test: errors leaving a switched coroutine
+// ==================================================================
+
+void testSwitchedResumeErrors(TestSuite& suite) {
+    LuaState* L = createState();
+    bool ok = runLua(L, R"(
+        local marker = {}
+        local leaf = coroutine.wrap(function()
+            coroutine.yield(1)
+            error(marker)
+        end)
+        local middle = coroutine.wrap(function()
+            coroutine.yield(leaf())
+            return leaf()
+        end)
+        local first = middle()
+        local ok2, err = pcall(middle)
+        r_wrap_chain = first == 1 and not ok2 and err == marker
+
+        local co = coroutine.create(function()
+            local inner = coroutine.create(function() error("inner failure") end)
+            local okInner, msg = coroutine.resume(inner)
+            coroutine.yield(okInner, msg)
+            return coroutine.status(inner)
+        end)
+        local _, okInner, msg = coroutine.resume(co)
+        local _, innerStatus = coroutine.resume(co)
+        r_resume_error = okInner == false and string.find(msg, "inner failure", 1, true) ~= nil
+        r_resume_error_dead = innerStatus == "dead"
+
+        local selfResume = coroutine.create(function()
+            return coroutine.resume(coroutine.running())
+        end)
+        local _, okSelf, selfMsg = coroutine.resume(selfResume)
+        r_self_resume = okSelf == false and string.find(selfMsg, "cannot resume", 1, true) ~= nil
+
+        local viaPcall = coroutine.create(function()
+            return pcall(function()
+                local inner = coroutine.wrap(function() coroutine.yield(7) end)
+                return inner()
+            end)
+        end)
+        local _, okPcall, value = coroutine.resume(viaPcall)
+        r_resume_in_pcall = okPcall and value == 7
+    )");
+    ASSERT_TRUE(suite, ok, "switched resume error chunk runs");
+    ASSERT_TRUE(suite, getGlobalBool(L, "r_wrap_chain"), "wrap errors unwind through switched wrap callers");
+    ASSERT_TRUE(suite, getGlobalBool(L, "r_resume_error"), "resume reports a switched coroutine error");
+    ASSERT_TRUE(suite, getGlobalBool(L, "r_resume_error_dead"), "failed switched coroutine is dead");
+    ASSERT_TRUE(suite, getGlobalBool(L, "r_self_resume"), "resuming the running coroutine fails");
+    ASSERT_TRUE(suite, getGlobalBool(L, "r_resume_in_pcall"), "switched resume works inside pcall");
+    delete L;
+}
+
+// ==================================================================
+// Test: dead coroutine states are recycled through the global pool
+// ==================================================================
+
+void testDeadCoroutineStatePool(TestSuite& suite) {
+    LuaState* L = createState();
+    GlobalState& globalState = L->getGlobalState();
+
+    bool ok = runLua(L, R"(
+        fresh = coroutine.create(function() end)
+    )");
+    ASSERT_TRUE(suite, ok, "fresh coroutine chunk runs");
+    Value fresh = L->getGlobal("fresh");
+    ASSERT_TRUE(suite, fresh.isThread(), "fresh coroutine is a thread");
+    LuaState* freshState = fresh.asThread()->getLuaState();
+    ASSERT_EQ(suite, freshState->getStack().capacity(), THREAD_INITIAL_STACK_SIZE,
+              "new coroutine starts with the small stack");
+    ASSERT_EQ(suite, freshState->getCallStack().size(), THREAD_INITIAL_CI_SIZE,
+              "new coroutine starts with the small call-info array");
+
+    ok = runLua(L, R"(
+        fresh = nil
+        for i = 1, 50 do
+            local step = coroutine.wrap(function(x) coroutine.yield(x) return x end)
+            step(i)
+            step()
+        end
+        local pending = coroutine.wrap(function()
+            local a = 1
+            local bump = function() a = a + 1 return a end
+            coroutine.yield(bump)
+        end)
+        pending()
+        pending = nil
+        -- 完整收集会清空状态池，这里只用增量步进完成两个周期
+        for _ = 1, 2 do
+            repeat until collectgarbage("step", 0)
+        end
+    )");
+    ASSERT_TRUE(suite, ok, "coroutine churn chunk runs");
+    const usize pooled = globalState.getThreadStatePoolSize();
+    ASSERT_TRUE(suite, pooled > 0, "collected coroutines leave their states in the pool");
+
+    ok = runLua(L, R"(
+        local co = coroutine.create(function(a, b)
+            local t = {a, b}
+            coroutine.yield(#t, coroutine.status(coroutine.running()))
+            return a + b
+        end)
+        local _, n, status = coroutine.resume(co, 3, 4)
+        local _, sum = coroutine.resume(co)
+        r_pool_reuse = n == 2 and status == "running" and sum == 7 and coroutine.status(co) == "dead"
+    )");
+    ASSERT_TRUE(suite, ok, "coroutine on a recycled state runs");
+    ASSERT_TRUE(suite, getGlobalBool(L, "r_pool_reuse"), "recycled state behaves like a fresh coroutine");
+    ASSERT_EQ(suite, globalState.getThreadStatePoolSize(), pooled - 1, "coroutine.create takes a pooled state");
+
+    GarbageCollector& gc = globalState.getGC();
+    const usize accountedWithPool = gc.getAccountedMemory();
+    const usize totalWithPool = gc.getTotalMemory();
+    globalState.clearThreadStatePool();
+    ASSERT_EQ(suite, globalState.getThreadStatePoolSize(), static_cast<usize>(0), "pool can be emptied");
+    ASSERT_TRUE(suite, gc.getAccountedMemory() < accountedWithPool, "pooled states count toward accounted memory");
+    ASSERT_TRUE(suite, gc.getTotalMemory() < totalWithPool, "pooled states count toward the heap total");
+
+    ok = runLua(L, R"(
+        collectgarbage()
+        local function deep(n) if n > 0 then return 1 + deep(n - 1) end return coroutine.yield() end
+        local deepStep = coroutine.wrap(function() return deep(200) end)
+        deepStep()
+        deepStep(0)
+        deepStep = nil
+        for _ = 1, 2 do
+            repeat until collectgarbage("step", 0)
+        end
+    )");
+    ASSERT_TRUE(suite, ok, "deep coroutine chunk runs");
+    ASSERT_EQ(suite, globalState.getThreadStatePoolSize(), static_cast<usize>(0),
+              "states left by deep recursion are not pooled");
+
+    ok = runLua(L, R"(
+        for i = 1, 20 do
+            local step = coroutine.wrap(function(x) coroutine.yield(x) return x end)
+            step(i)
+            step()
+        end
+        for _ = 1, 2 do
+            repeat until collectgarbage("step", 0)
+        end
+    )");
+    ASSERT_TRUE(suite, ok, "refill chunk runs");
+    ASSERT_TRUE(suite, globalState.getThreadStatePoolSize() > 0, "incremental cycles refill the pool");
+    ok = runLua(L, "collectgarbage()");
+    ASSERT_TRUE(suite, ok, "full collection runs");
+    ASSERT_EQ(suite, globalState.getThreadStatePoolSize(), static_cast<usize>(0), "full collection empties the pool");
+    delete L;
+}
+
 // ==================================================================
 // Test: coroutine.wrap with multiple return values
 // ==================================================================
@@ -625,6 +829,208 @@ void testWrapNoYield(TestSuite& suite) {
     delete L;
 }
 
+// ==================================================================
+// Test: built-in scheduler (spawn / join / sleep / channel)
+// ==================================================================
+
+void testSchedulerTasks(TestSuite& suite) {
+    LuaState* L = createState();
+    CoroutineScheduler& scheduler = L->getGlobalState().getScheduler();
+    bool ok = runLua(L, R"(
+        trace = {}
+        local ch = coroutine.channel()
+        consumer = coroutine.spawn(function()
+            local sum = 0
+            for i = 1, 3 do
+                local v = ch:receive()
+                trace[#trace + 1] = "recv" .. v
+                sum = sum + v
+            end
+            return sum
+        end)
+        producer = coroutine.spawn(function(base)
+            for i = 1, 3 do
+                ch:send(base + i)
+                coroutine.yield()
+            end
+            return "sent"
+        end, 10)
+        joiner = coroutine.spawn(function()
+            local ok, sum = coroutine.join(consumer)
+            r_joined = ok and sum
+            return sum * 2
+        end)
+        sleeper = coroutine.spawn(function()
+            coroutine.sleep(0.002)
+            r_woke = true
+        end)
+        failing = coroutine.spawn(function() error("task boom") end)
+        r_outside = pcall(coroutine.sleep, 1)
+    )");
+    ASSERT_TRUE(suite, ok, "scheduler setup chunk runs");
+    ASSERT_FALSE(suite, getGlobalBool(L, "r_outside"), "sleep outside a task is an error");
+    ASSERT_EQ(suite, scheduler.getTaskCount(), static_cast<usize>(5), "spawned tasks are pending");
+
+    const i32 hostTop = L->getTop();
+    usize pending = scheduler.run(L, CoroutineScheduler::UnlimitedBudget);
+    for (int round = 0; pending > 0 && round < 2000; ++round) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        pending = scheduler.run(L, CoroutineScheduler::UnlimitedBudget);
+    }
+    ASSERT_EQ(suite, pending, static_cast<usize>(0), "all tasks finish");
+    ASSERT_EQ(suite, L->getTop(), hostTop, "scheduler leaves the host stack balanced");
+    ASSERT_EQ(suite, getGlobalNumber(L, "r_joined"), 36.0, "join delivers the task results");
+    ASSERT_TRUE(suite, getGlobalBool(L, "r_woke"), "sleeping task wakes after its deadline");
+
+    ok = runLua(L, R"(
+        r_trace = table.concat(trace, ",")
+        local ok1, sum = coroutine.join(consumer)
+        local ok2, doubled = coroutine.join(joiner)
+        local ok3, msg = coroutine.join(failing)
+        r_finished = ok1 and sum == 36 and ok2 and doubled == 72 and not ok3
+        r_message = msg
+        r_not_task = pcall(coroutine.join, coroutine.create(function() end))
+    )");
+    ASSERT_TRUE(suite, ok, "join of finished tasks runs on the host");
+    ASSERT_EQ(suite, getGlobalString(L, "r_trace"), std::string("recv11,recv12,recv13"), "channel is FIFO");
+    ASSERT_TRUE(suite, getGlobalBool(L, "r_finished"), "finished tasks keep their results for join");
+    ASSERT_TRUE(suite, getGlobalString(L, "r_message").find("task boom") != std::string::npos,
+                "task error is reported through join");
+    ASSERT_FALSE(suite, getGlobalBool(L, "r_not_task"), "join rejects plain coroutines");
+
+    ok = runLua(L, R"(
+        r_steps = 0
+        coroutine.spawn(function()
+            for i = 1, 4 do
+                r_steps = r_steps + 1
+                coroutine.yield()
+            end
+        end)
+    )");
+    ASSERT_TRUE(suite, ok, "budget chunk runs");
+    ASSERT_EQ(suite, scheduler.run(L, 2), static_cast<usize>(1), "budget bounds the resumes per run");
+    ASSERT_EQ(suite, getGlobalNumber(L, "r_steps"), 2.0, "plain yield requeues the task");
+    ASSERT_EQ(suite, scheduler.run(L, CoroutineScheduler::UnlimitedBudget), static_cast<usize>(0),
+              "remaining steps finish");
+    ASSERT_EQ(suite, getGlobalNumber(L, "r_steps"), 4.0, "task ran every step");
+    delete L;
+}
+
+void testSchedulerFarTimers(TestSuite& suite) {
+    LuaState* L = createState();
+    CoroutineScheduler& scheduler = L->getGlobalState().getScheduler();
+    bool ok = runLua(L, R"(
+        order = {}
+        coroutine.spawn(function()
+            coroutine.sleep(0.3)
+            order[#order + 1] = "far"
+        end)
+        coroutine.spawn(function()
+            coroutine.sleep(0.002)
+            order[#order + 1] = "near"
+        end)
+    )");
+    ASSERT_TRUE(suite, ok, "far timer chunk runs");
+
+    const auto start = std::chrono::steady_clock::now();
+    usize pending = scheduler.run(L, CoroutineScheduler::UnlimitedBudget);
+    for (int round = 0; pending > 1 && round < 2000; ++round) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        pending = scheduler.run(L, CoroutineScheduler::UnlimitedBudget);
+    }
+    ASSERT_EQ(suite, pending, static_cast<usize>(1), "near timer expires while the far timer is pending");
+    for (int round = 0; pending > 0 && round < 4000; ++round) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        pending = scheduler.run(L, CoroutineScheduler::UnlimitedBudget);
+    }
+    ASSERT_EQ(suite, pending, static_cast<usize>(0), "timer beyond one wheel revolution expires");
+    ASSERT_TRUE(suite, std::chrono::steady_clock::now() - start >= std::chrono::milliseconds(300),
+                "far timer does not expire early");
+
+    ok = runLua(L, "r_order = table.concat(order, ',')");
+    ASSERT_TRUE(suite, ok, "order chunk runs");
+    ASSERT_EQ(suite, getGlobalString(L, "r_order"), std::string("near,far"), "timers expire in deadline order");
+    delete L;
+}
+
+void testChannelSkipsStaleReceivers(TestSuite& suite) {
+    LuaState* L = createState();
+    CoroutineScheduler& scheduler = L->getGlobalState().getScheduler();
+    bool ok = runLua(L, R"(
+        ch = coroutine.channel()
+        receiver = coroutine.spawn(function()
+            r_first = ch:receive()
+            return "done"
+        end)
+    )");
+    ASSERT_TRUE(suite, ok, "receiver chunk runs");
+    ASSERT_EQ(suite, scheduler.run(L, CoroutineScheduler::UnlimitedBudget), static_cast<usize>(1),
+              "receiver waits on the empty channel");
+
+    // 由其他方唤醒后，接收任务仍留在通道的等待队列中
+    Thread* receiver = L->getGlobal("receiver").asThread();
+    ASSERT_TRUE(suite, scheduler.wake(receiver, {}), "waiting receiver can be woken directly");
+    ASSERT_EQ(suite, scheduler.run(L, CoroutineScheduler::UnlimitedBudget), static_cast<usize>(0),
+              "woken receiver finishes");
+    ASSERT_FALSE(suite, scheduler.wake(receiver, {}), "finished task is not woken again");
+
+    ok = runLua(L, R"(
+        coroutine.spawn(function() ch:send(42) end)
+        coroutine.spawn(function() r_late = ch:receive() end)
+    )");
+    ASSERT_TRUE(suite, ok, "sender chunk runs");
+    ASSERT_EQ(suite, scheduler.run(L, CoroutineScheduler::UnlimitedBudget), static_cast<usize>(0),
+              "late receiver gets the value instead of waiting forever");
+    ASSERT_EQ(suite, getGlobalNumber(L, "r_late"), 42.0, "value sent past a stale receiver stays buffered");
+    delete L;
+}
+
+void testSchedulerRejectsDirectResume(TestSuite& suite) {
+    LuaState* L = createState();
+    CoroutineScheduler& scheduler = L->getGlobalState().getScheduler();
+    bool ok = runLua(L, R"(
+        sleeper = coroutine.spawn(function()
+            coroutine.sleep(0.002)
+            return "slept"
+        end)
+        waiter = coroutine.spawn(function()
+            local ok, value = coroutine.join(sleeper)
+            return value
+        end)
+        local readyOk, readyMessage = coroutine.resume(sleeper)
+        r_ready_rejected = not readyOk and readyMessage:find("suspended by the scheduler") ~= nil
+    )");
+    ASSERT_TRUE(suite, ok, "direct resume setup chunk runs");
+    ASSERT_TRUE(suite, getGlobalBool(L, "r_ready_rejected"), "resume of a ready task is rejected");
+
+    ASSERT_EQ(suite, scheduler.run(L, CoroutineScheduler::UnlimitedBudget), static_cast<usize>(2),
+              "sleeping and waiting tasks stay pending");
+    ok = runLua(L, R"(
+        local sleepOk = coroutine.resume(sleeper)
+        local waitOk = coroutine.resume(waiter)
+        r_suspended_rejected = not sleepOk and not waitOk
+        r_status = coroutine.status(sleeper) .. "," .. coroutine.status(waiter)
+    )");
+    ASSERT_TRUE(suite, ok, "direct resume of suspended tasks runs");
+    ASSERT_TRUE(suite, getGlobalBool(L, "r_suspended_rejected"), "resume of sleeping and waiting tasks is rejected");
+    ASSERT_EQ(suite, getGlobalString(L, "r_status"), std::string("suspended,suspended"),
+              "rejected resumes leave the tasks suspended");
+
+    usize pending = scheduler.run(L, CoroutineScheduler::UnlimitedBudget);
+    for (int round = 0; pending > 0 && round < 2000; ++round) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        pending = scheduler.run(L, CoroutineScheduler::UnlimitedBudget);
+    }
+    ASSERT_EQ(suite, pending, static_cast<usize>(0), "tasks still finish under the scheduler");
+    ok = runLua(L, R"(
+        local ok, value = coroutine.join(waiter)
+        r_joined = ok and value
+    )");
+    ASSERT_TRUE(suite, ok, "join after direct resume attempts runs");
+    ASSERT_EQ(suite, getGlobalString(L, "r_joined"), std::string("slept"), "waiter received the sleeper result");
+    delete L;
+}
+
 // ==================================================================
 // Registration
 // ==================================================================
@@ -655,6 +1061,13 @@ void registerCoroutineLibTests() {
                           testPendingCoroutineWithOpenUpvalueCanBeCollected);
     registry.registerTest(kSuiteName, "coroutine transfers release duplicate roots",
                           testCoroutineTransfersReleaseDuplicateRoots);
+    registry.registerTest(kSuiteName, "nested resume switch", testNestedResumeSwitch);
+    registry.registerTest(kSuiteName, "switched resume errors", testSwitchedResumeErrors);
+    registry.registerTest(kSuiteName, "dead coroutine state pool", testDeadCoroutineStatePool);
     registry.registerTest(kSuiteName, "wrap multiple values", testWrapMultipleValues);
     registry.registerTest(kSuiteName, "wrap no yield", testWrapNoYield);
+    registry.registerTest(kSuiteName, "scheduler tasks", testSchedulerTasks);
+    registry.registerTest(kSuiteName, "scheduler rejects direct resume", testSchedulerRejectsDirectResume);
+    registry.registerTest(kSuiteName, "scheduler far timers", testSchedulerFarTimers);
+    registry.registerTest(kSuiteName, "channel skips stale receivers", testChannelSkipsStaleReceivers);
 }
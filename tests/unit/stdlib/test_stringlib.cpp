@@ -18,6 +18,7 @@
 #include "core/table.hpp"
 #include "core/function.hpp"
 #include "core/gc_string.hpp"
+#include "core/userdata.hpp"
 #include "compiler/parser/parser.hpp"
 #include "compiler/codegen/codegen.hpp"
 
@@ -716,6 +717,41 @@ void testStringGmatchNoMatch(TestSuite& suite) {
     delete L;
 }
 
+void testStringGmatchIteratorState(TestSuite& suite) {
+    LuaState* L = createFullState();
+
+    // 迭代器状态跨协程、跨回收周期保持有效；耗尽后继续调用仍返回 nil
+    bool ok = runLua(L, R"lua(
+        local text = string.rep("alpha beta ", 200)
+        local it = string.gmatch(text, "(%a+)()")
+        local first, firstPos = it()
+        local co = coroutine.wrap(function()
+            local w, p = it()
+            coroutine.yield(w .. ":" .. p)
+        end)
+        local fromCoroutine = co()
+        text = nil
+        collectgarbage()
+        local count = 2
+        while it() do
+            count = count + 1
+        end
+        gResult = first .. ":" .. firstPos .. "," .. fromCoroutine
+        gCount = count
+        gExhausted = it() == nil and it() == nil
+        gPosition = string.gsub("ab", "()", "[%1]")
+    )lua");
+    ASSERT_TRUE(suite, ok, "gmatch iterator state runs");
+    ASSERT_EQ(suite, std::string("alpha:6,beta:11"), getGlobalStr(L, "gResult"),
+              "gmatch iterator resumes from another coroutine");
+    ASSERT_EQ(suite, 400.0, getGlobalNumber(L, "gCount"), "gmatch iterator survives collection of its subject");
+    ASSERT_TRUE(suite, L->getGlobal("gExhausted").asBoolean(), "exhausted gmatch iterator keeps returning nil");
+    ASSERT_EQ(suite, std::string("[1]a[2]b[3]"), getGlobalStr(L, "gPosition"),
+              "gsub position capture formats without temporary strings");
+
+    delete L;
+}
+
 // =====================================================================
 // Pattern matching tests for string.find (pattern mode)
 // =====================================================================
@@ -1196,6 +1232,116 @@ void testStringResourceAndIntegerBoundaries(TestSuite& suite) {
                 "string.format integer specifiers reject NaN before conversion");
 }
 
+void testStringBuffer(TestSuite& suite) {
+    LuaState* L = createFullState();
+
+    bool ok = runLua(L, R"lua(
+        local buf = string.buffer.new(8)
+        for i = 1, 100 do
+            buf:put(i, ",")
+        end
+        gLen = #buf
+        gMethodLen = buf:len()
+        gPrefix = string.sub(buf, 1, 6)
+        gFind = string.find(buf, "99,", 1, true)
+
+        buf:reset():put("a", 1.5, "b"):putf("[%5.2f|%s]", 3.14159, "x")
+        gFormatted = buf:tostring()
+        gToString = tostring(buf)
+
+        buf:put(buf)
+        gSelf = buf:tostring()
+
+        local head, mid = buf:get(2, 3)
+        gHead = head
+        gMid = mid
+        gRest = buf:get()
+        gEmpty = buf:len()
+
+        local other = string.buffer.new():put("xy")
+        buf:put("<", other, ">")
+        gNested = buf:tostring()
+        gGsub = string.gsub(buf, "%w", function(ch) buf:put(ch) return ch:upper() end)
+        gFormatArg = string.format("%s!", other)
+
+        for _ = 1, 50 do
+            buf:put("0123456789")
+            buf:get(10)
+        end
+        gInterleaved = buf:len()
+
+        gBadPut = pcall(function() buf:put({}) end)
+        gBadSelf = pcall(buf.put, "not a buffer", "x")
+    )lua");
+    ASSERT_TRUE(suite, ok, "string.buffer script runs");
+    ASSERT_EQ(suite, 292.0, getGlobalNumber(L, "gLen"), "# operator uses buffer __len");
+    ASSERT_EQ(suite, 292.0, getGlobalNumber(L, "gMethodLen"), "buf:len reports unconsumed bytes");
+    ASSERT_EQ(suite, std::string("1,2,3,"), getGlobalStr(L, "gPrefix"), "string.sub reads buffer bytes");
+    ASSERT_EQ(suite, 286.0, getGlobalNumber(L, "gFind"), "string.find accepts buffer subject");
+    ASSERT_EQ(suite, std::string("a1.5b[ 3.14|x]"), getGlobalStr(L, "gFormatted"), "put/putf append in order");
+    ASSERT_EQ(suite, std::string("a1.5b[ 3.14|x]"), getGlobalStr(L, "gToString"), "tostring uses buffer __tostring");
+    ASSERT_EQ(suite, std::string("a1.5b[ 3.14|x]a1.5b[ 3.14|x]"), getGlobalStr(L, "gSelf"),
+              "buf:put(buf) duplicates contents safely");
+    ASSERT_EQ(suite, std::string("a1"), getGlobalStr(L, "gHead"), "get(n) consumes leading bytes");
+    ASSERT_EQ(suite, std::string(".5b"), getGlobalStr(L, "gMid"), "get returns one string per length");
+    ASSERT_EQ(suite, std::string("[ 3.14|x]a1.5b[ 3.14|x]"), getGlobalStr(L, "gRest"), "get() drains the rest");
+    ASSERT_EQ(suite, 0.0, getGlobalNumber(L, "gEmpty"), "drained buffer is empty");
+    ASSERT_EQ(suite, std::string("<xy>"), getGlobalStr(L, "gNested"), "put accepts another buffer");
+    ASSERT_EQ(suite, std::string("<XY>"), getGlobalStr(L, "gGsub"), "gsub snapshots buffer subject before callbacks");
+    ASSERT_EQ(suite, std::string("xy!"), getGlobalStr(L, "gFormatArg"), "format %s accepts buffer");
+    ASSERT_EQ(suite, 6.0, getGlobalNumber(L, "gInterleaved"), "interleaved put/get keeps unconsumed bytes");
+    ASSERT_TRUE(suite, L->getGlobal("gBadPut").isFalse(), "put rejects tables");
+    ASSERT_TRUE(suite, L->getGlobal("gBadSelf").isFalse(), "methods reject non-buffer self");
+
+    ok = runLua(L, R"lua(
+        local f = io.tmpfile()
+        local buf = string.buffer.new():put("line1\n"):putf("%d-%s", 42, "z")
+        f:write(buf, "|", 7)
+        f:seek("set")
+        gWritten = f:read("*a")
+        f:close()
+    )lua");
+    ASSERT_TRUE(suite, ok, "file write with buffer runs");
+    ASSERT_EQ(suite, std::string("line1\n42-z|7"), getGlobalStr(L, "gWritten"), "f:write writes buffer bytes directly");
+
+    ResourcePolicy& policy = L->getGlobalState().getResourcePolicy();
+    const usize oldStringLimit = policy.maxStringBytes;
+    policy.maxStringBytes = 16;
+    ok = runLua(L, R"lua(
+        local buf = string.buffer.new()
+        buf:put("0123456789")
+        gLimited = pcall(function() buf:put("0123456789") end)
+    )lua");
+    policy.maxStringBytes = oldStringLimit;
+    ASSERT_TRUE(suite, ok, "buffer limit script runs");
+    ASSERT_TRUE(suite, L->getGlobal("gLimited").isFalse(), "buffer growth respects maxStringBytes");
+
+    ok = runLua(L, R"lua(
+        gNewNaN = pcall(string.buffer.new, 0 / 0)
+        gNewInf = pcall(string.buffer.new, 1 / 0)
+        local buf = string.buffer.new():put("abc")
+        gGetNaN = pcall(buf.get, buf, 0 / 0)
+        gGetHuge = buf:get(2 ^ 80)
+        gGrowing = string.buffer.new()
+        gPayload = string.rep("x", 4096)
+    )lua");
+    ASSERT_TRUE(suite, ok, "buffer argument script runs");
+    ASSERT_TRUE(suite, L->getGlobal("gNewNaN").isFalse(), "new rejects NaN sizes");
+    ASSERT_TRUE(suite, L->getGlobal("gNewInf").isFalse(), "new rejects infinite sizes");
+    ASSERT_TRUE(suite, L->getGlobal("gGetNaN").isFalse(), "get rejects NaN counts");
+    ASSERT_EQ(suite, std::string("abc"), getGlobalStr(L, "gGetHuge"), "get clamps large counts to the buffer size");
+
+    GarbageCollector& gc = L->getGlobalState().getGC();
+    Userdata* growing = L->getGlobal("gGrowing").asUserdata();
+    const usize accountedBefore = gc.getAccountedMemory();
+    ok = runLua(L, R"lua(gGrowing:put(gPayload))lua");
+    ASSERT_TRUE(suite, ok, "buffer growth script runs");
+    ASSERT_TRUE(suite, growing->getExternalSize() >= 4096, "buffer storage is reported as external bytes");
+    ASSERT_TRUE(suite, gc.getAccountedMemory() >= accountedBefore + 4096, "buffer growth is charged to the collector");
+
+    delete L;
+}
+
 // =====================================================================
 // Test Registration
 // =====================================================================
@@ -1216,6 +1362,7 @@ void registerStringLibTests() {
     registry.registerTest(kSuiteName, "string.gmatch single char", testStringGmatchSingleChar);
     registry.registerTest(kSuiteName, "string.gmatch empty string", testStringGmatchEmptyString);
     registry.registerTest(kSuiteName, "string.gmatch no match", testStringGmatchNoMatch);
+    registry.registerTest(kSuiteName, "string.gmatch iterator state", testStringGmatchIteratorState);
     registry.registerTest(kSuiteName, "string.find pattern", testStringFindPattern);
     registry.registerTest(kSuiteName, "string.match pattern", testStringMatchPattern);
     registry.registerTest(kSuiteName, "string.gsub pattern", testStringGsubPattern);
@@ -1224,4 +1371,5 @@ void registerStringLibTests() {
     registry.registerTest(kSuiteName, "string binary safety", testStringBinarySafety);
     registry.registerTest(kSuiteName, "string.dump", testStringDump);
     registry.registerTest(kSuiteName, "resource and integer boundaries", testStringResourceAndIntegerBoundaries);
+    registry.registerTest(kSuiteName, "string.buffer", testStringBuffer);
 }
@@ -84,13 +84,17 @@ void testStringPoolInsertionOomRollback(TestSuite& suite) {
         pool.setGarbageCollector(&gc);
         pool.resize(8);
 
+        // Warm the collector slab with a string of the same size class so the
+        // provisional GCString below is carved from an existing slab page.
+        (void)pool.intern("string-pool-insertion-xxx");
+
         const usize baselineLiveAllocations = probe.liveAllocations;
         const usize baselineObjectCount = gc.getObjectCount();
         const usize baselineMemory = gc.getAccountedMemory();
 
-        // The next allocator request creates GCString; the following request
-        // allocates the pre-reserved unordered_map node.
-        probe.failOnAllocation = probe.allocationAttempts + 2;
+        // GCString comes from the slab without an allocator request; the next
+        // request allocates the pre-reserved unordered_map node.
+        probe.failOnAllocation = probe.allocationAttempts + 1;
         bool threwBadAlloc = false;
         try {
             (void)pool.intern("string-pool-insertion-oom");
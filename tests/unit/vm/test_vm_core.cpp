@@ -7,6 +7,7 @@
  */
 
 #include "../framework/test_framework.hpp"
+#include "common/config.hpp"
 #include "vm/state/global_state.hpp"
 #include "vm/state/stack.hpp"
 #include "vm/state/call_info.hpp"
@@ -246,6 +247,21 @@ static i32 return_42(LuaState* L) {
     return 1;
 }
 
+/** @brief 记录 C 帧的预留空间，再用满 LUA_MINSTACK 个槽位，返回参数之和 */
+static i32 fill_min_stack(LuaState* L) {
+    const CallInfo& ci = L->getCurrentCallInfo();
+    const usize reserved = ci.top - L->getAbsoluteTop();
+    const bool capacityReady = L->getStack().capacity() >= ci.top;
+    const f64 sum = L->at(1).asNumber() + L->at(2).asNumber();
+    for (i32 i = 0; i < LUA_MINSTACK - 3; ++i) {
+        L->pushNil();
+    }
+    L->pushNumber(sum);
+    L->pushNumber(static_cast<f64>(reserved));
+    L->pushBoolean(capacityReady);
+    return 3;
+}
+
 void testLuaStateUserdataMetatable(TestSuite& suite) {
     LuaState* L = LuaState::newState();
     L->setTop(0);
@@ -366,6 +382,55 @@ void testTailReturnFromCFunctionKeepsLogicalTop(TestSuite& suite) {
     }
 }
 
+void testCFunctionFrameReservesMinStack(TestSuite& suite) {
+    const char* code = R"(
+        local total = 0
+        for i = 1, 100 do
+            local sum, reserved, ready = fill(i, 1)
+            if sum ~= i + 1 or reserved ~= 20 or not ready then
+                return false
+            end
+            total = total + sum
+        end
+        return total
+    )";
+
+    try {
+        RuntimeServices services = RuntimeServices::fromSingletons();
+        Parser parser(code);
+        auto parsed = parser.parse();
+        if (!parsed) {
+            throw parsed.error();
+        }
+        Chunk chunk = std::move(*parsed);
+
+        CodeGenerator codegen(services);
+        Proto* proto = codegen.generate(chunk, "=(c_frame_min_stack)");
+        ASSERT_TRUE(suite, proto != nullptr, "Proto generated for C frame");
+
+        LuaState* L = LuaState::newState();
+        Function* fill = new Function(fill_min_stack);
+        L->getGlobalState().getGC().registerObject(fill);
+        L->setGlobal("fill", Value(fill));
+
+        Function* chunkFunc = new Function(proto);
+        chunkFunc->setEnv(L->getGlobalTable());
+        L->getGlobalState().getGC().registerObject(chunkFunc);
+
+        VM::execute(services, L, chunkFunc);
+
+        ASSERT_TRUE(suite, L->top().isNumber(), "C frame loop completes");
+        if (L->top().isNumber()) {
+            ASSERT_EQ(suite, 5150.0, L->top().asNumber(), "C frames reserve LUA_MINSTACK slots above the arguments");
+        }
+
+        delete L;
+    } catch (const std::exception& e) {
+        std::cout << "  [ERROR] Exception: " << e.what() << std::endl;
+        ASSERT_TRUE(suite, false, "C frame min stack should not throw");
+    }
+}
+
 void testIOLibFileMetatableHooks(TestSuite& suite) {
     LuaState* L = LuaState::newState();
     openIOLib(L);
@@ -882,6 +947,7 @@ void registerVMCoreTests() {
     registry.registerTest("VM Core", "SELF Dispatch On Userdata", testSelfDispatchOnUserdata);
     registry.registerTest("VM Core", "Tail Return From C Function Keeps Logical Top",
                           testTailReturnFromCFunctionKeepsLogicalTop);
+    registry.registerTest("VM Core", "C Function Frame Reserves Min Stack", testCFunctionFrameReservesMinStack);
     registry.registerTest("VM Core", "IOLib File Metatable Hooks", testIOLibFileMetatableHooks);
     registry.registerTest("VM Core", "IOLib Default Input Output", testIOLibDefaultInputOutput);
     registry.registerTest("VM Core", "IOLib File Registry State Isolation", testIOLibFileRegistryIsStateIsolated);
@@ -169,7 +169,10 @@ $metricContract = [ordered]@{
     vm_instructions_per_second            = [pscustomobject]@{ Unit = "instructions/s"; Direction = "higher"; Samples = $ordinarySamples }
     cpp_to_lua_ns_per_call                = [pscustomobject]@{ Unit = "ns/call"; Direction = "lower"; Samples = $ordinarySamples }
     lua_to_cpp_ns_per_call                = [pscustomobject]@{ Unit = "ns/call"; Direction = "lower"; Samples = $ordinarySamples }
+    pcall_error_ns_per_call               = [pscustomobject]@{ Unit = "ns/call"; Direction = "lower"; Samples = $ordinarySamples }
     coroutine_resume_yield_ns             = [pscustomobject]@{ Unit = "ns/round-trip"; Direction = "lower"; Samples = $ordinarySamples }
+    coroutine_switch_ns                   = [pscustomobject]@{ Unit = "ns/round-trip"; Direction = "lower"; Samples = $ordinarySamples }
+    coroutine_spawn_ns                    = [pscustomobject]@{ Unit = "ns/coroutine"; Direction = "lower"; Samples = $ordinarySamples }
     table_operations_per_second           = [pscustomobject]@{ Unit = "operations/s"; Direction = "higher"; Samples = $ordinarySamples }
     closure_upvalue_lifecycle_per_second   = [pscustomobject]@{ Unit = "closures/s"; Direction = "higher"; Samples = $closureSamples }
     allocation_mib_per_second             = [pscustomobject]@{ Unit = "MiB/s"; Direction = "higher"; Samples = $closureSamples }
@@ -177,6 +180,8 @@ $metricContract = [ordered]@{
     gc_pause_p95_us                       = [pscustomobject]@{ Unit = "us"; Direction = "lower"; Samples = 1 }
     gc_pause_p99_us                       = [pscustomobject]@{ Unit = "us"; Direction = "lower"; Samples = 1 }
     gc_pause_max_us                       = [pscustomobject]@{ Unit = "us"; Direction = "lower"; Samples = 1 }
+    gc_pause_background_free_p99_us       = [pscustomobject]@{ Unit = "us"; Direction = "lower"; Samples = 1 }
+    gc_pause_background_free_max_us       = [pscustomobject]@{ Unit = "us"; Direction = "lower"; Samples = 1 }
     heap_growth_bytes_per_million_frames  = [pscustomobject]@{ Unit = "bytes/1M-frames"; Direction = "lower"; Samples = 1 }
 }
 